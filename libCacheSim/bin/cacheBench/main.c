@@ -0,0 +1,417 @@
+//
+// a multi-threaded throughput benchmark, all threads share one cache
+//
+// the trace is loaded into memory first so that the benchmark measures the
+// cache and not the trace reader. For each thread count, a new cache is warmed
+// up with one pass of the trace, then every thread replays the trace starting
+// from a different offset. Thread-safe algorithms (ConcurrentFIFO, ...,
+// ShardedLRU) are called directly, other algorithms are protected by one
+// global lock, which is the baseline the concurrent algorithms are compared
+// against
+//
+// example: ./cacheBench ../data/cloudPhysicsIO.vscsi vscsi concurrentClock 1GB
+//    --threads 1,2,4,8
+//
+
+#define _GNU_SOURCE
+#include <argp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../../include/libCacheSim/const.h"
+#include "../../utils/include/mystr.h"
+#include "../../utils/include/mysys.h"
+#include "../cachesim/cache_init.h"
+#include "../cli_reader_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define N_ARGS 4
+#define N_MAX_THREAD_CONFIG 32
+
+const char *argp_program_version = "cacheBench 0.0.1";
+const char *argp_program_bug_address =
+    "https://groups.google.com/g/libcachesim";
+
+enum argp_option_short {
+  OPTION_TRACE_TYPE_PARAMS = 't',
+  OPTION_EVICTION_PARAMS = 'e',
+  OPTION_NUM_REQ = 'n',
+  OPTION_THREADS = 0x100,
+  OPTION_NUM_REQ_PER_THREAD = 0x101,
+  OPTION_IGNORE_OBJ_SIZE = 0x102,
+  OPTION_NO_PIN = 0x103,
+};
+
+static struct argp_option options[] = {
+    {NULL, 0, NULL, 0, "trace reader related parameters", 0},
+    {"trace-type-params", OPTION_TRACE_TYPE_PARAMS,
+     "\"obj-id-col=1;delimiter=,\"", 0,
+     "Parameters used for csv trace, e.g., \"obj-id-col=1;delimiter=,\"", 2},
+    {"num-req", OPTION_NUM_REQ, "-1", 0,
+     "Num of requests to load, default -1 means all requests in the trace",
+     2},
+    {"ignore-obj-size", OPTION_IGNORE_OBJ_SIZE, "false", 0,
+     "specify to ignore the object size from the trace", 2},
+
+    {NULL, 0, NULL, 0, "benchmark related parameters:", 0},
+    {"eviction-params", OPTION_EVICTION_PARAMS, "\"n-bit-counter=2\"", 0,
+     "optional params for the eviction algorithm", 4},
+    {"threads", OPTION_THREADS, "1,2,4,8,16,32", 0,
+     "the number of threads to run, one run for each", 4},
+    {"num-req-per-thread", OPTION_NUM_REQ_PER_THREAD, "-1", 0,
+     "Num of requests sent by each thread, default -1 means one pass of the "
+     "loaded trace",
+     4},
+    {"no-pin", OPTION_NO_PIN, "false", 0,
+     "specify to not pin the threads to cores", 4},
+    {0}};
+
+struct arguments {
+  char *args[N_ARGS];
+  char *trace_path;
+  char *trace_type_str;
+  char *trace_type_params;
+  char *eviction_algo;
+  char *eviction_params;
+  uint64_t cache_size;
+  int64_t n_req;
+  int64_t n_req_per_thread;
+  bool ignore_obj_size;
+  bool pin_thread;
+
+  int n_threads[N_MAX_THREAD_CONFIG];
+  int n_thread_config;
+};
+
+/* the requests of the trace, stored as columns to keep the replay compact */
+typedef struct {
+  obj_id_t *obj_ids;
+  int64_t *obj_sizes;
+  int64_t n_req;
+} bench_trace_t;
+
+typedef struct {
+  cache_t *cache;
+  const bench_trace_t *trace;
+  /* NULL if the cache is thread-safe */
+  pthread_mutex_t *cache_lock;
+  pthread_barrier_t *barrier;
+
+  int64_t start_idx;
+  int64_t n_req;
+  int64_t n_miss;
+} bench_worker_t;
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+  struct arguments *arguments = state->input;
+
+  switch (key) {
+    case OPTION_TRACE_TYPE_PARAMS:
+      arguments->trace_type_params = arg;
+      break;
+    case OPTION_EVICTION_PARAMS:
+      arguments->eviction_params = strdup(arg);
+      replace_char(arguments->eviction_params, ';', ',');
+      replace_char(arguments->eviction_params, '_', '-');
+      break;
+    case OPTION_NUM_REQ:
+      arguments->n_req = atol(arg);
+      break;
+    case OPTION_NUM_REQ_PER_THREAD:
+      arguments->n_req_per_thread = atol(arg);
+      break;
+    case OPTION_IGNORE_OBJ_SIZE:
+      arguments->ignore_obj_size = is_true(arg) ? true : false;
+      break;
+    case OPTION_NO_PIN:
+      arguments->pin_thread = is_true(arg) ? false : true;
+      break;
+    case OPTION_THREADS: {
+      arguments->n_thread_config = 0;
+      char *threads_str = strdup(arg);
+      char *token = strtok(threads_str, ",");
+      while (token != NULL) {
+        if (arguments->n_thread_config >= N_MAX_THREAD_CONFIG) {
+          ERROR("too many thread configurations, at most %d\n",
+                N_MAX_THREAD_CONFIG);
+        }
+        int n_thread = atoi(token);
+        if (n_thread <= 0) {
+          ERROR("the number of threads should be positive, but got %s\n",
+                token);
+        }
+        arguments->n_threads[arguments->n_thread_config++] = n_thread;
+        token = strtok(NULL, ",");
+      }
+      free(threads_str);
+      break;
+    }
+    case ARGP_KEY_ARG:
+      if (state->arg_num >= N_ARGS) {
+        printf("found too many arguments, current %s\n", arg);
+        argp_usage(state);
+        exit(1);
+      }
+      arguments->args[state->arg_num] = arg;
+      break;
+    case ARGP_KEY_END:
+      if (state->arg_num < N_ARGS) {
+        printf("not enough arguments found\n");
+        argp_usage(state);
+        exit(1);
+      }
+      break;
+    default:
+      return ARGP_ERR_UNKNOWN;
+  }
+  return 0;
+}
+
+static char args_doc[] = "trace_path trace_type eviction_algo cache_size";
+
+static char doc[] =
+    "example: ./cacheBench /trace/path vscsi concurrentClock 1GB "
+    "--threads 1,2,4,8\n\n"
+    "cache_size is in byte, but also support KB/MB/GB\n"
+    "thread-safe eviction_algo: concurrentFIFO/concurrentClock/concurrentSieve/"
+    "concurrentS3FIFO/shardedLRU, other algorithms are protected by a global "
+    "lock\n";
+
+static struct argp argp = {options, parse_opt, args_doc, doc};
+
+static uint64_t conv_size_str_to_byte(const char *size_str) {
+  char *end;
+  uint64_t size = strtoull(size_str, &end, 10);
+  switch (*end) {
+    case 'k':
+    case 'K':
+      return size * KiB;
+    case 'm':
+    case 'M':
+      return size * MiB;
+    case 'g':
+    case 'G':
+      return size * GiB;
+    case 't':
+    case 'T':
+      return size * TiB;
+    default:
+      return size;
+  }
+}
+
+static void parse_cmd(int argc, char *argv[], struct arguments *args) {
+  memset(args, 0, sizeof(struct arguments));
+  args->n_req = -1;
+  args->n_req_per_thread = -1;
+  args->pin_thread = true;
+  int default_n_threads[] = {1, 2, 4, 8, 16, 32};
+  args->n_thread_config = sizeof(default_n_threads) / sizeof(int);
+  memcpy(args->n_threads, default_n_threads, sizeof(default_n_threads));
+
+  argp_parse(&argp, argc, argv, 0, 0, args);
+
+  args->trace_path = args->args[0];
+  args->trace_type_str = args->args[1];
+  args->eviction_algo = args->args[2];
+  args->cache_size = conv_size_str_to_byte(args->args[3]);
+  if (args->cache_size == 0) {
+    ERROR("cache size should be positive, but got %s\n", args->args[3]);
+  }
+}
+
+static void load_trace(const struct arguments *args, bench_trace_t *trace) {
+  reader_t *reader =
+      create_reader(args->trace_type_str, args->trace_path,
+                    args->trace_type_params, args->n_req,
+                    args->ignore_obj_size, 1);
+
+  int64_t n_req = args->n_req > 0 ? args->n_req : get_num_of_req(reader);
+  trace->obj_ids = my_malloc_n(obj_id_t, n_req);
+  trace->obj_sizes = my_malloc_n(int64_t, n_req);
+  trace->n_req = 0;
+
+  request_t *req = new_request();
+  while (trace->n_req < n_req && read_one_req(reader, req) == 0) {
+    trace->obj_ids[trace->n_req] = req->obj_id;
+    trace->obj_sizes[trace->n_req] = req->obj_size;
+    trace->n_req++;
+  }
+  free_request(req);
+  close_reader(reader);
+
+  if (trace->n_req == 0) {
+    ERROR("trace %s is empty\n", args->trace_path);
+  }
+}
+
+static void *bench_worker(void *arg) {
+  bench_worker_t *worker = (bench_worker_t *)arg;
+  const bench_trace_t *trace = worker->trace;
+  cache_t *cache = worker->cache;
+  request_t *req = new_request();
+  int64_t idx = worker->start_idx;
+  int64_t n_miss = 0;
+
+  pthread_barrier_wait(worker->barrier);
+  for (int64_t i = 0; i < worker->n_req; i++) {
+    req->obj_id = trace->obj_ids[idx];
+    req->obj_size = trace->obj_sizes[idx];
+    req->clock_time = i;
+
+    bool hit;
+    if (worker->cache_lock != NULL) {
+      pthread_mutex_lock(worker->cache_lock);
+      hit = cache->get(cache, req);
+      pthread_mutex_unlock(worker->cache_lock);
+    } else {
+      hit = cache->get(cache, req);
+    }
+    n_miss += !hit;
+
+    if (++idx == trace->n_req) {
+      idx = 0;
+    }
+  }
+  pthread_barrier_wait(worker->barrier);
+
+  worker->n_miss = n_miss;
+  free_request(req);
+  return NULL;
+}
+
+/**
+ * @brief create a cache sized for the trace, create_cache uses a fixed
+ * hashpower which wastes memory for small traces
+ */
+static cache_t *create_bench_cache(const struct arguments *args,
+                                   const bench_trace_t *trace) {
+  cache_t *tmp_cache = create_cache(args->trace_path, args->eviction_algo,
+                                    args->cache_size, args->eviction_params,
+                                    false);
+  common_cache_params_t cc_params = {
+      .cache_size = args->cache_size,
+      .default_ttl = 86400 * 300,
+      .hashpower = 16,
+      .consider_obj_metadata = false,
+  };
+  while ((1ULL << cc_params.hashpower) < (uint64_t)trace->n_req &&
+         cc_params.hashpower < 30) {
+    cc_params.hashpower++;
+  }
+  cache_t *cache = tmp_cache->cache_init(cc_params, args->eviction_params);
+  tmp_cache->cache_free(tmp_cache);
+  return cache;
+}
+
+/**
+ * @brief run one configuration
+ *
+ * @return the throughput in million requests per second
+ */
+static double run_bench(const struct arguments *args,
+                        const bench_trace_t *trace, int n_thread,
+                        double *miss_ratio, char *cache_name) {
+  cache_t *cache = create_bench_cache(args, trace);
+  strncpy(cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+  bool thread_safe = strncmp(cache->cache_name, "Concurrent", 10) == 0 ||
+                     strncmp(cache->cache_name, "ShardedLRU", 10) == 0;
+
+  /* warm up the cache with one single-threaded pass */
+  request_t *req = new_request();
+  for (int64_t i = 0; i < trace->n_req; i++) {
+    req->obj_id = trace->obj_ids[i];
+    req->obj_size = trace->obj_sizes[i];
+    req->clock_time = i;
+    cache->get(cache, req);
+  }
+  free_request(req);
+
+  pthread_mutex_t cache_lock;
+  pthread_mutex_init(&cache_lock, NULL);
+  pthread_barrier_t barrier;
+  pthread_barrier_init(&barrier, NULL, n_thread + 1);
+
+  int64_t n_req_per_thread =
+      args->n_req_per_thread > 0 ? args->n_req_per_thread : trace->n_req;
+  bench_worker_t *workers = my_malloc_n(bench_worker_t, n_thread);
+  pthread_t *threads = my_malloc_n(pthread_t, n_thread);
+  for (int i = 0; i < n_thread; i++) {
+    workers[i].cache = cache;
+    workers[i].trace = trace;
+    workers[i].cache_lock = thread_safe ? NULL : &cache_lock;
+    workers[i].barrier = &barrier;
+    workers[i].start_idx = trace->n_req * i / n_thread;
+    workers[i].n_req = n_req_per_thread;
+    workers[i].n_miss = 0;
+    pthread_create(&threads[i], NULL, bench_worker, &workers[i]);
+    if (args->pin_thread) {
+      set_thread_affinity(threads[i]);
+    }
+  }
+
+  pthread_barrier_wait(&barrier);
+  double start_time = gettime();
+  pthread_barrier_wait(&barrier);
+  double elapsed = gettime() - start_time;
+
+  int64_t n_miss = 0;
+  for (int i = 0; i < n_thread; i++) {
+    pthread_join(threads[i], NULL);
+    n_miss += workers[i].n_miss;
+  }
+  *miss_ratio = (double)n_miss / (double)(n_req_per_thread * n_thread);
+
+  my_free(sizeof(bench_worker_t) * n_thread, workers);
+  my_free(sizeof(pthread_t) * n_thread, threads);
+  pthread_barrier_destroy(&barrier);
+  pthread_mutex_destroy(&cache_lock);
+  cache->cache_free(cache);
+
+  return (double)(n_req_per_thread * n_thread) / elapsed / 1e6;
+}
+
+int main(int argc, char **argv) {
+  struct arguments args;
+  parse_cmd(argc, argv, &args);
+
+  bench_trace_t trace;
+  load_trace(&args, &trace);
+  INFO("loaded %ld requests from %s\n", (long)trace.n_req, args.trace_path);
+
+  char cache_name[CACHE_NAME_ARRAY_LEN];
+  double base_throughput = 0;
+  for (int i = 0; i < args.n_thread_config; i++) {
+    int n_thread = args.n_threads[i];
+    if (n_thread > n_cores() && args.pin_thread) {
+      WARN("%d threads on %d cores\n", n_thread, n_cores());
+    }
+    double miss_ratio;
+    double throughput =
+        run_bench(&args, &trace, n_thread, &miss_ratio, cache_name);
+    if (i == 0) {
+      base_throughput = throughput;
+    }
+    printf(
+        "%s %32s cache size %8s, %3d threads, throughput %8.2lf MQPS "
+        "(%6.2lfx), miss ratio %.4lf\n",
+        mybasename(args.trace_path), cache_name, args.args[3], n_thread,
+        throughput, throughput / base_throughput, miss_ratio);
+  }
+
+  my_free(sizeof(obj_id_t) * trace.n_req, trace.obj_ids);
+  my_free(sizeof(int64_t) * trace.n_req, trace.obj_sizes);
+  if (args.eviction_params != NULL) {
+    free(args.eviction_params);
+  }
+
+  return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -86,14 +86,18 @@ static inline cache_t *create_cache(const char *trace_path,
     cache = WTinyLFU_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "belady") == 0) {
     if (strcasestr(trace_path, "oracleGeneral") == NULL) {
-      WARN("belady is only supported for oracleGeneral trace\n");
+      WARN(
+          "belady needs the next access, use an oracleGeneral trace or "
+          "compute-next-access=true\n");
     }
     cache = Belady_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "nop") == 0) {
     cache = nop_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "beladySize") == 0) {
     if (strcasestr(trace_path, "oracleGeneral") == NULL) {
-      WARN("belady is only supported for oracleGeneral trace\n");
+      WARN(
+          "belady needs the next access, use an oracleGeneral trace or "
+          "compute-next-access=true\n");
     }
     cc_params.hashpower = MAX(cc_params.hashpower - 8, 16);
     cache = BeladySize_init(cc_params, eviction_params);
@@ -134,6 +138,16 @@ static inline cache_t *create_cache(const char *trace_path,
     cache = QDLP_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "sieve") == 0) {
     cache = Sieve_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "concurrentFIFO") == 0) {
+    cache = ConcurrentFIFO_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "concurrentClock") == 0) {
+    cache = ConcurrentClock_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "concurrentSieve") == 0) {
+    cache = ConcurrentSieve_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "concurrentS3FIFO") == 0) {
+    cache = ConcurrentS3FIFO_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "shardedLRU") == 0) {
+    cache = ShardedLRU_init(cc_params, eviction_params);
 #ifdef ENABLE_GLCACHE
   } else if (strcasecmp(eviction_algo, "GLCache") == 0 ||
              strcasecmp(eviction_algo, "gl-cache") == 0) {
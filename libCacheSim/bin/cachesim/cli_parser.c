@@ -25,6 +25,9 @@ static int conv_cache_sizes(char *cache_size_str, struct arguments *args);
 
 static void parse_eviction_algo(struct arguments *args, const char *arg);
 
+static bool need_next_access(const struct arguments *args,
+                             const reader_init_param_t *reader_init_params);
+
 const char *argp_program_version = "cachesim 0.0.1";
 const char *argp_program_bug_address =
     "https://groups.google.com/g/libcachesim";
@@ -72,7 +75,7 @@ static struct argp_option options[] = {
     {"admission-params", OPTION_ADMISSION_PARAMS, "\"prob=0.8\"", 0,
      "params for admission algorithm", 4},
     {"prefetch", OPTION_PREFETCH_ALGO, "Mithril", 0,
-     "Prefetching algorithm: Mithril", 4},
+     "Prefetching algorithm: Mithril, OBL, Sequential, AMP", 4},
     {"prefetch-params", OPTION_PREFETCH_PARAMS, "\"block-size=65536\"", 0,
      "optional params for each prefetching algorithm, e.g., block-size=65536",
      4},
@@ -306,6 +309,11 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
     reader_init_params.sampler = sampler;
   }
 
+  if (need_next_access(args, &reader_init_params)) {
+    INFO("the trace does not have next access, compute it in memory\n");
+    reader_init_params.compute_next_access = true;
+  }
+
   if ((args->trace_type == CSV_TRACE || args->trace_type == PLAIN_TXT_TRACE) &&
       reader_init_params.obj_size_field == -1) {
     args->consider_obj_metadata = false;
@@ -376,6 +384,36 @@ static void parse_eviction_algo(struct arguments *args, const char *arg) {
 #undef MAX_ALGO_LEN
 }
 
+/**
+ * @brief whether the algorithms need the next access that is not in the trace
+ */
+static bool need_next_access(const struct arguments *args,
+                             const reader_init_param_t *reader_init_params) {
+  if (reader_init_params->compute_next_access) return false;
+
+  switch (args->trace_type) {
+    case ORACLE_GENERAL_TRACE:
+    case ORACLE_GENERALOPNS_TRACE:
+    case ORACLE_SIM_TWR_TRACE:
+    case ORACLE_SYS_TWR_TRACE:
+    case ORACLE_SIM_TWRNS_TRACE:
+    case ORACLE_SYS_TWRNS_TRACE:
+    case ORACLE_CF1_TRACE:
+    case ORACLE_AKAMAI_TRACE:
+    case ORACLE_WIKI16u_TRACE:
+    case ORACLE_WIKI19u_TRACE:
+      return false;
+    default:
+      break;
+  }
+  if (reader_init_params->next_access_vtime_field > 0) return false;
+
+  for (int i = 0; i < args->n_eviction_algo; i++) {
+    if (strcasestr(args->eviction_algo[i], "belady") != NULL) return true;
+  }
+  return false;
+}
+
 /**
  *
  * @brief convert cache size string to byte, e.g., 100MB -> 100 * 1024 * 1024
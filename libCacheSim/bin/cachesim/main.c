@@ -7,6 +7,7 @@
 #include <libgen.h>
 
 #include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/prefetchAlgo.h"
 #include "../../include/libCacheSim/reader.h"
 #include "../../include/libCacheSim/simulator.h"
 #include "../../utils/include/mystr.h"
@@ -59,14 +60,24 @@ int main(int argc, char **argv) {
 
   printf("\n");
   for (int i = 0; i < args.n_cache_size * args.n_eviction_algo; i++) {
-    snprintf(output_str, 1024,
-             "%s %32s cache size %8ld%s, %lld req, miss ratio %.4lf, byte miss "
-             "ratio %.4lf\n",
-             output_filename, result[i].cache_name,
-             (long)(result[i].cache_size / size_unit), size_unit_str,
-             (long long)result[i].n_req,
-             (double)result[i].n_miss / (double)result[i].n_req,
-             (double)result[i].n_miss_byte / (double)result[i].n_req_byte);
+    int n = snprintf(
+        output_str, 1024,
+        "%s %32s cache size %8ld%s, %lld req, miss ratio %.4lf, byte miss "
+        "ratio %.4lf",
+        output_filename, result[i].cache_name,
+        (long)(result[i].cache_size / size_unit), size_unit_str,
+        (long long)result[i].n_req,
+        (double)result[i].n_miss / (double)result[i].n_req,
+        (double)result[i].n_miss_byte / (double)result[i].n_req_byte);
+    if (args.prefetch_algo != NULL) {
+      prefetch_stat_t stat = {.n_demand_miss = result[i].n_demand_miss,
+                              .n_prefetch = result[i].n_prefetch,
+                              .n_prefetch_hit = result[i].n_prefetch_hit};
+      n += snprintf(output_str + n, 1024 - n,
+                    ", prefetch accuracy %.4lf, coverage %.4lf",
+                    prefetch_accuracy(&stat), prefetch_coverage(&stat));
+    }
+    snprintf(output_str + n, 1024 - n, "\n");
     printf("%s", output_str);
     fprintf(output_file, "%s", output_str);
   }
@@ -1,6 +1,7 @@
 
 
 #include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/prefetchAlgo.h"
 #include "../../include/libCacheSim/reader.h"
 #include "../../utils/include/mymath.h"
 #include "../../utils/include/mystr.h"
@@ -69,12 +70,19 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval,
   convert_size_to_str(cache->cache_size, size_str);
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-truncation"
-  snprintf(output_str, 1024,
-           "%s %s cache size %8s, %16lu req, miss ratio %.4lf, throughput "
-           "%.2lf MQPS\n",
-           reader->trace_path, cache->cache_name, size_str,
-           (unsigned long)req_cnt, (double)miss_cnt / (double)req_cnt,
-           (double)req_cnt / 1000000.0 / runtime);
+  int n = snprintf(output_str, 1024,
+                   "%s %s cache size %8s, %16lu req, miss ratio %.4lf, "
+                   "throughput %.2lf MQPS",
+                   reader->trace_path, cache->cache_name, size_str,
+                   (unsigned long)req_cnt, (double)miss_cnt / (double)req_cnt,
+                   (double)req_cnt / 1000000.0 / runtime);
+  if (cache->prefetcher != NULL) {
+    n += snprintf(output_str + n, 1024 - n,
+                  ", prefetch accuracy %.4lf, coverage %.4lf",
+                  prefetch_accuracy(&cache->prefetcher->stat),
+                  prefetch_coverage(&cache->prefetcher->stat));
+  }
+  snprintf(output_str + n, 1024 - n, "\n");
 
 #pragma GCC diagnostic pop
   printf("%s", output_str);
@@ -136,6 +136,12 @@ void parse_reader_params(const char *reader_params_str,
       params->next_access_vtime_field = (int)strtol(value, &end, 0);
       if (strlen(end) > 2)
         ERROR("param parsing error, find string \"%s\" after number\n", end);
+    } else if (strcasecmp(key, "compute-next-access") == 0) {
+      params->compute_next_access = is_true(value);
+    } else if (strcasecmp(key, "next-access-mem-mb") == 0) {
+      params->next_access_mem_limit = strtoll(value, &end, 0) * MiB;
+      if (strlen(end) > 2)
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
     } else if (strcasecmp(key, "obj-id-is-num") == 0) {
       params->obj_id_is_num = is_true(value);
     } else if (strcasecmp(key, "header") == 0 ||
@@ -25,6 +25,7 @@ enum argp_option_short {
   // OPTION_OUTPUT_PATH = 'o',
   OPTION_NUM_REQ = 'n',
   OPTION_VERBOSE = 'v',
+  OPTION_STREAM = 0x101,
 };
 
 /*
@@ -38,6 +39,10 @@ static struct argp_option options[] = {
     {"num-req", OPTION_NUM_REQ, "-1", 0,
      "Num of requests to process, default -1 means all requests in the trace"},
 
+    {"stream", OPTION_STREAM, "false", 0,
+     "Write the dist while reading the trace instead of keeping an array of "
+     "n_req dist, the binary output uses int64_t"},
+
     // {"output", OPTION_OUTPUT_PATH, "output", 0, "Output path", 5},
     {"verbose", OPTION_VERBOSE, "1", 0, "Produce verbose output"},
 
@@ -63,6 +68,9 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_VERBOSE:
       arguments->verbose = is_true(arg) ? true : false;
       break;
+    case OPTION_STREAM:
+      arguments->stream = is_true(arg) ? true : false;
+      break;
     case ARGP_KEY_ARG:
       if (state->arg_num >= N_ARGS) {
         printf("found too many arguments, current %s\n", arg);
@@ -104,7 +112,9 @@ static char doc[] =
     "binary uses 4B for each request, total 4 * n_req bytes, "
     "txt stores a dist in one line, "
     "cntTxt counts and stores the number of dist, note that -1 means no "
-    "reuse\n\n";
+    "reuse\n\n"
+    "--stream writes the dist as the trace is read, the memory does not grow "
+    "with the trace, the binary output uses 8B for each request\n\n";
 
 /**
  * @brief initialize the arguments
@@ -117,6 +127,7 @@ static void init_arg(struct arguments *args) {
   args->trace_path = NULL;
   args->trace_type_params = NULL;
   args->verbose = true;
+  args->stream = false;
   memset(args->ofilepath, 0, OFILEPATH_LEN);
   args->n_req = -1;
 }
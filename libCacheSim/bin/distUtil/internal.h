@@ -24,6 +24,8 @@ struct arguments {
   char *trace_type_params;
   int64_t n_req;    /* number of requests to process */
   bool verbose;
+  /* write the dist while reading the trace, see stream_dist */
+  bool stream;
 
   /* arguments generated */
   reader_t *reader;
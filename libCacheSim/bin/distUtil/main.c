@@ -15,6 +15,19 @@ int main(int argc, char **argv) {
   struct arguments args;
   parse_cmd(argc, argv, &args);
 
+  if (args.stream) {
+    dist_output_e output_type = DIST_OUTPUT_BINARY;
+    if (strcasecmp(args.output_type, "txt") == 0) {
+      output_type = DIST_OUTPUT_TXT;
+    } else if (strcasecmp(args.output_type, "cntTxt") == 0) {
+      output_type = DIST_OUTPUT_CNT_TXT;
+    } else if (strcasecmp(args.output_type, "binary") != 0) {
+      ERROR("Unknown output type %s\n", args.output_type);
+    }
+    stream_dist(args.reader, args.dist_type, output_type, args.ofilepath);
+    return 0;
+  }
+
   int32_t *dist_array = NULL;
   int64_t array_size = 0;
   if (args.dist_type == STACK_DIST || args.dist_type == FUTURE_STACK_DIST) {
@@ -30,6 +30,17 @@ enum argp_option_short {
   OPTION_ACCESS_PATTERN_SAMPLE_RATIO = 0x102,
   OPTION_TRACK_N_HIT = 0x103,
   OPTION_TRACK_N_POPULAR = 0x104,
+  OPTION_NUM_THREAD = 0x105,
+  OPTION_SKETCH = 0x106,
+  OPTION_SKETCH_SAMPLE_RATIO = 0x107,
+  OPTION_MANIFEST = 0x108,
+  OPTION_NUM_JOB = 0x109,
+  OPTION_BINARY_OUTPUT = 0x10a,
+  OPTION_SCAN_MIN_RUN = 0x10b,
+  OPTION_SCAN_MAX_GAP = 0x10c,
+  OPTION_CHECKPOINT = 0x10d,
+  OPTION_CHECKPOINT_INTERVAL = 0x10e,
+  OPTION_RESUME = 0x10f,
 
   OPTION_ENABLE_ALL = 0x200,
   OPTION_ENABLE_COMMON = 0x201,
@@ -52,6 +63,8 @@ enum argp_option_short {
   OPTION_ENABLE_WRITE_REUSE_CCDF = 0x210,
   OPTION_ENABLE_WRITE_REUSE_CCDF2 = 0x211,
   OPTION_ENABLE_WRITE_REUSE_CCDF3 = 0x212,
+  OPTION_ENABLE_FOOTPRINT = 0x213,
+  OPTION_ENABLE_STACK_DIST = 0x214,
 };
 
 /*
@@ -98,6 +111,19 @@ static struct argp_option options[] = {
      3},
     {"ttl", OPTION_ENABLE_TTL, NULL, OPTION_ARG_OPTIONAL,
      "ttl analysis, output a ttl distribution in dataname.ttl file", 2},
+    {"footprint", OPTION_ENABLE_FOOTPRINT, NULL, OPTION_ARG_OPTIONAL,
+     "footprint analysis, output the working set size of all window lengths "
+     "and the miss ratio curve derived from it in dataname.footprint file",
+     3},
+    {"stackDist", OPTION_ENABLE_STACK_DIST, NULL, OPTION_ARG_OPTIONAL,
+     "stack distance analysis, output the stack distance histogram and the LRU "
+     "miss ratio curve in dataname.stackDist file",
+     3},
+    {"scan", OPTION_ENABLE_SCAN_DETECTOR, NULL, OPTION_ARG_OPTIONAL,
+     "scan detection, detect the sequential runs online and output the "
+     "fraction of scan requests per window in dataname.scanWindow_w300 and "
+     "the run length histogram in dataname.scan file",
+     3},
 
     {NULL, 0, NULL, 0, "trace analyzer related parameters:", 4},
     {"time-window", OPTION_TIME_WINDOW, "300", 0,
@@ -109,6 +135,48 @@ static struct argp_option options[] = {
      "track one-hit-wonder, two-hit-wonder, etc.", 4},
     {"track-n-popular", OPTION_TRACK_N_POPULAR, "8", 0,
      "track how many requests the n most popular objects get", 4},
+    {"num-thread", OPTION_NUM_THREAD, "1", 0,
+     "the number of threads, the objects are sharded across threads, 0 uses "
+     "all cores",
+     4},
+    {"sketch", OPTION_SKETCH, NULL, OPTION_ARG_OPTIONAL,
+     "use sketches instead of keeping all objects in memory, the per-object "
+     "analysis runs on a sample of the objects",
+     4},
+    {"sketch-sample-ratio", OPTION_SKETCH_SAMPLE_RATIO, "0.01", 0,
+     "the fraction of objects used in per-object analysis in sketch mode", 4},
+    {"binary-output", OPTION_BINARY_OUTPUT, NULL, OPTION_ARG_OPTIONAL,
+     "write the per-window output (size, reuse and popularityDecay heatmaps) "
+     "in a binary format that can be loaded with numpy, the files end with "
+     ".bin",
+     4},
+    {"scan-min-run", OPTION_SCAN_MIN_RUN, "32", 0,
+     "the number of requests of a sequential run before it is a scan", 4},
+    {"scan-max-gap", OPTION_SCAN_MAX_GAP, "1", 0,
+     "the largest obj_id gap between two requests of a sequential run, e.g., "
+     "the request size in sectors if obj_id is the LBA",
+     4},
+    {"checkpoint", OPTION_CHECKPOINT, "FILE", 0,
+     "save the analysis state to FILE periodically and at the end of the "
+     "trace, the analysis runs on one thread",
+     4},
+    {"checkpoint-interval", OPTION_CHECKPOINT_INTERVAL, "100000000", 0,
+     "the number of requests between two checkpoints", 4},
+    {"resume", OPTION_RESUME, NULL, OPTION_ARG_OPTIONAL,
+     "start from the checkpoint if it exists, the same trace resumes after "
+     "the requests in the checkpoint, a different trace is appended as the "
+     "next segment",
+     4},
+
+    {NULL, 0, NULL, 0, "batch mode parameters:", 6},
+    {"manifest", OPTION_MANIFEST, "manifest.txt", 0,
+     "analyze the traces in the manifest instead of one trace, each line is "
+     "trace_path trace_type [trace_type_params]",
+     6},
+    {"num-job", OPTION_NUM_JOB, "0", 0,
+     "the number of traces analyzed at the same time in batch mode, 0 uses "
+     "all cores when the machine is not busy",
+     6},
 
     {NULL, 0, NULL, 0, "common parameters:", 0},
 
@@ -150,6 +218,42 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_TRACK_N_HIT:
       arguments->analysis_param.track_n_hit = atoi(arg);
       break;
+    case OPTION_NUM_THREAD:
+      arguments->analysis_param.n_thread = atoi(arg);
+      if (arguments->analysis_param.n_thread <= 0) {
+        arguments->analysis_param.n_thread = n_cores();
+      }
+      break;
+    case OPTION_SKETCH:
+      arguments->analysis_param.sketch = true;
+      break;
+    case OPTION_SKETCH_SAMPLE_RATIO:
+      arguments->analysis_param.sketch_sample_ratio = atof(arg);
+      break;
+    case OPTION_BINARY_OUTPUT:
+      arguments->analysis_param.binary_output = true;
+      break;
+    case OPTION_SCAN_MIN_RUN:
+      arguments->analysis_param.scan_min_run = atoi(arg);
+      break;
+    case OPTION_SCAN_MAX_GAP:
+      arguments->analysis_param.scan_max_gap = atoi(arg);
+      break;
+    case OPTION_CHECKPOINT:
+      arguments->analysis_param.checkpoint_path = arg;
+      break;
+    case OPTION_CHECKPOINT_INTERVAL:
+      arguments->analysis_param.checkpoint_interval = atoll(arg);
+      break;
+    case OPTION_RESUME:
+      arguments->analysis_param.resume = true;
+      break;
+    case OPTION_MANIFEST:
+      arguments->manifest = arg;
+      break;
+    case OPTION_NUM_JOB:
+      arguments->n_job = atoi(arg);
+      break;
     case OPTION_ENABLE_ALL:
       arguments->analysis_option.req_rate = true;
       arguments->analysis_option.access_pattern = true;
@@ -157,6 +261,9 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
       arguments->analysis_option.reuse = true;
       arguments->analysis_option.popularity = true;
       arguments->analysis_option.popularity_decay = true;
+      arguments->analysis_option.footprint = true;
+      arguments->analysis_option.stack_dist = true;
+      arguments->analysis_option.scan = true;
       break;
     case OPTION_ENABLE_COMMON:
       arguments->analysis_option.req_rate = true;
@@ -186,6 +293,15 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_ENABLE_TTL:
       arguments->analysis_option.ttl = true;
       break;
+    case OPTION_ENABLE_FOOTPRINT:
+      arguments->analysis_option.footprint = true;
+      break;
+    case OPTION_ENABLE_STACK_DIST:
+      arguments->analysis_option.stack_dist = true;
+      break;
+    case OPTION_ENABLE_SCAN_DETECTOR:
+      arguments->analysis_option.scan = true;
+      break;
 
     case OPTION_VERBOSE:
       arguments->verbose = is_true(arg) ? true : false;
@@ -199,7 +315,7 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
       arguments->args[state->arg_num] = arg;
       break;
     case ARGP_KEY_END:
-      if (state->arg_num < N_ARGS) {
+      if (arguments->manifest == NULL && state->arg_num < N_ARGS) {
         printf("not enough arguments found\n");
         argp_usage(state);
         exit(1);
@@ -216,7 +332,9 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
    A description of the non-option command-line arguments
      that we accept.
 */
-static char args_doc[] = "trace_path trace_type [--task1] [--task2] ...";
+static char args_doc[] =
+    "trace_path trace_type [--task1] [--task2] ...\n"
+    "--manifest=manifest.txt [--task1] [--task2] ...";
 
 /* Program documentation. */
 static char doc[] =
@@ -225,7 +343,7 @@ static char doc[] =
     "if using csv trace, considering specifying -t obj-id-is-num=true\n\n"
     "task: "
     "[common/all/popularity/popularityDecay/reuse/size/reqRate/"
-    "accessPattern]\n\n";
+    "accessPattern/footprint/stackDist/scan]\n\n";
 
 /**
  * @brief initialize the arguments
@@ -241,6 +359,8 @@ static void init_arg(struct arguments *args) {
   memset(args->ofilepath, 0, OFILEPATH_LEN);
   args->n_req = -1;
   args->verbose = false;
+  args->manifest = NULL;
+  args->n_job = 0;
 
   args->analysis_option = traceAnalyzer::default_option();
   args->analysis_param = traceAnalyzer::default_param();
@@ -261,6 +381,15 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
 
   argp_parse(&argp, argc, argv, 0, 0, args);
 
+  if (args->manifest != NULL) {
+    if (args->analysis_param.checkpoint_path != NULL) {
+      ERROR("checkpoint is not supported in batch mode\n");
+      exit(1);
+    }
+    /* the readers are created by the batch jobs */
+    return;
+  }
+
   args->trace_path = args->args[0];
   const char *trace_type_str = args->args[1];
 
@@ -274,7 +403,9 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
                                args->trace_type_params, args->n_req, false, 1);
 }
 
-void free_arg(struct arguments *args) { close_reader(args->reader); }
+void free_arg(struct arguments *args) {
+  if (args->reader != NULL) close_reader(args->reader);
+}
 
 #ifdef __cplusplus
 }
@@ -24,6 +24,12 @@ struct arguments {
   int64_t n_req; /* number of requests to process */
   bool verbose;
 
+  /* batch mode, each line of the manifest is
+   * trace_path trace_type [trace_type_params] */
+  char *manifest;
+  /* the number of traces analyzed at the same time in batch mode */
+  int n_job;
+
   traceAnalyzer::analysis_option_t analysis_option;
   traceAnalyzer::analysis_param_t analysis_param;
 
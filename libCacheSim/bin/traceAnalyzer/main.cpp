@@ -2,16 +2,122 @@
 // Created by Juncheng Yang on 5/9/21.
 //
 
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "../../traceAnalyzer/analyzer.h"
+#include "../../traceAnalyzer/utils/include/threadPool.h"
 #include "../cli_reader_utils.h"
 #include "internal.h"
 
 using namespace traceAnalyzer;
 
+struct batch_job {
+  std::string trace_path;
+  std::string trace_type;
+  std::string trace_type_params;
+};
+
+static std::vector<struct batch_job> load_manifest(const char *path) {
+  std::ifstream ifs(path);
+  if (!ifs.is_open()) {
+    ERROR("cannot open manifest %s\n", path);
+    exit(1);
+  }
+
+  std::vector<struct batch_job> jobs;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::istringstream iss(line);
+    struct batch_job job;
+    if (!(iss >> job.trace_path) || job.trace_path[0] == '#') continue;
+    if (!(iss >> job.trace_type)) {
+      ERROR("manifest %s: no trace type for %s\n", path,
+            job.trace_path.c_str());
+      exit(1);
+    }
+    /* the rest of the line, the params may contain spaces */
+    std::getline(iss >> std::ws, job.trace_type_params);
+    jobs.push_back(job);
+  }
+
+  return jobs;
+}
+
+/* analyze the traces in the manifest on a thread pool, each trace writes its
+ * own output files, and the stat of all traces are appended to traceStat */
+static void run_batch(struct arguments *args) {
+  std::vector<struct batch_job> jobs = load_manifest(args->manifest);
+  INFO("batch analysis of %zu traces\n", jobs.size());
+
+  std::mutex output_mtx;
+  /* without the number of threads, the thread pool starts one thread per
+   * core and throttles the jobs when the load is high */
+  utilsSys::ThreadPool pool(args->n_job > 0 ? args->n_job : -1);
+  for (const auto &job : jobs) {
+    pool.add_Job([&args, &job, &output_mtx]() {
+      /* the reader aborts on a trace it cannot open, skip such trace so that
+       * one bad entry does not stop the batch */
+      if (access(job.trace_path.c_str(), R_OK) != 0) {
+        WARN("cannot read trace %s: %s, skip it\n", job.trace_path.c_str(),
+             strerror(errno));
+        return;
+      }
+      reader_t *reader = create_reader(
+          job.trace_type.c_str(), job.trace_path.c_str(),
+          job.trace_type_params.empty() ? NULL
+                                        : job.trace_type_params.c_str(),
+          args->n_req, false, 1);
+      if (reader == NULL) {
+        WARN("cannot create reader for trace %s, skip it\n",
+             job.trace_path.c_str());
+        return;
+      }
+
+      /* the output is named after the trace, under the output path if set */
+      std::string ofilepath = job.trace_path.substr(
+          job.trace_path.find_last_of('/') == std::string::npos
+              ? 0
+              : job.trace_path.find_last_of('/') + 1);
+      if (args->ofilepath[0] != '\0') {
+        ofilepath = std::string(args->ofilepath) + "/" + ofilepath;
+      }
+
+      TraceAnalyzer *stat = new TraceAnalyzer(
+          reader, ofilepath, args->analysis_option, args->analysis_param);
+      stat->run();
+
+      {
+        std::lock_guard<std::mutex> lock(output_mtx);
+        ofstream ofs("traceStat", ios::out | ios::app);
+        ofs << *stat << endl;
+        ofs.close();
+        cout << *stat;
+      }
+
+      delete stat;
+      close_reader(reader);
+    });
+  }
+  pool.wait_for_finish();
+}
+
 int main(int argc, char *argv[]) {
   struct arguments args;
   parse_cmd(argc, argv, &args);
 
+  if (args.manifest != NULL) {
+    run_batch(&args);
+    return 0;
+  }
+
   TraceAnalyzer *stat = new TraceAnalyzer(
       args.reader, args.ofilepath, args.analysis_option, args.analysis_param);
   stat->run();
@@ -27,6 +27,8 @@ enum argp_option_short {
   // trace conv
   OPTION_OUTPUT_TXT = 0x102,
   OPTION_REMOVE_SIZE_CHANGE = 0x103,
+  OPTION_NUM_THREAD = 0x104,
+  OPTION_MEM_LIMIT = 0x105,
 
   // trace print
   OPTION_NUM_REQ = 'n',
@@ -36,7 +38,22 @@ enum argp_option_short {
 
   // trace filter
   OPTION_FILTER_TYPE = 0x301,
-  OPTION_FILTER_SIZE = 0x302
+  OPTION_FILTER_SIZE = 0x302,
+  OPTION_OUTPUT_LCS = 0x303,
+
+  // slice
+  OPTION_START_REQ = 0x401,
+  OPTION_END_REQ = 0x402,
+  OPTION_START_TIME = 0x403,
+  OPTION_END_TIME = 0x404,
+  OPTION_OP = 0x405,
+  OPTION_TENANT = 0x406,
+  OPTION_NS = 0x407,
+  OPTION_MIN_SIZE = 0x408,
+  OPTION_MAX_SIZE = 0x409,
+
+  // trace sample
+  OPTION_SAMPLE_RATIOS = 0x501
 };
 
 /*
@@ -62,10 +79,18 @@ static struct argp_option options[] = {
      "whether remove object size change, if true, objects with changed size "
      "are updated to the old size",
      4},
+    {"num-thread", OPTION_NUM_THREAD, "1", 0,
+     "Number of threads finding the next access, 0 means all cores", 4},
+    {"mem-limit", OPTION_MEM_LIMIT, "0", 0,
+     "Memory limit in GiB of the object map, objects beyond the limit are "
+     "spilled to disk next to the output, 0 means no limit",
+     4},
 
     {0, 0, 0, 0, "tracePrint options:"},
     {"num-req", OPTION_NUM_REQ, "-1", 0,
-     "Number of requests to process, -1 means all requests in the trace", 6},
+     "Number of requests to process from the start of the slice, -1 means "
+     "all requests in the trace",
+     6},
     {"field-delimiter", OPTION_FIELD_DELIMITER, ",", 0,
      "The delimiter formatting the trace", 6},
     {"obj-id-only", OPTION_OBJ_ID_ONLY, "0", 0, "Only to print object id", 6},
@@ -74,11 +99,41 @@ static struct argp_option options[] = {
 
     {0, 0, 0, 0, "traceFilter options:"},
     {"filter-type", OPTION_FILTER_TYPE, "FIFO", 0,
-     "The filter type, e.g., FIFO and LRU", 8},
+     "The filter types separated by comma, e.g., FIFO,LRU", 8},
     {"filter-size", OPTION_FILTER_SIZE, "0.1", 0,
-     "The size of the filter, can be absolute size or relative to working set",
+     "The sizes of the filter separated by comma, can be absolute size or "
+     "relative to working set, each type runs with each size",
+     8},
+    {"output-lcs", OPTION_OUTPUT_LCS, "false", 0,
+     "write the output in lcs format with the trace stat in the header, also "
+     "used by traceSlice",
      8},
 
+    {0, 0, 0, 0, "tracePrint and traceSlice options:"},
+    {"start-req", OPTION_START_REQ, "0", 0,
+     "The index of the first request of the slice", 10},
+    {"end-req", OPTION_END_REQ, "-1", 0,
+     "The index after the last request of the slice, -1 means the end", 10},
+    {"start-time", OPTION_START_TIME, "-1", 0,
+     "The start time of the slice, in the time unit of the trace", 10},
+    {"end-time", OPTION_END_TIME, "-1", 0,
+     "The end time (exclusive) of the slice, in the time unit of the trace",
+     10},
+    {"op", OPTION_OP, "get", 0, "Only the requests of the op, e.g., get, set",
+     10},
+    {"tenant", OPTION_TENANT, "-1", 0, "Only the requests of the tenant", 10},
+    {"ns", OPTION_NS, "-1", 0, "Only the requests of the namespace", 10},
+    {"min-size", OPTION_MIN_SIZE, "-1", 0,
+     "Only the requests of objects no smaller than the size", 10},
+    {"max-size", OPTION_MAX_SIZE, "-1", 0,
+     "Only the requests of objects no larger than the size", 10},
+
+    {0, 0, 0, 0, "traceSample options:"},
+    {"sample-ratios", OPTION_SAMPLE_RATIOS, "0.01,0.001,0.0001", 0,
+     "The sample ratios separated by comma, each ratio is written to its own "
+     "lcs trace",
+     12},
+
     {0}};
 
 /*
@@ -108,6 +163,18 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_REMOVE_SIZE_CHANGE:
       arguments->remove_size_change = is_true(arg) ? true : false;
       break;
+    case OPTION_NUM_THREAD:
+      arguments->n_thread = atoi(arg);
+      if (arguments->n_thread <= 0) {
+        arguments->n_thread = n_cores();
+      }
+      break;
+    case OPTION_MEM_LIMIT:
+      arguments->mem_limit = (int64_t)(atof(arg) * GiB);
+      if (arguments->mem_limit < 0) {
+        ERROR("memory limit should be non-negative, get %s\n", arg);
+      }
+      break;
     case OPTION_OUTPUT_TXT:
       arguments->output_txt = is_true(arg) ? true : false;
       break;
@@ -127,7 +194,48 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
       arguments->cache_name = arg;
       break;
     case OPTION_FILTER_SIZE:
-      arguments->cache_size = atof(arg);
+      arguments->cache_size_str = arg;
+      break;
+    case OPTION_OUTPUT_LCS:
+      arguments->output_lcs = is_true(arg) ? true : false;
+      break;
+    case OPTION_START_REQ:
+      arguments->slice.start_req = atoll(arg);
+      break;
+    case OPTION_END_REQ:
+      arguments->slice.end_req = atoll(arg);
+      break;
+    case OPTION_START_TIME:
+      arguments->slice.start_time = atoll(arg);
+      break;
+    case OPTION_END_TIME:
+      arguments->slice.end_time = atoll(arg);
+      break;
+    case OPTION_OP:
+      arguments->slice.op = -1;
+      for (int i = 0; i < OP_INVALID; i++) {
+        if (strcasecmp(arg, req_op_str[i]) == 0) {
+          arguments->slice.op = i;
+        }
+      }
+      if (arguments->slice.op == -1) {
+        ERROR("unknown op %s\n", arg);
+      }
+      break;
+    case OPTION_TENANT:
+      arguments->slice.tenant = atoll(arg);
+      break;
+    case OPTION_NS:
+      arguments->slice.ns = atoll(arg);
+      break;
+    case OPTION_MIN_SIZE:
+      arguments->slice.min_size = atoll(arg);
+      break;
+    case OPTION_MAX_SIZE:
+      arguments->slice.max_size = atoll(arg);
+      break;
+    case OPTION_SAMPLE_RATIOS:
+      arguments->sample_ratios_str = arg;
       break;
     case ARGP_KEY_ARG:
       if (state->arg_num >= N_ARGS) {
@@ -163,13 +271,19 @@ static char doc[] =
     "tracePrint: utility to print binary trace in human-readable format\n"
     "traceConv: utility to convert a trace to oracleGeneral format\n\n"
     "traceFilter: utility to filter a trace\n\n"
+    "traceSlice: utility to write a slice of a trace\n\n"
+    "traceSample: utility to spatially sample a trace at several ratios\n\n"
     "example usage: ./tracePrint /trace/path oracleGeneral -n 20 "
     "--obj-id-only=1\n\n"
     "example usage: ./traceConv /trace/path csv -o "
     "/path/new_trace.oracleGeneral -t "
     "\"obj-id-col=5,time-col=2,obj-size-col=4\"\n\n"
     "example usage: ./traceFilter /trace/path lcs -o /path/new_trace.lcs "
-    "--filter fifo --filter-size 0.1\n\n";
+    "--filter-type fifo,lru --filter-size 0.01,0.1 --output-lcs 1\n\n"
+    "example usage: ./traceSlice /trace/path oracleGeneral -o /path/slice.lcs "
+    "--start-req 1200000000 --end-req 1300000000 --output-lcs 1\n\n"
+    "example usage: ./traceSample /trace/path oracleGeneral -o /path/sample "
+    "--sample-ratios 0.01,0.001,0.0001\n\n";
 
 /**
  * @brief initialize the arguments
@@ -188,11 +302,16 @@ static void init_arg(struct arguments *args) {
   memset(args->ofilepath, 0, OFILEPATH_LEN);
   args->output_txt = false;
   args->remove_size_change = false;
-  args->cache_name = NULL;
-  args->cache_size = 0;
+  args->n_thread = 1;
+  args->mem_limit = 0;
+  args->cache_name = (char *)"FIFO";
+  args->cache_size_str = (char *)"0.1";
+  args->output_lcs = false;
+  args->sample_ratios_str = (char *)"0.01,0.001,0.0001";
   args->delimiter = ',';
   args->print_obj_id_only = false;
   args->print_obj_id_32bit = false;
+  traceUtils::init_slice_param(&args->slice);
 }
 
 static void print_parsed_arg(struct arguments *args) {
@@ -226,6 +345,14 @@ static void print_parsed_arg(struct arguments *args) {
     n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
                   ", ignore object size");
 
+  if (args->n_thread > 1)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, ", %d threads",
+                  args->n_thread);
+
+  if (args->mem_limit > 0)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", memory limit %.2lf GiB", (double)args->mem_limit / GiB);
+
   snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, "\n");
 
   INFO("%s", output_str);
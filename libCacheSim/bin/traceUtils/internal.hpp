@@ -6,6 +6,7 @@
 
 #include "../../include/libCacheSim/reader.h"
 #include "../../include/libCacheSim/cache.h"
+#include "slice.hpp"
 
 #define N_ARGS 2
 #define OFILEPATH_LEN 128
@@ -28,6 +29,9 @@ struct arguments {
   /* some objects may change size during the trace, this keeps the size as the
    * last size in the trace */
   bool remove_size_change;
+  int n_thread;
+  /* the memory limit of the object map in bytes, 0 means no limit */
+  int64_t mem_limit;
 
   /* trace print */
   int64_t num_req; /* number of requests to print */
@@ -35,10 +39,16 @@ struct arguments {
   bool print_obj_id_only;
   bool print_obj_id_32bit;
 
-  /* trace filter */
+  /* tracePrint and traceSlice */
+  struct traceUtils::slice_param slice;
+
+  /* trace filter, comma separated lists of filter types and sizes */
   char *cache_name;
-  double cache_size;
-  cache_t *cache;
+  char *cache_size_str;
+  bool output_lcs;
+
+  /* trace sample, comma separated list of sample ratios */
+  char *sample_ratios_str;
 
   /* arguments generated */
   reader_t *reader;
@@ -63,9 +73,13 @@ namespace traceConv {
  * @param output_txt    whether also output a txt trace
  * @param remove_size_change whether remove object size change during traceConv
  * @param use_lcs_format whether use lcs format
+ * @param n_thread the number of threads finding the next access
+ * @param mem_limit the memory limit in bytes of the object map, objects
+ *                  beyond the limit are spilled to disk, 0 means no limit
  */
 void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath,
                               int sample_ratio, bool output_txt,
-                              bool remove_size_change, bool use_lcs_format);
+                              bool remove_size_change, bool use_lcs_format,
+                              int n_thread = 1, int64_t mem_limit = 0);
 
 }  // namespace traceConv
@@ -0,0 +1,43 @@
+#include "sample.hpp"
+
+#include "../../dataStructure/hash/hash.h"
+#include "../../include/libCacheSim/logging.h"
+
+namespace TraceSample {
+
+uint64_t cal_max_hv(double ratio) {
+  /* ratio * 2^64 rounds to 2^64 when the ratio is close to 1 */
+  double boundary = ratio * 18446744073709551616.0;
+  if (boundary >= 18446744073709551615.0) return UINT64_MAX;
+  if (boundary < 1.0) return 0;
+  return (uint64_t)boundary - 1;
+}
+
+void sample(reader_t *reader, std::vector<struct sample> &samples) {
+  request_t *req = new_request();
+
+  int64_t n_req = 0;
+  read_one_req(reader, req);
+  while (req->valid) {
+    n_req++;
+    uint64_t hv = (uint64_t)get_hash_value_int_64(&req->obj_id);
+    for (auto &s : samples) {
+      /* the samples are nested, a request not in this sample is not in the
+       * samples of smaller ratios */
+      if (hv > s.max_hv) break;
+      s.writer->write(req);
+    }
+
+    read_one_req(reader, req);
+  }
+
+  for (auto &s : samples) {
+    s.writer->close();
+    INFO("sample ratio %g: write %ld/%ld %.6lf requests to file %s\n", s.ratio,
+         (long)s.writer->n_req(), (long)n_req,
+         (double)s.writer->n_req() / n_req, s.writer->path().c_str());
+  }
+  free_request(req);
+}
+
+}  // namespace TraceSample
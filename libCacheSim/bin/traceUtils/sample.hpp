@@ -0,0 +1,41 @@
+#pragma once
+/**
+ * spatially sample a trace at several ratios in one pass, each sample is
+ * written in lcs format with the stat of the sampled trace in the header
+ *
+ * the hash of the obj_id is computed once per request, an object is in the
+ * sample of ratio r if the 64-bit hash < r * 2^64, so the sample of a smaller
+ * ratio is a subset of the sample of a larger ratio and a request stops at
+ * the first ratio it fails. Unlike the spatial sampler of the reader (which
+ * samples hash % (1 / r) == 0), any ratio in (0, 1] can be used
+ *
+ * the next access of the requests is not kept because sampling changes the
+ * request index, use traceConv on the sample to add it
+ */
+
+#include <inttypes.h>
+
+#include <vector>
+
+#include "../../include/libCacheSim/reader.h"
+#include "traceWriter.hpp"
+
+namespace TraceSample {
+struct sample {
+  double ratio;
+  /* the largest hash of the sampled objects */
+  uint64_t max_hv;
+  traceUtils::TraceWriter *writer;
+};
+
+/* the largest hash of the objects in the sample of the ratio */
+uint64_t cal_max_hv(double ratio);
+
+/**
+ * @brief write the requests of each sample in one pass of the trace, the
+ * writers are closed at the end
+ *
+ * @param samples sorted by the ratio in descending order
+ */
+void sample(reader_t *reader, std::vector<struct sample> &samples);
+}  // namespace TraceSample
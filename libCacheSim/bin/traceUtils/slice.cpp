@@ -0,0 +1,83 @@
+
+#include "slice.hpp"
+
+#include "../../include/libCacheSim/logging.h"
+
+namespace traceUtils {
+
+/* whether the records of the trace can be reached by offset */
+static bool can_seek(const reader_t *reader) {
+  return reader->trace_format == BINARY_TRACE_FORMAT &&
+         !reader->is_zstd_file && reader->sampler == NULL &&
+         reader->n_req_left == 0 && reader->item_size > 0;
+}
+
+static inline void seek_record(reader_t *reader, int64_t idx) {
+  reader->mmap_offset = reader->trace_start_offset + idx * reader->item_size;
+  reader->n_read_req = idx;
+  reader->next_access_idx = idx;
+}
+
+/* the first record at or after lo whose time is at least start_time */
+static int64_t find_start_time(reader_t *reader, int64_t lo, int64_t hi,
+                               int64_t start_time, request_t *req) {
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    seek_record(reader, mid);
+    if (read_one_req(reader, req) != 0 || req->clock_time >= start_time) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+/* -n (cap_at_n_req) counts the requests from the start of the slice, the
+ * requests before the start do not use up the cap */
+static inline void move_cap(reader_t *reader, int64_t cap) {
+  reader->cap_at_n_req = cap > 1 ? (int64_t)reader->n_read_req + cap : cap;
+}
+
+int64_t slice_seek(reader_t *reader, const struct slice_param *param) {
+  int64_t start_req = param->start_req > 0 ? param->start_req : 0;
+  int64_t cap = reader->cap_at_n_req;
+  reader->cap_at_n_req = -1;
+
+  if (can_seek(reader)) {
+    int64_t n_record =
+        (reader->file_size - reader->trace_start_offset) / reader->item_size;
+    if (start_req > n_record) start_req = n_record;
+
+    if (param->start_time > 0) {
+      request_t *req = new_request();
+      start_req =
+          find_start_time(reader, start_req, n_record, param->start_time, req);
+      free_request(req);
+    }
+
+    seek_record(reader, start_req);
+    move_cap(reader, cap);
+    return start_req;
+  }
+
+  if (param->start_time > 0) {
+    WARN("%s cannot seek, read the trace to the start time\n",
+         reader->trace_path);
+  }
+
+  request_t *req = new_request();
+  for (int64_t i = 0; i < start_req; i++) {
+    if (read_one_req(reader, req) != 0) {
+      free_request(req);
+      move_cap(reader, cap);
+      return i;
+    }
+  }
+  free_request(req);
+  move_cap(reader, cap);
+
+  return start_req;
+}
+
+}  // namespace traceUtils
@@ -0,0 +1,80 @@
+#pragma once
+/**
+ * select a slice of a trace by request index and time range, and filter the
+ * requests by op, tenant, namespace and size
+ *
+ * the start of the slice is found without reading the requests before it
+ * for uncompressed binary traces: the request index is converted to the
+ * offset of the record, and the start time is found by a binary search on
+ * the records, which assumes the trace is sorted by time. Other traces read
+ * and drop the requests before the start. Note that the request index of a
+ * binary trace is the index of the record, the requests dropped by the reader
+ * (e.g., size zero requests) are counted
+ */
+
+#include <inttypes.h>
+
+#include "../../include/libCacheSim/reader.h"
+#include "../../include/libCacheSim/request.h"
+
+namespace traceUtils {
+
+struct slice_param {
+  /* the requests in [start_req, end_req), -1 means no limit */
+  int64_t start_req;
+  int64_t end_req;
+  /* the requests in [start_time, end_time), -1 means no limit */
+  int64_t start_time;
+  int64_t end_time;
+
+  /* the filters, -1 means all */
+  int op;
+  int64_t tenant;
+  int64_t ns;
+  int64_t min_size;
+  int64_t max_size;
+};
+
+static inline void init_slice_param(struct slice_param *param) {
+  param->start_req = -1;
+  param->end_req = -1;
+  param->start_time = -1;
+  param->end_time = -1;
+  param->op = -1;
+  param->tenant = -1;
+  param->ns = -1;
+  param->min_size = -1;
+  param->max_size = -1;
+}
+
+/**
+ * @brief move the reader to the start of the slice, the cap on the number of
+ * requests of the reader (-n) is moved to count from the start
+ *
+ * @return the index of the next request the reader returns
+ */
+int64_t slice_seek(reader_t *reader, const struct slice_param *param);
+
+/* whether the request passes the filters of the slice */
+static inline bool slice_match(const request_t *req,
+                               const struct slice_param *param) {
+  if (param->start_time >= 0 && req->clock_time < param->start_time)
+    return false;
+  if (param->op >= 0 && req->op != param->op) return false;
+  if (param->tenant >= 0 && req->tenant_id != param->tenant) return false;
+  if (param->ns >= 0 && req->ns != param->ns) return false;
+  if (param->min_size >= 0 && req->obj_size < param->min_size) return false;
+  if (param->max_size >= 0 && req->obj_size > param->max_size) return false;
+  return true;
+}
+
+/* whether the request at idx is after the slice, the trace is assumed to be
+ * sorted by time */
+static inline bool slice_end(const request_t *req, int64_t idx,
+                             const struct slice_param *param) {
+  if (param->end_req >= 0 && idx >= param->end_req) return true;
+  if (param->end_time >= 0 && req->clock_time >= param->end_time) return true;
+  return false;
+}
+
+}  // namespace traceUtils
@@ -0,0 +1,115 @@
+#pragma once
+/**
+ * a buffered text output for printing traces, the integers are formatted
+ * directly into a large buffer (two digits at a time) and the buffer is
+ * written to the file descriptor with one write call when it is full, which
+ * is several times faster than printf per request
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "../../include/libCacheSim/logging.h"
+
+#define TEXT_PRINTER_BUF_SIZE (4 * 1024 * 1024)
+
+namespace traceUtils {
+
+class TextPrinter {
+ public:
+  explicit TextPrinter(int fd = STDOUT_FILENO,
+                       size_t buf_size = TEXT_PRINTER_BUF_SIZE)
+      : fd_(fd), buf_(buf_size) {}
+
+  ~TextPrinter() { flush(); }
+
+  TextPrinter(const TextPrinter &) = delete;
+  TextPrinter &operator=(const TextPrinter &) = delete;
+
+  inline void put_char(char c) {
+    reserve(1);
+    buf_[pos_++] = c;
+  }
+
+  inline void put_str(const char *s) {
+    size_t len = strlen(s);
+    reserve(len);
+    memcpy(buf_.data() + pos_, s, len);
+    pos_ += len;
+  }
+
+  inline void put_uint(uint64_t v) {
+    /* the digits are written backward into a local buffer */
+    char tmp[20];
+    char *p = tmp + sizeof(tmp);
+    while (v >= 100) {
+      uint64_t q = v / 100;
+      p -= 2;
+      memcpy(p, digits_ + (v - q * 100) * 2, 2);
+      v = q;
+    }
+    if (v >= 10) {
+      p -= 2;
+      memcpy(p, digits_ + v * 2, 2);
+    } else {
+      *--p = (char)('0' + v);
+    }
+
+    size_t len = tmp + sizeof(tmp) - p;
+    reserve(len);
+    memcpy(buf_.data() + pos_, p, len);
+    pos_ += len;
+  }
+
+  inline void put_int(int64_t v) {
+    if (v < 0) {
+      put_char('-');
+      put_uint(0 - (uint64_t)v);
+    } else {
+      put_uint((uint64_t)v);
+    }
+  }
+
+  void flush() {
+    const char *p = buf_.data();
+    size_t len = pos_;
+    while (len > 0) {
+      ssize_t n = write(fd_, p, len);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        ERROR("fail to write output, %s\n", strerror(errno));
+        exit(1);
+      }
+      p += n;
+      len -= (size_t)n;
+    }
+    pos_ = 0;
+  }
+
+ private:
+  inline void reserve(size_t len) {
+    if (pos_ + len > buf_.size()) flush();
+  }
+
+  static constexpr const char *digits_ =
+      "00010203040506070809"
+      "10111213141516171819"
+      "20212223242526272829"
+      "30313233343536373839"
+      "40414243444546474849"
+      "50515253545556575859"
+      "60616263646566676869"
+      "70717273747576777879"
+      "80818283848586878889"
+      "90919293949596979899";
+
+  int fd_;
+  std::vector<char> buf_;
+  size_t pos_ = 0;
+};
+
+}  // namespace traceUtils
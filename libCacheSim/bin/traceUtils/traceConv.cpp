@@ -1,16 +1,58 @@
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <deque>
 #include <fstream>
+#include <future>
 #include <iostream>
-#include <unordered_map>
+#include <memory>
+#include <vector>
 
+#include "../../dataStructure/robin_hood.h"
 #include "../../include/libCacheSim/logging.h"
 #include "../../include/libCacheSim/reader.h"
 #include "../../traceReader/generalReader/lcs.h"
 
+/**
+ * the trace is converted in one forward pass
+ *   1. the main thread reads the trace in chunks of CONV_CHUNK_N_REQ requests
+ *   2. worker threads find the next access of the requests whose next
+ *      request is in the same chunk, the last request of each object in the
+ *      chunk is left as -1
+ *   3. the main thread merges the chunks in order: the first request of an
+ *      object in a chunk is the next access of the last request of the object
+ *      in the previous chunks, which has been written, so it is patched in
+ *      the output file later. The last request of every object seen so far is
+ *      kept in a map
+ *   4. when the map exceeds the memory limit, the older half of the map is
+ *      spilled to CONV_N_SPILL_PART files partitioned by obj_id, a request
+ *      that does not find its object in the map is also written to the spill
+ *      files, and each spill file is matched at the end of the trace
+ *
+ * the output is written forward, the patches are applied through mmap in
+ * batches of CONV_MAX_PATCH
+ */
+
+/* the number of requests resolved by a worker at a time */
+#define CONV_CHUNK_N_REQ (1 << 19)
+/* the estimated memory used by a request in a chunk: the request, the local
+ * map and the first and last request of the objects */
+#define CONV_CHUNK_BYTES_PER_REQ 72
+/* the estimated memory of an object in the map, including rehashing */
+#define CONV_OPEN_REQ_BYTES 48
+#define CONV_MAX_PATCH (1 << 22)
+#define CONV_N_SPILL_PART 64
+#define CONV_SPILL_BUF_SIZE (256 * 1024)
+
 namespace traceConv {
 typedef struct oracleGeneral_req {
   uint32_t clock_time;
@@ -32,9 +74,370 @@ struct trace_stat {
   int64_t n_obj_byte;
 };
 
-static void _reverse_file(std::string ofilepath, struct trace_stat stat,
-                          bool output_txt, bool remove_size_change,
-                          bool use_lcs_format);
+/* the first and the last request of an object in a chunk */
+struct chunk_obj {
+  uint64_t obj_id;
+  uint32_t first;
+  uint32_t last;
+};
+
+struct conv_chunk {
+  /* the vtime (starting from 0) of the first request in the chunk */
+  int64_t start_vtime;
+  std::vector<oracleGeneral_req_t> reqs;
+  std::vector<chunk_obj> objs;
+  /* the index in objs of each request, only used to remove size change */
+  std::vector<uint32_t> obj_idx;
+};
+
+/* the last request of an object in the merged chunks, its next access is -1
+ * in the output until the object is requested again */
+struct open_req {
+  int64_t vtime;
+  uint32_t obj_size;
+  /* the first size of the object, used to remove size change */
+  uint32_t first_obj_size;
+};
+
+/* a spilled last request or a request that does not find its object in
+ * the map after spilling */
+struct spill_rec {
+  uint64_t obj_id;
+  int64_t vtime;
+  uint32_t obj_size;
+  uint32_t is_query;
+};
+
+struct patch {
+  int64_t vtime;
+  int64_t next_access_vtime;
+};
+
+/**
+ * @brief find the next access of the requests whose next request is in the
+ * same chunk, runs on the worker threads
+ */
+static conv_chunk *_resolve_chunk(conv_chunk *chunk, bool record_obj_idx) {
+  robin_hood::unordered_flat_map<uint64_t, uint32_t> obj_pos;
+  uint32_t n_req = (uint32_t)chunk->reqs.size();
+  obj_pos.reserve(n_req);
+  if (record_obj_idx) chunk->obj_idx.resize(n_req);
+
+  for (uint32_t i = 0; i < n_req; i++) {
+    oracleGeneral_req_t *req = &chunk->reqs[i];
+    uint64_t obj_id = req->obj_id;
+    req->next_access_vtime = -1;
+
+    auto it = obj_pos.try_emplace(obj_id, (uint32_t)chunk->objs.size());
+    uint32_t k = it.first->second;
+    if (it.second) {
+      chunk->objs.push_back({obj_id, i, i});
+    } else {
+      chunk->reqs[chunk->objs[k].last].next_access_vtime =
+          chunk->start_vtime + i + 1;
+      chunk->objs[k].last = i;
+    }
+
+    if (record_obj_idx) chunk->obj_idx[i] = k;
+  }
+
+  return chunk;
+}
+
+class OracleGeneralWriter {
+ public:
+  OracleGeneralWriter(const std::string &ofilepath, bool remove_size_change,
+                      bool use_lcs_format, int64_t max_open_req)
+      : ofilepath_(ofilepath),
+        remove_size_change_(remove_size_change),
+        header_size_(use_lcs_format ? sizeof(lcs_trace_header_t) : 0),
+        max_open_req_(max_open_req) {
+    memset(&stat_, 0, sizeof(stat_));
+    fd_ = open(ofilepath_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+      ERROR("Unable to open '%s', %s\n", ofilepath_.c_str(), strerror(errno));
+      exit(1);
+    }
+
+    /* the header is written at the end when the trace stat is known */
+    if (use_lcs_format) {
+      lcs_trace_header_t lcs_header;
+      memset(&lcs_header, 0, sizeof(lcs_header));
+      _write(&lcs_header, sizeof(lcs_header));
+    }
+  }
+
+  ~OracleGeneralWriter() {
+    if (fd_ >= 0) close(fd_);
+  }
+
+  void add_req_byte(int64_t n_byte) { stat_.n_req_byte += n_byte; }
+
+  /* merge the chunks in trace order and write the requests */
+  void merge_chunk(conv_chunk *chunk);
+
+  /* match the spill files and apply the remaining patches */
+  struct trace_stat finish();
+
+  int64_t n_open_req() const { return (int64_t)open_reqs_.size(); }
+
+  int64_t n_spilled_req() const { return n_spilled_req_; }
+
+ private:
+  void _write(const void *buf, size_t len);
+
+  void _add_patch(int64_t vtime, int64_t next_access_vtime) {
+    patches_.push_back({vtime, next_access_vtime});
+    if (patches_.size() >= CONV_MAX_PATCH) _apply_patches();
+  }
+
+  void _apply_patches();
+
+  void _spill(uint64_t obj_id, int64_t vtime, uint32_t obj_size,
+              bool is_query);
+
+  /* spill the older half of the map */
+  void _spill_open_reqs();
+
+  void _match_spill_part(int part);
+
+  const std::string ofilepath_;
+  const bool remove_size_change_;
+  const size_t header_size_;
+  /* the max number of objects in the map, 0 means no limit */
+  const int64_t max_open_req_;
+
+  int fd_ = -1;
+  struct trace_stat stat_;
+  robin_hood::unordered_flat_map<uint64_t, open_req> open_reqs_;
+  std::vector<struct patch> patches_;
+  int64_t n_patched_req_ = 0;
+
+  FILE *spill_files_[CONV_N_SPILL_PART] = {nullptr};
+  int64_t n_spilled_req_ = 0;
+};
+
+void OracleGeneralWriter::_write(const void *buf, size_t len) {
+  const char *p = static_cast<const char *>(buf);
+  while (len > 0) {
+    ssize_t n = write(fd_, p, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ERROR("fail to write %s, %s\n", ofilepath_.c_str(), strerror(errno));
+      exit(1);
+    }
+    p += n;
+    len -= (size_t)n;
+  }
+}
+
+void OracleGeneralWriter::merge_chunk(conv_chunk *chunk) {
+  std::vector<uint32_t> first_obj_size;
+  if (remove_size_change_) first_obj_size.resize(chunk->objs.size());
+
+  for (size_t k = 0; k < chunk->objs.size(); k++) {
+    const chunk_obj &obj = chunk->objs[k];
+    uint32_t last_obj_size = chunk->reqs[obj.last].obj_size;
+    uint32_t obj_size = chunk->reqs[obj.first].obj_size;
+
+    auto it = open_reqs_.try_emplace(obj.obj_id);
+    if (!it.second) {
+      /* the object is requested in the previous chunks */
+      _add_patch(it.first->second.vtime, chunk->start_vtime + obj.first + 1);
+      stat_.n_obj -= 1;
+      stat_.n_obj_byte -= it.first->second.obj_size;
+      obj_size = it.first->second.first_obj_size;
+    } else if (n_spilled_req_ > 0) {
+      /* the object may have been spilled, the first size of a spilled object
+       * is not known, so spilling is disabled when removing size change */
+      _spill(obj.obj_id, chunk->start_vtime + obj.first, 0, true);
+    }
+
+    /* the last request of each object has no next access */
+    stat_.n_obj += 1;
+    stat_.n_obj_byte += last_obj_size;
+    it.first->second = {chunk->start_vtime + obj.last, last_obj_size,
+                        obj_size};
+    if (remove_size_change_) first_obj_size[k] = obj_size;
+  }
+
+  if (remove_size_change_) {
+    for (size_t i = 0; i < chunk->reqs.size(); i++) {
+      chunk->reqs[i].obj_size = first_obj_size[chunk->obj_idx[i]];
+    }
+  }
+
+  _write(chunk->reqs.data(), chunk->reqs.size() * sizeof(oracleGeneral_req_t));
+  stat_.n_req += (int64_t)chunk->reqs.size();
+
+  if (max_open_req_ > 0 && (int64_t)open_reqs_.size() > max_open_req_) {
+    _spill_open_reqs();
+  }
+}
+
+void OracleGeneralWriter::_apply_patches() {
+  if (patches_.empty()) return;
+
+  /* sort the patches so that the pages are visited in order */
+  std::sort(patches_.begin(), patches_.end(),
+            [](const struct patch &a, const struct patch &b) {
+              return a.vtime < b.vtime;
+            });
+
+  size_t file_size =
+      header_size_ + (size_t)stat_.n_req * sizeof(oracleGeneral_req_t);
+  char *mapped_file = reinterpret_cast<char *>(
+      mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0));
+  if (mapped_file == MAP_FAILED) {
+    ERROR("Unable to mmap %s, %s\n", ofilepath_.c_str(), strerror(errno));
+    exit(1);
+  }
+
+  for (const struct patch &p : patches_) {
+    assert(p.vtime < stat_.n_req);
+    memcpy(mapped_file + header_size_ +
+               (size_t)p.vtime * sizeof(oracleGeneral_req_t) +
+               offsetof(oracleGeneral_req_t, next_access_vtime),
+           &p.next_access_vtime, sizeof(int64_t));
+  }
+
+  munmap(mapped_file, file_size);
+  n_patched_req_ += (int64_t)patches_.size();
+  patches_.clear();
+}
+
+void OracleGeneralWriter::_spill(uint64_t obj_id, int64_t vtime,
+                                 uint32_t obj_size, bool is_query) {
+  int part = (int)((obj_id * 0x9E3779B97F4A7C15ULL) >> 58);
+  static_assert(CONV_N_SPILL_PART == 64, "the partition uses the top 6 bits");
+
+  if (spill_files_[part] == nullptr) {
+    std::string path = ofilepath_ + ".spill." + std::to_string(part);
+    spill_files_[part] = fopen(path.c_str(), "w+b");
+    if (spill_files_[part] == nullptr) {
+      ERROR("Unable to open '%s', %s\n", path.c_str(), strerror(errno));
+      exit(1);
+    }
+    setvbuf(spill_files_[part], NULL, _IOFBF, CONV_SPILL_BUF_SIZE);
+  }
+
+  struct spill_rec rec = {obj_id, vtime, obj_size, is_query ? 1u : 0u};
+  if (fwrite(&rec, sizeof(rec), 1, spill_files_[part]) != 1) {
+    ERROR("fail to write spill file of %s, %s\n", ofilepath_.c_str(),
+          strerror(errno));
+    exit(1);
+  }
+}
+
+void OracleGeneralWriter::_spill_open_reqs() {
+  /* the median vtime of a sample of the map */
+  std::vector<int64_t> sample;
+  size_t stride = open_reqs_.size() / 4096 + 1, i = 0;
+  for (const auto &p : open_reqs_) {
+    if (i++ % stride == 0) sample.push_back(p.second.vtime);
+  }
+  std::nth_element(sample.begin(), sample.begin() + sample.size() / 2,
+                   sample.end());
+  int64_t spill_before = sample[sample.size() / 2];
+
+  int64_t n_spilled = 0;
+  for (auto it = open_reqs_.begin(); it != open_reqs_.end();) {
+    if (it->second.vtime < spill_before) {
+      _spill(it->first, it->second.vtime, it->second.obj_size, false);
+      it = open_reqs_.erase(it);
+      n_spilled += 1;
+    } else {
+      ++it;
+    }
+  }
+
+  n_spilled_req_ += n_spilled;
+  DEBUG("%s: spill %ld objects, %ld objects in memory\n", ofilepath_.c_str(),
+        (long)n_spilled, (long)open_reqs_.size());
+}
+
+/**
+ * the records of an object in a spill file alternate between a spilled last
+ * request and a request that does not find the object in the map, because
+ * the object is only in the spill files after spilling and it is in the map
+ * again after the next request, so a query matches the spilled request
+ * before it, a query without a spilled request is a new object
+ */
+void OracleGeneralWriter::_match_spill_part(int part) {
+  FILE *ifile = spill_files_[part];
+  if (ifile == nullptr) return;
+  fflush(ifile);
+  rewind(ifile);
+
+  robin_hood::unordered_flat_map<uint64_t, std::pair<int64_t, uint32_t>>
+      spilled;
+  struct spill_rec rec;
+  while (fread(&rec, sizeof(rec), 1, ifile) == 1) {
+    if (!rec.is_query) {
+      spilled[rec.obj_id] = {rec.vtime, rec.obj_size};
+      continue;
+    }
+
+    auto it = spilled.find(rec.obj_id);
+    if (it != spilled.end()) {
+      _add_patch(it->second.first, rec.vtime + 1);
+      stat_.n_obj -= 1;
+      stat_.n_obj_byte -= it->second.second;
+      spilled.erase(it);
+    }
+  }
+
+  fclose(ifile);
+  spill_files_[part] = nullptr;
+  remove((ofilepath_ + ".spill." + std::to_string(part)).c_str());
+}
+
+struct trace_stat OracleGeneralWriter::finish() {
+  if (n_spilled_req_ > 0) {
+    INFO("%s: match %ld spilled objects\n", ofilepath_.c_str(),
+         (long)n_spilled_req_);
+  }
+  for (int i = 0; i < CONV_N_SPILL_PART; i++) {
+    _match_spill_part(i);
+  }
+  _apply_patches();
+
+  if (header_size_ > 0) {
+    lcs_trace_header_t lcs_header;
+    memset(&lcs_header, 0, sizeof(lcs_header));
+    lcs_header.start_magic = LCS_TRACE_START_MAGIC;
+    lcs_header.end_magic = LCS_TRACE_END_MAGIC;
+    lcs_header.n_req = stat_.n_req;
+    lcs_header.n_obj = stat_.n_obj;
+    lcs_header.n_req_byte = stat_.n_req_byte;
+    lcs_header.n_obj_byte = stat_.n_obj_byte;
+    lcs_header.time_field = 1;
+    lcs_header.obj_id_field = 2;
+    lcs_header.obj_size_field = 3;
+    lcs_header.next_access_vtime_field = 4;
+    lcs_header.item_size = sizeof(oracleGeneral_req_t);
+    lcs_header.n_fields = 4;
+    memcpy(lcs_header.format, "<IQIQ", 5);
+
+    verify_LCS_trace_header(&lcs_header);
+    if (pwrite(fd_, &lcs_header, sizeof(lcs_header), 0) !=
+        (ssize_t)sizeof(lcs_header)) {
+      ERROR("fail to write the header of %s, %s\n", ofilepath_.c_str(),
+            strerror(errno));
+      exit(1);
+    }
+  }
+
+  close(fd_);
+  fd_ = -1;
+  DEBUG("%s: %ld next access patched\n", ofilepath_.c_str(),
+        (long)n_patched_req_);
+
+  return stat_;
+}
+
+static void _write_txt(const std::string &ofilepath, size_t header_size,
+                       int64_t n_req);
 
 /**
  * @brief Convert a trace to oracleGeneral format, which is a binary format
@@ -47,88 +450,97 @@ static void _reverse_file(std::string ofilepath, struct trace_stat stat,
  * @param sample_ratio
  * @param output_txt
  * @param remove_size_change
+ * @param use_lcs_format
+ * @param n_thread the number of threads finding the next access in chunks
+ * @param mem_limit the memory limit in bytes of the map of objects, the
+ * objects are spilled to disk beyond the limit, 0 means no limit
  */
 void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath,
                               int sample_ratio, bool output_txt,
-                              bool remove_size_change, bool use_lcs_format) {
-  request_t *req = new_request();
-  std::ofstream ofile_temp(ofilepath + ".reverse",
-                           std::ios::out | std::ios::binary | std::ios::trunc);
-  std::unordered_map<uint64_t, int64_t> last_access_map;
-
-  int64_t n_req_curr = 0, n_req_total = get_num_of_req(reader);
-  last_access_map.reserve(n_req_total / 100 + 1e4);
+                              bool remove_size_change, bool use_lcs_format,
+                              int n_thread, int64_t mem_limit) {
+  if (n_thread <= 0) n_thread = 1;
+
+  int64_t max_open_req = 0;
+  if (mem_limit > 0) {
+    int64_t chunk_mem = (int64_t)(n_thread + 1) * CONV_CHUNK_N_REQ *
+                            CONV_CHUNK_BYTES_PER_REQ +
+                        (int64_t)CONV_MAX_PATCH * sizeof(struct patch);
+    if (remove_size_change) {
+      WARN(
+          "removing size change needs the size of all objects in memory, "
+          "ignore memory limit\n");
+    } else if (mem_limit - chunk_mem < 1000000LL * CONV_OPEN_REQ_BYTES) {
+      ERROR("memory limit %.2lf GiB is too small for %d threads\n",
+            (double)mem_limit / GiB, n_thread);
+      exit(1);
+    } else {
+      max_open_req = (mem_limit - chunk_mem) / CONV_OPEN_REQ_BYTES;
+    }
+  }
 
-  int64_t unique_bytes = 0, total_bytes = 0, n_obj = 0;
-  INFO("%s: %.2f M requests in total\n", reader->trace_path,
-       (double)n_req_total / 1.0e6);
+  OracleGeneralWriter writer(ofilepath, remove_size_change, use_lcs_format,
+                             max_open_req);
+  std::deque<std::future<conv_chunk *>> resolving;
 
-  reader->read_direction = READ_BACKWARD;
-  reader_set_read_pos(reader, 1.0);
-  go_back_one_req(reader);
+  request_t *req = new_request();
   read_one_req(reader, req);
-
   int64_t start_ts = req->clock_time;
-
-  oracleGeneral_req_t og_req;
-  og_req.init(req);
-
-  while (true) {
-    auto last_access_it = last_access_map.find(og_req.obj_id);
-
-    if (last_access_it == last_access_map.end()) {
-      og_req.next_access_vtime = -1;
-      n_obj++;
-      unique_bytes += req->obj_size;
-    } else {
-      og_req.next_access_vtime = last_access_it->second;
+  int64_t n_req_curr = 0, total_bytes = 0;
+
+  while (req->valid) {
+    conv_chunk *chunk = new conv_chunk;
+    chunk->start_vtime = n_req_curr;
+    chunk->reqs.resize(CONV_CHUNK_N_REQ);
+
+    size_t n = 0;
+    while (n < CONV_CHUNK_N_REQ && req->valid) {
+      chunk->reqs[n++].init(req);
+      total_bytes += req->obj_size;
+      n_req_curr += 1;
+
+      if (n_req_curr % 100000000 == 0) {
+        INFO(
+            "%s: %ld M requests (%.2lf GB), trace time %ld, %ld objects in "
+            "memory, %ld spilled\n",
+            reader->trace_path, (long)(n_req_curr / 1e6),
+            (double)total_bytes / GiB, (long)(req->clock_time - start_ts),
+            (long)writer.n_open_req(), (long)writer.n_spilled_req());
+      }
+      read_one_req(reader, req);
     }
-
-    total_bytes += req->obj_size;
-    last_access_map[req->obj_id] = n_req_curr;
-
-    ofile_temp.write(reinterpret_cast<char *>(&og_req),
-                     sizeof(oracleGeneral_req_t));
-    n_req_curr += 1;
-
-    if (n_req_curr % 100000000 == 0) {
-      INFO(
-          "%s: %ld M requests (%.2lf GB), trace time %ld, working set %lld "
-          "object, %lld B (%.2lf GB)\n",
-          reader->trace_path, (long)(n_req_curr / 1e6),
-          (double)total_bytes / GiB, (long)(start_ts - req->clock_time),
-          (long long)n_obj, (long long)unique_bytes,
-          (double)unique_bytes / GiB);
+    chunk->reqs.resize(n);
+
+    resolving.push_back(std::async(std::launch::async, _resolve_chunk, chunk,
+                                   remove_size_change));
+    if ((int)resolving.size() >= n_thread) {
+      std::unique_ptr<conv_chunk> resolved(resolving.front().get());
+      resolving.pop_front();
+      writer.merge_chunk(resolved.get());
     }
-
-    if (read_one_req_above(reader, req) != 0) {
-      break;
-    }
-    og_req.init(req);
   }
 
-  if (reader->sampler == nullptr) {
-    assert(n_req_curr == get_num_of_req(reader));
+  while (!resolving.empty()) {
+    std::unique_ptr<conv_chunk> resolved(resolving.front().get());
+    resolving.pop_front();
+    writer.merge_chunk(resolved.get());
   }
 
   free_request(req);
-  ofile_temp.close();
+  writer.add_req_byte(total_bytes);
+  struct trace_stat stat = writer.finish();
+  assert(stat.n_req == n_req_curr);
+
+  if (output_txt) {
+    _write_txt(ofilepath, use_lcs_format ? sizeof(lcs_trace_header_t) : 0,
+               stat.n_req);
+  }
 
   INFO(
-      "%s: %ld M requests (%.2lf GB), trace time %ld, working set %lld "
-      "object, %lld B (%.2lf GB), reversing output...\n",
-      reader->trace_path, (long)(n_req_curr / 1e6), (double)total_bytes / GiB,
-      (long)(start_ts - req->clock_time), (long long)n_obj,
-      (long long)unique_bytes, (double)unique_bytes / GiB);
-
-  struct trace_stat stat;
-  stat.n_req = n_req_curr;
-  stat.n_obj = n_obj;
-  stat.n_req_byte = total_bytes;
-  stat.n_obj_byte = unique_bytes;
-
-  _reverse_file(ofilepath, stat, output_txt, remove_size_change,
-                use_lcs_format);
+      "trace conversion finished, %ld requests %ld objects (%.2lf GB), output "
+      "%s\n",
+      (long)stat.n_req, (long)stat.n_obj, (double)stat.n_obj_byte / GiB,
+      ofilepath.c_str());
 }
 
 static void *_setup_mmap(const std::string &file_path, size_t *size) {
@@ -170,87 +582,25 @@ static void *_setup_mmap(const std::string &file_path, size_t *size) {
   return mapped_file;
 }
 
-static void _reverse_file(std::string ofilepath, struct trace_stat stat,
-                          bool output_txt, bool remove_size_change,
-                          bool use_lcs_format) {
-  int64_t n_req = 0;
+static void _write_txt(const std::string &ofilepath, size_t header_size,
+                       int64_t n_req) {
+  if (n_req == 0) return;
+
   size_t file_size;
   char *mapped_file =
-      reinterpret_cast<char *>(_setup_mmap(ofilepath + ".reverse", &file_size));
-  size_t pos = file_size;
-
-  std::ofstream ofile(ofilepath,
-                      std::ios::out | std::ios::binary | std::ios::trunc);
-  if (use_lcs_format) {
-    lcs_trace_header_t lcs_header;
-    lcs_header.start_magic = LCS_TRACE_START_MAGIC;
-    lcs_header.end_magic = LCS_TRACE_END_MAGIC;
-    lcs_header.n_req = stat.n_req;
-    lcs_header.n_obj = stat.n_obj;
-    lcs_header.n_req_byte = stat.n_req_byte;
-    lcs_header.n_obj_byte = stat.n_obj_byte;
-    lcs_header.time_field = 1;
-    lcs_header.obj_id_field = 2;
-    lcs_header.obj_size_field = 3;
-    lcs_header.next_access_vtime_field = 4;
-    lcs_header.item_size = sizeof(oracleGeneral_req_t);
-    lcs_header.n_fields = 4;
-    memcpy(lcs_header.format, "<IQIQ", 5);
-
-    verify_LCS_trace_header(&lcs_header);
-    ofile.write(reinterpret_cast<char *>(&lcs_header),
-                sizeof(lcs_trace_header_t));
-  }
-
-  std::ofstream ofile_txt;
-  if (output_txt)
-    ofile_txt.open(ofilepath + ".txt", std::ios::out | std::ios::trunc);
-
-  /* we remove object size change because some of the systems do not allow
-   * object size change */
-  std::unordered_map<uint64_t, uint32_t> last_obj_size;
-  last_obj_size.reserve(stat.n_obj);
+      reinterpret_cast<char *>(_setup_mmap(ofilepath, &file_size));
+  assert(file_size == header_size + n_req * sizeof(oracleGeneral_req_t));
 
+  std::ofstream ofile_txt(ofilepath + ".txt", std::ios::out | std::ios::trunc);
   oracleGeneral_req_t og_req;
-  size_t req_entry_size = sizeof(oracleGeneral_req_t);
-
-  while (pos >= req_entry_size) {
-    pos -= req_entry_size;
-    memcpy(&og_req, mapped_file + pos, req_entry_size);
-    if (og_req.next_access_vtime != -1) {
-      /* re.next_access_vtime is the vtime start from the end */
-      og_req.next_access_vtime = stat.n_req - og_req.next_access_vtime;
-    }
-
-    if (remove_size_change) {
-      auto it = last_obj_size.find(og_req.obj_id);
-      if (it != last_obj_size.end()) {
-        og_req.obj_size = it->second;
-      } else {
-        last_obj_size[og_req.obj_id] = og_req.obj_size;
-      }
-    }
-
-    ofile.write(reinterpret_cast<char *>(&og_req), req_entry_size);
-    if (output_txt) {
-      ofile_txt << og_req.clock_time << "," << og_req.obj_id << ","
-                << og_req.obj_size << "," << og_req.next_access_vtime << "\n";
-    }
-
-    if ((++n_req) % 100000000 == 0) {
-      INFO("%s: %ld M requests\n", ofilepath.c_str(), (long)(n_req / 1e6));
-    }
+  for (int64_t i = 0; i < n_req; i++) {
+    memcpy(&og_req, mapped_file + header_size + i * sizeof(og_req),
+           sizeof(og_req));
+    ofile_txt << og_req.clock_time << "," << og_req.obj_id << ","
+              << og_req.obj_size << "," << og_req.next_access_vtime << "\n";
   }
 
   munmap(mapped_file, file_size);
-  ofile.close();
-  if (output_txt) ofile_txt.close();
-
-  assert(n_req == stat.n_req);
-
-  remove((ofilepath + ".reverse").c_str());
-
-  INFO("trace conversion finished, %ld requests %ld objects, output %s\n",
-       (long) n_req, (long) stat.n_obj, ofilepath.c_str());
+  ofile_txt.close();
 }
-}  // namespace traceConv
\ No newline at end of file
+}  // namespace traceConv
@@ -36,7 +36,8 @@ int main(int argc, char *argv[]) {
 
   traceConv::convert_to_oracleGeneral(args.reader, args.ofilepath,
                                       args.sample_ratio, args.output_txt,
-                                      args.remove_size_change, false);
+                                      args.remove_size_change, false,
+                                      args.n_thread, args.mem_limit);
 }
 
 
@@ -1,7 +1,10 @@
 /**
- * Filter the trace to generate a second-layer cache trace.
- * only support single algorithm (without params), e.g., FIFO and LRU, at this
- * moment. The output format is lcs format (oracleGeneral).
+ * Filter the trace to generate second-layer cache traces.
+ * only support algorithms without params, e.g., FIFO and LRU, at this
+ * moment. Multiple filters (the cross product of the filter types and sizes)
+ * run in one pass of the trace, each writes its misses to its own output.
+ * The output format is oracleGeneral, or lcs with the trace stat in the
+ * header.
  *
  */
 
@@ -9,7 +12,9 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "../../include/libCacheSim/cache.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
@@ -19,44 +24,63 @@
 #include "../../utils/include/mysys.h"
 #include "../cli_reader_utils.h"
 #include "internal.hpp"
+#include "traceWriter.hpp"
 
 namespace TraceFilter {
-struct output_format {
-  uint32_t clock_time;
-  uint64_t obj_id;
-  uint32_t obj_size;
-  int64_t next_access_vtime;
-} __attribute__((packed));
-
-void filter(reader_t *reader, cache_t *cache, std::string ofilepath) {
-  request_t *req = new_request();
+struct filter {
+  std::string name;
+  uint64_t cache_size;
+  cache_t *cache;
+  traceUtils::TraceWriter *writer;
+};
 
-  std::ofstream output_file(ofilepath, std::ios::binary);
-  struct output_format output_req;
-  output_req.next_access_vtime = -2;
+/**
+ * @brief run all the filters in one pass of the trace, the misses of each
+ * filter are written to its own output
+ */
+void filter(reader_t *reader, std::vector<struct filter> &filters) {
+  request_t *req = new_request();
 
   read_one_req(reader, req);
   uint64_t start_ts = (uint64_t)req->clock_time;
 
-  int64_t n_req = 0, n_written_req = 0;
+  int64_t n_req = 0;
   while (req->valid) {
     n_req++;
     req->clock_time -= start_ts;
-    if (cache->get(cache, req) == false) {
-      output_req.clock_time = req->clock_time;
-      output_req.obj_id = req->obj_id;
-      output_req.obj_size = req->obj_size;
-      output_file.write((char *)&output_req, sizeof(struct output_format));
-      n_written_req++;
+    for (auto &f : filters) {
+      if (f.cache->get(f.cache, req) == false) {
+        f.writer->write(req);
+      }
     }
 
     read_one_req(reader, req);
   }
 
-  INFO("write %ld/%ld %.4lf requests to file %s\n", (long) n_written_req, (long) n_req,
-       (double)n_written_req / n_req, ofilepath.c_str());
+  for (auto &f : filters) {
+    f.writer->close();
+    INFO("%s %lu: write %ld/%ld %.4lf requests to file %s\n", f.name.c_str(),
+         (unsigned long)f.cache_size, (long)f.writer->n_req(), (long)n_req,
+         (double)f.writer->n_req() / n_req, f.writer->path().c_str());
+  }
   free_request(req);
-  output_file.close();
+}
+
+static cache_t *create_filter(const char *cache_name, uint64_t cache_size,
+                              int hashpower) {
+  common_cache_params_t cc_params = {.cache_size = cache_size,
+                                     .default_ttl = 86400 * 300,
+                                     .hashpower = hashpower,
+                                     .consider_obj_metadata = false};
+
+  if (strcasecmp(cache_name, "LRU") == 0) {
+    return LRU_init(cc_params, NULL);
+  } else if (strcasecmp(cache_name, "FIFO") == 0) {
+    return FIFO_init(cc_params, NULL);
+  }
+
+  ERROR("unsupported cache name %s\n", cache_name);
+  exit(1);
 }
 }  // namespace TraceFilter
 
@@ -64,40 +88,74 @@ int main(int argc, char *argv[]) {
   struct arguments args;
   cli::parse_cmd(argc, argv, &args);
 
-  if (args.cache_size < 1) {
-    int64_t wss_obj = 0, wss_byte = 0;
-    cal_working_set_size(args.reader, &wss_obj, &wss_byte);
-    if (args.ignore_obj_size) {
-      args.cache_size = (int64_t)(wss_obj * args.cache_size);
-    } else {
-      args.cache_size = (int64_t)(wss_byte * args.cache_size);
+  /* the filters are the cross product of the filter types and sizes, e.g.,
+   * --filter-type fifo,lru --filter-size 0.01,0.1 */
+  std::vector<std::string> cache_names, cache_size_strs;
+  std::string token;
+  std::stringstream cache_name_ss(args.cache_name);
+  while (std::getline(cache_name_ss, token, ',')) cache_names.push_back(token);
+  std::stringstream cache_size_ss(args.cache_size_str);
+  while (std::getline(cache_size_ss, token, ','))
+    cache_size_strs.push_back(token);
+
+  int64_t wss_obj = -1, wss_byte = -1;
+  std::vector<uint64_t> cache_sizes;
+  for (auto &size_str : cache_size_strs) {
+    double cache_size = atof(size_str.c_str());
+    if (cache_size < 1) {
+      if (wss_obj == -1) {
+        cal_working_set_size(args.reader, &wss_obj, &wss_byte);
+      }
+      if (args.ignore_obj_size) {
+        cache_size = (int64_t)(wss_obj * cache_size);
+      } else {
+        cache_size = (int64_t)(wss_byte * cache_size);
+      }
     }
+    cache_sizes.push_back(static_cast<uint64_t>(cache_size));
   }
 
-  common_cache_params_t cc_params = {
-      .cache_size = static_cast<uint64_t>(args.cache_size),
-      .default_ttl = 86400 * 300,
-      .hashpower = 24,
-      .consider_obj_metadata = false};
-
-  if (strcasecmp(args.cache_name, "LRU") == 0) {
-    args.cache = LRU_init(cc_params, NULL);
-  } else if (strcasecmp(args.cache_name, "FIFO") == 0) {
-    args.cache = FIFO_init(cc_params, NULL);
-  } else {
-    ERROR("unsupported cache name %s\n", args.cache_name);
+  size_t n_filter = cache_names.size() * cache_sizes.size();
+  if (n_filter == 0) {
+    ERROR("no filter is given\n");
     exit(1);
   }
 
-  if (args.ofilepath[0] == '\0') {
-    char *trace_filename = rindex(args.trace_path, '/');
-    snprintf(args.ofilepath, OFILEPATH_LEN, "%s.filter_%s_%lu.oracleGeneral",
-             trace_filename == NULL ? args.trace_path : trace_filename + 1,
-             args.cache_name, static_cast<unsigned long>(args.cache_size));
+  /* the hash table grows with the cache, so many filters start small */
+  int hashpower = n_filter > 1 ? 20 : 24;
+  const char *suffix = args.output_lcs ? "lcs" : "oracleGeneral";
+  char *trace_filename = rindex(args.trace_path, '/');
+  std::vector<struct TraceFilter::filter> filters;
+  for (auto &cache_name : cache_names) {
+    for (auto cache_size : cache_sizes) {
+      char ofilepath[OFILEPATH_LEN * 2];
+      if (args.ofilepath[0] == '\0') {
+        snprintf(ofilepath, sizeof(ofilepath), "%s.filter_%s_%lu.%s",
+                 trace_filename == NULL ? args.trace_path : trace_filename + 1,
+                 cache_name.c_str(), static_cast<unsigned long>(cache_size),
+                 suffix);
+      } else if (n_filter == 1) {
+        snprintf(ofilepath, sizeof(ofilepath), "%s", args.ofilepath);
+      } else {
+        snprintf(ofilepath, sizeof(ofilepath), "%s.filter_%s_%lu",
+                 args.ofilepath, cache_name.c_str(),
+                 static_cast<unsigned long>(cache_size));
+      }
+
+      filters.push_back(
+          {cache_name, cache_size,
+           TraceFilter::create_filter(cache_name.c_str(), cache_size,
+                                      hashpower),
+           new traceUtils::TraceWriter(ofilepath, args.output_lcs)});
+    }
   }
 
-  TraceFilter::filter(args.reader, args.cache, args.ofilepath);
+  TraceFilter::filter(args.reader, filters);
 
+  for (auto &f : filters) {
+    f.cache->cache_free(f.cache);
+    delete f.writer;
+  }
   cli::free_arg(&args);
 
   return 0;
@@ -7,44 +7,60 @@
 
 #include "../../include/libCacheSim/reader.h"
 #include "internal.hpp"
+#include "slice.hpp"
+#include "textPrinter.hpp"
 
 int main(int argc, char *argv[]) {
   struct arguments args;
 
   cli::parse_cmd(argc, argv, &args);
 
+  int64_t idx = traceUtils::slice_seek(args.reader, &args.slice);
+
   request_t *req = new_request();
   read_one_req(args.reader, req);
 
   bool trace_has_next_access_vtime = req->next_access_vtime != -2;
 
+  traceUtils::TextPrinter printer;
   if (!args.print_obj_id_only) {
     if (trace_has_next_access_vtime) {
-      printf("# time,object,size,next_access_vtime\n");
+      printer.put_str("# time,object,size,next_access_vtime\n");
     } else {
-      printf("# time,object,size\n");
+      printer.put_str("# time,object,size\n");
     }
   }
 
-  while (req->valid) {
+  while (req->valid && !traceUtils::slice_end(req, idx, &args.slice)) {
+    idx++;
+    if (!traceUtils::slice_match(req, &args.slice)) {
+      read_one_req(args.reader, req);
+      continue;
+    }
+
     if (args.print_obj_id_32bit) {
       req->obj_id = (uint32_t)req->obj_id;
     }
 
     if (args.print_obj_id_only) {
-      printf("%lu\n", (unsigned long)req->obj_id);
+      printer.put_uint(req->obj_id);
+      printer.put_char('\n');
     } else {
-      printf("%ld%c%lu%c%d", (long)req->clock_time, args.delimiter,
-             (unsigned long)req->obj_id, args.delimiter, (int)req->obj_size);
+      printer.put_int(req->clock_time);
+      printer.put_char(args.delimiter);
+      printer.put_uint(req->obj_id);
+      printer.put_char(args.delimiter);
+      printer.put_int((int)req->obj_size);
       if (trace_has_next_access_vtime) {
-        printf("%c%ld\n", args.delimiter, (long)req->next_access_vtime);
-      } else {
-        printf("\n");
+        printer.put_char(args.delimiter);
+        printer.put_int(req->next_access_vtime);
       }
+      printer.put_char('\n');
     }
     read_one_req(args.reader, req);
   }
 
+  printer.flush();
   free_request(req);
 
   return 0;
@@ -0,0 +1,60 @@
+/**
+ * spatially sample a trace at several ratios in one pass, e.g.,
+ * --sample-ratios 0.01,0.001,0.0001, see sample.hpp
+ */
+
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "internal.hpp"
+#include "sample.hpp"
+
+int main(int argc, char *argv[]) {
+  struct arguments args;
+  cli::parse_cmd(argc, argv, &args);
+
+  std::vector<double> ratios;
+  std::string token;
+  std::stringstream ratio_ss(args.sample_ratios_str);
+  while (std::getline(ratio_ss, token, ',')) {
+    double ratio = atof(token.c_str());
+    if (ratio <= 0 || ratio > 1) {
+      ERROR("sample ratio should be in (0, 1], get %s\n", token.c_str());
+      exit(1);
+    }
+    ratios.push_back(ratio);
+  }
+  if (ratios.empty()) {
+    ERROR("no sample ratio is given\n");
+    exit(1);
+  }
+  std::sort(ratios.begin(), ratios.end(), std::greater<double>());
+  ratios.erase(std::unique(ratios.begin(), ratios.end()), ratios.end());
+
+  char *trace_filename = rindex(args.trace_path, '/');
+  std::vector<struct TraceSample::sample> samples;
+  for (double ratio : ratios) {
+    char ofilepath[OFILEPATH_LEN * 2];
+    snprintf(ofilepath, sizeof(ofilepath), "%s.sample_%g.lcs",
+             args.ofilepath[0] != '\0'
+                 ? args.ofilepath
+                 : (trace_filename == NULL ? args.trace_path
+                                           : trace_filename + 1),
+             ratio);
+    samples.push_back({ratio, TraceSample::cal_max_hv(ratio),
+                       new traceUtils::TraceWriter(ofilepath, true)});
+  }
+
+  TraceSample::sample(args.reader, samples);
+
+  for (auto &s : samples) {
+    delete s.writer;
+  }
+  cli::free_arg(&args);
+
+  return 0;
+}
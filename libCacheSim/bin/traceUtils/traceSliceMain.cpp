@@ -0,0 +1,52 @@
+/**
+ * write a slice of a trace (a request index range or a time range, filtered
+ * by op, tenant, namespace and size) in oracleGeneral or lcs format, see
+ * slice.hpp for how the start of the slice is found
+ *
+ * the next access of the requests is not kept because the slice changes the
+ * request index, use traceConv on the slice to add it
+ */
+
+#include <string.h>
+
+#include <string>
+
+#include "../../include/libCacheSim/reader.h"
+#include "internal.hpp"
+#include "slice.hpp"
+#include "traceWriter.hpp"
+
+int main(int argc, char *argv[]) {
+  struct arguments args;
+  cli::parse_cmd(argc, argv, &args);
+
+  if (args.ofilepath[0] == '\0') {
+    char *trace_filename = rindex(args.trace_path, '/');
+    snprintf(args.ofilepath, OFILEPATH_LEN, "%s.slice.%s",
+             trace_filename == NULL ? args.trace_path : trace_filename + 1,
+             args.output_lcs ? "lcs" : "oracleGeneral");
+  }
+
+  int64_t start_idx = traceUtils::slice_seek(args.reader, &args.slice);
+  int64_t idx = start_idx;
+  traceUtils::TraceWriter writer(args.ofilepath, args.output_lcs);
+
+  request_t *req = new_request();
+  read_one_req(args.reader, req);
+  while (req->valid && !traceUtils::slice_end(req, idx, &args.slice)) {
+    idx++;
+    if (traceUtils::slice_match(req, &args.slice)) {
+      writer.write(req);
+    }
+    read_one_req(args.reader, req);
+  }
+  writer.close();
+
+  INFO("write %ld requests (request %ld - %ld of the trace) to %s\n",
+       (long)writer.n_req(), (long)start_idx, (long)idx, args.ofilepath);
+
+  free_request(req);
+  cli::free_arg(&args);
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+
+#include "traceWriter.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../traceReader/generalReader/lcs.h"
+
+namespace traceUtils {
+
+TraceWriter::TraceWriter(const std::string &ofilepath, bool lcs_format,
+                         size_t buf_size)
+    : ofilepath_(ofilepath),
+      lcs_format_(lcs_format),
+      buf_(std::max(buf_size, sizeof(lcs_trace_header_t))) {
+  fd_ = open(ofilepath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    ERROR("Unable to open '%s', %s\n", ofilepath_.c_str(), strerror(errno));
+    exit(1);
+  }
+
+  /* the header is rewritten with the trace stat at close */
+  if (lcs_format_) {
+    memset(buf_.data(), 0, sizeof(lcs_trace_header_t));
+    buf_pos_ = sizeof(lcs_trace_header_t);
+  }
+}
+
+void TraceWriter::flush() {
+  const char *p = buf_.data();
+  size_t len = buf_pos_;
+  while (len > 0) {
+    ssize_t n = ::write(fd_, p, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ERROR("fail to write %s, %s\n", ofilepath_.c_str(), strerror(errno));
+      exit(1);
+    }
+    p += n;
+    len -= (size_t)n;
+  }
+  buf_pos_ = 0;
+}
+
+void TraceWriter::close() {
+  if (fd_ < 0) return;
+  flush();
+
+  if (lcs_format_) {
+    lcs_trace_header_t lcs_header;
+    memset(&lcs_header, 0, sizeof(lcs_header));
+    lcs_header.start_magic = LCS_TRACE_START_MAGIC;
+    lcs_header.end_magic = LCS_TRACE_END_MAGIC;
+    lcs_header.n_req = n_req_;
+    lcs_header.n_obj = (int64_t)obj_size_.size();
+    lcs_header.n_req_byte = n_req_byte_;
+    for (const auto &p : obj_size_) lcs_header.n_obj_byte += p.second;
+    lcs_header.time_field = 1;
+    lcs_header.obj_id_field = 2;
+    lcs_header.obj_size_field = 3;
+    lcs_header.next_access_vtime_field = 4;
+    lcs_header.item_size = sizeof(oracleGeneral_req_t);
+    lcs_header.n_fields = 4;
+    memcpy(lcs_header.format, "<IQIQ", 5);
+
+    verify_LCS_trace_header(&lcs_header);
+    if (pwrite(fd_, &lcs_header, sizeof(lcs_header), 0) !=
+        (ssize_t)sizeof(lcs_header)) {
+      ERROR("fail to write the header of %s, %s\n", ofilepath_.c_str(),
+            strerror(errno));
+      exit(1);
+    }
+  }
+
+  ::close(fd_);
+  fd_ = -1;
+}
+
+}  // namespace traceUtils
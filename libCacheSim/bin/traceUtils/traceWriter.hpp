@@ -0,0 +1,91 @@
+#pragma once
+/**
+ * a buffered writer of oracleGeneral traces, optionally with the lcs header
+ *
+ * the requests are copied to a large buffer and written with one write call
+ * per buffer, the lcs header has the stat of the output trace (the number of
+ * requests, objects and bytes), so the writer tracks the objects written
+ * when the lcs format is used, and the header is written when the writer is
+ * closed
+ */
+
+#include <inttypes.h>
+
+#include <string>
+#include <vector>
+
+#include "../../dataStructure/robin_hood.h"
+#include "../../include/libCacheSim/request.h"
+
+#define TRACE_WRITER_BUF_SIZE (8 * 1024 * 1024)
+
+namespace traceUtils {
+
+typedef struct oracleGeneral_req {
+  uint32_t clock_time;
+  uint64_t obj_id;
+  uint32_t obj_size;
+  int64_t next_access_vtime;
+} __attribute__((packed)) oracleGeneral_req_t;
+
+class TraceWriter {
+ public:
+  /**
+   * @param ofilepath
+   * @param lcs_format write the lcs header (lcs_trace_header_t) before the
+   * requests, the requests use the oracleGeneral layout in both formats
+   * @param buf_size the size of the output buffer in bytes
+   */
+  TraceWriter(const std::string &ofilepath, bool lcs_format,
+              size_t buf_size = TRACE_WRITER_BUF_SIZE);
+
+  ~TraceWriter() { close(); }
+
+  TraceWriter(const TraceWriter &) = delete;
+  TraceWriter &operator=(const TraceWriter &) = delete;
+
+  /**
+   * @param req
+   * @param next_access_vtime the next access of the request in the output
+   * trace, -2 means unknown
+   */
+  inline void write(const request_t *req, int64_t next_access_vtime = -2) {
+    if (buf_pos_ + sizeof(oracleGeneral_req_t) > buf_.size()) flush();
+
+    oracleGeneral_req_t *og_req =
+        reinterpret_cast<oracleGeneral_req_t *>(buf_.data() + buf_pos_);
+    og_req->clock_time = (uint32_t)req->clock_time;
+    og_req->obj_id = req->obj_id;
+    og_req->obj_size = (uint32_t)req->obj_size;
+    og_req->next_access_vtime = next_access_vtime;
+    buf_pos_ += sizeof(oracleGeneral_req_t);
+
+    n_req_ += 1;
+    n_req_byte_ += req->obj_size;
+    if (lcs_format_) obj_size_[req->obj_id] = (uint32_t)req->obj_size;
+  }
+
+  /* flush the buffer, write the lcs header and close the file */
+  void close();
+
+  int64_t n_req() const { return n_req_; }
+
+  const std::string &path() const { return ofilepath_; }
+
+ private:
+  void flush();
+
+  const std::string ofilepath_;
+  const bool lcs_format_;
+  int fd_ = -1;
+
+  std::vector<char> buf_;
+  size_t buf_pos_ = 0;
+
+  int64_t n_req_ = 0;
+  int64_t n_req_byte_ = 0;
+  /* the last size of the objects in the output, only used in lcs format */
+  robin_hood::unordered_flat_map<uint64_t, uint32_t> obj_size_;
+};
+
+}  // namespace traceUtils
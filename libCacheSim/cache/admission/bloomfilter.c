@@ -1,33 +1,120 @@
 //
 // Created by Juncheng on 5/29/21.
 //
+// bloom filter admission: an object is admitted on its second request,
+// one-hit wonders are not admitted
+//
+// the filter uses two generations of bloom filters, new objects are added to
+// the current generation, and an object is considered seen if it is in either
+// generation. When the current generation is full, the previous generation is
+// cleared and becomes the new current generation, so the memory usage is
+// constant and the false positive rate is bounded
+//
+// params:
+//   n-obj: the number of objects tracked per generation, default 1000000,
+//          at most about 220 million with the default fpr
+//   fpr: the false positive rate of each generation, default 0.01
+//
 
-#include <glib.h>
+#include <math.h>
 #include <stdbool.h>
 
+#include "../../dataStructure/bloom.h"
 #include "../../include/libCacheSim/admissionAlgo.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define BF_ADMISSION_DEFAULT_N_OBJ 1000000
+#define BF_ADMISSION_DEFAULT_FPR 0.01
+
 typedef struct bloomfilter_admission {
-  GHashTable *seen_times;
+  struct bloom bf[2];
+  int curr_bf_idx;
+  int64_t n_obj_per_gen;
+  double fpr;
+  // the number of objects added to the current generation
+  int64_t n_obj_in_curr_gen;
 } bf_admission_params_t;
 
+static void bloomfilter_rotate(bf_admission_params_t *bf) {
+  bf->curr_bf_idx = 1 - bf->curr_bf_idx;
+  bloom_reset(&bf->bf[bf->curr_bf_idx]);
+  bf->n_obj_in_curr_gen = 0;
+}
+
 bool bloomfilter_admit(admissioner_t *admissioner, const request_t *req) {
   bf_admission_params_t *bf = admissioner->params;
-  gpointer key = GINT_TO_POINTER(req->obj_id);
-  gpointer n_times =
-      g_hash_table_lookup(bf->seen_times, GSIZE_TO_POINTER(req->obj_id));
-  if (n_times == NULL) {
-    g_hash_table_insert(bf->seen_times, key, GINT_TO_POINTER(1));
-    return false;
-  } else {
-    g_hash_table_insert(bf->seen_times, key,
-                        GINT_TO_POINTER(GPOINTER_TO_INT(n_times) + 1));
+  struct bloom *curr_bf = &bf->bf[bf->curr_bf_idx];
+  struct bloom *prev_bf = &bf->bf[1 - bf->curr_bf_idx];
+
+  if (bloom_add(curr_bf, &req->obj_id, sizeof(obj_id_t)) == 1) {
     return true;
   }
+
+  // first time seen in this generation
+  bf->n_obj_in_curr_gen += 1;
+  bool seen = bloom_check(prev_bf, &req->obj_id, sizeof(obj_id_t)) == 1;
+
+  if (bf->n_obj_in_curr_gen >= bf->n_obj_per_gen) {
+    bloomfilter_rotate(bf);
+  }
+
+  return seen;
+}
+
+static void bloomfilter_admissioner_parse_params(const char *init_params,
+                                                 bf_admission_params_t *bf) {
+  bf->n_obj_per_gen = BF_ADMISSION_DEFAULT_N_OBJ;
+  bf->fpr = BF_ADMISSION_DEFAULT_FPR;
+
+  if (init_params != NULL) {
+    char *params_str = strdup(init_params);
+    char *old_params_str = params_str;
+    char *end;
+
+    while (params_str != NULL && params_str[0] != '\0') {
+      /* different parameters are separated by comma,
+       * key and value are separated by = */
+      char *key = strsep((char **)&params_str, "=");
+      char *value = strsep((char **)&params_str, ",");
+
+      // skip the white space
+      while (params_str != NULL && *params_str == ' ') {
+        params_str++;
+      }
+
+      if (strcasecmp(key, "n-obj") == 0) {
+        bf->n_obj_per_gen = strtoll(value, &end, 0);
+        if (strlen(end) > 2) {
+          ERROR("param parsing error, find string \"%s\" after number\n", end);
+        }
+      } else if (strcasecmp(key, "fpr") == 0) {
+        bf->fpr = strtod(value, &end);
+        if (strlen(end) > 2) {
+          ERROR("param parsing error, find string \"%s\" after number\n", end);
+        }
+      } else {
+        ERROR("bloomfilter admission does not have parameter %s\n", key);
+      }
+    }
+    free(old_params_str);
+  }
+
+  if (bf->fpr <= 0 || bf->fpr >= 1) {
+    ERROR("bloomfilter admission fpr should be in (0, 1), get %lf\n", bf->fpr);
+  }
+  /* the bloom filter counts its bits in an int, the bits per object grows as
+   * the fpr shrinks, so the max n-obj depends on the fpr */
+  double bits_per_obj = -log(bf->fpr) / 0.480453013918201;  // ln(2)^2
+  int64_t max_n_obj = (int64_t)(INT32_MAX / bits_per_obj);
+  if (bf->n_obj_per_gen < 1000 || bf->n_obj_per_gen > max_n_obj) {
+    ERROR(
+        "bloomfilter admission n-obj should be in [1000, %ld] with fpr %lf, "
+        "get %ld\n",
+        (long)max_n_obj, bf->fpr, (long)bf->n_obj_per_gen);
+  }
 }
 
 admissioner_t *clone_bloomfilter_admissioner(admissioner_t *admissioner) {
@@ -35,8 +122,9 @@ admissioner_t *clone_bloomfilter_admissioner(admissioner_t *admissioner) {
 }
 
 void free_bloomfilter_admissioner(admissioner_t *admissioner) {
-  struct bloomfilter_admission *bf = admissioner->params;
-  g_hash_table_destroy(bf->seen_times);
+  bf_admission_params_t *bf = admissioner->params;
+  bloom_free(&bf->bf[0]);
+  bloom_free(&bf->bf[1]);
   free(bf);
   if (admissioner->init_params) {
     free(admissioner->init_params);
@@ -45,22 +133,27 @@ void free_bloomfilter_admissioner(admissioner_t *admissioner) {
 }
 
 admissioner_t *create_bloomfilter_admissioner(const char *init_params) {
-  if (init_params != NULL) {
-    ERROR("bloomfilter admission does not take any parameters");
-  }
-
-  admissioner_t *admissioner = (admissioner_t *)malloc(sizeof(admissioner_t));
-  admissioner->init_params = NULL;
-
   bf_admission_params_t *bf_params =
       (bf_admission_params_t *)malloc(sizeof(bf_admission_params_t));
-  memset(bf_params, 0, sizeof(struct bloomfilter_admission));
-  bf_params->seen_times = g_hash_table_new(g_direct_hash, g_direct_equal);
+  memset(bf_params, 0, sizeof(bf_admission_params_t));
+  bloomfilter_admissioner_parse_params(init_params, bf_params);
 
+  for (int i = 0; i < 2; i++) {
+    if (bloom_init(&bf_params->bf[i], (int)bf_params->n_obj_per_gen,
+                   bf_params->fpr) != 0) {
+      ERROR("bloomfilter admission fails to allocate bloom filter\n");
+    }
+  }
+  bf_params->curr_bf_idx = 0;
+  bf_params->n_obj_in_curr_gen = 0;
+
+  admissioner_t *admissioner = (admissioner_t *)malloc(sizeof(admissioner_t));
+  memset(admissioner, 0, sizeof(admissioner_t));
   admissioner->params = bf_params;
   admissioner->clone = clone_bloomfilter_admissioner;
   admissioner->free = free_bloomfilter_admissioner;
   admissioner->admit = bloomfilter_admit;
+  if (init_params != NULL) admissioner->init_params = strdup(init_params);
 
   return admissioner;
 }
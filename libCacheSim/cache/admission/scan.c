@@ -0,0 +1,139 @@
+//
+// scan admission
+//
+// a sequential run (scan) of a backup or a table scan accesses each block
+// once, caching the blocks of a long scan flushes the cache without adding
+// hits. This admissioner tracks the sequential runs with the online scan
+// detector (dataStructure/scanDetector.h), the first min-run - 1 blocks of a
+// run are admitted, the min-run-th block and the blocks after it are not.
+// Hits are recorded through the update callback so that a hit does not break
+// the run.
+//
+// params:
+//   n-streams: the number of runs tracked at the same time, default 32
+//   min-run: the length of a run when it becomes a scan, default 32
+//   max-gap: the largest distance (in obj_id) between two consecutive blocks
+//   of a run, default 1 (strictly sequential)
+//
+
+#include <stdbool.h>
+
+#include "../../dataStructure/scanDetector.h"
+#include "../../include/libCacheSim/admissionAlgo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct scan_admissioner {
+  struct scan_detector detector;
+
+  int n_streams;
+  int min_run;
+  int max_gap;
+} scan_admission_params_t;
+
+bool scan_admit(admissioner_t *admissioner, const request_t *req) {
+  scan_admission_params_t *pa = admissioner->params;
+  int64_t run_len = scan_detector_add(&pa->detector, req->obj_id);
+
+  return !scan_detector_is_scan(&pa->detector, run_len);
+}
+
+void scan_update(admissioner_t *admissioner, const request_t *req) {
+  scan_admission_params_t *pa = admissioner->params;
+  scan_detector_add(&pa->detector, req->obj_id);
+}
+
+static void scan_admissioner_parse_params(const char *init_params,
+                                          scan_admission_params_t *pa) {
+  pa->n_streams = 32;
+  pa->min_run = 32;
+  pa->max_gap = 1;
+
+  if (init_params != NULL) {
+    char *params_str = strdup(init_params);
+    char *old_params_str = params_str;
+    char *end;
+
+    while (params_str != NULL && params_str[0] != '\0') {
+      /* different parameters are separated by comma,
+       * key and value are separated by = */
+      char *key = strsep((char **)&params_str, "=");
+      char *value = strsep((char **)&params_str, ",");
+
+      // skip the white space
+      while (params_str != NULL && *params_str == ' ') {
+        params_str++;
+      }
+
+      if (strcasecmp(key, "n-streams") == 0) {
+        pa->n_streams = (int)strtol(value, &end, 0);
+      } else if (strcasecmp(key, "min-run") == 0) {
+        pa->min_run = (int)strtol(value, &end, 0);
+      } else if (strcasecmp(key, "max-gap") == 0) {
+        pa->max_gap = (int)strtol(value, &end, 0);
+      } else {
+        ERROR("scan admission does not have parameter %s\n", key);
+      }
+
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    }
+    free(old_params_str);
+  }
+
+  if (pa->n_streams <= 0) {
+    ERROR("scan admission n-streams should be positive, get %d\n",
+          pa->n_streams);
+  }
+  if (pa->min_run <= 1) {
+    ERROR("scan admission min-run should be larger than 1, get %d\n",
+          pa->min_run);
+  }
+  if (pa->max_gap <= 0) {
+    ERROR("scan admission max-gap should be positive, get %d\n", pa->max_gap);
+  }
+}
+
+admissioner_t *clone_scan_admissioner(admissioner_t *admissioner) {
+  return create_scan_admissioner(admissioner->init_params);
+}
+
+void free_scan_admissioner(admissioner_t *admissioner) {
+  scan_admission_params_t *pa = admissioner->params;
+  scan_detector_free(&pa->detector);
+  free(pa);
+  if (admissioner->init_params) {
+    free(admissioner->init_params);
+  }
+  free(admissioner);
+}
+
+admissioner_t *create_scan_admissioner(const char *init_params) {
+  scan_admission_params_t *pa =
+      (scan_admission_params_t *)malloc(sizeof(scan_admission_params_t));
+  memset(pa, 0, sizeof(scan_admission_params_t));
+  scan_admissioner_parse_params(init_params, pa);
+
+  if (scan_detector_init(&pa->detector, pa->n_streams, pa->min_run,
+                         pa->max_gap) != 0) {
+    ERROR("scan admission fails to allocate scan detector\n");
+  }
+
+  admissioner_t *admissioner = (admissioner_t *)malloc(sizeof(admissioner_t));
+  memset(admissioner, 0, sizeof(admissioner_t));
+  admissioner->params = pa;
+  admissioner->admit = scan_admit;
+  admissioner->update = scan_update;
+  admissioner->free = free_scan_admissioner;
+  admissioner->clone = clone_scan_admissioner;
+  if (init_params != NULL) admissioner->init_params = strdup(init_params);
+
+  return admissioner;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,187 @@
+//
+// TinyLFU admission
+//
+// TinyLFU: A Highly Efficient Cache Admission Policy, Einziger et al., 2017
+//
+// the access frequency is estimated with a doorkeeper bloom filter and a
+// 4-bit count-min sketch, the first access of an object only sets the
+// doorkeeper, later accesses increment the sketch. After sample-ratio * n-obj
+// accesses, all counters are halved and the doorkeeper is cleared so that the
+// frequency reflects recent popularity.
+//
+// the admissioner does not see the eviction candidate, so instead of
+// comparing against the victim, an object is admitted when its estimated
+// frequency reaches min-freq. Hits are recorded through the update callback
+// when the eviction algorithm uses cache_get_base, otherwise only misses are
+// recorded.
+//
+// params:
+//   n-obj: the number of objects tracked, default 1000000
+//   sample-ratio: the number of accesses between two resets, in units of
+//   n-obj, default 10
+//   min-freq: the minimal estimated frequency to admit an object, default 2
+//   fpr: the false positive rate of the doorkeeper, default 0.01
+//
+
+#include <stdbool.h>
+
+#include "../../dataStructure/blockedCountMinSketch.h"
+#include "../../dataStructure/bloom.h"
+#include "../../dataStructure/hash/hash.h"
+#include "../../include/libCacheSim/admissionAlgo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tinylfu_admissioner {
+  struct blocked_cms sketch;
+  struct bloom doorkeeper;
+
+  int64_t n_obj;
+  int64_t sample_ratio;
+  int min_freq;
+  double fpr;
+
+  int64_t sample_size;
+  int64_t n_sample;
+} tinylfu_admission_params_t;
+
+static void tinylfu_record(tinylfu_admission_params_t *pa,
+                           const request_t *req, const uint64_t hash) {
+  if (bloom_add(&pa->doorkeeper, &req->obj_id, sizeof(obj_id_t)) == 1) {
+    blocked_cms_increment(&pa->sketch, hash);
+  }
+
+  if (++pa->n_sample >= pa->sample_size) {
+    blocked_cms_halve(&pa->sketch);
+    bloom_reset(&pa->doorkeeper);
+    pa->n_sample /= 2;
+  }
+}
+
+static int tinylfu_estimate(tinylfu_admission_params_t *pa,
+                            const request_t *req, const uint64_t hash) {
+  int freq = blocked_cms_estimate(&pa->sketch, hash);
+  if (bloom_check(&pa->doorkeeper, &req->obj_id, sizeof(obj_id_t)) == 1) {
+    freq += 1;
+  }
+  return freq;
+}
+
+bool tinylfu_admit(admissioner_t *admissioner, const request_t *req) {
+  tinylfu_admission_params_t *pa = admissioner->params;
+  uint64_t hash = get_hash_value_int_64(&req->obj_id);
+  tinylfu_record(pa, req, hash);
+
+  return tinylfu_estimate(pa, req, hash) >= pa->min_freq;
+}
+
+void tinylfu_update(admissioner_t *admissioner, const request_t *req) {
+  tinylfu_admission_params_t *pa = admissioner->params;
+  tinylfu_record(pa, req, get_hash_value_int_64(&req->obj_id));
+}
+
+static void tinylfu_admissioner_parse_params(const char *init_params,
+                                             tinylfu_admission_params_t *pa) {
+  pa->n_obj = 1000000;
+  pa->sample_ratio = 10;
+  pa->min_freq = 2;
+  pa->fpr = 0.01;
+
+  if (init_params != NULL) {
+    char *params_str = strdup(init_params);
+    char *old_params_str = params_str;
+    char *end;
+
+    while (params_str != NULL && params_str[0] != '\0') {
+      /* different parameters are separated by comma,
+       * key and value are separated by = */
+      char *key = strsep((char **)&params_str, "=");
+      char *value = strsep((char **)&params_str, ",");
+
+      // skip the white space
+      while (params_str != NULL && *params_str == ' ') {
+        params_str++;
+      }
+
+      if (strcasecmp(key, "n-obj") == 0) {
+        pa->n_obj = strtoll(value, &end, 0);
+      } else if (strcasecmp(key, "sample-ratio") == 0) {
+        pa->sample_ratio = strtoll(value, &end, 0);
+      } else if (strcasecmp(key, "min-freq") == 0) {
+        pa->min_freq = (int)strtol(value, &end, 0);
+      } else if (strcasecmp(key, "fpr") == 0) {
+        pa->fpr = strtod(value, &end);
+      } else {
+        ERROR("tinyLFU admission does not have parameter %s\n", key);
+      }
+
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    }
+    free(old_params_str);
+  }
+
+  if (pa->n_obj < 1000 || pa->n_obj > INT32_MAX) {
+    ERROR("tinyLFU admission n-obj should be in [1000, %d], get %ld\n",
+          INT32_MAX, (long)pa->n_obj);
+  }
+  if (pa->sample_ratio <= 0) {
+    ERROR("tinyLFU admission sample-ratio should be positive, get %ld\n",
+          (long)pa->sample_ratio);
+  }
+  if (pa->min_freq <= 0 || pa->min_freq > BLOCKED_CMS_MAX_COUNT + 1) {
+    ERROR("tinyLFU admission min-freq should be in [1, %d], get %d\n",
+          BLOCKED_CMS_MAX_COUNT + 1, pa->min_freq);
+  }
+  if (pa->fpr <= 0 || pa->fpr >= 1) {
+    ERROR("tinyLFU admission fpr should be in (0, 1), get %lf\n", pa->fpr);
+  }
+  pa->sample_size = pa->n_obj * pa->sample_ratio;
+}
+
+admissioner_t *clone_tinylfu_admissioner(admissioner_t *admissioner) {
+  return create_tinylfu_admissioner(admissioner->init_params);
+}
+
+void free_tinylfu_admissioner(admissioner_t *admissioner) {
+  tinylfu_admission_params_t *pa = admissioner->params;
+  blocked_cms_free(&pa->sketch);
+  bloom_free(&pa->doorkeeper);
+  free(pa);
+  if (admissioner->init_params) {
+    free(admissioner->init_params);
+  }
+  free(admissioner);
+}
+
+admissioner_t *create_tinylfu_admissioner(const char *init_params) {
+  tinylfu_admission_params_t *pa =
+      (tinylfu_admission_params_t *)malloc(sizeof(tinylfu_admission_params_t));
+  memset(pa, 0, sizeof(tinylfu_admission_params_t));
+  tinylfu_admissioner_parse_params(init_params, pa);
+
+  if (blocked_cms_init(&pa->sketch, pa->n_obj) != 0) {
+    ERROR("tinyLFU admission fails to allocate count-min sketch\n");
+  }
+  if (bloom_init(&pa->doorkeeper, (int)pa->n_obj, pa->fpr) != 0) {
+    ERROR("tinyLFU admission fails to allocate doorkeeper\n");
+  }
+
+  admissioner_t *admissioner = (admissioner_t *)malloc(sizeof(admissioner_t));
+  memset(admissioner, 0, sizeof(admissioner_t));
+  admissioner->params = pa;
+  admissioner->admit = tinylfu_admit;
+  admissioner->update = tinylfu_update;
+  admissioner->free = free_tinylfu_admissioner;
+  admissioner->clone = clone_tinylfu_admissioner;
+  if (init_params != NULL) admissioner->init_params = strdup(init_params);
+
+  return admissioner;
+}
+
+#ifdef __cplusplus
+}
+#endif
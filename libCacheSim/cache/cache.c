@@ -57,6 +57,7 @@ cache_t *cache_struct_init(const char *const cache_name,
   int hash_power = HASH_POWER_DEFAULT;
   if (params.hashpower > 0 && params.hashpower < 40)
     hash_power = params.hashpower;
+  cache->hashpower = hash_power;
   cache->hashtable = create_hashtable(hash_power);
   hashtable_add_ptr_to_monitoring(cache->hashtable, &cache->q_head);
   hashtable_add_ptr_to_monitoring(cache->hashtable, &cache->q_tail);
@@ -70,7 +71,7 @@ cache_t *cache_struct_init(const char *const cache_name,
  * @param cache
  */
 void cache_struct_free(cache_t *cache) {
-  free_hashtable(cache->hashtable);
+  if (cache->hashtable != NULL) free_hashtable(cache->hashtable);
   if (cache->admissioner != NULL) cache->admissioner->free(cache->admissioner);
   if (cache->prefetcher != NULL) cache->prefetcher->free(cache->prefetcher);
   my_free(sizeof(cache_t), cache);
@@ -86,7 +87,7 @@ void cache_struct_free(cache_t *cache) {
 cache_t *clone_cache(const cache_t *old_cache) {
   common_cache_params_t cc_params = {
       .cache_size = old_cache->cache_size,
-      .hashpower = old_cache->hashtable->hashpower,
+      .hashpower = old_cache->hashpower,
       .default_ttl = old_cache->default_ttl,
       .consider_obj_metadata = old_cache->obj_md_size == 0 ? false : true,
   };
@@ -112,7 +113,7 @@ cache_t *create_cache_with_new_size(const cache_t *old_cache,
                                     uint64_t new_size) {
   common_cache_params_t cc_params = {
       .cache_size = new_size,
-      .hashpower = old_cache->hashtable->hashpower,
+      .hashpower = old_cache->hashpower,
       .default_ttl = old_cache->default_ttl,
       .consider_obj_metadata = old_cache->obj_md_size == 0 ? false : true,
   };
@@ -234,6 +235,9 @@ bool cache_get_base(cache_t *cache, const request_t *req) {
 
   if (hit) {
     VVERBOSE("req %ld, obj %ld --- cache hit\n", cache->n_req, req->obj_id);
+    if (cache->admissioner != NULL && cache->admissioner->update != NULL) {
+      cache->admissioner->update(cache->admissioner, req);
+    }
   } else if (!cache->can_insert(cache, req)) {
     VVERBOSE("req %ld, obj %ld --- cache miss cannot insert\n", cache->n_req,
              req->obj_id);
@@ -44,6 +44,8 @@ static void set_default_params(GLCache_params_t *params) {
   params->retrain_intvl = 86400;
   params->train_source_y = TRAIN_Y_FROM_ONLINE;
   params->type = LOGCACHE_LEARNED;
+  params->learner.async_train = false;
+  params->learner.max_staleness = 3600;
 
   params->curr_evict_bucket_idx = 0;
   params->start_rtime = -1;
@@ -53,7 +55,7 @@ const char *GLCache_default_params(void) {
   return "segment-size=100, n-merge=2, "
          "type=learned, rank-intvl=0.02,"
          "merge-consecutive-segs=true, train-source-y=online,"
-         "retrain-intvl=86400";
+         "retrain-intvl=86400, async-train=false, max-staleness=3600";
 }
 
 static void GLCache_parse_init_params(const char *cache_specific_params,
@@ -76,6 +78,11 @@ static void GLCache_parse_init_params(const char *cache_specific_params,
       params->merge_consecutive_segs = atoi(value);
     } else if (strcasecmp(key, "retrain-intvl") == 0) {
       params->retrain_intvl = atoi(value);
+    } else if (strcasecmp(key, "async-train") == 0) {
+      params->learner.async_train =
+          strcasecmp(value, "true") == 0 || strcasecmp(value, "1") == 0;
+    } else if (strcasecmp(key, "max-staleness") == 0) {
+      params->learner.max_staleness = atol(value);
     } else if (strcasecmp(key, "train-source-y") == 0) {
       if (strcasecmp(value, "online") == 0) {
         params->train_source_y = TRAIN_Y_FROM_ONLINE;
@@ -192,10 +199,11 @@ cache_t *GLCache_init(const common_cache_params_t ccache_params,
   INFO(
       "%s, %.0lfMB, segment_size %d, training_interval %d, source %d, "
       "rank interval %.2lf, merge consecutive segments %d, "
-      "merge %d segments\n",
+      "merge %d segments, async training %d, max staleness %ld\n",
       GLCache_type_names[params->type], (double)cache->cache_size / 1048576.0,
       params->segment_size, params->retrain_intvl, params->train_source_y,
-      params->rank_intvl, params->merge_consecutive_segs, params->n_merge);
+      params->rank_intvl, params->merge_consecutive_segs, params->n_merge,
+      params->learner.async_train, (long)params->learner.max_staleness);
   return cache;
 }
 
@@ -206,7 +214,13 @@ cache_t *GLCache_init(const common_cache_params_t ccache_params,
  */
 static void GLCache_free(cache_t *cache) {
   GLCache_params_t *params = cache->eviction_params;
+  learner_t *l = &params->learner;
   bucket_t *bkt = &params->train_bucket;
+
+  stop_train_thread(cache);
+  if (l->booster != NULL) {
+    safe_call(XGBoosterFree(l->booster));
+  }
   segment_t *seg = bkt->first_seg, *next_seg;
 
   while (seg != NULL) {
@@ -245,8 +259,17 @@ static void GLCache_free(cache_t *cache) {
           params->learner.valid_x);
   my_free(sizeof(feature_t) * params->learner.valid_matrix_n_row,
           params->learner.valid_y);
-  my_free(sizeof(pred_t) * params->learner.inf_matrix_n_row,
-          params->learner.inference_x);
+  my_free(sizeof(feature_t) * l->inf_matrix_n_row * l->n_feature,
+          l->inference_x);
+  my_free(sizeof(segment_t *) * l->inf_matrix_n_row, l->inf_row_segs);
+  if (l->async_train) {
+    my_free(sizeof(feature_t) * l->train_matrix_n_row * l->n_feature,
+            l->async_job.train_x);
+    my_free(sizeof(train_y_t) * l->train_matrix_n_row, l->async_job.train_y);
+    my_free(sizeof(feature_t) * l->valid_matrix_n_row * l->n_feature,
+            l->async_job.valid_x);
+    my_free(sizeof(train_y_t) * l->valid_matrix_n_row, l->async_job.valid_y);
+  }
 
   my_free(sizeof(GLCache_params_t), params);
   cache_struct_free(cache);
@@ -274,6 +297,9 @@ static void GLCache_free(cache_t *cache) {
 static bool GLCache_get(cache_t *cache, const request_t *req) {
   GLCache_params_t *params = cache->eviction_params;
 
+  /* install the model from the training thread if it is ready */
+  poll_trained_model(cache);
+
   bool ret = cache_get_base(cache, req);
 
   if (params->type == LOGCACHE_LEARNED ||
@@ -392,6 +418,7 @@ static cache_obj_t *GLCache_insert(cache_t *cache, const request_t *req) {
       seg->req_rate = params->cache_state.req_rate;
       seg->write_rate = params->cache_state.write_rate;
       seg->miss_ratio = params->cache_state.miss_ratio;
+      seg->feature_dirty = true;
     }
 
     seg = allocate_new_seg(cache, bucket->bucket_id);
@@ -406,6 +433,7 @@ static cache_obj_t *GLCache_insert(cache_t *cache, const request_t *req) {
 
   seg->n_byte += cache_obj->obj_size + cache->obj_md_size;
   seg->n_obj += 1;
+  seg->feature_dirty = true;
   cache->occupied_byte += cache_obj->obj_size + cache->obj_md_size;
   cache->n_obj += 1;
 
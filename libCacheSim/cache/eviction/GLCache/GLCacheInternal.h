@@ -1,5 +1,6 @@
 #pragma once
 
+#include <pthread.h>
 #include <xgboost/c_api.h>
 
 #include "../../../include/libCacheSim/cache.h"
@@ -44,13 +45,28 @@ typedef struct {
   int64_t last_hour_window_ts;
 } seg_feature_t;
 
+/* a compacted copy of the training data, a model is trained from a job
+ * either on the request path or on the training thread */
+typedef struct train_job {
+  feature_t *train_x;
+  train_y_t *train_y;
+  feature_t *valid_x;
+  train_y_t *valid_y;
+  unsigned int n_train_samples;
+  unsigned int n_valid_samples;
+
+  /* trace time when the training data is taken */
+  int64_t rtime;
+
+  /* output */
+  BoosterHandle booster;
+  int n_trees;
+} train_job_t;
+
 typedef struct learner {
   int64_t last_train_rtime;
 
-  BoosterHandle booster;   // model
-  DMatrixHandle train_dm;  // training data
-  DMatrixHandle valid_dm;  // validation data
-  DMatrixHandle inf_dm;    // inference data
+  BoosterHandle booster;  // model used for inference
 
   /* learner stat */
   int n_train;
@@ -63,7 +79,6 @@ typedef struct learner {
   feature_t *valid_x;
   train_y_t *valid_y;
   feature_t *inference_x;
-  pred_t *pred;
 
   int n_feature;
   unsigned int n_train_samples;
@@ -73,6 +88,31 @@ typedef struct learner {
   int32_t valid_matrix_n_row;
   int32_t inf_matrix_n_row;
 
+  /* the inference matrix has one row per in-use segment, row i belongs to
+   * inf_row_segs[i], the rows of segments with unchanged features are only
+   * refreshed in the time-dependent features before each inference */
+  struct segment **inf_row_segs;
+  int32_t n_inf_rows;
+
+  /* asynchronous training: the request path copies the training data into
+   * async_job and the training thread builds the model, the new model is
+   * installed on the request path at the next inference, or the request path
+   * blocks if the model in training is older than max_staleness */
+  bool async_train;
+  int64_t max_staleness; /* in seconds of trace time */
+  bool train_thread_started;
+  pthread_t train_thread;
+  pthread_mutex_t train_mtx;
+  pthread_cond_t train_cond;
+  train_job_t async_job;
+  bool job_in_flight; /* only accessed on the request path */
+  /* protected by train_mtx */
+  bool job_submitted;
+  bool train_stop;
+  /* set by the training thread when the model is ready, read without lock */
+  int job_done;
+  int n_train_blocked; /* the number of times the request path waited */
+
 } learner_t;
 
 typedef struct cache_state {
@@ -127,6 +167,11 @@ typedef struct segment {
   int64_t become_train_seg_rtime;
   unsigned int training_data_row_idx;
 
+  /* row in the inference matrix, -1 if the segment is not in the matrix */
+  int32_t inf_row;
+  /* whether the features have changed since the row was written */
+  bool feature_dirty;
+
   seg_feature_t feature;
 
   int32_t magic;
@@ -279,8 +324,16 @@ void seg_hit_update(GLCache_params_t *params, cache_obj_t *cache_obj);
 /************* learning *****************/
 void train(cache_t *cache);
 
+void poll_trained_model(cache_t *cache);
+
+void stop_train_thread(cache_t *cache);
+
 void inference(cache_t *cache);
 
+void inf_matrix_add_seg(GLCache_params_t *params, segment_t *seg);
+
+void inf_matrix_remove_seg(GLCache_params_t *params, segment_t *seg);
+
 /************* data preparation *****************/
 void snapshot_segs_to_training_data(cache_t *cache);
 
@@ -291,6 +344,9 @@ void prepare_training_data(cache_t *cache);
 bool prepare_one_row(cache_t *cache, segment_t *curr_seg, bool training_data,
                      feature_t *x, train_y_t *y);
 
+void update_row_time_features(cache_t *cache, segment_t *curr_seg,
+                              feature_t *x);
+
 /********************** helper ********************/
 #define safe_call(call)                                                      \
   {                                                                          \
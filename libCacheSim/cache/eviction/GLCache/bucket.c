@@ -24,6 +24,7 @@ void append_seg_to_bucket(GLCache_params_t *params, bucket_t *bucket,
     params->n_training_segs += 1;
   } else {
     params->n_in_use_segs += 1;
+    inf_matrix_add_seg(params, segment);
   }
 }
 
@@ -46,6 +47,7 @@ void remove_seg_from_bucket(GLCache_params_t *params, bucket_t *bucket,
 
   params->n_in_use_segs -= 1;
   bucket->n_in_use_segs -= 1;
+  inf_matrix_remove_seg(params, segment);
 
   if (bucket->n_in_use_segs == 0) {
     params->n_used_buckets -= 1;
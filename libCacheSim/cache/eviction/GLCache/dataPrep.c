@@ -68,6 +68,21 @@ static void clean_training_segs(cache_t *cache) {
   params->train_bucket.last_seg = NULL;
 }
 
+/**
+ * @brief update the features that change with time even if the segment is not
+ * accessed, this is the only part of a row that needs to be refreshed in the
+ * inference matrix when the segment has not changed
+ */
+void update_row_time_features(cache_t *cache, segment_t *curr_seg,
+                              feature_t *x) {
+  GLCache_params_t *params = cache->eviction_params;
+
+  x[0] = (feature_t)params->curr_rtime - curr_seg->create_rtime;
+#ifdef SCALE_AGE
+  x[0] = (feature_t)x[3] / ((feature_t)params->curr_rtime);
+#endif
+}
+
 /**
  * @brief update the segment feature when a segment is evicted
  *
@@ -98,7 +113,6 @@ bool prepare_one_row(cache_t *cache, segment_t *curr_seg, bool is_training_data,
   GLCache_params_t *params = cache->eviction_params;
   learner_t *learner = &params->learner;
 
-  x[0] = (feature_t)params->curr_rtime - curr_seg->create_rtime;
   x[1] = (feature_t)curr_seg->n_byte / curr_seg->n_obj;
   x[2] = (feature_t)curr_seg->n_hit;
   x[3] = (feature_t)curr_seg->n_active;
@@ -108,9 +122,7 @@ bool prepare_one_row(cache_t *cache, segment_t *curr_seg, bool is_training_data,
   // x[6] = (feature_t) ((curr_seg->create_rtime / 3600) % 24);
   // x[7] = (feature_t) ((curr_seg->create_rtime / 60) % 60);
 
-#ifdef SCALE_AGE
-  x[0] = (feature_t)x[3] / ((feature_t)params->curr_rtime);
-#endif
+  update_row_time_features(cache, curr_seg, x);
 
   for (int k = 0; k < N_FEATURE_TIME_WINDOW; k++) {
     x[N_FEATURE_NORMAL + k * 3 + 0] =
@@ -265,41 +277,6 @@ static int cmp_train_y(const void *p1, const void *p2) {
     return -1;
 }
 
-static void prepare_training_data_per_package(cache_t *cache) {
-  GLCache_params_t *params = cache->eviction_params;
-  learner_t *learner = &params->learner;
-
-  safe_call(XGDMatrixCreateFromMat(learner->train_x, learner->n_train_samples,
-                                   learner->n_feature, -2, &learner->train_dm));
-
-  safe_call(XGDMatrixCreateFromMat(learner->valid_x, learner->n_valid_samples,
-                                   learner->n_feature, -2, &learner->valid_dm));
-
-  safe_call(XGDMatrixSetFloatInfo(learner->train_dm, "label", learner->train_y,
-                                  learner->n_train_samples));
-
-  safe_call(XGDMatrixSetFloatInfo(learner->valid_dm, "label", learner->valid_y,
-                                  learner->n_valid_samples));
-
-#if OBJECTIVE == LTR
-  // set group used for MAP and NDCG
-  // const int n_group = 20;
-  // unsigned int group[n_group];
-  // for (int i = 0; i < n_group; i++) {
-  //   group[i] = learner->n_train_samples/n_group;
-  // }
-  // group[(n_group - 1)] = learner->n_train_samples -
-  // (learner->n_train_samples/n_group) * (n_group - 1);
-  // safe_call(XGDMatrixSetUIntInfo(learner->train_dm, "group", group,
-  // n_group));
-
-  safe_call(XGDMatrixSetUIntInfo(learner->train_dm, "group",
-                                 &learner->n_train_samples, 1));
-  safe_call(XGDMatrixSetUIntInfo(learner->valid_dm, "group",
-                                 &learner->n_valid_samples, 1));
-#endif
-}
-
 void prepare_training_data(cache_t *cache) {
   GLCache_params_t *params = cache->eviction_params;
   learner_t *learner = &params->learner;
@@ -456,7 +433,6 @@ void prepare_training_data(cache_t *cache) {
   learner->n_train_samples = pos_in_train_data;
   learner->n_valid_samples = pos_in_valid_data;
 
-  prepare_training_data_per_package(cache);
 #ifdef TRAIN_KEEP_HALF
   learner->n_train_samples = original_n_train_samples;
 #endif
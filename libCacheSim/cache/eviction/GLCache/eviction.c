@@ -115,12 +115,14 @@ void GLCache_merge_segs(cache_t *cache, bucket_t *bucket, segment_t **segs) {
 
         new_seg->n_obj += 1;
         new_seg->n_byte += cache_obj->obj_size;
+        new_seg->feature_dirty = true;
       } else {
         cache->n_obj -= 1;
         cache->occupied_byte -= (cache_obj->obj_size + cache->obj_md_size);
       }
       obj_evict_update(cache, cache_obj);
       cache_obj->GLCache.in_cache = 0;
+      segs[i]->feature_dirty = true;
 
       if (cache_obj->GLCache.seen_after_snapshot == 1) {
         /* do not need to keep a ghost in the hashtable */
@@ -154,6 +156,7 @@ int evict_one_seg(cache_t *cache, segment_t *seg) {
     // if (hashtable_try_delete(cache->hashtable, cache_obj)) {
     if (cache_obj->GLCache.in_cache == 1) {
       cache_obj->GLCache.in_cache = 0;
+      seg->feature_dirty = true;
 
       n_cleaned += 1;
       cache->n_obj -= 1;
@@ -5,71 +5,85 @@
 #include "obj.h"
 #include "utils.h"
 
-static inline void resize_matrix(GLCache_params_t *params, feature_t **x_p,
-                                 pred_t **y_p, int32_t *size_p,
-                                 int64_t new_size) {
-  learner_t *learner = &params->learner;
-  if ((*size_p) != 0) {
-    // free previously allocated memory
-    // TODO: use realloc instead of free
-    DEBUG_ASSERT(*x_p != NULL);
-    my_free(sizeof(feature_t) * (*size_p) * learner->n_feature, *x_p);
-    my_free(sizeof(pred_t) * (*size_p), *y_p);
+/* grow the inference matrix and the row to segment mapping, because each
+ * segment is not fixed size, the number of segments can vary over time */
+static void resize_inf_matrix(learner_t *learner, int32_t new_n_row) {
+  feature_t *new_x = my_malloc_n(feature_t, new_n_row * learner->n_feature);
+  segment_t **new_row_segs = my_malloc_n(segment_t *, new_n_row);
+
+  if (learner->inf_matrix_n_row != 0) {
+    memcpy(new_x, learner->inference_x,
+           sizeof(feature_t) * learner->n_inf_rows * learner->n_feature);
+    memcpy(new_row_segs, learner->inf_row_segs,
+           sizeof(segment_t *) * learner->n_inf_rows);
+    my_free(sizeof(feature_t) * learner->inf_matrix_n_row * learner->n_feature,
+            learner->inference_x);
+    my_free(sizeof(segment_t *) * learner->inf_matrix_n_row,
+            learner->inf_row_segs);
   }
 
-  *x_p = my_malloc_n(feature_t, new_size * learner->n_feature);
-  memset(*x_p, 0, sizeof(feature_t) * new_size * learner->n_feature);
-  *y_p = my_malloc_n(pred_t, new_size);
-  memset(*y_p, 0, sizeof(pred_t) * new_size);
-  *size_p = new_size;
+  learner->inference_x = new_x;
+  learner->inf_row_segs = new_row_segs;
+  learner->inf_matrix_n_row = new_n_row;
 }
 
-/* calculate the ranking of all segments for eviction */
-/* TODO: can sample some segments to improve throughput */
-static int prepare_inference_data(cache_t *cache) {
-  GLCache_params_t *params = cache->eviction_params;
+/* give a newly cached segment a row in the inference matrix */
+void inf_matrix_add_seg(GLCache_params_t *params, segment_t *seg) {
   learner_t *learner = &params->learner;
 
-  /** because each segment is not fixed size,
-   * the number of segments in total can vary over time,
-   * if the inference data matrix is not big enough,
-   * we resize the matrix */
-  if (learner->inf_matrix_n_row < params->n_in_use_segs) {
-    resize_matrix(params, &learner->inference_x, &learner->pred,
-                  &learner->inf_matrix_n_row, params->n_in_use_segs * 2);
+  DEBUG_ASSERT(seg->inf_row == -1);
+  if (learner->n_inf_rows == learner->inf_matrix_n_row) {
+    resize_inf_matrix(learner, MAX(learner->inf_matrix_n_row * 2, 1024));
   }
 
-  feature_t *x = learner->inference_x;
+  seg->inf_row = learner->n_inf_rows++;
+  seg->feature_dirty = true;
+  learner->inf_row_segs[seg->inf_row] = seg;
+}
 
-  int n_segs = 0;
-  int inv_sample_ratio = MAX(params->n_in_use_segs / N_INFERENCE_DATA, 1);
-  int credit = inv_sample_ratio;
-  // printf("%d %d\n", params->n_in_use_segs, inv_sample_ratio);
+/* remove the row of a segment that leaves the cache,
+ * the last row is moved into the hole to keep the matrix dense */
+void inf_matrix_remove_seg(GLCache_params_t *params, segment_t *seg) {
+  learner_t *learner = &params->learner;
+  int32_t row = seg->inf_row;
+  int32_t last_row = learner->n_inf_rows - 1;
+
+  DEBUG_ASSERT(row >= 0 && row <= last_row);
+  DEBUG_ASSERT(learner->inf_row_segs[row] == seg);
+  if (row != last_row) {
+    segment_t *last_seg = learner->inf_row_segs[last_row];
+    memcpy(&learner->inference_x[row * learner->n_feature],
+           &learner->inference_x[last_row * learner->n_feature],
+           sizeof(feature_t) * learner->n_feature);
+    learner->inf_row_segs[row] = last_seg;
+    last_seg->inf_row = row;
+  }
 
-  for (int bi = 0; bi < MAX_N_BUCKET; bi++) {
-    segment_t *curr_seg = params->buckets[bi].first_seg;
-    for (int si = 0; si < params->buckets[bi].n_in_use_segs; si++) {
-      if (--credit == 0) {
-        prepare_one_row(cache, curr_seg, false, &x[learner->n_feature * n_segs],
-                        NULL);
-        curr_seg = curr_seg->next_seg;
-        n_segs++;
+  learner->n_inf_rows -= 1;
+  seg->inf_row = -1;
+}
 
-        credit = inv_sample_ratio;
-      }
-    }
-  }
-  DEBUG_ASSERT(inv_sample_ratio > 1 || params->n_in_use_segs == n_segs);
+/* update the inference matrix, only the segments that have changed since the
+ * last inference are prepared from scratch, other rows only refresh the
+ * time-dependent features */
+static int prepare_inference_data(cache_t *cache) {
+  GLCache_params_t *params = cache->eviction_params;
+  learner_t *learner = &params->learner;
 
-  if (params->learner.n_inference > 0) {
-    safe_call(XGDMatrixFree(learner->inf_dm));
-  }
-  safe_call(XGDMatrixCreateFromMat(learner->inference_x, n_segs,
-                                   learner->n_feature, -2, &learner->inf_dm));
+  DEBUG_ASSERT(learner->n_inf_rows == params->n_in_use_segs);
 
-  safe_call(XGDMatrixSetUIntInfo(learner->inf_dm, "group", &n_segs, 1));
+  for (int i = 0; i < learner->n_inf_rows; i++) {
+    segment_t *curr_seg = learner->inf_row_segs[i];
+    feature_t *x = &learner->inference_x[learner->n_feature * i];
+    if (curr_seg->feature_dirty) {
+      prepare_one_row(cache, curr_seg, false, x, NULL);
+      curr_seg->feature_dirty = false;
+    } else {
+      update_row_time_features(cache, curr_seg, x);
+    }
+  }
 
-  return n_segs;
+  return learner->n_inf_rows;
 }
 
 void inference_xgboost(cache_t *cache) {
@@ -78,8 +92,23 @@ void inference_xgboost(cache_t *cache) {
 
   int n_segs = prepare_inference_data(cache);
 
+  /* predict from the dense matrix in place, this avoids creating a DMatrix
+   * (a copy of the matrix) on each inference */
+  static const char *predict_config =
+      "{\"type\": 0, \"training\": false, \"iteration_begin\": 0, "
+      "\"iteration_end\": 0, \"strict_shape\": false, \"cache_id\": 0, "
+      "\"missing\": -2}";
+  char array_interface[256];
+  snprintf(array_interface, sizeof(array_interface),
+           "{\"data\": [%lu, true], \"shape\": [%d, %d], \"typestr\": \"<f4\", "
+           "\"version\": 3}",
+           (unsigned long)(uintptr_t)learner->inference_x, n_segs,
+           learner->n_feature);
+
   /* pred result stored in xgboost lib */
   const float *pred;
+  const bst_ulong *out_shape;
+  bst_ulong out_dim;
 
 #ifdef DUMP_INFERENCE_DATA
   static __thread char filename[24];
@@ -87,64 +116,46 @@ void inference_xgboost(cache_t *cache) {
   FILE *f = fopen(filename, "a");
 #endif
 
-  bst_ulong out_len = 0;
-  // TODO: use XGBoosterPredictFromDense to avoid copy
-  // https://github.com/dmlc/xgboost/blob/36346f8f563ef79bae94604e60483fb0bf4c2661/demo/c-api/inference/inference.c
-  safe_call(XGBoosterPredict(learner->booster, learner->inf_dm, 0, 0, 0,
-                             &out_len, &pred));
-  DEBUG_ASSERT(out_len == n_segs);
+  safe_call(XGBoosterPredictFromDense(learner->booster, array_interface,
+                                      predict_config, NULL, &out_shape,
+                                      &out_dim, &pred));
+  DEBUG_ASSERT(out_shape[0] == n_segs);
 
   segment_t **ranked_segs = params->seg_sel.ranked_segs;
 
-  n_segs = 0;
-  int inv_sample_ratio = MAX(params->n_in_use_segs / N_INFERENCE_DATA, 1);
-  int credit = inv_sample_ratio;
-
-  for (int bi = 0; bi < MAX_N_BUCKET; bi++) {
-    segment_t *curr_seg = params->buckets[bi].first_seg;
-    for (int si = 0; si < params->buckets[bi].n_in_use_segs; si++) {
-      if (--credit == 0) {
-        credit = inv_sample_ratio;
+  for (int i = 0; i < n_segs; i++) {
+    segment_t *curr_seg = learner->inf_row_segs[i];
 #if OBJECTIVE == REG
-        if (pred[n_segs] > 0)
-          curr_seg->pred_utility = pred[n_segs] * 1e6 / curr_seg->n_byte;
-        else if (pred[n_segs] < 0)
-          curr_seg->pred_utility = pred[n_segs] * curr_seg->n_byte;
+    if (pred[i] > 0)
+      curr_seg->pred_utility = pred[i] * 1e6 / curr_seg->n_byte;
+    else if (pred[i] < 0)
+      curr_seg->pred_utility = pred[i] * curr_seg->n_byte;
 #elif OBJECTIVE == LTR
-        // segments with smaller utility (high relevance) are evicted first
-        if (pred[n_segs] > 0) {
-          curr_seg->pred_utility = 1.0 / pred[n_segs];
-        } else {
-          curr_seg->pred_utility = INT32_MAX;
-        }
+    // segments with smaller utility (high relevance) are evicted first
+    if (pred[i] > 0) {
+      curr_seg->pred_utility = 1.0 / pred[i];
+    } else {
+      curr_seg->pred_utility = INT32_MAX;
+    }
 #endif
 
-        if (params->buckets[curr_seg->bucket_id].n_in_use_segs <
-            params->n_merge + 1) {
-          // if the segment is the last segment of a bucket or the bucket does
-          // not have enough segments
-          curr_seg->pred_utility += INT32_MAX / 2;
-        }
-
-        ranked_segs[n_segs] = curr_seg;
-        n_segs++;
+    if (params->buckets[curr_seg->bucket_id].n_in_use_segs <
+        params->n_merge + 1) {
+      // if the segment is the last segment of a bucket or the bucket does
+      // not have enough segments
+      curr_seg->pred_utility += INT32_MAX / 2;
+    }
 
-      } else {
-        curr_seg->pred_utility = INT32_MAX;
-      }
+    ranked_segs[i] = curr_seg;
 
 #ifdef DUMP_INFERENCE_DATA
-      fprintf(f, "%d %f/%lf: ", n_segs, pred[n_segs],
-              cal_seg_utility(cache, curr_seg, true));
-      for (int j = 0; j < learner->n_feature; j++) {
-        fprintf(f, "%f,",
-                learner->inference_x[learner->n_feature * n_segs + j]);
-      }
-      fprintf(f, "\n");
-#endif
-
-      curr_seg = curr_seg->next_seg;
+    fprintf(f, "%d %f/%lf: ", i, pred[i],
+            cal_seg_utility(cache, curr_seg, true));
+    for (int j = 0; j < learner->n_feature; j++) {
+      fprintf(f, "%f,", learner->inference_x[learner->n_feature * i + j]);
     }
+    fprintf(f, "\n");
+#endif
   }
 
   params->seg_sel.n_ranked_segs = n_segs;
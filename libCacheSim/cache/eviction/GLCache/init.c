@@ -55,12 +55,13 @@ void init_learner(cache_t *cache) {
   learner_t *l = &params->learner;
 
   l->n_feature = N_FEATURE_TIME_WINDOW * 3 + N_FEATURE_NORMAL;
-  l->pred = NULL;
   l->train_x = NULL;
   l->train_matrix_n_row = 0;
   l->valid_matrix_n_row = 0;
   l->inference_x = NULL;
   l->inf_matrix_n_row = 0;
+  l->inf_row_segs = NULL;
+  l->n_inf_rows = 0;
 
   l->n_train = -1;
   l->n_inference = 0;
@@ -81,6 +82,15 @@ void init_learner(cache_t *cache) {
   memset(l->valid_y, 0, sizeof(train_y_t) * l->valid_matrix_n_row);
   // l->retrain_intvl = retrain_intvl;
   l->last_train_rtime = 0;
+
+  if (l->async_train) {
+    /* the training thread trains from a copy of the training data */
+    train_job_t *job = &l->async_job;
+    job->train_x = my_malloc_n(feature_t, l->train_matrix_n_row * l->n_feature);
+    job->train_y = my_malloc_n(train_y_t, l->train_matrix_n_row);
+    job->valid_x = my_malloc_n(feature_t, l->valid_matrix_n_row * l->n_feature);
+    job->valid_y = my_malloc_n(train_y_t, l->valid_matrix_n_row);
+  }
 }
 
 static void init_buckets(cache_t *cache) {
@@ -42,6 +42,7 @@ static void seg_feature_shift(GLCache_params_t *params, segment_t *seg) {
 void seg_hit_update(GLCache_params_t *params, cache_obj_t *cache_obj) {
   segment_t *segment = cache_obj->GLCache.segment;
   segment->n_hit += 1;
+  segment->feature_dirty = true;
 
   if (params->curr_rtime - segment->feature.last_min_window_ts >= 60) {
     seg_feature_shift(params, segment);
@@ -89,6 +90,7 @@ void clear_dynamic_features(cache_t *cache) {
       }
       curr_seg->n_hit = 0;
       curr_seg->n_active = 0;
+      curr_seg->feature_dirty = true;
       curr_seg = curr_seg->next_seg;
     }
   }
@@ -116,6 +118,7 @@ segment_t *allocate_new_seg(cache_t *cache, int bucket_id) {
   new_seg->seg_id = params->n_allocated_segs++;
   new_seg->bucket_id = bucket_id;
   new_seg->rank = -1;
+  new_seg->inf_row = -1;
 
   return new_seg;
 }
@@ -138,6 +141,7 @@ void link_new_seg_before_seg(GLCache_params_t *params, bucket_t *bucket,
   old_seg->prev_seg = new_seg;
 
   params->n_in_use_segs += 1;
+  inf_matrix_add_seg(params, new_seg);
   bucket->n_in_use_segs += 1;
 }
 
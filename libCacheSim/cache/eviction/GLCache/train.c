@@ -19,54 +19,66 @@ static void debug_print_feature_matrix(const DMatrixHandle handle,
   printf("\n");
 }
 
-static void train_xgboost(cache_t *cache) {
-  GLCache_params_t *params = cache->eviction_params;
-  learner_t *learner = &params->learner;
+static void create_train_dmatrix(const learner_t *learner,
+                                 const train_job_t *job,
+                                 DMatrixHandle *train_dm,
+                                 DMatrixHandle *valid_dm) {
+  safe_call(XGDMatrixCreateFromMat(job->train_x, job->n_train_samples,
+                                   learner->n_feature, -2, train_dm));
 
-  if (learner->n_train != 0) {
-    safe_call(XGBoosterFree(learner->booster));
-    safe_call(XGDMatrixFree(learner->train_dm));
-    safe_call(XGDMatrixFree(learner->valid_dm));
-  }
+  safe_call(XGDMatrixCreateFromMat(job->valid_x, job->n_valid_samples,
+                                   learner->n_feature, -2, valid_dm));
 
-  prepare_training_data(cache);
-  // debug_print_feature_matrix(learner->train_dm, 20);
+  safe_call(XGDMatrixSetFloatInfo(*train_dm, "label", job->train_y,
+                                  job->n_train_samples));
+
+  safe_call(XGDMatrixSetFloatInfo(*valid_dm, "label", job->valid_y,
+                                  job->n_valid_samples));
+
+#if OBJECTIVE == LTR
+  safe_call(XGDMatrixSetUIntInfo(*train_dm, "group", &job->n_train_samples, 1));
+  safe_call(XGDMatrixSetUIntInfo(*valid_dm, "group", &job->n_valid_samples, 1));
+#endif
+}
+
+/**
+ * @brief train a model from the job, this only reads the job and the learner
+ * configuration, so it can run on the training thread
+ */
+static void train_xgboost(const learner_t *learner, train_job_t *job) {
+  DMatrixHandle train_dm, valid_dm;
+  create_train_dmatrix(learner, job, &train_dm, &valid_dm);
+  // debug_print_feature_matrix(train_dm, 20);
 
-  DMatrixHandle eval_dmats[2] = {learner->train_dm, learner->valid_dm};
+  DMatrixHandle eval_dmats[2] = {train_dm, valid_dm};
   static const char *eval_names[2] = {"train", "valid"};
   const char *eval_result;
   double train_loss, valid_loss, last_valid_loss = 0;
   int n_stable_iter = 0;
+  BoosterHandle booster;
 
-  safe_call(XGBoosterCreate(eval_dmats, 1, &learner->booster));
-  safe_call(XGBoosterSetParam(learner->booster, "booster", "gbtree"));
-  safe_call(XGBoosterSetParam(learner->booster, "verbosity", "1"));
-  safe_call(XGBoosterSetParam(learner->booster, "nthread", "1"));
+  safe_call(XGBoosterCreate(eval_dmats, 1, &booster));
+  safe_call(XGBoosterSetParam(booster, "booster", "gbtree"));
+  safe_call(XGBoosterSetParam(booster, "verbosity", "1"));
+  safe_call(XGBoosterSetParam(booster, "nthread", "1"));
 #if OBJECTIVE == REG
-  safe_call(
-      XGBoosterSetParam(learner->booster, "objective", "reg:squarederror"));
+  safe_call(XGBoosterSetParam(booster, "objective", "reg:squarederror"));
 #elif OBJECTIVE == LTR
-  safe_call(XGBoosterSetParam(learner->booster, "objective", "rank:pairwise"));
+  safe_call(XGBoosterSetParam(booster, "objective", "rank:pairwise"));
 #endif
 
   for (int i = 0; i < N_TRAIN_ITER; ++i) {
     // Update the model performance for each iteration
-    safe_call(XGBoosterUpdateOneIter(learner->booster, i, learner->train_dm));
-    if (learner->n_valid_samples < 10) continue;
-    safe_call(XGBoosterEvalOneIter(learner->booster, i, eval_dmats, eval_names,
-                                   2, &eval_result));
+    safe_call(XGBoosterUpdateOneIter(booster, i, train_dm));
+    if (job->n_valid_samples < 10) continue;
+    safe_call(XGBoosterEvalOneIter(booster, i, eval_dmats, eval_names, 2,
+                                   &eval_result));
 #if OBJECTIVE == REG
     char *train_pos = strstr(eval_result, "train-rmse:") + 11;
     char *valid_pos = strstr(eval_result, "valid-rmse") + 11;
     train_loss = strtof(train_pos, NULL);
     valid_loss = strtof(valid_pos, NULL);
 
-    // DEBUG("%.2lf hour, cache size %.2lf MB, iter %d, train loss %.4lf, valid
-    // loss %.4lf\n",
-    //     (double) params->curr_rtime / 3600.0,
-    //     (double) cache->cache_size / 1024.0 / 1024.0,
-    //     i, train_loss, valid_loss);
-
     if (fabs(last_valid_loss - valid_loss) / valid_loss < 0.01) {
       n_stable_iter += 1;
       if (n_stable_iter > 2) {
@@ -85,17 +97,35 @@ static void train_xgboost(cache_t *cache) {
 #endif
   }
 #ifndef __APPLE__
-  safe_call(XGBoosterBoostedRounds(learner->booster, &learner->n_trees));
+  safe_call(XGBoosterBoostedRounds(booster, &job->n_trees));
 #endif
 
+  safe_call(XGDMatrixFree(train_dm));
+  safe_call(XGDMatrixFree(valid_dm));
+
+  job->booster = booster;
+}
+
+/* replace the model used for inference with the model trained from job */
+static void install_model(cache_t *cache, train_job_t *job) {
+  GLCache_params_t *params = cache->eviction_params;
+  learner_t *learner = &params->learner;
+
+  if (learner->booster != NULL) {
+    safe_call(XGBoosterFree(learner->booster));
+  }
+  learner->booster = job->booster;
+  learner->n_trees = job->n_trees;
+  job->booster = NULL;
+  learner->n_train += 1;
+
   DEBUG(
       "%.2lf hour, cache size %.2lf MB, vtime %ld, train/valid %d/%d samples, "
-      "%d trees, "
-      "rank intvl %.4lf\n",
+      "%d trees, model from %.2lf hour, rank intvl %.4lf\n",
       (double)params->curr_rtime / 3600.0,
       (double)cache->cache_size / 1024.0 / 1024.0, (long)params->curr_vtime,
-      (int)learner->n_train_samples, (int)learner->n_valid_samples,
-      learner->n_trees, params->rank_intvl);
+      (int)job->n_train_samples, (int)job->n_valid_samples, learner->n_trees,
+      (double)job->rtime / 3600.0, params->rank_intvl);
 
 #ifdef DUMP_MODEL
   {
@@ -107,8 +137,121 @@ static void train_xgboost(cache_t *cache) {
 #endif
 }
 
+static void *train_thread_func(void *arg) {
+  learner_t *learner = arg;
+
+  pthread_mutex_lock(&learner->train_mtx);
+  while (true) {
+    while (!learner->job_submitted && !learner->train_stop) {
+      pthread_cond_wait(&learner->train_cond, &learner->train_mtx);
+    }
+    if (learner->train_stop) break;
+    pthread_mutex_unlock(&learner->train_mtx);
+
+    train_xgboost(learner, &learner->async_job);
+
+    pthread_mutex_lock(&learner->train_mtx);
+    learner->job_submitted = false;
+    __atomic_store_n(&learner->job_done, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&learner->train_cond);
+  }
+  pthread_mutex_unlock(&learner->train_mtx);
+
+  return NULL;
+}
+
+/* hand over a copy of the training data to the training thread */
+static void submit_train_job(cache_t *cache) {
+  GLCache_params_t *params = cache->eviction_params;
+  learner_t *learner = &params->learner;
+  train_job_t *job = &learner->async_job;
+
+  if (!learner->train_thread_started) {
+    pthread_mutex_init(&learner->train_mtx, NULL);
+    pthread_cond_init(&learner->train_cond, NULL);
+    pthread_create(&learner->train_thread, NULL, train_thread_func, learner);
+    learner->train_thread_started = true;
+  }
+
+  DEBUG_ASSERT(!learner->job_in_flight);
+  memcpy(job->train_x, learner->train_x,
+         sizeof(feature_t) * learner->n_train_samples * learner->n_feature);
+  memcpy(job->train_y, learner->train_y,
+         sizeof(train_y_t) * learner->n_train_samples);
+  memcpy(job->valid_x, learner->valid_x,
+         sizeof(feature_t) * learner->n_valid_samples * learner->n_feature);
+  memcpy(job->valid_y, learner->valid_y,
+         sizeof(train_y_t) * learner->n_valid_samples);
+  job->n_train_samples = learner->n_train_samples;
+  job->n_valid_samples = learner->n_valid_samples;
+  job->rtime = params->curr_rtime;
+
+  pthread_mutex_lock(&learner->train_mtx);
+  learner->job_submitted = true;
+  __atomic_store_n(&learner->job_done, 0, __ATOMIC_RELAXED);
+  pthread_cond_signal(&learner->train_cond);
+  pthread_mutex_unlock(&learner->train_mtx);
+
+  learner->job_in_flight = true;
+}
+
+/* wait for the training thread to finish the in-flight job */
+static void wait_train_job(learner_t *learner) {
+  pthread_mutex_lock(&learner->train_mtx);
+  while (learner->job_submitted) {
+    pthread_cond_wait(&learner->train_cond, &learner->train_mtx);
+  }
+  pthread_mutex_unlock(&learner->train_mtx);
+}
+
+/**
+ * @brief install the model trained on the training thread if it is ready,
+ * if the training data of the in-flight job is older than max_staleness,
+ * block until the model is ready, this is called on the request path
+ */
+void poll_trained_model(cache_t *cache) {
+  GLCache_params_t *params = cache->eviction_params;
+  learner_t *learner = &params->learner;
+
+  if (!learner->job_in_flight) return;
+
+  if (__atomic_load_n(&learner->job_done, __ATOMIC_ACQUIRE) == 0) {
+    if (params->curr_rtime - learner->async_job.rtime <
+        learner->max_staleness) {
+      return;
+    }
+    learner->n_train_blocked += 1;
+    wait_train_job(learner);
+  }
+
+  learner->job_in_flight = false;
+  install_model(cache, &learner->async_job);
+}
+
+void stop_train_thread(cache_t *cache) {
+  GLCache_params_t *params = cache->eviction_params;
+  learner_t *learner = &params->learner;
+
+  if (!learner->train_thread_started) return;
+
+  pthread_mutex_lock(&learner->train_mtx);
+  learner->train_stop = true;
+  pthread_cond_broadcast(&learner->train_cond);
+  pthread_mutex_unlock(&learner->train_mtx);
+  pthread_join(learner->train_thread, NULL);
+
+  if (learner->async_job.booster != NULL) {
+    safe_call(XGBoosterFree(learner->async_job.booster));
+    learner->async_job.booster = NULL;
+  }
+  pthread_mutex_destroy(&learner->train_mtx);
+  pthread_cond_destroy(&learner->train_cond);
+  learner->train_thread_started = false;
+}
+
 void train(cache_t *cache) {
   GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  learner_t *learner = &params->learner;
 
   uint64_t start_time = gettime_usec();
 #ifdef LOAD_MODEL
@@ -118,15 +261,39 @@ void train(cache_t *cache) {
 
     safe_call(XGBoosterLoadModel(learner->booster, s));
     INFO("Load model %s\n", s);
+    learner->n_train += 1;
   }
 #else
-  train_xgboost(cache);
+  prepare_training_data(cache);
+
+  if (learner->async_train) {
+    /* at most one job is in flight, the previous model must be installed
+     * before the next training data can be handed over */
+    if (learner->job_in_flight) {
+      learner->n_train_blocked += 1;
+      wait_train_job(learner);
+      learner->job_in_flight = false;
+      install_model(cache, &learner->async_job);
+    }
+    submit_train_job(cache);
+  } else {
+    train_job_t job = {
+        .train_x = learner->train_x,
+        .train_y = learner->train_y,
+        .valid_x = learner->valid_x,
+        .valid_y = learner->valid_y,
+        .n_train_samples = learner->n_train_samples,
+        .n_valid_samples = learner->n_valid_samples,
+        .rtime = params->curr_rtime,
+    };
+    train_xgboost(learner, &job);
+    install_model(cache, &job);
+  }
 #endif
 
   uint64_t end_time = gettime_usec();
   // INFO("training time %.4lf sec\n", (end_time - start_time) / 1000000.0);
-  params->learner.n_train += 1;
-  params->learner.last_train_rtime = params->curr_rtime;
-  params->learner.n_train_samples = 0;
-  params->learner.n_valid_samples = 0;
+  learner->last_train_rtime = params->curr_rtime;
+  learner->n_train_samples = 0;
+  learner->n_valid_samples = 0;
 }
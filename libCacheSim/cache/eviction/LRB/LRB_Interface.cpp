@@ -19,13 +19,22 @@ extern "C" {
 typedef struct {
   void *LRB_cache;
   char *objective;
+  // train in a background thread, results are not deterministic if true
+  bool async_training;
+  // the number of evictions of one request that share one inference
+  int eviction_batch;
+  // with async training, swap in the model exactly this many requests after
+  // the training data is handed over, 0 swaps it in when it is ready
+  int training_delay;
   SimpleRequest lrb_req;
 
   pair<uint64_t, uint32_t> to_evict_pair;
   cache_obj_t obj_tmp;
 } LRB_params_t;
 
-static const char *DEFAULT_PARAMS = "objective=byte-miss-ratio";
+static const char *DEFAULT_PARAMS =
+    "objective=byte-miss-ratio,async-training=false,eviction-batch=1,"
+    "training-delay=0";
 
 // ***********************************************************************
 // ****                                                               ****
@@ -95,10 +104,9 @@ cache_t *LRB_init(const common_cache_params_t ccache_params,
   memset(params, 0, sizeof(LRB_params_t));
   cache->eviction_params = params;
 
+  LRB_parse_params(cache, DEFAULT_PARAMS);
   if (cache_specific_params != NULL) {
     LRB_parse_params(cache, cache_specific_params);
-  } else {
-    LRB_parse_params(cache, DEFAULT_PARAMS);
   }
 
   auto *lrb = new lrb::LRBCache();
@@ -109,6 +117,9 @@ cache_t *LRB_init(const common_cache_params_t ccache_params,
   std::map<string, string> params_map;
 
   params_map["objective"] = params->objective;
+  params_map["async_training"] = params->async_training ? "true" : "false";
+  params_map["eviction_batch"] = std::to_string(params->eviction_batch);
+  params_map["training_delay"] = std::to_string(params->training_delay);
 
   if (strcmp(params->objective, "object-miss-ratio") == 0) {
     snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "%s", "LRB-OMR");
@@ -132,6 +143,7 @@ static void LRB_free(cache_t *cache) {
   auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
   auto *LRB = static_cast<lrb::LRBCache *>(params->LRB_cache);
   delete LRB;
+  free(params->objective);
   free(cache->to_evict_candidate);
   my_free(sizeof(LRB_params_t), params);
   cache_struct_free(cache);
@@ -307,9 +319,11 @@ static int64_t LRB_get_occupied_byte(const cache_t *cache) {
 // ***********************************************************************
 static const char *LRB_current_params(cache_t *cache, LRB_params_t *params) {
   static __thread char params_str[128];
-  int n = snprintf(params_str, 128, "objective=%s", params->objective);
-
-  snprintf(cache->cache_name + n, 128 - n, "\n");
+  snprintf(params_str, 128,
+           "objective=%s,async-training=%d,eviction-batch=%d,"
+           "training-delay=%d\n",
+           params->objective, params->async_training, params->eviction_batch,
+           params->training_delay);
 
   return params_str;
 }
@@ -332,10 +346,26 @@ static void LRB_parse_params(cache_t *cache,
     }
 
     if (strcasecmp(key, "objective") == 0) {
+      free(params->objective);
       params->objective = strdup(value);
       if (params->objective == NULL) {
         ERROR("out of memory %s\n", strerror(errno));
       }
+    } else if (strcasecmp(key, "async-training") == 0) {
+      params->async_training =
+          strcasecmp(value, "true") == 0 || strcmp(value, "1") == 0;
+    } else if (strcasecmp(key, "eviction-batch") == 0) {
+      params->eviction_batch = (int)strtol(value, &end, 0);
+      if (params->eviction_batch < 1) {
+        ERROR("eviction-batch should be positive, but got %d\n",
+              params->eviction_batch);
+      }
+    } else if (strcasecmp(key, "training-delay") == 0) {
+      params->training_delay = (int)strtol(value, &end, 0);
+      if (params->training_delay < 0) {
+        ERROR("training-delay should not be negative, but got %d\n",
+              params->training_delay);
+      }
     } else if (strcasecmp(key, "print") == 0) {
       printf("current parameters: %s\n", LRB_current_params(cache, params));
       exit(0);
@@ -11,20 +11,19 @@ using namespace chrono;
 using namespace std;
 using namespace lrb;
 
-void LRBCache::train() {
-    ++n_retrain;
+shared_ptr<LRBModel> LRBCache::train(TrainingData *data) {
     auto timeBegin = chrono::system_clock::now();
-    if (booster) LGBM_BoosterFree(booster);
+    auto new_model = make_shared<LRBModel>();
     // create training dataset
     DatasetHandle trainData;
     LGBM_DatasetCreateFromCSR(
-            static_cast<void *>(training_data->indptr.data()),
+            static_cast<void *>(data->indptr.data()),
             C_API_DTYPE_INT32,
-            training_data->indices.data(),
-            static_cast<void *>(training_data->data.data()),
+            data->indices.data(),
+            static_cast<void *>(data->data.data()),
             C_API_DTYPE_FLOAT64,
-            training_data->indptr.size(),
-            training_data->data.size(),
+            data->indptr.size(),
+            data->data.size(),
             n_feature,  //remove future t
             map_to_string(training_params).c_str(),
             nullptr,
@@ -32,31 +31,31 @@ void LRBCache::train() {
 
     LGBM_DatasetSetField(trainData,
                          "label",
-                         static_cast<void *>(training_data->labels.data()),
-                         training_data->labels.size(),
+                         static_cast<void *>(data->labels.data()),
+                         data->labels.size(),
                          C_API_DTYPE_FLOAT32);
 
     // init booster
-    LGBM_BoosterCreate(trainData, map_to_string(training_params).c_str(), &booster);
+    LGBM_BoosterCreate(trainData, map_to_string(training_params).c_str(), &new_model->booster);
     // train
     for (int i = 0; i < stoi(training_params["num_iterations"]); i++) {
         int isFinished;
-        LGBM_BoosterUpdateOneIter(booster, &isFinished);
+        LGBM_BoosterUpdateOneIter(new_model->booster, &isFinished);
         if (isFinished) {
             break;
         }
     }
 
     int64_t len;
-    vector<double> result(training_data->indptr.size() - 1);
-    LGBM_BoosterPredictForCSR(booster,
-                              static_cast<void *>(training_data->indptr.data()),
+    vector<double> result(data->indptr.size() - 1);
+    LGBM_BoosterPredictForCSR(new_model->booster,
+                              static_cast<void *>(data->indptr.data()),
                               C_API_DTYPE_INT32,
-                              training_data->indices.data(),
-                              static_cast<void *>(training_data->data.data()),
+                              data->indices.data(),
+                              static_cast<void *>(data->data.data()),
                               C_API_DTYPE_FLOAT64,
-                              training_data->indptr.size(),
-                              training_data->data.size(),
+                              data->indptr.size(),
+                              data->data.size(),
                               n_feature,  //remove future t
                               C_API_PREDICT_NORMAL,
                               0,
@@ -68,7 +67,7 @@ void LRBCache::train() {
 
     double se = 0;
     for (int i = 0; i < result.size(); ++i) {
-        auto diff = result[i] - training_data->labels[i];
+        auto diff = result[i] - data->labels[i];
         se += diff * diff;
     }
     training_loss = training_loss * 0.99 + se / batch_size * 0.01;
@@ -76,6 +75,96 @@ void LRBCache::train() {
     LGBM_DatasetFree(trainData);
     training_time = 0.95 * training_time +
                     0.05 * chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now() - timeBegin).count();
+
+    return new_model;
+}
+
+void LRBCache::publish_model(const shared_ptr<LRBModel> &new_model) {
+    new_model->version = ++model_version;
+    // the old booster is freed when the last inference using it finishes
+    atomic_store(&model, new_model);
+    ++n_retrain;
+}
+
+void LRBCache::submit_training_data() {
+    if (!async_training) {
+        publish_model(train(training_data));
+        training_data->clear();
+        return;
+    }
+
+    if (training_delay) {
+        //at most one batch is in flight, so no batch is dropped
+        if (training_in_flight) {
+            wait_trained_model();
+        }
+        training_in_flight = true;
+        training_submit_seq = current_seq;
+    }
+
+    {
+        lock_guard<mutex> lock(training_mutex);
+        if (pending_training_data) {
+            //the trainer has not picked up the last batch, replace it with the newer one
+            ++n_training_dropped;
+            swap(pending_training_data, training_data);
+        } else {
+            pending_training_data = training_data;
+            if (spare_training_data) {
+                training_data = spare_training_data;
+                spare_training_data = nullptr;
+            } else {
+                training_data = new TrainingData(n_feature, memory_window);
+            }
+        }
+    }
+    training_data->clear();
+    training_cv.notify_one();
+}
+
+void LRBCache::training_loop() {
+    unique_lock<mutex> lock(training_mutex);
+    while (true) {
+        training_cv.wait(lock, [this] { return training_stop || pending_training_data; });
+        if (training_stop) {
+            break;
+        }
+        TrainingData *data = pending_training_data;
+        pending_training_data = nullptr;
+
+        //the request path keeps running while the model is trained
+        lock.unlock();
+        auto new_model = train(data);
+        if (!training_delay) {
+            publish_model(new_model);
+        }
+        data->clear();
+        lock.lock();
+
+        if (training_delay) {
+            //the request path swaps the model in at the fixed delay
+            trained_model = new_model;
+            trained_cv.notify_one();
+        }
+
+        if (spare_training_data) {
+            delete data;
+        } else {
+            spare_training_data = data;
+        }
+    }
+}
+
+void LRBCache::wait_trained_model() {
+    shared_ptr<LRBModel> new_model;
+    {
+        unique_lock<mutex> lock(training_mutex);
+        trained_cv.wait(lock, [this] { return trained_model != nullptr; });
+        new_model = std::move(trained_model);
+        trained_model = nullptr;
+    }
+    publish_model(new_model);
+    training_in_flight = false;
 }
 
 void LRBCache::sample() {
@@ -106,7 +195,8 @@ void LRBCache::update_stat_periodic() {
     }
     obj_distribution[0] = obj_distribution[1] = 0;
     segment_percent_beyond.emplace_back(percent_beyond);
-    segment_n_retrain.emplace_back(n_retrain);
+    segment_n_retrain.emplace_back(n_retrain.exchange(0));
+    segment_model_version.emplace_back(model_version);
     segment_n_in.emplace_back(in_cache_metas.size());
     segment_n_out.emplace_back(out_cache_metas.size());
 
@@ -119,7 +209,6 @@ void LRBCache::update_stat_periodic() {
     training_data_distribution[0] = training_data_distribution[1] = 0;
     segment_positive_example_ratio.emplace_back(positive_example_ratio);
 
-    n_retrain = 0;
     assert(in_cache_metas.size() + out_cache_metas.size() == key_map.size());
 }
 
@@ -128,6 +217,10 @@ bool LRBCache::lookup(const SimpleRequest &req) {
     bool ret;
     ++current_seq;
 
+    if (training_in_flight && current_seq - training_submit_seq >= training_delay) {
+        wait_trained_model();
+    }
+
     forget();
 
     //first update the metadata: insert/update, which can trigger pending data.mature
@@ -155,8 +248,7 @@ bool LRBCache::lookup(const SimpleRequest &req) {
             }
             //batch_size ~>= batch_size
             if (training_data->labels.size() >= batch_size) {
-                train();
-                training_data->clear();
+                submit_training_data();
             }
             meta._sample_times.clear();
             meta._sample_times.shrink_to_fit();
@@ -214,8 +306,7 @@ void LRBCache::forget() {
             }
             //batch_size ~>= batch_size
             if (training_data->labels.size() >= batch_size) {
-                train();
-                training_data->clear();
+                submit_training_data();
             }
             meta._sample_times.clear();
             meta._sample_times.shrink_to_fit();
@@ -264,6 +355,8 @@ void LRBCache::admit(const SimpleRequest &req) {
 
 
 pair<uint64_t, uint32_t> LRBCache::rank() {
+    //hold a reference so that the trainer can publish a new model meanwhile
+    auto curr_model = atomic_load(&model);
 
     {
         //if not trained yet, or in_cache_lru past memory window, use LRU
@@ -272,15 +365,31 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
         assert(it != key_map.end());
         auto pos = it->second.list_pos;
         auto &meta = in_cache_metas[pos];
-        if ((!booster) || (memory_window <= current_seq - meta._past_timestamp)) {
+        if ((!curr_model) || (memory_window <= current_seq - meta._past_timestamp)) {
             //this use LRU force eviction, consider sampled a beyond boundary object
-            if (booster) {
+            if (curr_model) {
                 ++obj_distribution[1];
             }
             return {meta._key, pos};
         }
     }
 
+    //the features do not change within one request, so the candidates ranked by an earlier eviction of
+    //this request are still valid, skip the ones evicted or not in the cache any more
+    if (ranked_seq == current_seq && ranked_model == curr_model) {
+        while (ranked_idx < ranked_keys.size()) {
+            auto it = key_map.find(ranked_keys[ranked_idx++]);
+            if (it != key_map.end() && !it->second.list_idx) {
+                auto pos = it->second.list_pos;
+                if (memory_window <= current_seq - in_cache_metas[pos]._past_timestamp) {
+                    //beyond boundary, the same as the LRU force eviction above
+                    ++obj_distribution[1];
+                }
+                return {it->first, (uint32_t) pos};
+            }
+        }
+    }
+
     int32_t indptr[sample_rate + 1];
     indptr[0] = 0;
     int32_t indices[sample_rate * n_feature];
@@ -362,7 +471,7 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
     //sample to measure inference time
     if (!(current_seq % 10000))
         timeBegin = chrono::system_clock::now();
-    LGBM_BoosterPredictForCSR(booster,
+    LGBM_BoosterPredictForCSR(curr_model->booster,
                               static_cast<void *>(indptr),
                               C_API_DTYPE_INT32,
                               indices,
@@ -406,6 +515,15 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
          }
     );
 
+    ++n_inference;
+    ranked_keys.clear();
+    for (uint32_t i = 1; i < eviction_batch && i < sample_rate; ++i) {
+        ranked_keys.emplace_back(keys[index[i]]);
+    }
+    ranked_idx = 0;
+    ranked_seq = current_seq;
+    ranked_model = curr_model;
+
     return {keys[index[0]], poses[index[0]]};
 }
 
@@ -433,8 +551,7 @@ void LRBCache::evict_with_candidate(pair<uint64_t, uint32_t> &epair) {
             }
             //batch_size ~>= batch_size
             if (training_data->labels.size() >= batch_size) {
-                train();
-                training_data->clear();
+                submit_training_data();
             }
             meta._sample_times.clear();
             meta._sample_times.shrink_to_fit();
@@ -17,6 +17,11 @@
 #include <sstream>
 #include <fstream>
 #include <list>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 using namespace webcachesim;
 using namespace std;
@@ -264,6 +269,26 @@ public:
 };
 
 
+/*
+ * a trained booster and its version, the booster is shared between the
+ * training thread and the inference on the request path, and it is freed when
+ * the last user releases it
+ */
+struct LRBModel {
+    BoosterHandle booster = nullptr;
+    uint64_t version = 0;
+
+    LRBModel() = default;
+
+    LRBModel(const LRBModel &) = delete;
+
+    LRBModel &operator=(const LRBModel &) = delete;
+
+    ~LRBModel() {
+        if (booster) LGBM_BoosterFree(booster);
+    }
+};
+
 struct KeyMapEntryT {
     unsigned int list_idx: 1;
     unsigned int list_pos: 31;
@@ -290,13 +315,59 @@ public:
     // sample_size: use n_memorize keys + random choose (sample_rate - n_memorize) keys
     uint sample_rate = 64;
 
-    double training_loss = 0;
+    // written by the training thread
+    atomic<double> training_loss{0};
     int32_t n_force_eviction = 0;
 
-    double training_time = 0;
+    atomic<double> training_time{0};
     double inference_time = 0;
 
-    BoosterHandle booster = nullptr;
+    // the latest model, read and replaced with atomic_load/atomic_store
+    shared_ptr<LRBModel> model;
+    atomic<uint64_t> model_version{0};
+
+    /*
+     * training runs in a background thread on a full batch of training data,
+     * the request path hands the batch over and continues with an empty one.
+     * If the trainer is still busy, the newer batch replaces the pending one.
+     * Off by default, the model is trained in the request path
+     */
+    bool async_training = false;
+    thread training_thread;
+    mutex training_mutex;
+    condition_variable training_cv;
+    // protected by training_mutex
+    TrainingData *pending_training_data = nullptr;
+    TrainingData *spare_training_data = nullptr;
+    bool training_stop = false;
+    uint64_t n_training_dropped = 0;
+
+    /*
+     * with a positive training_delay the trained model is swapped in exactly
+     * training_delay requests after its batch is handed over, the request path
+     * blocks if the trainer is behind, so the results do not depend on the
+     * speed of the trainer. 0 swaps the model in as soon as it is trained
+     */
+    uint32_t training_delay = 0;
+    // protected by training_mutex, the model waiting to be swapped in
+    shared_ptr<LRBModel> trained_model;
+    condition_variable trained_cv;
+    // only used by the request path
+    bool training_in_flight = false;
+    uint32_t training_submit_seq = 0;
+
+    /*
+     * one inference ranks sample_rate candidates, the best eviction_batch
+     * candidates are evicted by the following evictions of the same request
+     * without another inference. The default 1 ranks for every eviction
+     */
+    uint32_t eviction_batch = 1;
+    vector<uint64_t> ranked_keys;
+    uint32_t ranked_idx = 0;
+    uint32_t ranked_seq = 0;
+    // the model that ranked ranked_keys, a newly published model ranks again
+    shared_ptr<LRBModel> ranked_model;
+    uint64_t n_inference = 0;
 
     unordered_map<string, string> training_params = {
             //don't use alias here. C api may not recongize
@@ -329,12 +400,27 @@ public:
     uint32_t training_data_distribution[2];  //1: pos, 0: neg
     vector<float> segment_positive_example_ratio;
     vector<double> segment_percent_beyond;
-    int n_retrain = 0;
+    atomic<int> n_retrain{0};
     vector<int> segment_n_retrain;
+    vector<uint64_t> segment_model_version;
     bool is_sampling = false;
 
     uint64_t byte_million_req;
 
+    ~LRBCache() override {
+        if (training_thread.joinable()) {
+            {
+                lock_guard<mutex> lock(training_mutex);
+                training_stop = true;
+            }
+            training_cv.notify_one();
+            training_thread.join();
+        }
+        delete training_data;
+        delete pending_training_data;
+        delete spare_training_data;
+    }
+
     void init_with_params(const map<string, string> &params) override {
         //set params
         for (auto &it: params) {
@@ -350,6 +436,16 @@ public:
                 training_params["num_threads"] = it.second;
             } else if (it.first == "num_leaves") {
                 training_params["num_leaves"] = it.second;
+            } else if (it.first == "async_training") {
+                async_training = (it.second == "true" || it.second == "1");
+            } else if (it.first == "eviction_batch") {
+                eviction_batch = stoul(it.second);
+                if (eviction_batch == 0) {
+                    cerr << "error: eviction_batch should be positive" << endl;
+                    abort();
+                }
+            } else if (it.first == "training_delay") {
+                training_delay = stoul(it.second);
             } else if (it.first == "byte_million_req") {
                 byte_million_req = stoull(it.second);
             } else if (it.first == "n_edc_feature") {
@@ -398,6 +494,9 @@ public:
         }
         inference_params = training_params;
         training_data = new TrainingData(n_feature, memory_window);
+        if (async_training) {
+            training_thread = thread(&LRBCache::training_loop, this);
+        }
     }
 
     string map_to_string(unordered_map<string, string> &map) {
@@ -422,7 +521,18 @@ public:
     //sample, rank the 1st and return
     pair<uint64_t, uint32_t> rank();
 
-    void train();
+    // train a model on the batch, it does not touch the cache metadata
+    shared_ptr<LRBModel> train(TrainingData *data);
+
+    // hand the full batch of training data to the trainer (or train in place)
+    void submit_training_data();
+
+    void publish_model(const shared_ptr<LRBModel> &new_model);
+
+    void training_loop();
+
+    // wait for the model of the batch in flight and swap it in
+    void wait_trained_model();
 
     void sample();
 
@@ -45,10 +45,9 @@ static bool Random_remove(cache_t *cache, const obj_id_t obj_id);
  */
 cache_t *Random_init(const common_cache_params_t ccache_params,
                      const char *cache_specific_params) {
-  common_cache_params_t ccache_params_copy = ccache_params;
-  ccache_params_copy.hashpower = MAX(12, ccache_params_copy.hashpower - 8);
-
   cache_t *cache = cache_struct_init("Random", ccache_params, cache_specific_params);
+  // sample from a dense object array so that eviction is O(1) and uniform
+  hashtable_enable_sampling(cache->hashtable);
   cache->cache_init = Random_init;
   cache->cache_free = Random_free;
   cache->get = Random_get;
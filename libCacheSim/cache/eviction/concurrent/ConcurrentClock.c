@@ -0,0 +1,334 @@
+//
+//  a thread-safe Clock (FIFO-Reinsertion), objects are queued in a lock-free
+//  ring queue, a hit sets the atomic visited bit (or increments the n-bit
+//  counter), and eviction pushes visited objects back to the queue
+//  see concurrentCache.h for the design shared by the concurrent algorithms
+//
+//
+//  ConcurrentClock.c
+//  libCacheSim
+//
+
+#include "concurrentCache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  concurrent_hashtable_t *hashtable;
+  struct ring_queue queue;
+
+  int n_bit_counter;
+  int max_freq;
+} ConcurrentClock_params_t;
+
+static const char *DEFAULT_PARAMS = "n-bit-counter=1";
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void ConcurrentClock_parse_params(cache_t *cache,
+                                         const char *cache_specific_params);
+static void ConcurrentClock_free(cache_t *cache);
+static bool ConcurrentClock_get(cache_t *cache, const request_t *req);
+static cache_obj_t *ConcurrentClock_find(cache_t *cache, const request_t *req,
+                                         const bool update_cache);
+static cache_obj_t *ConcurrentClock_insert(cache_t *cache,
+                                           const request_t *req);
+static cache_obj_t *ConcurrentClock_to_evict(cache_t *cache,
+                                             const request_t *req);
+static void ConcurrentClock_evict(cache_t *cache, const request_t *req);
+static bool ConcurrentClock_remove(cache_t *cache, const obj_id_t obj_id);
+
+static bool ConcurrentClock_evict_one(cache_t *cache);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ****                       init, free, get                         ****
+// ***********************************************************************
+
+/**
+ * @brief initialize a ConcurrentClock cache
+ *
+ * @param ccache_params some common cache parameters, the cache holds at most
+ * 2^hashpower objects
+ * @param cache_specific_params ConcurrentClock specific parameters, see
+ * parse_params
+ */
+cache_t *ConcurrentClock_init(const common_cache_params_t ccache_params,
+                              const char *cache_specific_params) {
+  cache_t *cache = concurrent_cache_struct_init(
+      "ConcurrentClock", ccache_params, cache_specific_params);
+  cache->cache_init = ConcurrentClock_init;
+  cache->cache_free = ConcurrentClock_free;
+  cache->get = ConcurrentClock_get;
+  cache->find = ConcurrentClock_find;
+  cache->insert = ConcurrentClock_insert;
+  cache->evict = ConcurrentClock_evict;
+  cache->remove = ConcurrentClock_remove;
+  cache->to_evict = ConcurrentClock_to_evict;
+  cache->get_occupied_byte = concurrent_cache_get_occupied_byte;
+  cache->get_n_obj = concurrent_cache_get_n_obj;
+  cache->can_insert = concurrent_cache_can_insert;
+  cache->obj_md_size = 0;
+
+  cache->eviction_params = malloc(sizeof(ConcurrentClock_params_t));
+  memset(cache->eviction_params, 0, sizeof(ConcurrentClock_params_t));
+  ConcurrentClock_params_t *params =
+      (ConcurrentClock_params_t *)cache->eviction_params;
+  params->hashtable = create_concurrent_hashtable(cache->hashpower);
+  if (ring_queue_init(&params->queue, concurrent_cache_queue_capacity(cache)) !=
+      0) {
+    ERROR("%s fails to allocate the queue\n", cache->cache_name);
+  }
+
+  ConcurrentClock_parse_params(cache, DEFAULT_PARAMS);
+  if (cache_specific_params != NULL) {
+    ConcurrentClock_parse_params(cache, cache_specific_params);
+  }
+
+  if (params->n_bit_counter != 1) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "ConcurrentClock-%d",
+             params->n_bit_counter);
+  }
+
+  return cache;
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void ConcurrentClock_free(cache_t *cache) {
+  ConcurrentClock_params_t *params =
+      (ConcurrentClock_params_t *)cache->eviction_params;
+  concurrent_cache_free_queue(&params->queue);
+  free_concurrent_hashtable(params->hashtable);
+  free(cache->eviction_params);
+  cache_struct_free(cache);
+}
+
+/**
+ * @brief this function is the user facing API, it is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static void ConcurrentClock_hit(cache_obj_t *obj, void *user_data) {
+  ConcurrentClock_params_t *params = (ConcurrentClock_params_t *)user_data;
+  int32_t *freq = concurrent_obj_freq(obj);
+  // read before write so that hits on popular objects do not bounce the line
+  int32_t curr_freq = __atomic_load_n(freq, __ATOMIC_RELAXED);
+  while (curr_freq < params->max_freq &&
+         !__atomic_compare_exchange_n(freq, &curr_freq, curr_freq + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+static bool ConcurrentClock_get(cache_t *cache, const request_t *req) {
+  ConcurrentClock_params_t *params =
+      (ConcurrentClock_params_t *)cache->eviction_params;
+
+  if (concurrent_hashtable_find(params->hashtable, req->obj_id,
+                                ConcurrentClock_hit, params)) {
+    return true;
+  }
+
+  if (cache->can_insert(cache, req)) {
+    ConcurrentClock_insert(cache, req);
+  }
+
+  return false;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****       developer facing APIs (used by cache developer)         ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief check whether an object is in the cache,
+ * the returned object is only safe to use in single-threaded mode
+ *
+ * @param cache
+ * @param req
+ * @param update_cache whether to update the visited bit
+ * @return the object or NULL if not found
+ */
+static cache_obj_t *ConcurrentClock_find(cache_t *cache, const request_t *req,
+                                         const bool update_cache) {
+  ConcurrentClock_params_t *params =
+      (ConcurrentClock_params_t *)cache->eviction_params;
+  cache_obj_t *obj = concurrent_cache_find(params->hashtable, req->obj_id);
+  if (obj != NULL && update_cache) {
+    ConcurrentClock_hit(obj, params);
+  }
+  return obj;
+}
+
+/**
+ * @brief insert an object into the cache and evict until the cache has
+ * enough space, this function is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return the inserted object, NULL if another thread has inserted it
+ */
+static cache_obj_t *ConcurrentClock_insert(cache_t *cache,
+                                           const request_t *req) {
+  ConcurrentClock_params_t *params =
+      (ConcurrentClock_params_t *)cache->eviction_params;
+
+  cache_obj_t *obj =
+      concurrent_cache_insert_obj(cache, params->hashtable, req);
+  if (obj == NULL) {
+    return NULL;
+  }
+  *concurrent_obj_freq(obj) = 0;
+
+  // the new object is not in the queue yet, so it is not evicted here
+  while (concurrent_cache_get_occupied_byte(cache) > cache->cache_size) {
+    if (!ConcurrentClock_evict_one(cache)) {
+      // other threads have popped all objects and will free the space
+      break;
+    }
+  }
+
+  while (!ring_queue_push(&params->queue, obj)) {
+    ConcurrentClock_evict_one(cache);
+  }
+
+  return obj;
+}
+
+/**
+ * @brief find the object to be evicted, not supported because the head of
+ * the queue can be popped by another thread at any time
+ */
+static cache_obj_t *ConcurrentClock_to_evict(cache_t *cache,
+                                             const request_t *req) {
+  assert(false);
+  return NULL;
+}
+
+/**
+ * @brief pop objects from the queue, push the visited ones back with the
+ * counter decremented and evict the first one not visited
+ *
+ * @return false if the queue is empty
+ */
+static bool ConcurrentClock_evict_one(cache_t *cache) {
+  ConcurrentClock_params_t *params =
+      (ConcurrentClock_params_t *)cache->eviction_params;
+
+  while (true) {
+    cache_obj_t *obj = ring_queue_pop(&params->queue);
+    if (obj == NULL) {
+      return false;
+    }
+
+    int32_t *freq = concurrent_obj_freq(obj);
+    if (__atomic_load_n(freq, __ATOMIC_RELAXED) >= 1) {
+      __atomic_fetch_sub(freq, 1, __ATOMIC_RELAXED);
+      if (ring_queue_push(&params->queue, obj)) {
+        continue;
+      }
+      // the queue has been filled by other threads, evict this object
+    }
+
+    concurrent_cache_evict_obj(cache, params->hashtable, obj);
+    return true;
+  }
+}
+
+/**
+ * @brief evict an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param req not used
+ */
+static void ConcurrentClock_evict(cache_t *cache, const request_t *req) {
+  ConcurrentClock_evict_one(cache);
+}
+
+/**
+ * @brief remove an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param obj_id
+ * @return true if the object is removed, false if the object is not in the
+ * cache
+ */
+static bool ConcurrentClock_remove(cache_t *cache, const obj_id_t obj_id) {
+  ConcurrentClock_params_t *params =
+      (ConcurrentClock_params_t *)cache->eviction_params;
+  return concurrent_cache_remove(cache, params->hashtable, obj_id);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  parameter set up functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+static const char *ConcurrentClock_current_params(
+    ConcurrentClock_params_t *params) {
+  static __thread char params_str[128];
+  snprintf(params_str, 128, "n-bit-counter=%d\n", params->n_bit_counter);
+
+  return params_str;
+}
+
+static void ConcurrentClock_parse_params(cache_t *cache,
+                                         const char *cache_specific_params) {
+  ConcurrentClock_params_t *params =
+      (ConcurrentClock_params_t *)cache->eviction_params;
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "n-bit-counter") == 0) {
+      params->n_bit_counter = (int)strtol(value, &end, 0);
+      if (params->n_bit_counter < 1 || params->n_bit_counter > 30) {
+        ERROR("n-bit-counter should be in [1, 30], but got %d\n",
+              params->n_bit_counter);
+      }
+      params->max_freq = (1 << params->n_bit_counter) - 1;
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: %s\n",
+             ConcurrentClock_current_params(params));
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s, example paramters %s\n",
+            cache->cache_name, key, ConcurrentClock_current_params(params));
+      exit(1);
+    }
+  }
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,229 @@
+//
+//  a thread-safe FIFO, objects are queued in a lock-free ring queue
+//  see concurrentCache.h for the design shared by the concurrent algorithms
+//
+//
+//  ConcurrentFIFO.c
+//  libCacheSim
+//
+
+#include "concurrentCache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  concurrent_hashtable_t *hashtable;
+  struct ring_queue queue;
+} ConcurrentFIFO_params_t;
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void ConcurrentFIFO_free(cache_t *cache);
+static bool ConcurrentFIFO_get(cache_t *cache, const request_t *req);
+static cache_obj_t *ConcurrentFIFO_find(cache_t *cache, const request_t *req,
+                                        const bool update_cache);
+static cache_obj_t *ConcurrentFIFO_insert(cache_t *cache,
+                                          const request_t *req);
+static cache_obj_t *ConcurrentFIFO_to_evict(cache_t *cache,
+                                            const request_t *req);
+static void ConcurrentFIFO_evict(cache_t *cache, const request_t *req);
+static bool ConcurrentFIFO_remove(cache_t *cache, const obj_id_t obj_id);
+
+static bool ConcurrentFIFO_evict_one(cache_t *cache);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ****                       init, free, get                         ****
+// ***********************************************************************
+
+/**
+ * @brief initialize a ConcurrentFIFO cache
+ *
+ * @param ccache_params some common cache parameters, the cache holds at most
+ * 2^hashpower objects
+ * @param cache_specific_params not used
+ */
+cache_t *ConcurrentFIFO_init(const common_cache_params_t ccache_params,
+                             const char *cache_specific_params) {
+  cache_t *cache = concurrent_cache_struct_init(
+      "ConcurrentFIFO", ccache_params, cache_specific_params);
+  cache->cache_init = ConcurrentFIFO_init;
+  cache->cache_free = ConcurrentFIFO_free;
+  cache->get = ConcurrentFIFO_get;
+  cache->find = ConcurrentFIFO_find;
+  cache->insert = ConcurrentFIFO_insert;
+  cache->evict = ConcurrentFIFO_evict;
+  cache->remove = ConcurrentFIFO_remove;
+  cache->to_evict = ConcurrentFIFO_to_evict;
+  cache->get_occupied_byte = concurrent_cache_get_occupied_byte;
+  cache->get_n_obj = concurrent_cache_get_n_obj;
+  cache->can_insert = concurrent_cache_can_insert;
+  cache->obj_md_size = 0;
+
+  cache->eviction_params = malloc(sizeof(ConcurrentFIFO_params_t));
+  memset(cache->eviction_params, 0, sizeof(ConcurrentFIFO_params_t));
+  ConcurrentFIFO_params_t *params =
+      (ConcurrentFIFO_params_t *)cache->eviction_params;
+  params->hashtable = create_concurrent_hashtable(cache->hashpower);
+  if (ring_queue_init(&params->queue, concurrent_cache_queue_capacity(cache)) !=
+      0) {
+    ERROR("%s fails to allocate the queue\n", cache->cache_name);
+  }
+
+  return cache;
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void ConcurrentFIFO_free(cache_t *cache) {
+  ConcurrentFIFO_params_t *params =
+      (ConcurrentFIFO_params_t *)cache->eviction_params;
+  concurrent_cache_free_queue(&params->queue);
+  free_concurrent_hashtable(params->hashtable);
+  free(cache->eviction_params);
+  cache_struct_free(cache);
+}
+
+/**
+ * @brief this function is the user facing API, it is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static bool ConcurrentFIFO_get(cache_t *cache, const request_t *req) {
+  ConcurrentFIFO_params_t *params =
+      (ConcurrentFIFO_params_t *)cache->eviction_params;
+
+  if (concurrent_hashtable_find(params->hashtable, req->obj_id, NULL, NULL)) {
+    return true;
+  }
+
+  if (cache->can_insert(cache, req)) {
+    ConcurrentFIFO_insert(cache, req);
+  }
+
+  return false;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****       developer facing APIs (used by cache developer)         ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief check whether an object is in the cache,
+ * the returned object is only safe to use in single-threaded mode
+ *
+ * @param cache
+ * @param req
+ * @param update_cache not used, FIFO does not update on hit
+ * @return the object or NULL if not found
+ */
+static cache_obj_t *ConcurrentFIFO_find(cache_t *cache, const request_t *req,
+                                        const bool update_cache) {
+  ConcurrentFIFO_params_t *params =
+      (ConcurrentFIFO_params_t *)cache->eviction_params;
+  return concurrent_cache_find(params->hashtable, req->obj_id);
+}
+
+/**
+ * @brief insert an object into the cache and evict until the cache has
+ * enough space, this function is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return the inserted object, NULL if another thread has inserted it
+ */
+static cache_obj_t *ConcurrentFIFO_insert(cache_t *cache,
+                                          const request_t *req) {
+  ConcurrentFIFO_params_t *params =
+      (ConcurrentFIFO_params_t *)cache->eviction_params;
+
+  cache_obj_t *obj =
+      concurrent_cache_insert_obj(cache, params->hashtable, req);
+  if (obj == NULL) {
+    return NULL;
+  }
+
+  // the new object is not in the queue yet, so it is not evicted here
+  while (concurrent_cache_get_occupied_byte(cache) > cache->cache_size) {
+    if (!ConcurrentFIFO_evict_one(cache)) {
+      // other threads have popped all objects and will free the space
+      break;
+    }
+  }
+
+  while (!ring_queue_push(&params->queue, obj)) {
+    ConcurrentFIFO_evict_one(cache);
+  }
+
+  return obj;
+}
+
+/**
+ * @brief find the object to be evicted, not supported because the head of
+ * the queue can be popped by another thread at any time
+ */
+static cache_obj_t *ConcurrentFIFO_to_evict(cache_t *cache,
+                                            const request_t *req) {
+  assert(false);
+  return NULL;
+}
+
+/**
+ * @brief pop the oldest object and evict it
+ *
+ * @return false if the queue is empty
+ */
+static bool ConcurrentFIFO_evict_one(cache_t *cache) {
+  ConcurrentFIFO_params_t *params =
+      (ConcurrentFIFO_params_t *)cache->eviction_params;
+
+  cache_obj_t *obj = ring_queue_pop(&params->queue);
+  if (obj == NULL) {
+    return false;
+  }
+  concurrent_cache_evict_obj(cache, params->hashtable, obj);
+  return true;
+}
+
+/**
+ * @brief evict an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param req not used
+ */
+static void ConcurrentFIFO_evict(cache_t *cache, const request_t *req) {
+  ConcurrentFIFO_evict_one(cache);
+}
+
+/**
+ * @brief remove an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param obj_id
+ * @return true if the object is removed, false if the object is not in the
+ * cache
+ */
+static bool ConcurrentFIFO_remove(cache_t *cache, const obj_id_t obj_id) {
+  ConcurrentFIFO_params_t *params =
+      (ConcurrentFIFO_params_t *)cache->eviction_params;
+  return concurrent_cache_remove(cache, params->hashtable, obj_id);
+}
+
+#ifdef __cplusplus
+}
+#endif
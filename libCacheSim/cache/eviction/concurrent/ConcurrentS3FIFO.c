@@ -0,0 +1,481 @@
+//
+//  a thread-safe S3FIFO, small FIFO + main FIFO (2-bit Clock) + ghost
+//
+//  the small and the main FIFO are lock-free ring queues, a hit increments
+//  the atomic frequency of the object, and objects are moved between the
+//  queues by the threads that evict. The ghost is a lock-free table of
+//  (fingerprint, timestamp) indexed by the object hash, an entry is valid if
+//  it was inserted within the last ghost-size-ratio * n_obj ghost insertions,
+//  so colliding objects overwrite each other instead of taking a lock
+//  see concurrentCache.h for the design shared by the concurrent algorithms
+//
+//
+//  ConcurrentS3FIFO.c
+//  libCacheSim
+//
+
+#include "../../../dataStructure/hash/hash.h"
+#include "concurrentCache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  concurrent_hashtable_t *hashtable;
+  struct ring_queue small_fifo;
+  struct ring_queue main_fifo;
+
+  // the bytes of the objects in each queue, updated by the threads that push
+  // and pop, so they do not include the objects being inserted
+  int64_t small_fifo_byte;
+  int64_t main_fifo_byte;
+  int64_t small_fifo_size;
+  int64_t main_fifo_size;
+
+  uint64_t *ghost_table;
+  uint64_t ghost_mask;
+  uint32_t ghost_vtime;
+
+  int move_to_main_threshold;
+  int max_freq;
+  double fifo_size_ratio;
+  double ghost_size_ratio;
+} ConcurrentS3FIFO_params_t;
+
+static const char *DEFAULT_CACHE_PARAMS =
+    "fifo-size-ratio=0.10,ghost-size-ratio=0.90,move-to-main-threshold=2";
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void ConcurrentS3FIFO_parse_params(cache_t *cache,
+                                          const char *cache_specific_params);
+static void ConcurrentS3FIFO_free(cache_t *cache);
+static bool ConcurrentS3FIFO_get(cache_t *cache, const request_t *req);
+static cache_obj_t *ConcurrentS3FIFO_find(cache_t *cache, const request_t *req,
+                                          const bool update_cache);
+static cache_obj_t *ConcurrentS3FIFO_insert(cache_t *cache,
+                                            const request_t *req);
+static cache_obj_t *ConcurrentS3FIFO_to_evict(cache_t *cache,
+                                              const request_t *req);
+static void ConcurrentS3FIFO_evict(cache_t *cache, const request_t *req);
+static bool ConcurrentS3FIFO_remove(cache_t *cache, const obj_id_t obj_id);
+static bool ConcurrentS3FIFO_can_insert(cache_t *cache, const request_t *req);
+
+static bool ConcurrentS3FIFO_evict_one(cache_t *cache);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief initialize a ConcurrentS3FIFO cache
+ *
+ * @param ccache_params some common cache parameters, each FIFO holds at most
+ * 2^hashpower objects
+ * @param cache_specific_params the same parameters as S3FIFO
+ */
+cache_t *ConcurrentS3FIFO_init(const common_cache_params_t ccache_params,
+                               const char *cache_specific_params) {
+  cache_t *cache = concurrent_cache_struct_init(
+      "ConcurrentS3FIFO", ccache_params, cache_specific_params);
+  cache->cache_init = ConcurrentS3FIFO_init;
+  cache->cache_free = ConcurrentS3FIFO_free;
+  cache->get = ConcurrentS3FIFO_get;
+  cache->find = ConcurrentS3FIFO_find;
+  cache->insert = ConcurrentS3FIFO_insert;
+  cache->evict = ConcurrentS3FIFO_evict;
+  cache->remove = ConcurrentS3FIFO_remove;
+  cache->to_evict = ConcurrentS3FIFO_to_evict;
+  cache->get_occupied_byte = concurrent_cache_get_occupied_byte;
+  cache->get_n_obj = concurrent_cache_get_n_obj;
+  cache->can_insert = ConcurrentS3FIFO_can_insert;
+  cache->obj_md_size = 0;
+
+  cache->eviction_params = malloc(sizeof(ConcurrentS3FIFO_params_t));
+  memset(cache->eviction_params, 0, sizeof(ConcurrentS3FIFO_params_t));
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+
+  ConcurrentS3FIFO_parse_params(cache, DEFAULT_CACHE_PARAMS);
+  if (cache_specific_params != NULL) {
+    ConcurrentS3FIFO_parse_params(cache, cache_specific_params);
+  }
+  params->max_freq = MAX(3, params->move_to_main_threshold);
+
+  params->small_fifo_size =
+      (int64_t)(ccache_params.cache_size * params->fifo_size_ratio);
+  params->main_fifo_size = ccache_params.cache_size - params->small_fifo_size;
+
+  uint16_t hashpower = cache->hashpower;
+  params->hashtable = create_concurrent_hashtable(hashpower);
+  uint64_t capacity = concurrent_cache_queue_capacity(cache);
+  if (ring_queue_init(&params->small_fifo, capacity) != 0 ||
+      ring_queue_init(&params->main_fifo, capacity) != 0) {
+    ERROR("%s fails to allocate the queues\n", cache->cache_name);
+  }
+  params->ghost_table = my_malloc_n(uint64_t, hashsize(hashpower));
+  memset(params->ghost_table, 0, sizeof(uint64_t) * hashsize(hashpower));
+  params->ghost_mask = hashmask(hashpower);
+
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN,
+           "ConcurrentS3FIFO-%.4lf-%d", params->fifo_size_ratio,
+           params->move_to_main_threshold);
+
+  return cache;
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void ConcurrentS3FIFO_free(cache_t *cache) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+  concurrent_cache_free_queue(&params->small_fifo);
+  concurrent_cache_free_queue(&params->main_fifo);
+  my_free(sizeof(uint64_t) * (params->ghost_mask + 1), params->ghost_table);
+  free_concurrent_hashtable(params->hashtable);
+  free(cache->eviction_params);
+  cache_struct_free(cache);
+}
+
+static void ConcurrentS3FIFO_hit(cache_obj_t *obj, void *user_data) {
+  ConcurrentS3FIFO_params_t *params = (ConcurrentS3FIFO_params_t *)user_data;
+  int32_t *freq = concurrent_obj_freq(obj);
+  // the frequency is capped, so hits on popular objects only read the line
+  if (__atomic_load_n(freq, __ATOMIC_RELAXED) < params->max_freq) {
+    __atomic_fetch_add(freq, 1, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * @brief this function is the user facing API, it is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static bool ConcurrentS3FIFO_get(cache_t *cache, const request_t *req) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+
+  if (concurrent_hashtable_find(params->hashtable, req->obj_id,
+                                ConcurrentS3FIFO_hit, params)) {
+    return true;
+  }
+
+  if (cache->can_insert(cache, req)) {
+    ConcurrentS3FIFO_insert(cache, req);
+  }
+
+  return false;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                          ghost table                          ****
+// ****                                                               ****
+// ***********************************************************************
+
+/* an entry is the 32-bit fingerprint of the object followed by the 32-bit
+ * ghost time when it is inserted, 0 is an empty entry */
+static inline uint64_t _ghost_entry(const uint64_t hv, const uint32_t vtime) {
+  uint64_t fingerprint = (hv >> 32) | 1;
+  return (fingerprint << 32) | vtime;
+}
+
+static void ConcurrentS3FIFO_ghost_insert(ConcurrentS3FIFO_params_t *params,
+                                          const obj_id_t obj_id) {
+  uint64_t hv = get_hash_value_int_64(&obj_id);
+  uint32_t vtime =
+      __atomic_fetch_add(&params->ghost_vtime, 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&params->ghost_table[hv & params->ghost_mask],
+                   _ghost_entry(hv, vtime), __ATOMIC_RELAXED);
+}
+
+/* check whether the object is in the ghost and remove it */
+static bool ConcurrentS3FIFO_ghost_remove(cache_t *cache,
+                                          ConcurrentS3FIFO_params_t *params,
+                                          const obj_id_t obj_id) {
+  uint64_t hv = get_hash_value_int_64(&obj_id);
+  uint64_t *entry_ptr = &params->ghost_table[hv & params->ghost_mask];
+  uint64_t entry = __atomic_load_n(entry_ptr, __ATOMIC_RELAXED);
+  if (entry == 0 || (entry >> 32) != (_ghost_entry(hv, 0) >> 32)) {
+    return false;
+  }
+
+  // the ghost holds about as many objects as ghost-size-ratio of the cache
+  uint32_t age = __atomic_load_n(&params->ghost_vtime, __ATOMIC_RELAXED) -
+                 (uint32_t)entry;
+  double ghost_n_obj =
+      params->ghost_size_ratio * (double)concurrent_cache_get_n_obj(cache);
+  if ((double)age >= ghost_n_obj) {
+    return false;
+  }
+
+  return __atomic_compare_exchange_n(entry_ptr, &entry, 0, false,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****       developer facing APIs (used by cache developer)         ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief check whether an object is in the cache,
+ * the returned object is only safe to use in single-threaded mode
+ *
+ * @param cache
+ * @param req
+ * @param update_cache whether to update the frequency
+ * @return the object or NULL if not found
+ */
+static cache_obj_t *ConcurrentS3FIFO_find(cache_t *cache, const request_t *req,
+                                          const bool update_cache) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+  cache_obj_t *obj = concurrent_cache_find(params->hashtable, req->obj_id);
+  if (obj != NULL && update_cache) {
+    ConcurrentS3FIFO_hit(obj, params);
+  }
+  return obj;
+}
+
+
+/**
+ * @brief insert an object into the main FIFO if it is in the ghost, otherwise
+ * into the small FIFO, and evict until the cache has enough space,
+ * this function is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return the inserted object, NULL if another thread has inserted it
+ */
+static cache_obj_t *ConcurrentS3FIFO_insert(cache_t *cache,
+                                            const request_t *req) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+
+  bool hit_on_ghost =
+      ConcurrentS3FIFO_ghost_remove(cache, params, req->obj_id);
+  cache_obj_t *obj =
+      concurrent_cache_insert_obj(cache, params->hashtable, req);
+  if (obj == NULL) {
+    return NULL;
+  }
+  *concurrent_obj_freq(obj) = 0;
+
+  // the new object is not in the queues yet, so it is not evicted here
+  while (concurrent_cache_get_occupied_byte(cache) > cache->cache_size) {
+    if (!ConcurrentS3FIFO_evict_one(cache)) {
+      // other threads have popped all objects and will free the space
+      break;
+    }
+  }
+
+  struct ring_queue *queue = &params->small_fifo;
+  int64_t *queue_byte = &params->small_fifo_byte;
+  if (hit_on_ghost) {
+    queue = &params->main_fifo;
+    queue_byte = &params->main_fifo_byte;
+  }
+  while (!ring_queue_push(queue, obj)) {
+    ConcurrentS3FIFO_evict_one(cache);
+  }
+  __atomic_fetch_add(queue_byte, concurrent_obj_byte(cache, obj),
+                     __ATOMIC_RELAXED);
+
+  return obj;
+}
+
+/**
+ * @brief find the object to be evicted, not supported because the queues
+ * can be popped by another thread at any time
+ */
+static cache_obj_t *ConcurrentS3FIFO_to_evict(cache_t *cache,
+                                              const request_t *req) {
+  assert(false);
+  return NULL;
+}
+
+/* evict from the small FIFO, objects accessed at least
+ * move-to-main-threshold times are moved to the main FIFO */
+static bool ConcurrentS3FIFO_evict_small(cache_t *cache) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+
+  while (true) {
+    cache_obj_t *obj = ring_queue_pop(&params->small_fifo);
+    if (obj == NULL) {
+      return false;
+    }
+    __atomic_fetch_sub(&params->small_fifo_byte,
+                       concurrent_obj_byte(cache, obj), __ATOMIC_RELAXED);
+
+    int32_t *freq = concurrent_obj_freq(obj);
+    if (__atomic_exchange_n(freq, 0, __ATOMIC_RELAXED) >=
+        params->move_to_main_threshold) {
+      if (ring_queue_push(&params->main_fifo, obj)) {
+        __atomic_fetch_add(&params->main_fifo_byte,
+                           concurrent_obj_byte(cache, obj), __ATOMIC_RELAXED);
+        continue;
+      }
+      // the main FIFO has been filled by other threads, evict this object
+      concurrent_cache_evict_obj(cache, params->hashtable, obj);
+      return true;
+    }
+
+    ConcurrentS3FIFO_ghost_insert(params, obj->obj_id);
+    concurrent_cache_evict_obj(cache, params->hashtable, obj);
+    return true;
+  }
+}
+
+/* evict from the main FIFO, accessed objects are pushed back with the
+ * frequency decremented */
+static bool ConcurrentS3FIFO_evict_main(cache_t *cache) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+
+  while (true) {
+    cache_obj_t *obj = ring_queue_pop(&params->main_fifo);
+    if (obj == NULL) {
+      return false;
+    }
+
+    int32_t *freq = concurrent_obj_freq(obj);
+    int32_t curr_freq = __atomic_load_n(freq, __ATOMIC_RELAXED);
+    if (curr_freq >= 1) {
+      // clock with 2-bit counter
+      __atomic_store_n(freq, MIN(curr_freq, 3) - 1, __ATOMIC_RELAXED);
+      if (ring_queue_push(&params->main_fifo, obj)) {
+        continue;
+      }
+      // the queue has been filled by other threads, evict this object
+    }
+
+    __atomic_fetch_sub(&params->main_fifo_byte,
+                       concurrent_obj_byte(cache, obj), __ATOMIC_RELAXED);
+    concurrent_cache_evict_obj(cache, params->hashtable, obj);
+    return true;
+  }
+}
+
+/**
+ * @brief evict one object, from the main FIFO if it is larger than its
+ * share or the small FIFO is empty, otherwise from the small FIFO
+ *
+ * @return false if both queues are empty
+ */
+static bool ConcurrentS3FIFO_evict_one(cache_t *cache) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+
+  if (__atomic_load_n(&params->main_fifo_byte, __ATOMIC_RELAXED) >
+          params->main_fifo_size ||
+      __atomic_load_n(&params->small_fifo_byte, __ATOMIC_RELAXED) == 0) {
+    return ConcurrentS3FIFO_evict_main(cache) ||
+           ConcurrentS3FIFO_evict_small(cache);
+  }
+  return ConcurrentS3FIFO_evict_small(cache) ||
+         ConcurrentS3FIFO_evict_main(cache);
+}
+
+/**
+ * @brief evict an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param req not used
+ */
+static void ConcurrentS3FIFO_evict(cache_t *cache, const request_t *req) {
+  ConcurrentS3FIFO_evict_one(cache);
+}
+
+/**
+ * @brief remove an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param obj_id
+ * @return true if the object is removed, false if the object is not in the
+ * cache
+ */
+static bool ConcurrentS3FIFO_remove(cache_t *cache, const obj_id_t obj_id) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+  return concurrent_cache_remove(cache, params->hashtable, obj_id);
+}
+
+static bool ConcurrentS3FIFO_can_insert(cache_t *cache, const request_t *req) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)cache->eviction_params;
+
+  return (int64_t)req->obj_size + (int64_t)cache->obj_md_size <=
+         params->small_fifo_size;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                parameter set up functions                     ****
+// ****                                                               ****
+// ***********************************************************************
+static const char *ConcurrentS3FIFO_current_params(
+    ConcurrentS3FIFO_params_t *params) {
+  static __thread char params_str[128];
+  snprintf(params_str, 128,
+           "fifo-size-ratio=%.4lf,ghost-size-ratio=%.4lf,"
+           "move-to-main-threshold=%d\n",
+           params->fifo_size_ratio, params->ghost_size_ratio,
+           params->move_to_main_threshold);
+  return params_str;
+}
+
+static void ConcurrentS3FIFO_parse_params(cache_t *cache,
+                                          const char *cache_specific_params) {
+  ConcurrentS3FIFO_params_t *params =
+      (ConcurrentS3FIFO_params_t *)(cache->eviction_params);
+
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "fifo-size-ratio") == 0) {
+      params->fifo_size_ratio = strtod(value, NULL);
+    } else if (strcasecmp(key, "ghost-size-ratio") == 0) {
+      params->ghost_size_ratio = strtod(value, NULL);
+    } else if (strcasecmp(key, "move-to-main-threshold") == 0) {
+      params->move_to_main_threshold = atoi(value);
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("parameters: %s\n", ConcurrentS3FIFO_current_params(params));
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s\n", cache->cache_name, key);
+      exit(1);
+    }
+  }
+
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,285 @@
+//
+//  a thread-safe Sieve, a hit sets the atomic visited bit without taking the
+//  queue lock. Sieve evicts from the middle of the queue and keeps visited
+//  objects in place, which a ring queue cannot do, so the list and the hand
+//  are protected by a lock that is only taken on misses
+//  see concurrentCache.h for the design shared by the concurrent algorithms
+//
+//
+//  ConcurrentSieve.c
+//  libCacheSim
+//
+
+#include "concurrentCache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  concurrent_hashtable_t *hashtable;
+
+  pthread_mutex_t lock;
+  cache_obj_t *q_head;
+  cache_obj_t *q_tail;
+  cache_obj_t *pointer;
+} ConcurrentSieve_params_t;
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void ConcurrentSieve_free(cache_t *cache);
+static bool ConcurrentSieve_get(cache_t *cache, const request_t *req);
+static cache_obj_t *ConcurrentSieve_find(cache_t *cache, const request_t *req,
+                                         const bool update_cache);
+static cache_obj_t *ConcurrentSieve_insert(cache_t *cache,
+                                           const request_t *req);
+static cache_obj_t *ConcurrentSieve_to_evict(cache_t *cache,
+                                             const request_t *req);
+static void ConcurrentSieve_evict(cache_t *cache, const request_t *req);
+static bool ConcurrentSieve_remove(cache_t *cache, const obj_id_t obj_id);
+
+static void ConcurrentSieve_evict_locked(cache_t *cache);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ****                       init, free, get                         ****
+// ***********************************************************************
+
+/**
+ * @brief initialize a ConcurrentSieve cache
+ *
+ * @param ccache_params some common cache parameters
+ * @param cache_specific_params not used
+ */
+cache_t *ConcurrentSieve_init(const common_cache_params_t ccache_params,
+                              const char *cache_specific_params) {
+  cache_t *cache = concurrent_cache_struct_init(
+      "ConcurrentSieve", ccache_params, cache_specific_params);
+  cache->cache_init = ConcurrentSieve_init;
+  cache->cache_free = ConcurrentSieve_free;
+  cache->get = ConcurrentSieve_get;
+  cache->find = ConcurrentSieve_find;
+  cache->insert = ConcurrentSieve_insert;
+  cache->evict = ConcurrentSieve_evict;
+  cache->remove = ConcurrentSieve_remove;
+  cache->to_evict = ConcurrentSieve_to_evict;
+  cache->get_occupied_byte = concurrent_cache_get_occupied_byte;
+  cache->get_n_obj = concurrent_cache_get_n_obj;
+  cache->can_insert = concurrent_cache_can_insert;
+
+  if (ccache_params.consider_obj_metadata) {
+    cache->obj_md_size = 1;
+  } else {
+    cache->obj_md_size = 0;
+  }
+
+  cache->eviction_params = malloc(sizeof(ConcurrentSieve_params_t));
+  memset(cache->eviction_params, 0, sizeof(ConcurrentSieve_params_t));
+  ConcurrentSieve_params_t *params =
+      (ConcurrentSieve_params_t *)cache->eviction_params;
+  params->hashtable = create_concurrent_hashtable(cache->hashpower);
+  pthread_mutex_init(&params->lock, NULL);
+  params->q_head = NULL;
+  params->q_tail = NULL;
+  params->pointer = NULL;
+
+  return cache;
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void ConcurrentSieve_free(cache_t *cache) {
+  ConcurrentSieve_params_t *params =
+      (ConcurrentSieve_params_t *)cache->eviction_params;
+  cache_obj_t *obj = params->q_head;
+  while (obj != NULL) {
+    cache_obj_t *next_obj = obj->queue.next;
+    free_cache_obj(obj);
+    obj = next_obj;
+  }
+  pthread_mutex_destroy(&params->lock);
+  free_concurrent_hashtable(params->hashtable);
+  free(cache->eviction_params);
+  cache_struct_free(cache);
+}
+
+static void ConcurrentSieve_hit(cache_obj_t *obj, void *user_data) {
+  int32_t *visited = concurrent_obj_freq(obj);
+  // read before write so that hits on popular objects do not bounce the line
+  if (__atomic_load_n(visited, __ATOMIC_RELAXED) == 0) {
+    __atomic_store_n(visited, 1, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * @brief this function is the user facing API, it is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static bool ConcurrentSieve_get(cache_t *cache, const request_t *req) {
+  ConcurrentSieve_params_t *params =
+      (ConcurrentSieve_params_t *)cache->eviction_params;
+
+  if (concurrent_hashtable_find(params->hashtable, req->obj_id,
+                                ConcurrentSieve_hit, NULL)) {
+    return true;
+  }
+
+  if (cache->can_insert(cache, req)) {
+    ConcurrentSieve_insert(cache, req);
+  }
+
+  return false;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****       developer facing APIs (used by cache developer)         ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief check whether an object is in the cache,
+ * the returned object is only safe to use in single-threaded mode
+ *
+ * @param cache
+ * @param req
+ * @param update_cache whether to update the visited bit
+ * @return the object or NULL if not found
+ */
+static cache_obj_t *ConcurrentSieve_find(cache_t *cache, const request_t *req,
+                                         const bool update_cache) {
+  ConcurrentSieve_params_t *params =
+      (ConcurrentSieve_params_t *)cache->eviction_params;
+  cache_obj_t *obj = concurrent_cache_find(params->hashtable, req->obj_id);
+  if (obj != NULL && update_cache) {
+    ConcurrentSieve_hit(obj, NULL);
+  }
+  return obj;
+}
+
+/**
+ * @brief insert an object into the cache and evict until the cache has
+ * enough space, this function is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return the inserted object, NULL if another thread has inserted it
+ */
+static cache_obj_t *ConcurrentSieve_insert(cache_t *cache,
+                                           const request_t *req) {
+  ConcurrentSieve_params_t *params =
+      (ConcurrentSieve_params_t *)cache->eviction_params;
+
+  pthread_mutex_lock(&params->lock);
+  // the object is inserted into the hashtable under the lock so that a
+  // concurrent remove never finds an object that is not in the list
+  cache_obj_t *obj =
+      concurrent_cache_insert_obj(cache, params->hashtable, req);
+  if (obj == NULL) {
+    pthread_mutex_unlock(&params->lock);
+    return NULL;
+  }
+
+  while (concurrent_cache_get_occupied_byte(cache) > cache->cache_size &&
+         params->q_tail != NULL) {
+    ConcurrentSieve_evict_locked(cache);
+  }
+  prepend_obj_to_head(&params->q_head, &params->q_tail, obj);
+  pthread_mutex_unlock(&params->lock);
+
+  return obj;
+}
+
+/**
+ * @brief find the object to be evicted, not supported because the hand can
+ * be moved by another thread at any time
+ */
+static cache_obj_t *ConcurrentSieve_to_evict(cache_t *cache,
+                                             const request_t *req) {
+  assert(false);
+  return NULL;
+}
+
+/* move the hand to the first object not visited and evict it, the caller
+ * holds the lock */
+static void ConcurrentSieve_evict_locked(cache_t *cache) {
+  ConcurrentSieve_params_t *params =
+      (ConcurrentSieve_params_t *)cache->eviction_params;
+
+  /* if we have run one full around or first eviction */
+  cache_obj_t *obj = params->pointer == NULL ? params->q_tail : params->pointer;
+
+  while (__atomic_exchange_n(concurrent_obj_freq(obj), 0, __ATOMIC_RELAXED) >
+         0) {
+    obj = obj->queue.prev == NULL ? params->q_tail : obj->queue.prev;
+  }
+
+  params->pointer = obj->queue.prev;
+  remove_obj_from_list(&params->q_head, &params->q_tail, obj);
+  concurrent_cache_evict_obj(cache, params->hashtable, obj);
+}
+
+/**
+ * @brief evict an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param req not used
+ */
+static void ConcurrentSieve_evict(cache_t *cache, const request_t *req) {
+  ConcurrentSieve_params_t *params =
+      (ConcurrentSieve_params_t *)cache->eviction_params;
+
+  pthread_mutex_lock(&params->lock);
+  if (params->q_tail != NULL) {
+    ConcurrentSieve_evict_locked(cache);
+  }
+  pthread_mutex_unlock(&params->lock);
+}
+
+/**
+ * @brief remove an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param obj_id
+ * @return true if the object is removed, false if the object is not in the
+ * cache
+ */
+static bool ConcurrentSieve_remove(cache_t *cache, const obj_id_t obj_id) {
+  ConcurrentSieve_params_t *params =
+      (ConcurrentSieve_params_t *)cache->eviction_params;
+
+  pthread_mutex_lock(&params->lock);
+  cache_obj_t *obj = NULL;
+  concurrent_hashtable_delete_obj_id(params->hashtable, obj_id,
+                                     _concurrent_cache_save_obj_func, &obj);
+  if (obj == NULL) {
+    pthread_mutex_unlock(&params->lock);
+    return false;
+  }
+
+  if (obj == params->pointer) {
+    params->pointer = obj->queue.prev;
+  }
+  remove_obj_from_list(&params->q_head, &params->q_tail, obj);
+  concurrent_cache_add(cache, -concurrent_obj_byte(cache, obj), -1);
+  free_cache_obj(obj);
+  pthread_mutex_unlock(&params->lock);
+
+  return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
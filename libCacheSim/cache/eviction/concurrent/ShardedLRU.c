@@ -0,0 +1,506 @@
+//
+//  a thread-safe LRU with n independently locked shards, an object belongs to
+//  the shard chosen by its hash and each shard has 1/n of the cache size
+//
+//  promotion is deferred as in Caffeine: a hit looks up the concurrent
+//  hashtable and records the object id in a read buffer of the shard without
+//  taking the shard lock. The buffers are drained under the shard lock before
+//  each insert, and when a buffer is full. If the shard lock is held by
+//  another thread, the hit is dropped, so LRU is approximate under contention
+//
+//  single-threaded, the buffered hits are applied in order before the next
+//  eviction, so ShardedLRU with one shard has the same miss ratio as LRU
+//  see concurrentCache.h for the design shared by the concurrent algorithms
+//
+//
+//  ShardedLRU.c
+//  libCacheSim
+//
+
+#include "../../../dataStructure/hash/hash.h"
+#include "concurrentCache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the number of read buffers per shard, threads are spread over the buffers
+ * to reduce the contention on the buffer tail */
+#define SHARDED_LRU_N_READ_BUFFER 16
+
+typedef struct {
+  obj_id_t obj_id;
+  uint64_t full;
+} read_buffer_slot_t;
+
+/* a lossy bounded buffer, many threads add object ids, the thread holding the
+ * shard lock drains it */
+typedef struct {
+  uint64_t head;
+  char pad0[56];
+  uint64_t tail;
+  read_buffer_slot_t *slots;
+} __attribute__((aligned(64))) read_buffer_t;
+
+typedef struct {
+  pthread_mutex_t lock;
+  cache_obj_t *q_head;
+  cache_obj_t *q_tail;
+  int64_t occupied_byte;
+  int64_t cache_size;
+  read_buffer_t *read_buffers;
+} __attribute__((aligned(64))) lru_shard_t;
+
+typedef struct {
+  concurrent_hashtable_t *hashtable;
+  lru_shard_t *shards;
+
+  int n_shard;
+  int read_buffer_size;
+} ShardedLRU_params_t;
+
+static const char *DEFAULT_PARAMS = "n-shard=16,read-buffer-size=16";
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void ShardedLRU_parse_params(cache_t *cache,
+                                    const char *cache_specific_params);
+static void ShardedLRU_free(cache_t *cache);
+static bool ShardedLRU_get(cache_t *cache, const request_t *req);
+static cache_obj_t *ShardedLRU_find(cache_t *cache, const request_t *req,
+                                    const bool update_cache);
+static cache_obj_t *ShardedLRU_insert(cache_t *cache, const request_t *req);
+static cache_obj_t *ShardedLRU_to_evict(cache_t *cache, const request_t *req);
+static void ShardedLRU_evict(cache_t *cache, const request_t *req);
+static bool ShardedLRU_remove(cache_t *cache, const obj_id_t obj_id);
+static bool ShardedLRU_can_insert(cache_t *cache, const request_t *req);
+
+static void ShardedLRU_init_shards(cache_t *cache);
+static void ShardedLRU_drain_locked(ShardedLRU_params_t *params,
+                                    lru_shard_t *shard);
+static void ShardedLRU_evict_locked(cache_t *cache, lru_shard_t *shard);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ****                       init, free, get                         ****
+// ***********************************************************************
+
+/**
+ * @brief initialize a ShardedLRU cache
+ *
+ * @param ccache_params some common cache parameters
+ * @param cache_specific_params ShardedLRU specific parameters, see
+ * parse_params
+ */
+cache_t *ShardedLRU_init(const common_cache_params_t ccache_params,
+                         const char *cache_specific_params) {
+  cache_t *cache = concurrent_cache_struct_init(
+      "ShardedLRU", ccache_params, cache_specific_params);
+  cache->cache_init = ShardedLRU_init;
+  cache->cache_free = ShardedLRU_free;
+  cache->get = ShardedLRU_get;
+  cache->find = ShardedLRU_find;
+  cache->insert = ShardedLRU_insert;
+  cache->evict = ShardedLRU_evict;
+  cache->remove = ShardedLRU_remove;
+  cache->to_evict = ShardedLRU_to_evict;
+  cache->get_occupied_byte = concurrent_cache_get_occupied_byte;
+  cache->get_n_obj = concurrent_cache_get_n_obj;
+  cache->can_insert = ShardedLRU_can_insert;
+
+  if (ccache_params.consider_obj_metadata) {
+    cache->obj_md_size = 8 * 2;
+  } else {
+    cache->obj_md_size = 0;
+  }
+
+  cache->eviction_params = malloc(sizeof(ShardedLRU_params_t));
+  memset(cache->eviction_params, 0, sizeof(ShardedLRU_params_t));
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  params->hashtable = create_concurrent_hashtable(cache->hashpower);
+
+  ShardedLRU_parse_params(cache, DEFAULT_PARAMS);
+  if (cache_specific_params != NULL) {
+    ShardedLRU_parse_params(cache, cache_specific_params);
+  }
+  ShardedLRU_init_shards(cache);
+
+  if (params->n_shard != 16) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "ShardedLRU-%d",
+             params->n_shard);
+  }
+
+  return cache;
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void ShardedLRU_free(cache_t *cache) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  for (int i = 0; i < params->n_shard; i++) {
+    lru_shard_t *shard = &params->shards[i];
+    cache_obj_t *obj = shard->q_head;
+    while (obj != NULL) {
+      cache_obj_t *next_obj = obj->queue.next;
+      free_cache_obj(obj);
+      obj = next_obj;
+    }
+    for (int j = 0; j < SHARDED_LRU_N_READ_BUFFER; j++) {
+      free(shard->read_buffers[j].slots);
+    }
+    free(shard->read_buffers);
+    pthread_mutex_destroy(&shard->lock);
+  }
+  free(params->shards);
+  free_concurrent_hashtable(params->hashtable);
+  free(cache->eviction_params);
+  cache_struct_free(cache);
+}
+
+/* each thread uses the read buffer of its stripe in every shard */
+static __thread int32_t thread_stripe = -1;
+static int32_t n_thread_stripe = 0;
+
+static inline lru_shard_t *ShardedLRU_get_shard(ShardedLRU_params_t *params,
+                                                const obj_id_t obj_id) {
+  /* the hashtable uses the low bits, the shard uses the high bits */
+  uint64_t hv = get_hash_value_int_64(&obj_id) >> 32;
+  return &params->shards[hv % params->n_shard];
+}
+
+/* add the object id to the read buffer, return false if the buffer is full */
+static inline bool ShardedLRU_read_buffer_offer(ShardedLRU_params_t *params,
+                                                read_buffer_t *buf,
+                                                const obj_id_t obj_id) {
+  uint64_t tail = __atomic_load_n(&buf->tail, __ATOMIC_RELAXED);
+  do {
+    if (tail - __atomic_load_n(&buf->head, __ATOMIC_ACQUIRE) >=
+        (uint64_t)params->read_buffer_size) {
+      return false;
+    }
+  } while (!__atomic_compare_exchange_n(&buf->tail, &tail, tail + 1, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+  read_buffer_slot_t *slot =
+      &buf->slots[tail & (uint64_t)(params->read_buffer_size - 1)];
+  slot->obj_id = obj_id;
+  __atomic_store_n(&slot->full, 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+/* record a hit, the object is promoted when the read buffer is drained */
+static void ShardedLRU_record_hit(ShardedLRU_params_t *params,
+                                  const obj_id_t obj_id) {
+  if (thread_stripe == -1) {
+    thread_stripe = __atomic_fetch_add(&n_thread_stripe, 1, __ATOMIC_RELAXED);
+  }
+  lru_shard_t *shard = ShardedLRU_get_shard(params, obj_id);
+  read_buffer_t *buf = &shard->read_buffers[thread_stripe &
+                                            (SHARDED_LRU_N_READ_BUFFER - 1)];
+
+  if (ShardedLRU_read_buffer_offer(params, buf, obj_id)) {
+    return;
+  }
+
+  // the buffer is full, drain it unless another thread holds the lock, in
+  // which case the hit is dropped
+  if (pthread_mutex_trylock(&shard->lock) == 0) {
+    ShardedLRU_drain_locked(params, shard);
+    ShardedLRU_read_buffer_offer(params, buf, obj_id);
+    pthread_mutex_unlock(&shard->lock);
+  }
+}
+
+/**
+ * @brief this function is the user facing API, it is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static bool ShardedLRU_get(cache_t *cache, const request_t *req) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+
+  if (concurrent_hashtable_find(params->hashtable, req->obj_id, NULL, NULL)) {
+    ShardedLRU_record_hit(params, req->obj_id);
+    return true;
+  }
+
+  if (cache->can_insert(cache, req)) {
+    ShardedLRU_insert(cache, req);
+  }
+
+  return false;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****       developer facing APIs (used by cache developer)         ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief check whether an object is in the cache,
+ * the returned object is only safe to use in single-threaded mode
+ *
+ * @param cache
+ * @param req
+ * @param update_cache whether to record the hit for promotion
+ * @return the object or NULL if not found
+ */
+static cache_obj_t *ShardedLRU_find(cache_t *cache, const request_t *req,
+                                    const bool update_cache) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  cache_obj_t *obj = concurrent_cache_find(params->hashtable, req->obj_id);
+  if (obj != NULL && update_cache) {
+    ShardedLRU_record_hit(params, req->obj_id);
+  }
+  return obj;
+}
+
+/**
+ * @brief insert an object into its shard and evict from the shard until the
+ * shard has enough space, this function is thread-safe
+ *
+ * @param cache
+ * @param req
+ * @return the inserted object, NULL if another thread has inserted it
+ */
+static cache_obj_t *ShardedLRU_insert(cache_t *cache, const request_t *req) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  lru_shard_t *shard = ShardedLRU_get_shard(params, req->obj_id);
+
+  pthread_mutex_lock(&shard->lock);
+  // apply the buffered hits before choosing the objects to evict
+  ShardedLRU_drain_locked(params, shard);
+
+  cache_obj_t *obj =
+      concurrent_cache_insert_obj(cache, params->hashtable, req);
+  if (obj == NULL) {
+    pthread_mutex_unlock(&shard->lock);
+    return NULL;
+  }
+
+  shard->occupied_byte += concurrent_obj_byte(cache, obj);
+  while (shard->occupied_byte > shard->cache_size && shard->q_tail != NULL) {
+    ShardedLRU_evict_locked(cache, shard);
+  }
+  prepend_obj_to_head(&shard->q_head, &shard->q_tail, obj);
+  pthread_mutex_unlock(&shard->lock);
+
+  return obj;
+}
+
+/**
+ * @brief find the least recently used object in the shard of the request,
+ * the returned object is only safe to use in single-threaded mode
+ *
+ * @param cache
+ * @param req
+ * @return the object to be evicted
+ */
+static cache_obj_t *ShardedLRU_to_evict(cache_t *cache, const request_t *req) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  lru_shard_t *shard = ShardedLRU_get_shard(params, req->obj_id);
+
+  pthread_mutex_lock(&shard->lock);
+  ShardedLRU_drain_locked(params, shard);
+  cache_obj_t *obj = shard->q_tail;
+  pthread_mutex_unlock(&shard->lock);
+
+  return obj;
+}
+
+/* apply the hits recorded in the read buffers of the shard, the caller holds
+ * the shard lock, so the objects of the shard cannot be freed meanwhile */
+static void ShardedLRU_drain_locked(ShardedLRU_params_t *params,
+                                    lru_shard_t *shard) {
+  uint64_t mask = (uint64_t)(params->read_buffer_size - 1);
+  for (int i = 0; i < SHARDED_LRU_N_READ_BUFFER; i++) {
+    read_buffer_t *buf = &shard->read_buffers[i];
+    uint64_t head = buf->head;
+    uint64_t tail = __atomic_load_n(&buf->tail, __ATOMIC_ACQUIRE);
+    while (head < tail) {
+      read_buffer_slot_t *slot = &buf->slots[head & mask];
+      if (__atomic_load_n(&slot->full, __ATOMIC_ACQUIRE) == 0) {
+        // the writer has reserved the slot but not written it yet
+        break;
+      }
+      obj_id_t obj_id = slot->obj_id;
+      __atomic_store_n(&slot->full, 0, __ATOMIC_RELAXED);
+      head++;
+
+      // the object may have been evicted after the hit was recorded
+      cache_obj_t *obj = concurrent_cache_find(params->hashtable, obj_id);
+      if (obj != NULL) {
+        move_obj_to_head(&shard->q_head, &shard->q_tail, obj);
+      }
+    }
+    __atomic_store_n(&buf->head, head, __ATOMIC_RELEASE);
+  }
+}
+
+/* evict the least recently used object of the shard, the caller holds the
+ * shard lock */
+static void ShardedLRU_evict_locked(cache_t *cache, lru_shard_t *shard) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  cache_obj_t *obj = shard->q_tail;
+  shard->occupied_byte -= concurrent_obj_byte(cache, obj);
+  remove_obj_from_list(&shard->q_head, &shard->q_tail, obj);
+  concurrent_cache_evict_obj(cache, params->hashtable, obj);
+}
+
+/**
+ * @brief evict the least recently used object in the shard of the request,
+ * this function is thread-safe
+ *
+ * @param cache
+ * @param req
+ */
+static void ShardedLRU_evict(cache_t *cache, const request_t *req) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  lru_shard_t *shard = ShardedLRU_get_shard(params, req->obj_id);
+
+  pthread_mutex_lock(&shard->lock);
+  ShardedLRU_drain_locked(params, shard);
+  if (shard->q_tail != NULL) {
+    ShardedLRU_evict_locked(cache, shard);
+  }
+  pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * @brief remove an object from the cache, this function is thread-safe
+ *
+ * @param cache
+ * @param obj_id
+ * @return true if the object is removed, false if the object is not in the
+ * cache
+ */
+static bool ShardedLRU_remove(cache_t *cache, const obj_id_t obj_id) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  lru_shard_t *shard = ShardedLRU_get_shard(params, obj_id);
+
+  pthread_mutex_lock(&shard->lock);
+  cache_obj_t *obj = NULL;
+  concurrent_hashtable_delete_obj_id(params->hashtable, obj_id,
+                                     _concurrent_cache_save_obj_func, &obj);
+  if (obj == NULL) {
+    pthread_mutex_unlock(&shard->lock);
+    return false;
+  }
+
+  shard->occupied_byte -= concurrent_obj_byte(cache, obj);
+  remove_obj_from_list(&shard->q_head, &shard->q_tail, obj);
+  concurrent_cache_add(cache, -concurrent_obj_byte(cache, obj), -1);
+  free_cache_obj(obj);
+  pthread_mutex_unlock(&shard->lock);
+
+  return true;
+}
+
+/* an object can only use the space of its shard */
+static bool ShardedLRU_can_insert(cache_t *cache, const request_t *req) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  return (int64_t)req->obj_size + (int64_t)cache->obj_md_size <=
+         cache->cache_size / params->n_shard;
+}
+
+static void ShardedLRU_init_shards(cache_t *cache) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+
+  params->shards =
+      aligned_alloc(64, sizeof(lru_shard_t) * (size_t)params->n_shard);
+  if (params->shards == NULL) {
+    ERROR("%s fails to allocate the shards\n", cache->cache_name);
+  }
+  memset(params->shards, 0, sizeof(lru_shard_t) * (size_t)params->n_shard);
+
+  for (int i = 0; i < params->n_shard; i++) {
+    lru_shard_t *shard = &params->shards[i];
+    pthread_mutex_init(&shard->lock, NULL);
+    shard->cache_size = cache->cache_size / params->n_shard;
+    shard->read_buffers = aligned_alloc(
+        64, sizeof(read_buffer_t) * SHARDED_LRU_N_READ_BUFFER);
+    memset(shard->read_buffers, 0,
+           sizeof(read_buffer_t) * SHARDED_LRU_N_READ_BUFFER);
+    for (int j = 0; j < SHARDED_LRU_N_READ_BUFFER; j++) {
+      shard->read_buffers[j].slots =
+          calloc(params->read_buffer_size, sizeof(read_buffer_slot_t));
+    }
+  }
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  parameter set up functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+static const char *ShardedLRU_current_params(ShardedLRU_params_t *params) {
+  static __thread char params_str[128];
+  snprintf(params_str, 128, "n-shard=%d,read-buffer-size=%d\n",
+           params->n_shard, params->read_buffer_size);
+
+  return params_str;
+}
+
+static void ShardedLRU_parse_params(cache_t *cache,
+                                    const char *cache_specific_params) {
+  ShardedLRU_params_t *params = (ShardedLRU_params_t *)cache->eviction_params;
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "n-shard") == 0) {
+      params->n_shard = (int)strtol(value, &end, 0);
+      if (params->n_shard < 1) {
+        ERROR("n-shard should be positive, but got %d\n", params->n_shard);
+      }
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    } else if (strcasecmp(key, "read-buffer-size") == 0) {
+      params->read_buffer_size = (int)strtol(value, &end, 0);
+      if (params->read_buffer_size < 1 ||
+          (params->read_buffer_size & (params->read_buffer_size - 1)) != 0) {
+        ERROR("read-buffer-size should be a power of 2, but got %d\n",
+              params->read_buffer_size);
+      }
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: %s\n", ShardedLRU_current_params(params));
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s, example paramters %s\n",
+            cache->cache_name, key, ShardedLRU_current_params(params));
+      exit(1);
+    }
+  }
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
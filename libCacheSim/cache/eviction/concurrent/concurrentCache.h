@@ -0,0 +1,172 @@
+//
+// helpers shared by the concurrent eviction algorithms
+//
+// the concurrent algorithms can be used by many threads at the same time
+// through cache->get and cache->remove:
+//   the objects are indexed by a concurrent_hashtable_t with striped locks,
+//   a hit only locks one bucket and sets the atomic visited bit / frequency
+//   the eviction queues are lock-free ring queues (Sieve and ShardedLRU
+//   use locked lists)
+//   n_obj and occupied_byte are updated with atomic operations
+//
+// memory ownership: an object is freed only by the thread that pops it from
+// the queue, and only after it has been deleted from the hashtable, so the
+// hit path (which runs under the bucket lock) never sees a freed object. An
+// object removed by cache->remove stays in the queue until it is popped
+//
+// limitations: cache->n_req is not updated (it would be one contended
+// counter), admission and prefetching are not supported, and the object
+// returned by find can be freed by another thread, so it is only for
+// single-threaded use. The occupied bytes can exceed the cache size by the
+// objects being inserted when all queued objects have been popped by other
+// threads
+//
+
+#pragma once
+
+#include "../../../dataStructure/concurrentRingQueue.h"
+#include "../../../dataStructure/hashtable/concurrentHashTable.h"
+#include "../../../dataStructure/hashtable/hashtable.h"
+#include "../../../include/libCacheSim/evictionAlgo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief create the cache struct, the objects are indexed by the concurrent
+ * hashtable of the algorithm, so the hashtable of cache_struct_init is freed,
+ * cache->hashpower is the hashpower for the concurrent hashtable
+ */
+static inline cache_t *concurrent_cache_struct_init(
+    const char *cache_name, const common_cache_params_t params,
+    const void *init_params) {
+  cache_t *cache = cache_struct_init(cache_name, params, init_params);
+  free_hashtable(cache->hashtable);
+  cache->hashtable = NULL;
+  return cache;
+}
+
+/* cache_obj_t is packed, the metadata is 4-byte aligned in practice, cast
+ * through void * to use the atomic builtins */
+static inline int32_t *concurrent_obj_freq(cache_obj_t *obj) {
+  return (int32_t *)(void *)&obj->concurrent.freq;
+}
+
+static inline int64_t concurrent_obj_byte(const cache_t *cache,
+                                          const cache_obj_t *obj) {
+  return (int64_t)obj->obj_size + (int64_t)cache->obj_md_size;
+}
+
+static inline bool concurrent_cache_can_insert(cache_t *cache,
+                                               const request_t *req) {
+  return (int64_t)req->obj_size + (int64_t)cache->obj_md_size <=
+         cache->cache_size;
+}
+
+/* add n_byte and n_obj to the cache, return the occupied bytes after adding */
+static inline int64_t concurrent_cache_add(cache_t *cache, int64_t n_byte,
+                                           int64_t n_obj) {
+  __atomic_fetch_add(&cache->n_obj, n_obj, __ATOMIC_RELAXED);
+  return __atomic_add_fetch(&cache->occupied_byte, n_byte, __ATOMIC_RELAXED);
+}
+
+static inline int64_t concurrent_cache_get_occupied_byte(
+    const cache_t *cache) {
+  return __atomic_load_n(&cache->occupied_byte, __ATOMIC_RELAXED);
+}
+
+static inline int64_t concurrent_cache_get_n_obj(const cache_t *cache) {
+  return __atomic_load_n(&cache->n_obj, __ATOMIC_RELAXED);
+}
+
+static inline void _concurrent_cache_save_obj_func(cache_obj_t *obj,
+                                                   void *user_data) {
+  *(cache_obj_t **)user_data = obj;
+}
+
+/**
+ * @brief find an object without updating it, the returned object can be
+ * evicted by another thread at any time, so this is for single-threaded use
+ */
+static inline cache_obj_t *concurrent_cache_find(
+    concurrent_hashtable_t *hashtable, const obj_id_t obj_id) {
+  cache_obj_t *obj = NULL;
+  concurrent_hashtable_find(hashtable, obj_id, _concurrent_cache_save_obj_func,
+                            &obj);
+  return obj;
+}
+
+/**
+ * @brief create an object from the request and insert it into the hashtable
+ *
+ * @return the object, NULL if another thread has inserted the same object
+ */
+static inline cache_obj_t *concurrent_cache_insert_obj(
+    cache_t *cache, concurrent_hashtable_t *hashtable, const request_t *req) {
+  cache_obj_t *obj = create_cache_obj_from_request(req);
+  if (!concurrent_hashtable_insert_obj(hashtable, obj)) {
+    free_cache_obj(obj);
+    return NULL;
+  }
+  concurrent_cache_add(cache, concurrent_obj_byte(cache, obj), 1);
+  return obj;
+}
+
+/**
+ * @brief evict an object popped from the queue and free it, the object is
+ * not counted if it has been removed by cache->remove
+ */
+static inline void concurrent_cache_evict_obj(cache_t *cache,
+                                              concurrent_hashtable_t *hashtable,
+                                              cache_obj_t *obj) {
+  if (concurrent_hashtable_delete_obj(hashtable, obj)) {
+    concurrent_cache_add(cache, -concurrent_obj_byte(cache, obj), -1);
+  }
+  free_cache_obj(obj);
+}
+
+static inline void _concurrent_cache_remove_func(cache_obj_t *obj,
+                                                 void *user_data) {
+  *(int64_t *)user_data = obj->obj_size;
+}
+
+/**
+ * @brief remove an object from the hashtable and update the cache metadata,
+ * the object is freed when it is popped from the queue
+ */
+static inline bool concurrent_cache_remove(cache_t *cache,
+                                           concurrent_hashtable_t *hashtable,
+                                           const obj_id_t obj_id) {
+  int64_t obj_size = 0;
+  if (!concurrent_hashtable_delete_obj_id(
+          hashtable, obj_id, _concurrent_cache_remove_func, &obj_size)) {
+    return false;
+  }
+  concurrent_cache_add(cache, -(obj_size + cache->obj_md_size), -1);
+  return true;
+}
+
+/* the capacity of a ring queue, every object takes at least one byte, so a
+ * queue does not need more slots than the cache size or the hashtable */
+static inline uint64_t concurrent_cache_queue_capacity(const cache_t *cache) {
+  uint64_t capacity = 2;
+  while (capacity < (uint64_t)cache->cache_size &&
+         capacity < hashsize(cache->hashpower)) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+/* free the objects that are still in a queue, not thread-safe */
+static inline void concurrent_cache_free_queue(struct ring_queue *queue) {
+  cache_obj_t *obj;
+  while ((obj = ring_queue_pop(queue)) != NULL) {
+    free_cache_obj(obj);
+  }
+  ring_queue_free(queue);
+}
+
+#ifdef __cplusplus
+}
+#endif
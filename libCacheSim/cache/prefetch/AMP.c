@@ -0,0 +1,329 @@
+//
+//  stride-detecting prefetcher with AMP-style adaptive prefetch depth
+//
+//  Gill and Bathen, "AMP: Adaptive Multi-stream Prefetching in a Shared
+//  Cache", FAST'07
+//
+//  it tracks up to n-streams streams, a stream is a sequence of requests with
+//  a constant stride (|stride| <= max-stride, stride 1 is a sequential run),
+//  once min-confirm requests follow the stride, the stream keeps depth blocks
+//  prefetched ahead, and prefetches the next batch when the number of blocks
+//  prefetched ahead drops to depth / 2 (the trigger distance).
+//  As in AMP, the depth of each stream adapts:
+//    - it increases by 1 when the last block prefetched by the stream is
+//      requested, or a block the stream is expected to cover misses
+//    - it decreases by 1 when a block prefetched by the stream is evicted
+//      without being requested
+//
+//  the prefetched blocks have the same size as the request, see OBL.c
+//
+//  AMP.c
+//  libCacheSim
+//
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../../include/libCacheSim/prefetchAlgo.h"
+#include "prefetchUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* a prefetched block is tagged with its stream and the generation of the
+ * stream, so that a block of a replaced stream does not change the depth of
+ * the new stream in the same slot */
+#define AMP_TAG(stream_idx, gen) (((uint32_t)(gen) << 8) | (uint32_t)(stream_idx))
+#define AMP_TAG_STREAM(tag) ((tag)&0xff)
+#define AMP_MAX_N_STREAMS 256
+
+typedef struct {
+  int n_streams;
+  int max_stride;
+  int min_confirm;
+  int init_depth;
+  int max_depth;
+} AMP_init_params_t;
+
+typedef struct {
+  int64_t last_obj_id;
+  int64_t stride;
+  /* the last block prefetched along the stride */
+  int64_t prefetched_until;
+  int32_t n_confirm;
+  int32_t depth;
+  uint32_t gen;
+  int64_t last_access_vtime;
+} amp_stream_t;
+
+typedef struct {
+  int n_streams;
+  int max_stride;
+  int min_confirm;
+  int init_depth;
+  int max_depth;
+
+  amp_stream_t *streams;
+  int64_t vtime;
+  /* the stream of the current request, set by handle_find and consumed by
+   * prefetch, -1 if there is nothing to prefetch */
+  int curr_stream;
+
+  prefetched_set_t prefetched;
+} AMP_params_t;
+
+const char *AMP_default_params(void) {
+  return "n-streams=32, max-stride=64, min-confirm=2, init-depth=4, "
+         "max-depth=64";
+}
+
+static void set_AMP_default_init_params(AMP_init_params_t *init_params) {
+  init_params->n_streams = 32;
+  init_params->max_stride = 64;
+  init_params->min_confirm = 2;
+  init_params->init_depth = 4;
+  init_params->max_depth = 64;
+}
+
+static void AMP_parse_init_params(const char *prefetcher_specific_params,
+                                  AMP_init_params_t *init_params) {
+  char *params_str = strdup(prefetcher_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+    if (strcasecmp(key, "n-streams") == 0) {
+      init_params->n_streams = atoi(value);
+    } else if (strcasecmp(key, "max-stride") == 0) {
+      init_params->max_stride = atoi(value);
+    } else if (strcasecmp(key, "min-confirm") == 0) {
+      init_params->min_confirm = atoi(value);
+    } else if (strcasecmp(key, "init-depth") == 0) {
+      init_params->init_depth = atoi(value);
+    } else if (strcasecmp(key, "max-depth") == 0) {
+      init_params->max_depth = atoi(value);
+    } else if (strcasecmp(key, "print") == 0 ||
+               strcasecmp(key, "default") == 0) {
+      printf("default params: %s\n", AMP_default_params());
+      exit(0);
+    } else {
+      ERROR("AMP does not have parameter %s\n", key);
+      printf("default params: %s\n", AMP_default_params());
+      exit(1);
+    }
+  }
+
+  free(old_params_str);
+}
+
+static inline bool AMP_stream_is_active(const AMP_params_t *params,
+                                        const amp_stream_t *s) {
+  return s->stride != 0 && s->n_confirm >= params->min_confirm;
+}
+
+/**
+ * @brief find the stream that the request follows, a request that does not
+ * follow the stride of any stream, but is close to the last block of a stream
+ * that is not established sets the stride of that stream, otherwise it
+ * replaces the LRU stream
+ *
+ * @return the stream index
+ */
+static int AMP_update_streams(AMP_params_t *params, const request_t *req,
+                              bool hit) {
+  int64_t obj_id = (int64_t)req->obj_id;
+  int lru_idx = 0, near_idx = -1;
+  params->vtime += 1;
+
+  for (int i = 0; i < params->n_streams; i++) {
+    amp_stream_t *s = &params->streams[i];
+    if (s->last_access_vtime == 0) {
+      /* unused slot */
+      lru_idx = i;
+      continue;
+    }
+
+    if (s->stride != 0 && obj_id == s->last_obj_id + s->stride) {
+      if (!hit && AMP_stream_is_active(params, s) &&
+          s->depth < params->max_depth) {
+        /* the block should have been prefetched by this stream */
+        s->depth += 1;
+      }
+      s->last_obj_id = obj_id;
+      s->n_confirm += 1;
+      s->last_access_vtime = params->vtime;
+      return i;
+    }
+
+    /* an established stream is not re-strided by a random nearby request */
+    int64_t delta = obj_id - s->last_obj_id;
+    if (near_idx == -1 && !AMP_stream_is_active(params, s) && delta != 0 &&
+        delta <= params->max_stride && delta >= -params->max_stride) {
+      near_idx = i;
+    }
+    if (s->last_access_vtime < params->streams[lru_idx].last_access_vtime) {
+      lru_idx = i;
+    }
+  }
+
+  amp_stream_t *s;
+  if (near_idx != -1) {
+    /* a new stride for a stream that is not yet established */
+    s = &params->streams[near_idx];
+    s->stride = obj_id - s->last_obj_id;
+    s->n_confirm = 1;
+    s->prefetched_until = obj_id;
+    s->last_obj_id = obj_id;
+    s->last_access_vtime = params->vtime;
+    return near_idx;
+  }
+
+  s = &params->streams[lru_idx];
+  s->last_obj_id = obj_id;
+  s->stride = 0;
+  s->n_confirm = 0;
+  s->prefetched_until = obj_id;
+  s->depth = params->init_depth;
+  s->gen += 1;
+  s->last_access_vtime = params->vtime;
+
+  return -1;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                     prefetcher interfaces                     ****
+// ****                                                               ****
+// ****   create, free, clone, handle_find, handle_evict, prefetch    ****
+// ***********************************************************************
+static void AMP_handle_find(cache_t *cache, const request_t *req, bool hit) {
+  prefetcher_t *prefetcher = cache->prefetcher;
+  AMP_params_t *params = (AMP_params_t *)prefetcher->params;
+  uint32_t tag;
+
+  if (prefetch_stat_on_find(prefetcher, &params->prefetched, req, hit, &tag)) {
+    amp_stream_t *s = &params->streams[AMP_TAG_STREAM(tag)];
+    /* the stream has consumed all blocks it prefetched, it may be too
+     * conservative */
+    if (AMP_TAG(AMP_TAG_STREAM(tag), s->gen) == tag &&
+        (int64_t)req->obj_id == s->prefetched_until &&
+        s->depth < params->max_depth) {
+      s->depth += 1;
+    }
+  }
+
+  params->curr_stream = AMP_update_streams(params, req, hit);
+}
+
+static void AMP_handle_evict(cache_t *cache, const request_t *check_req) {
+  prefetcher_t *prefetcher = cache->prefetcher;
+  AMP_params_t *params = (AMP_params_t *)prefetcher->params;
+  uint32_t tag;
+
+  if (prefetch_stat_on_evict(prefetcher, &params->prefetched, check_req,
+                             &tag)) {
+    /* prefetched too far ahead, the block is evicted before it is used */
+    amp_stream_t *s = &params->streams[AMP_TAG_STREAM(tag)];
+    if (AMP_TAG(AMP_TAG_STREAM(tag), s->gen) == tag && s->depth > 1) {
+      s->depth -= 1;
+    }
+  }
+}
+
+static void AMP_prefetch(cache_t *cache, const request_t *req) {
+  AMP_params_t *params = (AMP_params_t *)(cache->prefetcher->params);
+
+  if (params->curr_stream == -1) return;
+  int idx = params->curr_stream;
+  amp_stream_t *s = &params->streams[idx];
+  params->curr_stream = -1;
+  if (!AMP_stream_is_active(params, s)) return;
+
+  int64_t obj_id = (int64_t)req->obj_id;
+  int64_t n_ahead = (s->prefetched_until - obj_id) / s->stride;
+  if (n_ahead < 0) {
+    /* the stream has passed the prefetched blocks */
+    s->prefetched_until = obj_id;
+    n_ahead = 0;
+  }
+  /* trigger distance */
+  if (n_ahead > s->depth / 2) return;
+
+  request_t new_req = *req;
+  uint32_t tag = AMP_TAG(idx, s->gen);
+  for (int64_t i = n_ahead + 1; i <= s->depth; i++) {
+    int64_t id = obj_id + i * s->stride;
+    if (id < 0) break;
+    prefetch_one_obj(cache, &params->prefetched, &new_req, (obj_id_t)id, tag);
+    s->prefetched_until = id;
+  }
+}
+
+static void free_AMP_prefetcher(prefetcher_t *prefetcher) {
+  AMP_params_t *params = (AMP_params_t *)prefetcher->params;
+
+  prefetched_set_free(&params->prefetched);
+  my_free(sizeof(amp_stream_t) * params->n_streams, params->streams);
+  my_free(sizeof(AMP_params_t), params);
+  if (prefetcher->init_params) {
+    free(prefetcher->init_params);
+  }
+  my_free(sizeof(prefetcher_t), prefetcher);
+}
+
+static prefetcher_t *clone_AMP_prefetcher(prefetcher_t *prefetcher,
+                                          uint64_t cache_size) {
+  return create_AMP_prefetcher(prefetcher->init_params, cache_size);
+}
+
+prefetcher_t *create_AMP_prefetcher(const char *init_params,
+                                    uint64_t cache_size) {
+  AMP_init_params_t AMP_init_params;
+  set_AMP_default_init_params(&AMP_init_params);
+  if (init_params != NULL) {
+    AMP_parse_init_params(init_params, &AMP_init_params);
+  }
+  assert(AMP_init_params.n_streams > 0 &&
+         AMP_init_params.n_streams <= AMP_MAX_N_STREAMS);
+  assert(AMP_init_params.max_stride > 0 && AMP_init_params.min_confirm > 0);
+  assert(AMP_init_params.init_depth > 0 &&
+         AMP_init_params.init_depth <= AMP_init_params.max_depth);
+
+  AMP_params_t *params = my_malloc(AMP_params_t);
+  memset(params, 0, sizeof(AMP_params_t));
+  params->n_streams = AMP_init_params.n_streams;
+  params->max_stride = AMP_init_params.max_stride;
+  params->min_confirm = AMP_init_params.min_confirm;
+  params->init_depth = AMP_init_params.init_depth;
+  params->max_depth = AMP_init_params.max_depth;
+  params->curr_stream = -1;
+  params->streams = my_malloc_n(amp_stream_t, params->n_streams);
+  memset(params->streams, 0, sizeof(amp_stream_t) * params->n_streams);
+  prefetched_set_init(&params->prefetched, PREFETCHED_SET_INIT_SIZE);
+
+  prefetcher_t *prefetcher = (prefetcher_t *)my_malloc(prefetcher_t);
+  memset(prefetcher, 0, sizeof(prefetcher_t));
+  prefetcher->params = params;
+  prefetcher->prefetch = AMP_prefetch;
+  prefetcher->handle_find = AMP_handle_find;
+  prefetcher->handle_evict = AMP_handle_evict;
+  prefetcher->free = free_AMP_prefetcher;
+  prefetcher->clone = clone_AMP_prefetcher;
+  if (init_params) {
+    prefetcher->init_params = strdup(init_params);
+  }
+
+  return prefetcher;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -42,6 +42,8 @@ static inline void _Mithril_rec_min_support_one(cache_t *Mithril,
                                                 const request_t *req);
 static inline gint _Mithril_get_total_num_of_ts(gint64 *row, gint row_length);
 static void _Mithril_mining(cache_t *Mithril);
+static void _Mithril_poll_mining(cache_t *Mithril);
+static void _Mithril_stop_mining_thread(Mithril_params_t *Mithril_params);
 
 static void _Mithril_add_to_prefetch_table(cache_t *Mithril, gpointer gp1,
                                            gpointer gp2);
@@ -51,7 +53,8 @@ const char *Mithril_default_params(void) {
          "max-support=8, min-support=2, confidence=1, pf-list-size=2, "
          "rec-trigger=miss, block-size=1, max-metadata-size=0.1, "
          "cycle-time=2, mining-threshold=5120, sequential-type=0, "
-         "sequential-K=-1, AMP-pthreshold=-1";
+         "sequential-K=-1, AMP-pthreshold=-1, async-mining=false, "
+         "mining-delay=0";
 }
 
 static void set_Mithril_default_init_params(
@@ -71,6 +74,9 @@ static void set_Mithril_default_init_params(
   init_params->sequential_K = -1;
 
   init_params->AMP_pthreshold = -1;
+
+  init_params->async_mining = FALSE;
+  init_params->mining_delay = 0;
 }
 
 static void Mithril_parse_init_params(const char *cache_specific_params,
@@ -119,6 +125,11 @@ static void Mithril_parse_init_params(const char *cache_specific_params,
       init_params->sequential_K = atoi(value);
     } else if (strcasecmp(key, "AMP-pthreshold") == 0) {
       init_params->AMP_pthreshold = atoi(value);
+    } else if (strcasecmp(key, "async-mining") == 0) {
+      init_params->async_mining =
+          strcasecmp(value, "true") == 0 || strcasecmp(value, "1") == 0;
+    } else if (strcasecmp(key, "mining-delay") == 0) {
+      init_params->mining_delay = atoi(value);
     } else if (strcasecmp(key, "print") == 0 ||
                strcasecmp(key, "default") == 0) {
       printf("default params: %s\n", Mithril_default_params());
@@ -204,6 +215,13 @@ static void set_Mithril_params(Mithril_params_t *Mithril_params,
 
   Mithril_params->ts = 0;
 
+  Mithril_params->async_mining = init_params->async_mining;
+  Mithril_params->mining_delay = init_params->mining_delay;
+  mining_job_t *job = &Mithril_params->mining_job;
+  job->ts_stride = (rmtable->mtable_row_len - 1) * 4;
+  job->lookahead_range = Mithril_params->lookahead_range;
+  job->confidence = Mithril_params->confidence;
+
   Mithril_params->hit_on_prefetch_Mithril = 0;
   Mithril_params->hit_on_prefetch_sequential = 0;
   Mithril_params->num_of_prefetch_Mithril = 0;
@@ -247,6 +265,10 @@ static void Mithril_handle_find(cache_t *cache, const request_t *req,
   Mithril_params_t *Mithril_params =
       (Mithril_params_t *)(cache->prefetcher->params);
 
+  if (Mithril_params->job_in_flight) {
+    _Mithril_poll_mining(cache);
+  }
+
   /*use cache_size_map to record the current requested obj's size*/
   g_hash_table_insert(Mithril_params->cache_size_map,
                       GINT_TO_POINTER(req->obj_id),
@@ -413,6 +435,17 @@ void Mithril_prefetch(cache_t *cache, const request_t *req) {
 void free_Mithril_prefetcher(prefetcher_t *prefetcher) {
   Mithril_params_t *Mithril_params = (Mithril_params_t *)prefetcher->params;
 
+  _Mithril_stop_mining_thread(Mithril_params);
+  mining_job_t *job = &Mithril_params->mining_job;
+  g_free(job->obj_ids);
+  g_free(job->n_ts);
+  g_free(job->ts);
+  g_free(job->sort_keys);
+  g_free(job->sorted_obj_ids);
+  g_free(job->sorted_n_ts);
+  g_free(job->sorted_ts);
+  g_free(job->assoc);
+
   g_hash_table_destroy(Mithril_params->prefetch_hashtable);
   g_hash_table_destroy(Mithril_params->cache_size_map);
   g_hash_table_destroy(Mithril_params->rmtable->hashtable);
@@ -463,6 +496,7 @@ prefetcher_t *create_Mithril_prefetcher(const char *init_params,
   }
 
   Mithril_params_t *Mithril_params = my_malloc(Mithril_params_t);
+  memset(Mithril_params, 0, sizeof(Mithril_params_t));
   // when all object's size is 1, cache->cache_size is the number of objects
   // that can be cached, and users should set block_size in prefetching_params.
   // Otherwise, cache->cache_size is the total bytes that can be cached and
@@ -892,10 +926,6 @@ static inline gint _Mithril_get_total_num_of_ts(gint64 *row, gint row_length) {
   return count;
 }
 
-gint mining_table_entry_cmp(gconstpointer a, gconstpointer b) {
-  return (gint)GET_NTH_TS(a, 1) - (gint)GET_NTH_TS(b, 1);
-}
-
 /* in debug */
 void print_one_line(gpointer key, gpointer value, gpointer user_data) {
   gint src_key = GPOINTER_TO_INT(key);
@@ -919,103 +949,171 @@ void print_prefetch_table(Mithril_params_t *Mithril_params) {
 }
 
 /**
- the mining funciton, it is called when mining table is ready
+ copy the mining table into the mining job and clear the mining table,
+ the timestamps are unpacked with GET_NTH_TS so the mined associations are
+ the same as mining the table in place
 
  @param Mithril the cache struct
  */
-static void _Mithril_mining(cache_t *cache) {
+static void _Mithril_snapshot_mining_table(cache_t *cache) {
   Mithril_params_t *Mithril_params =
       (Mithril_params_t *)(cache->prefetcher->params);
   rec_mining_t *rmtable = Mithril_params->rmtable;
+  mining_job_t *job = &Mithril_params->mining_job;
+  gint n_rows = (gint)rmtable->mining_table->len;
+  gint stride = job->ts_stride;
+
+  if (n_rows > job->capacity) {
+    gint capacity = MAX(n_rows, Mithril_params->mtable_size);
+    job->obj_ids = g_renew(gint64, job->obj_ids, capacity);
+    job->n_ts = g_renew(gint32, job->n_ts, capacity);
+    job->ts = g_renew(gint32, job->ts, (gint64)capacity * stride);
+    job->sort_keys = g_renew(gint64, job->sort_keys, capacity);
+    job->sorted_obj_ids = g_renew(gint64, job->sorted_obj_ids, capacity);
+    job->sorted_n_ts = g_renew(gint32, job->sorted_n_ts, capacity);
+    job->sorted_ts = g_renew(gint32, job->sorted_ts, (gint64)capacity * stride);
+    job->capacity = capacity;
+  }
 
-#ifdef PROFILING
-  GTimer *timer = g_timer_new();
-  gulong microsecond;
-  g_timer_start(timer);
-#endif
+  /* remove all elements from hashtable, the rows are leaving the mining
+   * table */
+  for (gint i = 0; i < n_rows; i++) {
+    gint64 *item = GET_ROW_IN_MTABLE(Mithril_params, i);
+    g_hash_table_remove(rmtable->hashtable, GINT_TO_POINTER(*item));
 
-  int i, j, k;
+    job->obj_ids[i] = item[0];
+    job->n_ts[i] = _Mithril_get_total_num_of_ts(item, rmtable->mtable_row_len);
+    gint32 *ts = job->ts + (gint64)i * stride;
+    for (gint k = 1; k <= stride; k++) {
+      ts[k - 1] = GET_NTH_TS(item, k);
+    }
+  }
 
-  /* first sort mining table, then do the mining */
-  /* first remove all elements from hashtable, otherwise after sort, it will
-   mess up for obj_id_type l but we can't do this for dataType c, otherwise
-   the string will be freed during remove in hashtable
-   */
-  gint64 *item = (gint64 *)rmtable->mining_table->data;
-  for (i = 0; i < (int)rmtable->mining_table->len; i++) {
-    g_hash_table_remove(rmtable->hashtable, GINT_TO_POINTER(*item));
-    item += rmtable->mtable_row_len;
+  job->n_rows = n_rows;
+  job->n_assoc = 0;
+  job->snapshot_ts = Mithril_params->ts;
+  rmtable->mining_table->len = 0;
+}
+
+static int _Mithril_sort_key_cmp(const void *a, const void *b) {
+  gint64 ka = *(const gint64 *)a, kb = *(const gint64 *)b;
+  return (ka > kb) - (ka < kb);
+}
+
+static inline void _Mithril_add_assoc(mining_job_t *job, gint64 src,
+                                      gint64 dst) {
+  if (job->n_assoc * 2 + 2 > job->assoc_capacity) {
+    job->assoc_capacity = MAX(job->assoc_capacity * 2, 1024);
+    job->assoc = g_renew(gint64, job->assoc, job->assoc_capacity);
   }
+  job->assoc[job->n_assoc * 2] = src;
+  job->assoc[job->n_assoc * 2 + 1] = dst;
+  job->n_assoc += 1;
+}
+
+/**
+ mine the associations in a snapshot, it does not touch Mithril_params,
+ so it can run on the mining thread.
+
+ the rows are sorted by the first timestamp, ties are kept in the order of
+ the mining table. Two rows are associated if at most confidence of the
+ compared timestamps are more than lookahead_range apart and (they are the
+ first candidate of the first row or one pair of timestamps is adjacent),
+ which is what the nested scan over the packed rows computed
+
+ @param job the snapshot, associations are written to job->assoc
+ */
+static void _Mithril_mine_snapshot(mining_job_t *job) {
+  gint n_rows = job->n_rows;
+  gint stride = job->ts_stride;
+  gint lookahead_range = job->lookahead_range;
+  gint confidence = job->confidence;
 
-  g_array_sort(rmtable->mining_table, mining_table_entry_cmp);
+  GTimer *timer = g_timer_new();
+  g_timer_start(timer);
 
-  gboolean associated_flag, first_flag;
-  gint64 *item1, *item2;
-  gint num_of_ts1, num_of_ts2, shorter_length;
-  for (i = 0; i < (long)rmtable->mining_table->len - 1; i++) {
-    item1 = GET_ROW_IN_MTABLE(Mithril_params, i);
-    num_of_ts1 = _Mithril_get_total_num_of_ts(item1, rmtable->mtable_row_len);
-    first_flag = TRUE;
+  for (gint i = 0; i < n_rows; i++) {
+    job->sort_keys[i] = ((gint64)job->ts[(gint64)i * stride] << 32) | i;
+  }
+  qsort(job->sort_keys, n_rows, sizeof(gint64), _Mithril_sort_key_cmp);
+  for (gint i = 0; i < n_rows; i++) {
+    gint row = (gint)(job->sort_keys[i] & 0xffffffff);
+    job->sorted_obj_ids[i] = job->obj_ids[row];
+    job->sorted_n_ts[i] = job->n_ts[row];
+    memcpy(job->sorted_ts + (gint64)i * stride,
+           job->ts + (gint64)row * stride, sizeof(gint32) * stride);
+  }
+
+  job->n_assoc = 0;
+  for (gint i = 0; i < n_rows - 1; i++) {
+    const gint32 *ts1 = job->sorted_ts + (gint64)i * stride;
+    gint num_of_ts1 = job->sorted_n_ts[i];
+    gboolean first_flag = TRUE;
 
-    for (j = i + 1; j < (long)rmtable->mining_table->len; j++) {
-      item2 = GET_ROW_IN_MTABLE(Mithril_params, j);
+    for (gint j = i + 1; j < n_rows; j++) {
+      const gint32 *ts2 = job->sorted_ts + (gint64)j * stride;
 
       // check first timestamp
-      if (GET_NTH_TS(item2, 1) - GET_NTH_TS(item1, 1) >
-          Mithril_params->lookahead_range) {
+      if (ts2[0] - ts1[0] > lookahead_range) {
         break;
       }
-      num_of_ts2 = _Mithril_get_total_num_of_ts(item2, rmtable->mtable_row_len);
-
-      if (ABS(num_of_ts1 - num_of_ts2) > Mithril_params->confidence) {
+      gint num_of_ts2 = job->sorted_n_ts[j];
+      if (ABS(num_of_ts1 - num_of_ts2) > confidence) {
         continue;
       }
 
-      shorter_length = MIN(num_of_ts1, num_of_ts2);
-
-      associated_flag = FALSE;
-      if (first_flag) {
+      gint shorter_length = MIN(num_of_ts1, num_of_ts2);
+      gboolean associated_flag = first_flag;
+      first_flag = FALSE;
+      if (shorter_length == 1 && ABS(ts1[0] - ts2[0]) == 1) {
         associated_flag = TRUE;
-        first_flag = FALSE;
       }
-      // is next line useless??
-      if (shorter_length == 1 &&
-          ABS(GET_NTH_TS(item1, 1) - GET_NTH_TS(item2, 1)) == 1) {
+
+      /* count instead of break, so the loop can be vectorized */
+      gint n_far = 0, n_adjacent = 0;
+      for (gint k = 0; k < shorter_length - 1; k++) {
+        gint32 diff = ABS(ts1[k] - ts2[k]);
+        n_far += diff > lookahead_range;
+        n_adjacent += diff == 1;
+      }
+      if (n_far > confidence) {
+        associated_flag = FALSE;
+      } else if (n_adjacent > 0) {
         associated_flag = TRUE;
       }
 
-      gint error = 0;
-      for (k = 1; k < shorter_length; k++) {
-        if (ABS(GET_NTH_TS(item1, k) - GET_NTH_TS(item2, k)) >
-            Mithril_params->lookahead_range) {
-          error++;
-          if (error > Mithril_params->confidence) {
-            associated_flag = FALSE;
-            break;
-          }
-        }
-
-        if (ABS(GET_NTH_TS(item1, k) - GET_NTH_TS(item2, k)) == 1) {
-          associated_flag = TRUE;
-        }
-      }
       if (associated_flag) {
-        // finally, add to prefetch table
-        _Mithril_add_to_prefetch_table(cache, GINT_TO_POINTER(item1[0]),
-                                       GINT_TO_POINTER(item2[0]));
+        _Mithril_add_assoc(job, job->sorted_obj_ids[i],
+                           job->sorted_obj_ids[j]);
       }
     }
   }
 
-  // may be just following?
-  rmtable->mining_table->len = 0;
+  job->mining_time = g_timer_elapsed(timer, NULL);
+  g_timer_destroy(timer);
+}
+
+/**
+ add the associations of a finished mining job to the prefetch table,
+ this runs on the request path between two requests, so a request sees either
+ none or all of the associations of one mining round
+
+ @param Mithril the cache struct
+ */
+static void _Mithril_apply_mining_job(cache_t *cache) {
+  Mithril_params_t *Mithril_params =
+      (Mithril_params_t *)(cache->prefetcher->params);
+  mining_job_t *job = &Mithril_params->mining_job;
+
+  for (gint64 i = 0; i < job->n_assoc; i++) {
+    _Mithril_add_to_prefetch_table(cache, GINT_TO_POINTER(job->assoc[i * 2]),
+                                   GINT_TO_POINTER(job->assoc[i * 2 + 1]));
+  }
+  job->n_assoc = 0;
 
 #ifdef PROFILING
   printf("ts: %lu, clearing training data takes %lf seconds\n",
-         (unsigned long)Mithril_params->ts,
-         g_timer_elapsed(timer, &microsecond));
-  g_timer_stop(timer);
-  g_timer_destroy(timer);
+         (unsigned long)Mithril_params->ts, job->mining_time);
 #endif
 
 #ifdef debug
@@ -1023,6 +1121,132 @@ static void _Mithril_mining(cache_t *cache) {
 #endif
 }
 
+static void *_Mithril_mining_thread_func(void *arg) {
+  Mithril_params_t *Mithril_params = arg;
+
+  pthread_mutex_lock(&Mithril_params->mining_mtx);
+  while (TRUE) {
+    while (!Mithril_params->job_submitted && !Mithril_params->mining_stop) {
+      pthread_cond_wait(&Mithril_params->mining_cond,
+                        &Mithril_params->mining_mtx);
+    }
+    if (Mithril_params->mining_stop) break;
+    pthread_mutex_unlock(&Mithril_params->mining_mtx);
+
+    _Mithril_mine_snapshot(&Mithril_params->mining_job);
+
+    pthread_mutex_lock(&Mithril_params->mining_mtx);
+    Mithril_params->job_submitted = FALSE;
+    __atomic_store_n(&Mithril_params->job_done, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&Mithril_params->mining_cond);
+  }
+  pthread_mutex_unlock(&Mithril_params->mining_mtx);
+
+  return NULL;
+}
+
+static void _Mithril_submit_mining_job(Mithril_params_t *Mithril_params) {
+  if (!Mithril_params->mining_thread_started) {
+    pthread_mutex_init(&Mithril_params->mining_mtx, NULL);
+    pthread_cond_init(&Mithril_params->mining_cond, NULL);
+    pthread_create(&Mithril_params->mining_thread, NULL,
+                   _Mithril_mining_thread_func, Mithril_params);
+    Mithril_params->mining_thread_started = TRUE;
+  }
+
+  pthread_mutex_lock(&Mithril_params->mining_mtx);
+  Mithril_params->job_submitted = TRUE;
+  __atomic_store_n(&Mithril_params->job_done, 0, __ATOMIC_RELAXED);
+  pthread_cond_signal(&Mithril_params->mining_cond);
+  pthread_mutex_unlock(&Mithril_params->mining_mtx);
+
+  Mithril_params->job_in_flight = TRUE;
+}
+
+static void _Mithril_wait_mining_job(Mithril_params_t *Mithril_params) {
+  pthread_mutex_lock(&Mithril_params->mining_mtx);
+  while (Mithril_params->job_submitted) {
+    pthread_cond_wait(&Mithril_params->mining_cond,
+                      &Mithril_params->mining_mtx);
+  }
+  pthread_mutex_unlock(&Mithril_params->mining_mtx);
+}
+
+/**
+ add the associations of the in-flight mining job to the prefetch table if it
+ is finished, with mining_delay, this happens exactly mining_delay requests
+ after the snapshot (blocking if the mining thread is behind)
+
+ @param Mithril the cache struct
+ */
+static void _Mithril_poll_mining(cache_t *cache) {
+  Mithril_params_t *Mithril_params =
+      (Mithril_params_t *)(cache->prefetcher->params);
+
+  if (Mithril_params->mining_delay > 0) {
+    if (Mithril_params->ts - Mithril_params->mining_job.snapshot_ts <
+        (guint64)Mithril_params->mining_delay) {
+      return;
+    }
+    if (__atomic_load_n(&Mithril_params->job_done, __ATOMIC_ACQUIRE) == 0) {
+      Mithril_params->n_mining_blocked += 1;
+      _Mithril_wait_mining_job(Mithril_params);
+    }
+  } else if (__atomic_load_n(&Mithril_params->job_done, __ATOMIC_ACQUIRE) ==
+             0) {
+    return;
+  }
+
+  Mithril_params->job_in_flight = FALSE;
+  _Mithril_apply_mining_job(cache);
+}
+
+static void _Mithril_stop_mining_thread(Mithril_params_t *Mithril_params) {
+  if (!Mithril_params->mining_thread_started) return;
+
+  pthread_mutex_lock(&Mithril_params->mining_mtx);
+  Mithril_params->mining_stop = TRUE;
+  pthread_cond_broadcast(&Mithril_params->mining_cond);
+  pthread_mutex_unlock(&Mithril_params->mining_mtx);
+  pthread_join(Mithril_params->mining_thread, NULL);
+
+  pthread_mutex_destroy(&Mithril_params->mining_mtx);
+  pthread_cond_destroy(&Mithril_params->mining_cond);
+  Mithril_params->mining_thread_started = FALSE;
+}
+
+/**
+ the mining funciton, it is called when mining table is ready,
+ it takes a snapshot of the mining table and mines it on the request path,
+ or hands it to the mining thread when async_mining is enabled
+
+ @param Mithril the cache struct
+ */
+static void _Mithril_mining(cache_t *cache) {
+  Mithril_params_t *Mithril_params =
+      (Mithril_params_t *)(cache->prefetcher->params);
+
+  if (Mithril_params->job_in_flight) {
+    /* the previous round must be added to the prefetch table before its
+     * buffers are reused */
+    if (__atomic_load_n(&Mithril_params->job_done, __ATOMIC_ACQUIRE) == 0) {
+      Mithril_params->n_mining_blocked += 1;
+      _Mithril_wait_mining_job(Mithril_params);
+    }
+    Mithril_params->job_in_flight = FALSE;
+    _Mithril_apply_mining_job(cache);
+  }
+
+  _Mithril_snapshot_mining_table(cache);
+
+  if (Mithril_params->async_mining) {
+    _Mithril_submit_mining_job(Mithril_params);
+  } else {
+    _Mithril_mine_snapshot(&Mithril_params->mining_job);
+    _Mithril_apply_mining_job(cache);
+  }
+}
+
 /**
  add two associated block into prefetch table
 
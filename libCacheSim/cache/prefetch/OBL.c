@@ -0,0 +1,163 @@
+//
+//  one block lookahead (OBL) prefetcher
+//
+//  on a miss to block b, prefetch b+1 ... b+degree,
+//  with tagged prefetching (default), the first hit on a prefetched block
+//  also triggers a prefetch, so a sequential scan only misses once
+//
+//  like the sequential prefetching in Mithril, the next block of obj_id is
+//  obj_id + 1 and it has the same size as the request, which fits block traces
+//  (e.g., vscsi) where the object size is ignored or fixed
+//
+//  OBL.c
+//  libCacheSim
+//
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../../include/libCacheSim/prefetchAlgo.h"
+#include "prefetchUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  int degree;
+  bool tagged;
+} OBL_init_params_t;
+
+typedef struct {
+  int degree;
+  bool tagged;
+
+  /* set by handle_find and consumed by prefetch of the same request */
+  bool trigger;
+
+  prefetched_set_t prefetched;
+} OBL_params_t;
+
+const char *OBL_default_params(void) { return "degree=1, tagged=true"; }
+
+static void set_OBL_default_init_params(OBL_init_params_t *init_params) {
+  init_params->degree = 1;
+  init_params->tagged = true;
+}
+
+static void OBL_parse_init_params(const char *prefetcher_specific_params,
+                                  OBL_init_params_t *init_params) {
+  char *params_str = strdup(prefetcher_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+    if (strcasecmp(key, "degree") == 0) {
+      init_params->degree = atoi(value);
+    } else if (strcasecmp(key, "tagged") == 0) {
+      init_params->tagged =
+          strcasecmp(value, "true") == 0 || strcasecmp(value, "1") == 0;
+    } else if (strcasecmp(key, "print") == 0 ||
+               strcasecmp(key, "default") == 0) {
+      printf("default params: %s\n", OBL_default_params());
+      exit(0);
+    } else {
+      ERROR("OBL does not have parameter %s\n", key);
+      printf("default params: %s\n", OBL_default_params());
+      exit(1);
+    }
+  }
+
+  free(old_params_str);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                     prefetcher interfaces                     ****
+// ****                                                               ****
+// ****   create, free, clone, handle_find, handle_evict, prefetch    ****
+// ***********************************************************************
+static void OBL_handle_find(cache_t *cache, const request_t *req, bool hit) {
+  prefetcher_t *prefetcher = cache->prefetcher;
+  OBL_params_t *params = (OBL_params_t *)prefetcher->params;
+
+  bool prefetch_hit =
+      prefetch_stat_on_find(prefetcher, &params->prefetched, req, hit, NULL);
+  params->trigger = !hit || (params->tagged && prefetch_hit);
+}
+
+static void OBL_handle_evict(cache_t *cache, const request_t *check_req) {
+  prefetcher_t *prefetcher = cache->prefetcher;
+  OBL_params_t *params = (OBL_params_t *)prefetcher->params;
+
+  prefetch_stat_on_evict(prefetcher, &params->prefetched, check_req, NULL);
+}
+
+static void OBL_prefetch(cache_t *cache, const request_t *req) {
+  OBL_params_t *params = (OBL_params_t *)(cache->prefetcher->params);
+
+  if (!params->trigger) return;
+  params->trigger = false;
+
+  request_t new_req = *req;
+  for (int i = 1; i <= params->degree; i++) {
+    prefetch_one_obj(cache, &params->prefetched, &new_req, req->obj_id + i, 0);
+  }
+}
+
+static void free_OBL_prefetcher(prefetcher_t *prefetcher) {
+  OBL_params_t *params = (OBL_params_t *)prefetcher->params;
+
+  prefetched_set_free(&params->prefetched);
+  my_free(sizeof(OBL_params_t), params);
+  if (prefetcher->init_params) {
+    free(prefetcher->init_params);
+  }
+  my_free(sizeof(prefetcher_t), prefetcher);
+}
+
+static prefetcher_t *clone_OBL_prefetcher(prefetcher_t *prefetcher,
+                                          uint64_t cache_size) {
+  return create_OBL_prefetcher(prefetcher->init_params, cache_size);
+}
+
+prefetcher_t *create_OBL_prefetcher(const char *init_params,
+                                    uint64_t cache_size) {
+  OBL_init_params_t OBL_init_params;
+  set_OBL_default_init_params(&OBL_init_params);
+  if (init_params != NULL) {
+    OBL_parse_init_params(init_params, &OBL_init_params);
+  }
+  assert(OBL_init_params.degree > 0);
+
+  OBL_params_t *params = my_malloc(OBL_params_t);
+  memset(params, 0, sizeof(OBL_params_t));
+  params->degree = OBL_init_params.degree;
+  params->tagged = OBL_init_params.tagged;
+  prefetched_set_init(&params->prefetched, PREFETCHED_SET_INIT_SIZE);
+
+  prefetcher_t *prefetcher = (prefetcher_t *)my_malloc(prefetcher_t);
+  memset(prefetcher, 0, sizeof(prefetcher_t));
+  prefetcher->params = params;
+  prefetcher->prefetch = OBL_prefetch;
+  prefetcher->handle_find = OBL_handle_find;
+  prefetcher->handle_evict = OBL_handle_evict;
+  prefetcher->free = free_OBL_prefetcher;
+  prefetcher->clone = clone_OBL_prefetcher;
+  if (init_params) {
+    prefetcher->init_params = strdup(init_params);
+  }
+
+  return prefetcher;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,230 @@
+//
+//  sequential-run prefetcher
+//
+//  it tracks up to n-streams sequential runs, a request to the block after the
+//  last block of a run extends the run, once a run has min-run blocks, the
+//  prefetcher keeps degree blocks ahead of the run,
+//  an unmatched request starts a new run in the least recently used stream
+//
+//  the next block of obj_id is obj_id + 1 and it has the same size as the
+//  request, see OBL.c
+//
+//  Sequential.c
+//  libCacheSim
+//
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../../include/libCacheSim/prefetchAlgo.h"
+#include "prefetchUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  int n_streams;
+  int min_run;
+  int degree;
+} Sequential_init_params_t;
+
+typedef struct {
+  obj_id_t last_obj_id;
+  /* the last block that has been prefetched for this run */
+  obj_id_t prefetched_until;
+  int64_t run_len;
+  int64_t last_access_vtime;
+} seq_stream_t;
+
+typedef struct {
+  int n_streams;
+  int min_run;
+  int degree;
+
+  seq_stream_t *streams;
+  int64_t vtime;
+  /* the stream of the current request, set by handle_find and consumed by
+   * prefetch, -1 if there is nothing to prefetch */
+  int curr_stream;
+
+  prefetched_set_t prefetched;
+} Sequential_params_t;
+
+const char *Sequential_default_params(void) {
+  return "n-streams=16, min-run=2, degree=4";
+}
+
+static void set_Sequential_default_init_params(
+    Sequential_init_params_t *init_params) {
+  init_params->n_streams = 16;
+  init_params->min_run = 2;
+  init_params->degree = 4;
+}
+
+static void Sequential_parse_init_params(
+    const char *prefetcher_specific_params,
+    Sequential_init_params_t *init_params) {
+  char *params_str = strdup(prefetcher_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+    if (strcasecmp(key, "n-streams") == 0) {
+      init_params->n_streams = atoi(value);
+    } else if (strcasecmp(key, "min-run") == 0) {
+      init_params->min_run = atoi(value);
+    } else if (strcasecmp(key, "degree") == 0) {
+      init_params->degree = atoi(value);
+    } else if (strcasecmp(key, "print") == 0 ||
+               strcasecmp(key, "default") == 0) {
+      printf("default params: %s\n", Sequential_default_params());
+      exit(0);
+    } else {
+      ERROR("Sequential does not have parameter %s\n", key);
+      printf("default params: %s\n", Sequential_default_params());
+      exit(1);
+    }
+  }
+
+  free(old_params_str);
+}
+
+/* find the run that req extends, or start a new run in the LRU stream */
+static int Sequential_update_streams(Sequential_params_t *params,
+                                     const request_t *req) {
+  int lru_idx = 0;
+  params->vtime += 1;
+
+  for (int i = 0; i < params->n_streams; i++) {
+    seq_stream_t *s = &params->streams[i];
+    if (s->run_len > 0 && req->obj_id == s->last_obj_id + 1) {
+      s->last_obj_id = req->obj_id;
+      s->run_len += 1;
+      s->last_access_vtime = params->vtime;
+      return i;
+    }
+    if (s->run_len > 0 && req->obj_id == s->last_obj_id) {
+      /* re-reference of the last block does not break the run */
+      s->last_access_vtime = params->vtime;
+      return -1;
+    }
+    if (s->last_access_vtime < params->streams[lru_idx].last_access_vtime) {
+      lru_idx = i;
+    }
+  }
+
+  seq_stream_t *s = &params->streams[lru_idx];
+  s->last_obj_id = req->obj_id;
+  s->prefetched_until = req->obj_id;
+  s->run_len = 1;
+  s->last_access_vtime = params->vtime;
+
+  return lru_idx;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                     prefetcher interfaces                     ****
+// ****                                                               ****
+// ****   create, free, clone, handle_find, handle_evict, prefetch    ****
+// ***********************************************************************
+static void Sequential_handle_find(cache_t *cache, const request_t *req,
+                                   bool hit) {
+  prefetcher_t *prefetcher = cache->prefetcher;
+  Sequential_params_t *params = (Sequential_params_t *)prefetcher->params;
+
+  prefetch_stat_on_find(prefetcher, &params->prefetched, req, hit, NULL);
+  params->curr_stream = Sequential_update_streams(params, req);
+}
+
+static void Sequential_handle_evict(cache_t *cache,
+                                    const request_t *check_req) {
+  prefetcher_t *prefetcher = cache->prefetcher;
+  Sequential_params_t *params = (Sequential_params_t *)prefetcher->params;
+
+  prefetch_stat_on_evict(prefetcher, &params->prefetched, check_req, NULL);
+}
+
+static void Sequential_prefetch(cache_t *cache, const request_t *req) {
+  Sequential_params_t *params =
+      (Sequential_params_t *)(cache->prefetcher->params);
+
+  if (params->curr_stream == -1) return;
+  seq_stream_t *s = &params->streams[params->curr_stream];
+  params->curr_stream = -1;
+  if (s->run_len < params->min_run) return;
+
+  obj_id_t start = s->prefetched_until + 1;
+  if (start <= req->obj_id) start = req->obj_id + 1;
+  obj_id_t end = req->obj_id + params->degree;
+
+  request_t new_req = *req;
+  for (obj_id_t id = start; id <= end; id++) {
+    prefetch_one_obj(cache, &params->prefetched, &new_req, id, 0);
+  }
+  if (end > s->prefetched_until) s->prefetched_until = end;
+}
+
+static void free_Sequential_prefetcher(prefetcher_t *prefetcher) {
+  Sequential_params_t *params = (Sequential_params_t *)prefetcher->params;
+
+  prefetched_set_free(&params->prefetched);
+  my_free(sizeof(seq_stream_t) * params->n_streams, params->streams);
+  my_free(sizeof(Sequential_params_t), params);
+  if (prefetcher->init_params) {
+    free(prefetcher->init_params);
+  }
+  my_free(sizeof(prefetcher_t), prefetcher);
+}
+
+static prefetcher_t *clone_Sequential_prefetcher(prefetcher_t *prefetcher,
+                                                 uint64_t cache_size) {
+  return create_Sequential_prefetcher(prefetcher->init_params, cache_size);
+}
+
+prefetcher_t *create_Sequential_prefetcher(const char *init_params,
+                                           uint64_t cache_size) {
+  Sequential_init_params_t seq_init_params;
+  set_Sequential_default_init_params(&seq_init_params);
+  if (init_params != NULL) {
+    Sequential_parse_init_params(init_params, &seq_init_params);
+  }
+  assert(seq_init_params.n_streams > 0 && seq_init_params.min_run > 0 &&
+         seq_init_params.degree > 0);
+
+  Sequential_params_t *params = my_malloc(Sequential_params_t);
+  memset(params, 0, sizeof(Sequential_params_t));
+  params->n_streams = seq_init_params.n_streams;
+  params->min_run = seq_init_params.min_run;
+  params->degree = seq_init_params.degree;
+  params->curr_stream = -1;
+  params->streams = my_malloc_n(seq_stream_t, params->n_streams);
+  memset(params->streams, 0, sizeof(seq_stream_t) * params->n_streams);
+  prefetched_set_init(&params->prefetched, PREFETCHED_SET_INIT_SIZE);
+
+  prefetcher_t *prefetcher = (prefetcher_t *)my_malloc(prefetcher_t);
+  memset(prefetcher, 0, sizeof(prefetcher_t));
+  prefetcher->params = params;
+  prefetcher->prefetch = Sequential_prefetch;
+  prefetcher->handle_find = Sequential_handle_find;
+  prefetcher->handle_evict = Sequential_handle_evict;
+  prefetcher->free = free_Sequential_prefetcher;
+  prefetcher->clone = clone_Sequential_prefetcher;
+  if (init_params) {
+    prefetcher->init_params = strdup(init_params);
+  }
+
+  return prefetcher;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,183 @@
+//
+//  helpers shared by the lightweight block prefetchers (OBL, Sequential, AMP)
+//
+//  prefetchUtils.h
+//  libCacheSim
+//
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../dataStructure/hash/hash.h"
+#include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/prefetchAlgo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PREFETCHED_SET_EMPTY UINT64_MAX
+#define PREFETCHED_SET_INIT_SIZE 1024
+
+/**
+ * the set of objects that are prefetched but not requested yet,
+ * each object carries a tag (e.g., the stream that prefetched it),
+ * it is a linear probing hash table with backward-shift deletion,
+ * so it does not need tombstones and lookups stay short
+ */
+typedef struct prefetched_set {
+  uint64_t *keys;
+  uint32_t *tags;
+  uint64_t mask;
+  uint64_t n_elem;
+} prefetched_set_t;
+
+static inline void prefetched_set_init(prefetched_set_t *set, uint64_t size) {
+  set->keys = my_malloc_n(uint64_t, size);
+  set->tags = my_malloc_n(uint32_t, size);
+  memset(set->keys, 0xff, sizeof(uint64_t) * size);
+  set->mask = size - 1;
+  set->n_elem = 0;
+}
+
+static inline void prefetched_set_free(prefetched_set_t *set) {
+  my_free(sizeof(uint64_t) * (set->mask + 1), set->keys);
+  my_free(sizeof(uint32_t) * (set->mask + 1), set->tags);
+}
+
+static inline uint64_t _prefetched_set_slot(const prefetched_set_t *set,
+                                            uint64_t key) {
+  return get_hash_value_int_64(&key) & set->mask;
+}
+
+static inline void prefetched_set_insert(prefetched_set_t *set, uint64_t key,
+                                         uint32_t tag);
+
+static inline void _prefetched_set_grow(prefetched_set_t *set) {
+  prefetched_set_t old = *set;
+  prefetched_set_init(set, (old.mask + 1) * 2);
+  for (uint64_t i = 0; i <= old.mask; i++) {
+    if (old.keys[i] != PREFETCHED_SET_EMPTY) {
+      prefetched_set_insert(set, old.keys[i], old.tags[i]);
+    }
+  }
+  prefetched_set_free(&old);
+}
+
+static inline void prefetched_set_insert(prefetched_set_t *set, uint64_t key,
+                                         uint32_t tag) {
+  if ((set->n_elem + 1) * 4 > (set->mask + 1) * 3) _prefetched_set_grow(set);
+
+  uint64_t i = _prefetched_set_slot(set, key);
+  while (set->keys[i] != PREFETCHED_SET_EMPTY && set->keys[i] != key) {
+    i = (i + 1) & set->mask;
+  }
+  if (set->keys[i] == PREFETCHED_SET_EMPTY) set->n_elem += 1;
+  set->keys[i] = key;
+  set->tags[i] = tag;
+}
+
+/**
+ * @brief remove key from the set
+ *
+ * @return true if the key was in the set, and its tag is written to tag_p
+ */
+static inline bool prefetched_set_remove(prefetched_set_t *set, uint64_t key,
+                                         uint32_t *tag_p) {
+  uint64_t i = _prefetched_set_slot(set, key);
+  while (set->keys[i] != key) {
+    if (set->keys[i] == PREFETCHED_SET_EMPTY) return false;
+    i = (i + 1) & set->mask;
+  }
+  if (tag_p != NULL) *tag_p = set->tags[i];
+
+  /* shift back the following entries that are displaced from their slot */
+  uint64_t hole = i;
+  uint64_t j = (i + 1) & set->mask;
+  while (set->keys[j] != PREFETCHED_SET_EMPTY) {
+    uint64_t home = _prefetched_set_slot(set, set->keys[j]);
+    if (((j - home) & set->mask) >= ((j - hole) & set->mask)) {
+      set->keys[hole] = set->keys[j];
+      set->tags[hole] = set->tags[j];
+      hole = j;
+    }
+    j = (j + 1) & set->mask;
+  }
+  set->keys[hole] = PREFETCHED_SET_EMPTY;
+  set->n_elem -= 1;
+
+  return true;
+}
+
+/**
+ * @brief update the prefetch stat on a user request,
+ * a request to a prefetched object is a prefetch hit,
+ * the prefetched object is then treated as a normal object
+ *
+ * @return true if the request is the first request to a prefetched object
+ */
+static inline bool prefetch_stat_on_find(prefetcher_t *prefetcher,
+                                         prefetched_set_t *set,
+                                         const request_t *req, bool hit,
+                                         uint32_t *tag_p) {
+  prefetcher->stat.n_req += 1;
+  if (!hit) {
+    /* a prefetched object is removed from the set when it is evicted */
+    prefetcher->stat.n_demand_miss += 1;
+    return false;
+  }
+
+  if (set->n_elem != 0 && prefetched_set_remove(set, req->obj_id, tag_p)) {
+    prefetcher->stat.n_prefetch_hit += 1;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief update the prefetch stat when an object is evicted,
+ *
+ * @return true if the evicted object was prefetched and never requested
+ */
+static inline bool prefetch_stat_on_evict(prefetcher_t *prefetcher,
+                                          prefetched_set_t *set,
+                                          const request_t *req,
+                                          uint32_t *tag_p) {
+  if (set->n_elem != 0 && prefetched_set_remove(set, req->obj_id, tag_p)) {
+    prefetcher->stat.n_prefetch_unused += 1;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief insert obj_id into the cache if it is not cached, the object has the
+ * same size as the request that triggers the prefetch
+ *
+ * @return true if the object is prefetched
+ */
+static inline bool prefetch_one_obj(cache_t *cache, prefetched_set_t *set,
+                                    request_t *new_req, obj_id_t obj_id,
+                                    uint32_t tag) {
+  new_req->obj_id = obj_id;
+  if (new_req->obj_size + cache->obj_md_size > cache->cache_size) return false;
+  if (cache->find(cache, new_req, false)) return false;
+
+  while ((long)cache->get_occupied_byte(cache) + new_req->obj_size +
+             cache->obj_md_size >
+         (long)cache->cache_size) {
+    cache->evict(cache, new_req);
+  }
+  cache->insert(cache, new_req);
+
+  cache->prefetcher->stat.n_prefetch += 1;
+  prefetched_set_insert(set, obj_id, tag);
+
+  return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
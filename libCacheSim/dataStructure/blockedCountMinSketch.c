@@ -0,0 +1,181 @@
+//
+// a blocked count-min sketch with 4-bit counters, see blockedCountMinSketch.h
+//
+// layout of one 64-byte block, each word holds 16 4-bit counters
+//
+// |  half 0: word 0-3 (row 0-3)  |  half 1: word 4-7 (row 0-3)  |
+//
+// an item uses the high 32 bits of its hash to choose the block, one bit to
+// choose the half, and 4 bits per row to choose the counter in the row's word
+//
+// the AVX2 functions are compiled with the target attribute and chosen at
+// runtime, so the library does not need to be built with -mavx2
+//
+
+#include "blockedCountMinSketch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BLOCKED_CMS_DISPATCH_AVX2
+#define BLOCKED_CMS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define WORD_PER_BLOCK 8
+#define BLOCK_SIZE (WORD_PER_BLOCK * sizeof(uint64_t))
+
+static inline uint64_t *_get_half_block(const struct blocked_cms *cms,
+                                        const uint64_t hash) {
+  uint64_t block_idx = (hash >> 32) & cms->block_mask;
+  uint64_t half = (hash >> 31) & 1;
+  return cms->table + block_idx * WORD_PER_BLOCK + half * BLOCKED_CMS_N_ROW;
+}
+
+/* the bit offset of the counter in the word of row i */
+static inline uint64_t _get_shift(const uint64_t hash, const int row) {
+  return ((hash >> (row * 4)) & 0xF) * 4;
+}
+
+int blocked_cms_init(struct blocked_cms *cms, uint64_t entries) {
+  cms->ready = 0;
+
+  // each word holds 16 counters of a row
+  uint64_t n_word = 16;
+  while (n_word * 16 < entries) n_word <<= 1;
+  cms->n_block = n_word * BLOCKED_CMS_N_ROW / WORD_PER_BLOCK;
+  cms->block_mask = cms->n_block - 1;
+
+  cms->table = aligned_alloc(BLOCK_SIZE, cms->n_block * BLOCK_SIZE);
+  if (cms->table == NULL) {
+    return 1;
+  }
+  memset(cms->table, 0, cms->n_block * BLOCK_SIZE);
+
+  blocked_cms_use_avx2(cms, true);
+  cms->ready = 1;
+  return 0;
+}
+
+int blocked_cms_use_avx2(struct blocked_cms *cms, bool use_avx2) {
+  cms->use_avx2 = 0;
+#ifdef BLOCKED_CMS_DISPATCH_AVX2
+  if (use_avx2 && __builtin_cpu_supports("avx2")) {
+    cms->use_avx2 = 1;
+  }
+#endif
+  return cms->use_avx2;
+}
+
+static int _increment_scalar(struct blocked_cms *cms, uint64_t hash) {
+  uint64_t *words = _get_half_block(cms, hash);
+  int cnt[BLOCKED_CMS_N_ROW];
+  int min_val = BLOCKED_CMS_MAX_COUNT;
+  for (int i = 0; i < BLOCKED_CMS_N_ROW; i++) {
+    cnt[i] = (int)((words[i] >> _get_shift(hash, i)) & 0xF);
+    if (cnt[i] < min_val) min_val = cnt[i];
+  }
+
+  if (min_val == BLOCKED_CMS_MAX_COUNT) {
+    return min_val;
+  }
+
+  for (int i = 0; i < BLOCKED_CMS_N_ROW; i++) {
+    if (cnt[i] == min_val) {
+      words[i] += 1ULL << _get_shift(hash, i);
+    }
+  }
+
+  return min_val + 1;
+}
+
+static int _estimate_scalar(const struct blocked_cms *cms, uint64_t hash) {
+  const uint64_t *words = _get_half_block(cms, hash);
+  int min_val = BLOCKED_CMS_MAX_COUNT;
+  for (int i = 0; i < BLOCKED_CMS_N_ROW; i++) {
+    int cnt = (int)((words[i] >> _get_shift(hash, i)) & 0xF);
+    if (cnt < min_val) min_val = cnt;
+  }
+  return min_val;
+}
+
+#ifdef BLOCKED_CMS_DISPATCH_AVX2
+/* the minimum of the four 64-bit lanes, broadcast to all lanes */
+static inline BLOCKED_CMS_TARGET_AVX2 __m256i _mm256_hmin_epi64(__m256i v) {
+  __m256i swapped = _mm256_permute4x64_epi64(v, 0xB1);  // 1 0 3 2
+  v = _mm256_blendv_epi8(v, swapped, _mm256_cmpgt_epi64(v, swapped));
+  swapped = _mm256_permute4x64_epi64(v, 0x4E);  // 2 3 0 1
+  return _mm256_blendv_epi8(v, swapped, _mm256_cmpgt_epi64(v, swapped));
+}
+
+static inline BLOCKED_CMS_TARGET_AVX2 __m256i
+_get_shifts(const uint64_t hash) {
+  return _mm256_set_epi64x(_get_shift(hash, 3), _get_shift(hash, 2),
+                           _get_shift(hash, 1), _get_shift(hash, 0));
+}
+
+static BLOCKED_CMS_TARGET_AVX2 int _increment_avx2(struct blocked_cms *cms,
+                                                   uint64_t hash) {
+  uint64_t *words = _get_half_block(cms, hash);
+  __m256i shifts = _get_shifts(hash);
+  __m256i w = _mm256_load_si256((const __m256i *)words);
+  __m256i cnt =
+      _mm256_and_si256(_mm256_srlv_epi64(w, shifts), _mm256_set1_epi64x(0xF));
+  __m256i min_cnt = _mm256_hmin_epi64(cnt);
+  int min_val = (int)_mm256_extract_epi64(min_cnt, 0);
+  if (min_val == BLOCKED_CMS_MAX_COUNT) {
+    return min_val;
+  }
+
+  __m256i is_min = _mm256_cmpeq_epi64(cnt, min_cnt);
+  __m256i inc = _mm256_and_si256(
+      _mm256_sllv_epi64(_mm256_set1_epi64x(1), shifts), is_min);
+  _mm256_store_si256((__m256i *)words, _mm256_add_epi64(w, inc));
+
+  return min_val + 1;
+}
+
+static BLOCKED_CMS_TARGET_AVX2 int _estimate_avx2(
+    const struct blocked_cms *cms, uint64_t hash) {
+  const uint64_t *words = _get_half_block(cms, hash);
+  __m256i w = _mm256_load_si256((const __m256i *)words);
+  __m256i cnt = _mm256_and_si256(_mm256_srlv_epi64(w, _get_shifts(hash)),
+                                 _mm256_set1_epi64x(0xF));
+  return (int)_mm256_extract_epi64(_mm256_hmin_epi64(cnt), 0);
+}
+#endif
+
+int blocked_cms_increment(struct blocked_cms *cms, uint64_t hash) {
+#ifdef BLOCKED_CMS_DISPATCH_AVX2
+  if (cms->use_avx2) return _increment_avx2(cms, hash);
+#endif
+  return _increment_scalar(cms, hash);
+}
+
+int blocked_cms_estimate(const struct blocked_cms *cms, uint64_t hash) {
+#ifdef BLOCKED_CMS_DISPATCH_AVX2
+  if (cms->use_avx2) return _estimate_avx2(cms, hash);
+#endif
+  return _estimate_scalar(cms, hash);
+}
+
+void blocked_cms_halve(struct blocked_cms *cms) {
+  // shift every counter right by one and clear the bit that comes from the
+  // neighbouring counter, this loop is vectorized by the compiler
+  uint64_t n_word = cms->n_block * WORD_PER_BLOCK;
+  for (uint64_t i = 0; i < n_word; i++) {
+    cms->table[i] = (cms->table[i] >> 1) & 0x7777777777777777ULL;
+  }
+}
+
+void blocked_cms_reset(struct blocked_cms *cms) {
+  memset(cms->table, 0, cms->n_block * BLOCK_SIZE);
+}
+
+void blocked_cms_free(struct blocked_cms *cms) {
+  if (cms->ready) {
+    free(cms->table);
+  }
+  cms->ready = 0;
+}
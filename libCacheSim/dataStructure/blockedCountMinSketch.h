@@ -0,0 +1,118 @@
+#ifndef _BLOCKED_COUNT_MIN_SKETCH_H
+#define _BLOCKED_COUNT_MIN_SKETCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** ***************************************************************************
+ * A count-min sketch with four rows of 4-bit counters (max count 15).
+ *
+ * The table is divided into 64-byte blocks (one cache line), each item is
+ * mapped to one block and all four counters of the item are in the same half
+ * of the block, one 64-bit word per row, so an update or a query touches one
+ * cache line and needs one hash. On CPUs with AVX2 (checked at runtime), the
+ * four rows are loaded, compared and incremented with one 256-bit vector.
+ *
+ * Caller needs to allocate this struct and the first call must be to
+ * blocked_cms_init().
+ *
+ */
+struct blocked_cms {
+  // These fields are part of the public interface of this structure.
+  // Client code may read these values if desired. Client code MUST NOT
+  // modify any of these.
+  uint64_t n_block;
+
+  // Fields below are private to the implementation.
+  uint64_t block_mask;
+  uint64_t *table;
+  int ready;
+  // use the AVX2 increment and estimate
+  int use_avx2;
+};
+
+#define BLOCKED_CMS_N_ROW 4
+#define BLOCKED_CMS_MAX_COUNT 15
+
+/** ***************************************************************************
+ * Initialize the sketch.
+ *
+ * Parameters:
+ * -----------
+ *     cms     - Pointer to an allocated struct blocked_cms.
+ *     entries - The expected number of distinct items, the sketch allocates
+ *               one 4-bit counter per row per item (rounded up to power of 2).
+ *
+ * Return:
+ * -------
+ *     0 - on success
+ *     1 - on failure
+ *
+ */
+int blocked_cms_init(struct blocked_cms *cms, uint64_t entries);
+
+/** ***************************************************************************
+ * Increment the counters of an item using conservative update, only the
+ * counters that equal the current minimum are incremented, saturated counters
+ * are not changed.
+ *
+ * Parameters:
+ * -----------
+ *     cms  - Pointer to an initialized struct blocked_cms.
+ *     hash - 64-bit hash of the item.
+ *
+ * Return: the estimated count after the increment
+ *
+ */
+int blocked_cms_increment(struct blocked_cms *cms, uint64_t hash);
+
+/** ***************************************************************************
+ * Estimate the count of an item.
+ *
+ * Parameters:
+ * -----------
+ *     cms  - Pointer to an initialized struct blocked_cms.
+ *     hash - 64-bit hash of the item.
+ *
+ * Return: the minimum of the item's counters
+ *
+ */
+int blocked_cms_estimate(const struct blocked_cms *cms, uint64_t hash);
+
+/** ***************************************************************************
+ * Halve all counters, this is the aging (reset) operation of TinyLFU.
+ *
+ */
+void blocked_cms_halve(struct blocked_cms *cms);
+
+/** ***************************************************************************
+ * Reset all counters to zero.
+ *
+ */
+void blocked_cms_reset(struct blocked_cms *cms);
+
+/** ***************************************************************************
+ * Choose between the AVX2 and the scalar implementation, init chooses AVX2
+ * when the CPU supports it. Both give the same counters.
+ *
+ * Return: 1 if the AVX2 implementation is used, 0 if AVX2 is requested but
+ * not supported, or not requested
+ *
+ */
+int blocked_cms_use_avx2(struct blocked_cms *cms, bool use_avx2);
+
+/** ***************************************************************************
+ * Deallocate internal storage.
+ *
+ */
+void blocked_cms_free(struct blocked_cms *cms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
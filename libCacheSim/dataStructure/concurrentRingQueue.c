@@ -0,0 +1,99 @@
+//
+// a bounded MPMC ring queue, see concurrentRingQueue.h
+//
+// a cell at position pos is writable when its seq equals pos, and readable
+// when its seq equals pos + 1. After reading, the consumer sets seq to
+// pos + capacity so that the cell becomes writable in the next lap
+//
+
+#include "concurrentRingQueue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int ring_queue_init(struct ring_queue *q, uint64_t capacity) {
+  q->ready = 0;
+
+  uint64_t n_cell = 2;
+  while (n_cell < capacity) n_cell <<= 1;
+  q->capacity = n_cell;
+  q->mask = n_cell - 1;
+
+  q->cells = aligned_alloc(RING_QUEUE_CACHE_LINE_SIZE,
+                           n_cell * sizeof(struct ring_queue_cell));
+  if (q->cells == NULL) {
+    return 1;
+  }
+  for (uint64_t i = 0; i < n_cell; i++) {
+    q->cells[i].seq = i;
+    q->cells[i].data = NULL;
+  }
+  q->enqueue_pos = 0;
+  q->dequeue_pos = 0;
+
+  q->ready = 1;
+  return 0;
+}
+
+bool ring_queue_push(struct ring_queue *q, void *data) {
+  struct ring_queue_cell *cell;
+  uint64_t pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+  while (true) {
+    cell = &q->cells[pos & q->mask];
+    uint64_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    int64_t diff = (int64_t)seq - (int64_t)pos;
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&q->enqueue_pos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // the cell has not been consumed in the last lap
+      return false;
+    } else {
+      pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+
+  cell->data = data;
+  __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void *ring_queue_pop(struct ring_queue *q) {
+  struct ring_queue_cell *cell;
+  uint64_t pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+  while (true) {
+    cell = &q->cells[pos & q->mask];
+    uint64_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    int64_t diff = (int64_t)seq - (int64_t)(pos + 1);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&q->dequeue_pos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // the cell has not been produced in this lap
+      return NULL;
+    } else {
+      pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+    }
+  }
+
+  void *data = cell->data;
+  __atomic_store_n(&cell->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+  return data;
+}
+
+uint64_t ring_queue_size(const struct ring_queue *q) {
+  uint64_t dequeue_pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+  uint64_t enqueue_pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+  return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+}
+
+void ring_queue_free(struct ring_queue *q) {
+  if (q->ready) {
+    free(q->cells);
+  }
+  q->ready = 0;
+}
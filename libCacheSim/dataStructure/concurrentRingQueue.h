@@ -0,0 +1,99 @@
+#ifndef _CONCURRENT_RING_QUEUE_H
+#define _CONCURRENT_RING_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RING_QUEUE_CACHE_LINE_SIZE 64
+
+struct ring_queue_cell {
+  uint64_t seq;
+  void *data;
+};
+
+/** ***************************************************************************
+ * A bounded multi-producer multi-consumer FIFO queue of pointers on a ring
+ * buffer (Vyukov's queue).
+ *
+ * Each cell carries a sequence number that tells whether the cell is ready to
+ * be written or read in the current lap, so producers and consumers only
+ * synchronize with a CAS on their own position and never take a lock. The
+ * producer and the consumer positions are on different cache lines.
+ *
+ * Caller needs to allocate this struct and the first call must be to
+ * ring_queue_init().
+ *
+ */
+struct ring_queue {
+  // These fields are part of the public interface of this structure.
+  // Client code may read these values if desired. Client code MUST NOT
+  // modify any of these.
+  uint64_t capacity;
+
+  // Fields below are private to the implementation.
+  uint64_t mask;
+  struct ring_queue_cell *cells;
+  int ready;
+
+  // pad the positions so that producers and consumers do not share a line
+  char pad0[RING_QUEUE_CACHE_LINE_SIZE];
+  uint64_t enqueue_pos;
+  char pad1[RING_QUEUE_CACHE_LINE_SIZE - sizeof(uint64_t)];
+  uint64_t dequeue_pos;
+  char pad2[RING_QUEUE_CACHE_LINE_SIZE - sizeof(uint64_t)];
+};
+
+/** ***************************************************************************
+ * Initialize the queue.
+ *
+ * Parameters:
+ * -----------
+ *     q        - Pointer to an allocated struct ring_queue.
+ *     capacity - The max number of elements, rounded up to power of 2.
+ *
+ * Return:
+ * -------
+ *     0 - on success
+ *     1 - on failure
+ *
+ */
+int ring_queue_init(struct ring_queue *q, uint64_t capacity);
+
+/** ***************************************************************************
+ * Append an element to the tail of the queue, thread-safe.
+ *
+ * Return: true on success, false if the queue is full
+ *
+ */
+bool ring_queue_push(struct ring_queue *q, void *data);
+
+/** ***************************************************************************
+ * Remove the element at the head of the queue, thread-safe.
+ *
+ * Return: the element, NULL if the queue is empty
+ *
+ */
+void *ring_queue_pop(struct ring_queue *q);
+
+/** ***************************************************************************
+ * The number of elements in the queue, this is a snapshot and may be stale
+ * when other threads are pushing or popping.
+ *
+ */
+uint64_t ring_queue_size(const struct ring_queue *q);
+
+/** ***************************************************************************
+ * Deallocate internal storage, the elements are not freed.
+ *
+ */
+void ring_queue_free(struct ring_queue *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -78,6 +78,43 @@ static inline void add_to_bucket(hashtable_t *hashtable,
 #endif
 }
 
+/* append an object to the dense object array, must be called before n_obj is
+ * incremented */
+static inline void add_to_obj_arr(hashtable_t *hashtable,
+                                  cache_obj_t *cache_obj) {
+  if (hashtable->n_obj == hashtable->obj_arr_capacity) {
+    uint64_t new_capacity = hashtable->obj_arr_capacity * 2;
+    if (new_capacity > UINT32_MAX) {
+      ERROR("hashtable dense object array cannot hold more than %lu objects\n",
+            (unsigned long)UINT32_MAX);
+      abort();
+    }
+    cache_obj_t **new_arr = my_malloc_n(cache_obj_t *, new_capacity);
+    ASSERT_NOT_NULL(new_arr, "unable to grow dense object array to %lu\n",
+                    (unsigned long)new_capacity);
+    memcpy(new_arr, hashtable->obj_arr,
+           sizeof(cache_obj_t *) * hashtable->obj_arr_capacity);
+    my_free(sizeof(cache_obj_t *) * hashtable->obj_arr_capacity,
+            hashtable->obj_arr);
+    hashtable->obj_arr = new_arr;
+    hashtable->obj_arr_capacity = new_capacity;
+  }
+
+  cache_obj->obj_arr_idx = (uint32_t)hashtable->n_obj;
+  hashtable->obj_arr[hashtable->n_obj] = cache_obj;
+}
+
+/* swap-remove an object from the dense object array, must be called after
+ * n_obj is decremented and before the object is freed */
+static inline void remove_from_obj_arr(hashtable_t *hashtable,
+                                       cache_obj_t *cache_obj) {
+  uint32_t idx = cache_obj->obj_arr_idx;
+  DEBUG_ASSERT(hashtable->obj_arr[idx] == cache_obj);
+  cache_obj_t *last_obj = hashtable->obj_arr[hashtable->n_obj];
+  hashtable->obj_arr[idx] = last_obj;
+  last_obj->obj_arr_idx = idx;
+}
+
 /* free object, called by other functions when iterating through the hashtable
  */
 static inline void foreach_free_obj(cache_obj_t *cache_obj, void *user_data) {
@@ -144,6 +181,7 @@ cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable,
 
   cache_obj_t *new_cache_obj = create_cache_obj_from_request(req);
   add_to_bucket(hashtable, new_cache_obj);
+  if (hashtable->obj_arr != NULL) add_to_obj_arr(hashtable, new_cache_obj);
   hashtable->n_obj += 1;
   return new_cache_obj;
 }
@@ -157,6 +195,7 @@ cache_obj_t *chained_hashtable_insert_obj_v2(hashtable_t *hashtable,
     _chained_hashtable_expand_v2(hashtable);
 
   add_to_bucket(hashtable, cache_obj);
+  if (hashtable->obj_arr != NULL) add_to_obj_arr(hashtable, cache_obj);
   hashtable->n_obj += 1;
   return cache_obj;
 }
@@ -165,6 +204,7 @@ cache_obj_t *chained_hashtable_insert_obj_v2(hashtable_t *hashtable,
 void chained_hashtable_delete_v2(hashtable_t *hashtable,
                                  cache_obj_t *cache_obj) {
   hashtable->n_obj -= 1;
+  if (hashtable->obj_arr != NULL) remove_from_obj_arr(hashtable, cache_obj);
   uint64_t hv = get_hash_value_int_64(&cache_obj->obj_id) &
                 hashmask(hashtable->hashpower);
   if (hashtable->ptr_table[hv] == cache_obj) {
@@ -208,6 +248,7 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable,
   if (hashtable->ptr_table[hv] == cache_obj) {
     hashtable->ptr_table[hv] = cache_obj->hash_next;
     hashtable->n_obj -= 1;
+    if (hashtable->obj_arr != NULL) remove_from_obj_arr(hashtable, cache_obj);
     if (!hashtable->external_obj) free_cache_obj(cache_obj);
     return true;
   }
@@ -241,6 +282,7 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable,
   if (cur_obj != NULL) {
     cur_obj->hash_next = cache_obj->hash_next;
     hashtable->n_obj -= 1;
+    if (hashtable->obj_arr != NULL) remove_from_obj_arr(hashtable, cache_obj);
     if (!hashtable->external_obj) free_cache_obj(cache_obj);
     return true;
   }
@@ -271,8 +313,9 @@ bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable,
   // the object to remove is the first object in the hash bucket
   if (cur_obj->obj_id == obj_id) {
     hashtable->ptr_table[hv] = cur_obj->hash_next;
-    if (!hashtable->external_obj) free_cache_obj(cur_obj);
     hashtable->n_obj -= 1;
+    if (hashtable->obj_arr != NULL) remove_from_obj_arr(hashtable, cur_obj);
+    if (!hashtable->external_obj) free_cache_obj(cur_obj);
     return true;
   }
 
@@ -286,8 +329,9 @@ bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable,
   // the object to remove is in the hash bucket
   if (cur_obj != NULL) {
     prev_obj->hash_next = cur_obj->hash_next;
-    if (!hashtable->external_obj) free_cache_obj(cur_obj);
     hashtable->n_obj -= 1;
+    if (hashtable->obj_arr != NULL) remove_from_obj_arr(hashtable, cur_obj);
+    if (!hashtable->external_obj) free_cache_obj(cur_obj);
     return true;
   }
   // the object to remove is not in the hash table
@@ -295,12 +339,29 @@ bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable,
 }
 
 cache_obj_t *chained_hashtable_rand_obj_v2(const hashtable_t *hashtable) {
+  if (hashtable->obj_arr != NULL) {
+    DEBUG_ASSERT(hashtable->n_obj > 0);
+    return hashtable->obj_arr[next_rand() % hashtable->n_obj];
+  }
+
+  // without the dense array, probe random buckets until a non-empty one is
+  // found, this is slow at low load factor and biased towards short chains
   uint64_t pos = next_rand() & hashmask(hashtable->hashpower);
   while (hashtable->ptr_table[pos] == NULL)
     pos = next_rand() & hashmask(hashtable->hashpower);
   return hashtable->ptr_table[pos];
 }
 
+void chained_hashtable_enable_sampling_v2(hashtable_t *hashtable) {
+  DEBUG_ASSERT(hashtable->n_obj == 0);
+  if (hashtable->obj_arr != NULL) return;
+
+  hashtable->obj_arr_capacity = 1024;
+  hashtable->obj_arr =
+      my_malloc_n(cache_obj_t *, hashtable->obj_arr_capacity);
+  ASSERT_NOT_NULL(hashtable->obj_arr, "unable to allocate dense object array\n");
+}
+
 void chained_hashtable_foreach_v2(hashtable_t *hashtable,
                                   hashtable_iter iter_func, void *user_data) {
   cache_obj_t *cur_obj, *next_obj;
@@ -317,6 +378,9 @@ void chained_hashtable_foreach_v2(hashtable_t *hashtable,
 void free_chained_hashtable_v2(hashtable_t *hashtable) {
   if (!hashtable->external_obj)
     chained_hashtable_foreach_v2(hashtable, foreach_free_obj, NULL);
+  if (hashtable->obj_arr != NULL)
+    my_free(sizeof(cache_obj_t *) * hashtable->obj_arr_capacity,
+            hashtable->obj_arr);
   my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower),
           hashtable->ptr_table);
   my_free(sizeof(hashtable_t), hashtable);
@@ -42,6 +42,13 @@ void chained_hashtable_delete_v2(hashtable_t *hashtable,
 
 cache_obj_t *chained_hashtable_rand_obj_v2(const hashtable_t *hashtable);
 
+/**
+ * keep a dense array of all objects alongside the hash table so that
+ * chained_hashtable_rand_obj_v2 samples uniformly in O(1) regardless of
+ * the load factor, it must be called before any object is inserted
+ */
+void chained_hashtable_enable_sampling_v2(hashtable_t *hashtable);
+
 void chained_hashtable_foreach_v2(hashtable_t *hashtable,
                                   hashtable_iter iter_func, void *user_data);
 
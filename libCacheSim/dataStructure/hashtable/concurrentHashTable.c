@@ -0,0 +1,168 @@
+//
+// a chained hash table with striped bucket locks, see concurrentHashTable.h
+//
+// bucket i is protected by lock i & lock_mask, the objects are linked through
+// hash_next, so the table itself only stores one pointer per bucket
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "concurrentHashTable.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/macro.h"
+#include "../hash/hash.h"
+
+static inline uint64_t _get_bucket_idx(const concurrent_hashtable_t *hashtable,
+                                       const obj_id_t obj_id) {
+  return get_hash_value_int_64(&obj_id) & hashmask(hashtable->hashpower);
+}
+
+static inline pthread_spinlock_t *_get_lock(
+    const concurrent_hashtable_t *hashtable, const uint64_t bucket_idx) {
+  return &hashtable->locks[bucket_idx & hashtable->lock_mask].lock;
+}
+
+concurrent_hashtable_t *create_concurrent_hashtable(const uint16_t hashpower) {
+  concurrent_hashtable_t *hashtable = my_malloc(concurrent_hashtable_t);
+  memset(hashtable, 0, sizeof(concurrent_hashtable_t));
+  hashtable->hashpower = hashpower;
+
+  hashtable->ptr_table = my_malloc_n(cache_obj_t *, hashsize(hashpower));
+  if (hashtable->ptr_table == NULL) {
+    ERROR("allocate hash table %zu entry * %lu B = %ld MiB failed\n",
+          sizeof(cache_obj_t *), (unsigned long)(hashsize(hashpower)),
+          (long)(sizeof(cache_obj_t *) * hashsize(hashpower) / 1024 / 1024));
+  }
+  memset(hashtable->ptr_table, 0, sizeof(cache_obj_t *) * hashsize(hashpower));
+
+  uint16_t lock_power = MIN(hashpower, CONCURRENT_HASHTABLE_LOCK_POWER);
+  hashtable->lock_mask = hashmask(lock_power);
+  hashtable->locks = my_malloc_n(concurrent_hashtable_lock_t,
+                                 hashsize(lock_power));
+  for (uint64_t i = 0; i < hashsize(lock_power); i++) {
+    pthread_spin_init(&hashtable->locks[i].lock, PTHREAD_PROCESS_PRIVATE);
+  }
+
+  return hashtable;
+}
+
+bool concurrent_hashtable_find(concurrent_hashtable_t *hashtable,
+                               const obj_id_t obj_id, hashtable_iter func,
+                               void *user_data) {
+  uint64_t bucket_idx = _get_bucket_idx(hashtable, obj_id);
+  pthread_spinlock_t *lock = _get_lock(hashtable, bucket_idx);
+
+  pthread_spin_lock(lock);
+  cache_obj_t *cache_obj = hashtable->ptr_table[bucket_idx];
+  while (cache_obj != NULL && cache_obj->obj_id != obj_id) {
+    cache_obj = cache_obj->hash_next;
+  }
+  if (cache_obj != NULL && func != NULL) {
+    func(cache_obj, user_data);
+  }
+  pthread_spin_unlock(lock);
+
+  return cache_obj != NULL;
+}
+
+bool concurrent_hashtable_insert_obj(concurrent_hashtable_t *hashtable,
+                                     cache_obj_t *cache_obj) {
+  uint64_t bucket_idx = _get_bucket_idx(hashtable, cache_obj->obj_id);
+  pthread_spinlock_t *lock = _get_lock(hashtable, bucket_idx);
+
+  pthread_spin_lock(lock);
+  cache_obj_t *curr_obj = hashtable->ptr_table[bucket_idx];
+  while (curr_obj != NULL) {
+    if (curr_obj->obj_id == cache_obj->obj_id) {
+      pthread_spin_unlock(lock);
+      return false;
+    }
+    curr_obj = curr_obj->hash_next;
+  }
+  cache_obj->hash_next = hashtable->ptr_table[bucket_idx];
+  hashtable->ptr_table[bucket_idx] = cache_obj;
+  pthread_spin_unlock(lock);
+
+  return true;
+}
+
+/* unlink the object that matches obj (or obj_id if obj is NULL) from its
+ * bucket, the caller holds the bucket lock */
+static inline cache_obj_t *_unlink_obj(concurrent_hashtable_t *hashtable,
+                                       const uint64_t bucket_idx,
+                                       const cache_obj_t *obj,
+                                       const obj_id_t obj_id) {
+  cache_obj_t **prev_next = &hashtable->ptr_table[bucket_idx];
+  cache_obj_t *curr_obj = *prev_next;
+  while (curr_obj != NULL) {
+    if (obj != NULL ? curr_obj == obj : curr_obj->obj_id == obj_id) {
+      *prev_next = curr_obj->hash_next;
+      curr_obj->hash_next = NULL;
+      return curr_obj;
+    }
+    prev_next = &curr_obj->hash_next;
+    curr_obj = curr_obj->hash_next;
+  }
+  return NULL;
+}
+
+bool concurrent_hashtable_delete_obj(concurrent_hashtable_t *hashtable,
+                                     cache_obj_t *cache_obj) {
+  uint64_t bucket_idx = _get_bucket_idx(hashtable, cache_obj->obj_id);
+  pthread_spinlock_t *lock = _get_lock(hashtable, bucket_idx);
+
+  pthread_spin_lock(lock);
+  cache_obj_t *deleted = _unlink_obj(hashtable, bucket_idx, cache_obj, 0);
+  pthread_spin_unlock(lock);
+
+  return deleted != NULL;
+}
+
+bool concurrent_hashtable_delete_obj_id(concurrent_hashtable_t *hashtable,
+                                        const obj_id_t obj_id,
+                                        hashtable_iter func, void *user_data) {
+  uint64_t bucket_idx = _get_bucket_idx(hashtable, obj_id);
+  pthread_spinlock_t *lock = _get_lock(hashtable, bucket_idx);
+
+  pthread_spin_lock(lock);
+  cache_obj_t *deleted = _unlink_obj(hashtable, bucket_idx, NULL, obj_id);
+  if (deleted != NULL && func != NULL) {
+    func(deleted, user_data);
+  }
+  pthread_spin_unlock(lock);
+
+  return deleted != NULL;
+}
+
+void concurrent_hashtable_foreach(concurrent_hashtable_t *hashtable,
+                                  hashtable_iter func, void *user_data) {
+  for (uint64_t i = 0; i < hashsize(hashtable->hashpower); i++) {
+    cache_obj_t *cache_obj = hashtable->ptr_table[i];
+    while (cache_obj != NULL) {
+      cache_obj_t *next_obj = cache_obj->hash_next;
+      func(cache_obj, user_data);
+      cache_obj = next_obj;
+    }
+  }
+}
+
+void free_concurrent_hashtable(concurrent_hashtable_t *hashtable) {
+  uint64_t n_lock = hashtable->lock_mask + 1;
+  for (uint64_t i = 0; i < n_lock; i++) {
+    pthread_spin_destroy(&hashtable->locks[i].lock);
+  }
+  my_free(sizeof(concurrent_hashtable_lock_t) * n_lock, hashtable->locks);
+  my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower),
+          hashtable->ptr_table);
+  my_free(sizeof(concurrent_hashtable_t), hashtable);
+}
+
+#ifdef __cplusplus
+}
+#endif
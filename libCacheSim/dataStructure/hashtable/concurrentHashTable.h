@@ -0,0 +1,89 @@
+//
+// a chained hash table that can be used by multiple threads,
+// used by the concurrent eviction algorithms
+//
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+
+#include "hashtableStruct.h"
+
+// the buckets are protected by 2^12 striped spin locks
+#define CONCURRENT_HASHTABLE_LOCK_POWER 12
+
+typedef struct {
+  pthread_spinlock_t lock;
+  char pad[64 - sizeof(pthread_spinlock_t)];
+} concurrent_hashtable_lock_t;
+
+/**
+ * the table does not own the objects and does not grow, the caller allocates
+ * and frees the objects and chooses the hashpower for the expected number of
+ * objects. A callback passed to find or delete is called with the object while
+ * its bucket is locked, so the callback may touch the object even if another
+ * thread is trying to evict it
+ */
+typedef struct concurrent_hashtable {
+  cache_obj_t **ptr_table;
+  concurrent_hashtable_lock_t *locks;
+  uint64_t lock_mask;
+  uint16_t hashpower;
+} concurrent_hashtable_t;
+
+concurrent_hashtable_t *create_concurrent_hashtable(const uint16_t hashpower);
+
+/**
+ * @brief find an object, func is called on the object if found
+ *
+ * @param hashtable
+ * @param obj_id
+ * @param func can be NULL
+ * @param user_data passed to func
+ * @return whether the object is found
+ */
+bool concurrent_hashtable_find(concurrent_hashtable_t *hashtable,
+                               const obj_id_t obj_id, hashtable_iter func,
+                               void *user_data);
+
+/**
+ * @brief insert an object if no object with the same obj_id is in the table
+ *
+ * @return true if inserted, false if the obj_id exists
+ */
+bool concurrent_hashtable_insert_obj(concurrent_hashtable_t *hashtable,
+                                     cache_obj_t *cache_obj);
+
+/**
+ * @brief delete the given object
+ *
+ * @return true if deleted, false if the object is not in the table
+ */
+bool concurrent_hashtable_delete_obj(concurrent_hashtable_t *hashtable,
+                                     cache_obj_t *cache_obj);
+
+/**
+ * @brief delete the object with the obj_id, func is called on the object
+ * before it is deleted
+ *
+ * @return whether the object is found
+ */
+bool concurrent_hashtable_delete_obj_id(concurrent_hashtable_t *hashtable,
+                                        const obj_id_t obj_id,
+                                        hashtable_iter func, void *user_data);
+
+/**
+ * @brief call func on every object, not thread-safe
+ */
+void concurrent_hashtable_foreach(concurrent_hashtable_t *hashtable,
+                                  hashtable_iter func, void *user_data);
+
+void free_concurrent_hashtable(concurrent_hashtable_t *hashtable);
+
+#ifdef __cplusplus
+}
+#endif
@@ -29,6 +29,7 @@ extern "C" {
 #define hashtable_delete(hashtable, cache_obj) \
   chained_hashtable_delete(hashtable, cache_obj)
 #define hashtable_rand_obj(hashtable) chained_hashtable_rand_obj(hashtable)
+#define hashtable_enable_sampling(hashtable)
 #define hashtable_foreach(hashtable, iter_func, user_data) \
   chained_hashtable_foreach(hashtable, iter_func, user_data)
 #define free_hashtable(hashtable) free_chained_hashtable(hashtable)
@@ -55,6 +56,8 @@ extern "C" {
 #define hashtable_delete_obj_id(hashtable, obj_id) \
   chained_hashtable_delete_obj_id_v2(hashtable, obj_id)
 #define hashtable_rand_obj(hashtable) chained_hashtable_rand_obj_v2(hashtable)
+#define hashtable_enable_sampling(hashtable) \
+  chained_hashtable_enable_sampling_v2(hashtable)
 #define hashtable_foreach(hashtable, iter_func, user_data) \
   chained_hashtable_foreach_v2(hashtable, iter_func, user_data)
 #define free_hashtable(hashtable) free_chained_hashtable_v2(hashtable)
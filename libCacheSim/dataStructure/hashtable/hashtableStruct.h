@@ -40,6 +40,10 @@ typedef struct hashtable {
     };
     void *extra_data;
   };
+  // a dense array of all objects in the hashtable, used for O(1) uniform
+  // random sampling, NULL unless enabled by hashtable_enable_sampling
+  cache_obj_t **obj_arr;
+  uint64_t obj_arr_capacity;
 } hashtable_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,76 @@
+//
+// an online sequential run (scan) detector, see scanDetector.h
+//
+
+#include "scanDetector.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int scan_detector_init(struct scan_detector *sd, int n_streams, int min_run,
+                       int max_gap) {
+  memset(sd, 0, sizeof(struct scan_detector));
+  if (n_streams <= 0 || min_run <= 0 || max_gap <= 0) {
+    return 1;
+  }
+
+  sd->n_streams = n_streams;
+  sd->min_run = min_run;
+  sd->max_gap = max_gap;
+  sd->streams = calloc(n_streams, sizeof(struct scan_stream));
+  if (sd->streams == NULL) {
+    return 1;
+  }
+
+  sd->ready = 1;
+  return 0;
+}
+
+int64_t scan_detector_add(struct scan_detector *sd, uint64_t obj_id) {
+  struct scan_stream *s = NULL;
+  int lru_idx = 0;
+
+  sd->vtime += 1;
+  sd->n_req += 1;
+  sd->ended_run_len = 0;
+
+  for (int i = 0; i < sd->n_streams; i++) {
+    struct scan_stream *curr = &sd->streams[i];
+    if (curr->run_len > 0 && obj_id >= curr->last_obj_id &&
+        obj_id - curr->last_obj_id <= (uint64_t)sd->max_gap) {
+      s = curr;
+      break;
+    }
+    if (curr->last_access_vtime < sd->streams[lru_idx].last_access_vtime) {
+      lru_idx = i;
+    }
+  }
+
+  if (s == NULL) {
+    /* start a new run in the least recently used stream */
+    s = &sd->streams[lru_idx];
+    sd->ended_run_len = s->run_len;
+    s->run_len = 1;
+  } else if (obj_id != s->last_obj_id) {
+    s->run_len += 1;
+    if (s->run_len == sd->min_run) {
+      sd->n_scan += 1;
+      sd->n_req_in_scan += sd->min_run - 1;
+    }
+  }
+  s->last_obj_id = obj_id;
+  s->last_access_vtime = sd->vtime;
+
+  if (scan_detector_is_scan(sd, s->run_len)) {
+    sd->n_scan_req += 1;
+    sd->n_req_in_scan += 1;
+  }
+
+  return s->run_len;
+}
+
+void scan_detector_free(struct scan_detector *sd) {
+  free(sd->streams);
+  sd->streams = NULL;
+  sd->ready = 0;
+}
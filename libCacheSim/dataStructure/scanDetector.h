@@ -0,0 +1,112 @@
+#ifndef _SCAN_DETECTOR_H
+#define _SCAN_DETECTOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** ***************************************************************************
+ * An online detector of sequential runs (scans) in block traces.
+ *
+ * It tracks up to n_streams runs. A request extends a run when its obj_id is
+ * after the last block of the run by at most max_gap blocks, a re-reference
+ * of the last block does not break the run. An unmatched request starts a
+ * new run in the least recently used stream. The min_run-th request of a run
+ * and the requests after it are scan requests.
+ *
+ * The memory is n_streams entries, so it can be used during trace analysis
+ * and by caches, e.g., the scan admissioner (cache/admission/scan.c) does not
+ * admit scan requests so that a backup job does not flush the cache.
+ *
+ * Caller needs to allocate this struct and the first call must be to
+ * scan_detector_init().
+ *
+ */
+struct scan_stream {
+  uint64_t last_obj_id;
+  int64_t run_len;
+  int64_t last_access_vtime;
+};
+
+struct scan_detector {
+  // These fields are part of the public interface of this structure.
+  // Client code may read these values if desired. Client code MUST NOT
+  // modify any of these.
+  int n_streams;
+  int min_run;
+  int max_gap;
+
+  /* the number of requests, the number of requests detected as scan when
+   * they arrive, and the number of requests in runs of at least min_run
+   * requests (including the first min_run - 1 requests of the run) */
+  int64_t n_req;
+  int64_t n_scan_req;
+  int64_t n_req_in_scan;
+  /* the number of runs that reach min_run requests */
+  int64_t n_scan;
+  /* the length of the run replaced by the last request, 0 if no run ends */
+  int64_t ended_run_len;
+
+  // Fields below are private to the implementation.
+  struct scan_stream *streams;
+  int64_t vtime;
+  int ready;
+};
+
+/** ***************************************************************************
+ * Initialize the detector.
+ *
+ * Parameters:
+ * -----------
+ *     sd        - Pointer to an allocated struct scan_detector.
+ *     n_streams - The number of runs tracked at the same time.
+ *     min_run   - The length of a run when it becomes a scan, the first
+ *                 min_run - 1 requests of a run are not scan requests.
+ *     max_gap   - The largest distance from the last block of a run to the
+ *                 next request of the run, 1 means strictly sequential.
+ *
+ * Return:
+ * -------
+ *     0 - on success
+ *     1 - on failure
+ *
+ */
+int scan_detector_init(struct scan_detector *sd, int n_streams, int min_run,
+                       int max_gap);
+
+/** ***************************************************************************
+ * Add a request to the detector.
+ *
+ * Parameters:
+ * -----------
+ *     sd     - Pointer to an initialized struct scan_detector.
+ *     obj_id - The block of the request.
+ *
+ * Return:
+ * -------
+ *     the length of the run of the request, including the request
+ *
+ */
+int64_t scan_detector_add(struct scan_detector *sd, uint64_t obj_id);
+
+/** ***************************************************************************
+ * Whether a request whose run has run_len requests is a scan request.
+ */
+static inline bool scan_detector_is_scan(const struct scan_detector *sd,
+                                         int64_t run_len) {
+  return run_len >= sd->min_run;
+}
+
+/** ***************************************************************************
+ * Deallocate internal memory.
+ */
+void scan_detector_free(struct scan_detector *sd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -11,9 +11,14 @@ typedef struct admissioner *(*admissioner_create_func_ptr)(const char *);
 typedef struct admissioner *(*admissioner_clone_func_ptr)(struct admissioner *);
 typedef bool (*cache_admit_func_ptr)(struct admissioner*, const request_t *);
 typedef void (*admissioner_free_func_ptr)(struct admissioner *);
+typedef void (*admissioner_update_func_ptr)(struct admissioner *,
+                                            const request_t *);
 
 typedef struct admissioner {
   cache_admit_func_ptr admit;
+  // optional, called on cache hits so that the admissioner sees every request,
+  // admit is only called on misses
+  admissioner_update_func_ptr update;
   void *params;
   admissioner_clone_func_ptr clone;
   admissioner_free_func_ptr free;
@@ -24,6 +29,8 @@ admissioner_t *create_bloomfilter_admissioner(const char *init_params);
 admissioner_t *create_prob_admissioner(const char *init_params);
 admissioner_t *create_size_admissioner(const char *init_params);
 admissioner_t *create_adaptsize_admissioner(const char *init_params);
+admissioner_t *create_tinylfu_admissioner(const char *init_params);
+admissioner_t *create_scan_admissioner(const char *init_params);
 
 static inline admissioner_t *create_admissioner(const char *admission_algo,
                                                 const char *admission_params) {
@@ -36,6 +43,10 @@ static inline admissioner_t *create_admissioner(const char *admission_algo,
     admissioner = create_size_admissioner(admission_params);
   } else if (strcasecmp(admission_algo, "adaptsize") == 0) {
     admissioner = create_adaptsize_admissioner(admission_params);
+  } else if (strcasecmp(admission_algo, "tinylfu") == 0) {
+    admissioner = create_tinylfu_admissioner(admission_params);
+  } else if (strcasecmp(admission_algo, "scan") == 0) {
+    admissioner = create_scan_admissioner(admission_params);
   } else {
     ERROR("admission algo %s not supported\n", admission_algo);
   }
@@ -86,6 +86,11 @@ typedef struct {
   int64_t curr_rtime;
   int64_t expired_obj_cnt;
   int64_t expired_bytes;
+
+  /* the prefetcher stat, zero if the prefetcher does not maintain it */
+  int64_t n_prefetch;
+  int64_t n_prefetch_hit;
+  int64_t n_demand_miss;
   char cache_name[CACHE_NAME_ARRAY_LEN];
 } cache_stat_t;
 
@@ -139,6 +144,8 @@ struct cache {
   int64_t cache_size;
   int64_t default_ttl;
   int32_t obj_md_size;
+  // the hashpower the cache is created with, a clone uses the same hashpower
+  int32_t hashpower;
 
   /* cache stat is not updated automatically, it is popped up only in
    * some situations */
@@ -125,6 +125,11 @@ typedef struct {
   int32_t freq;
 } __attribute__((packed)) Sieve_obj_params_t;
 
+typedef struct {
+  // the visited bit or the frequency, accessed with atomic operations
+  int32_t freq;
+} __attribute__((packed)) Concurrent_obj_metadata_t;
+
 typedef struct {
   int64_t next_access_vtime;
   int32_t freq;
@@ -136,6 +141,9 @@ typedef struct cache_obj {
   struct cache_obj *hash_next;
   obj_id_t obj_id;
   uint32_t obj_size;
+  // the position in the hashtable's dense object array,
+  // only valid when sampling is enabled on the hashtable
+  uint32_t obj_arr_idx;
   struct {
     struct cache_obj *prev;
     struct cache_obj *next;
@@ -171,6 +179,7 @@ typedef struct cache_obj {
     LIRS_obj_metadata_t LIRS;
     S3FIFO_obj_metadata_t S3FIFO;
     Sieve_obj_params_t sieve;
+    Concurrent_obj_metadata_t concurrent;
 
 #if defined(ENABLE_GLCACHE) && ENABLE_GLCACHE == 1
     GLCache_obj_metadata_t GLCache;
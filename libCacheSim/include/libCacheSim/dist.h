@@ -19,6 +19,12 @@ typedef enum {
   FUTURE_STACK_DIST,
 } dist_type_e;
 
+typedef enum {
+  DIST_OUTPUT_BINARY,  /* int64_t per request */
+  DIST_OUTPUT_TXT,     /* one dist per line */
+  DIST_OUTPUT_CNT_TXT, /* the count of each dist, -1 is written as INT64_MAX */
+} dist_output_e;
+
 static char *g_dist_type_name[] = {
     "DIST_SINCE_LAST_ACCESS",
     "DIST_SINCE_FIRST_ACCESS",
@@ -84,6 +90,26 @@ void save_dist_as_cnt_txt(reader_t *const reader, const int32_t *dist_array,
                       const int64_t array_size, const char *const ofilepath,
                       const dist_type_e dist_type);
 
+/***********************************************************
+ * compute the distance of each request and write it to the output while
+ * reading the trace, unlike get_stack_dist and get_access_dist, the
+ * distances are not kept in memory and are not limited to int32_t
+ *
+ * the binary output (ofilepath.DIST_TYPE.int64) has an int64_t per request,
+ * FUTURE_STACK_DIST is written to a mmap'ed file because the distance of a
+ * request is known at its next request, so it cannot use the txt output
+ *
+ * @param reader
+ * @param dist_type
+ * @param output_type binary, txt or cnt, the txt and cnt output have the same
+ * format as save_dist_txt and save_dist_as_cnt_txt
+ * @param ofilepath
+ * @return the number of requests
+ */
+int64_t stream_dist(reader_t *const reader, const dist_type_e dist_type,
+                    const dist_output_e output_type,
+                    const char *const ofilepath);
+
 #ifdef __cplusplus
 }
 #endif
@@ -165,6 +165,23 @@ cache_t *FIFO_Belady_init(const common_cache_params_t ccache_params,
 cache_t *Sieve_init(const common_cache_params_t ccache_params,
                     const char *cache_specific_params);
 
+/* thread-safe algorithms, cache->get and cache->remove can be called by
+ * multiple threads at the same time */
+cache_t *ConcurrentFIFO_init(const common_cache_params_t ccache_params,
+                             const char *cache_specific_params);
+
+cache_t *ConcurrentClock_init(const common_cache_params_t ccache_params,
+                              const char *cache_specific_params);
+
+cache_t *ConcurrentSieve_init(const common_cache_params_t ccache_params,
+                              const char *cache_specific_params);
+
+cache_t *ConcurrentS3FIFO_init(const common_cache_params_t ccache_params,
+                               const char *cache_specific_params);
+
+cache_t *ShardedLRU_init(const common_cache_params_t ccache_params,
+                         const char *cache_specific_params);
+
 #ifdef ENABLE_LRB
 cache_t *LRB_init(const common_cache_params_t ccache_params,
                   const char *cache_specific_params);
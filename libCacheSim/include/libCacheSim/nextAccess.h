@@ -0,0 +1,78 @@
+//
+//  compute the next access vtime of each request of a trace in memory,
+//  so that algorithms that need the future (Belady, BeladySize,
+//  FIFO_Belady, ...) can run on a trace that is not in oracle format,
+//  see traceReader/nextAccess.c
+//
+//  nextAccess.h
+//  libCacheSim
+//
+
+#ifndef NEXT_ACCESS_H
+#define NEXT_ACCESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the default memory budget of the next access distances */
+#define NEXT_ACCESS_DEFAULT_MEM_LIMIT (4LL * 1024 * 1024 * 1024)
+/* the distance of a request that has no future access */
+#define NEXT_ACCESS_NONE UINT32_MAX
+
+struct reader;
+
+typedef struct next_access_oracle {
+  int64_t n_req;
+  int64_t n_obj;
+  /* the distance (in requests) to the next access of the same object,
+   * NEXT_ACCESS_NONE if the object is not requested again,
+   * a distance that does not fit in 32 bits is capped at
+   * NEXT_ACCESS_NONE - 1 */
+  uint32_t *dist;
+  /* the size of the mmapped sidecar file, 0 if dist is in memory */
+  size_t mapped_size;
+} next_access_oracle_t;
+
+/**
+ * @brief read the trace once and compute the next access of each request,
+ * if the distances do not fit in mem_limit_byte, they are spilled to a
+ * sidecar file next to the trace (or in $TMPDIR if the trace directory is
+ * not writable), which is mmapped and removed on close. The budget includes
+ * an estimate of the per-object memory (the object id map and the last seen
+ * positions), so a trace with many objects spills earlier.
+ * the reader is reset after the computation
+ *
+ * @param reader the reader, requests are read with read_one_req, so the
+ * sampler and other reader params apply
+ * @param mem_limit_byte the memory budget, <= 0 uses
+ * NEXT_ACCESS_DEFAULT_MEM_LIMIT
+ */
+next_access_oracle_t *create_next_access_oracle(struct reader *reader,
+                                                int64_t mem_limit_byte);
+
+void free_next_access_oracle(next_access_oracle_t *oracle);
+
+/**
+ * @brief get the next access vtime of the idx-th (start from 0) request,
+ * the vtime is the reference count (start from 1) of the next access, as in
+ * oracleGeneral traces, INT64_MAX if there is no future access
+ */
+static inline int64_t next_access_oracle_get(
+    const next_access_oracle_t *oracle, int64_t idx) {
+  if (idx >= oracle->n_req) return INT64_MAX;
+
+  uint32_t dist = oracle->dist[idx];
+  if (dist == NEXT_ACCESS_NONE) return INT64_MAX;
+  return idx + (int64_t)dist + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NEXT_ACCESS_H */
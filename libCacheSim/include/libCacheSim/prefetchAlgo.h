@@ -18,6 +18,19 @@ typedef void (*prefetcher_free_func_ptr)(struct prefetcher *);
 typedef struct prefetcher *(*prefetcher_clone_func_ptr)(struct prefetcher *,
                                                         uint64_t);
 
+/* prefetch effectiveness, maintained by OBL, Sequential and AMP */
+typedef struct prefetch_stat {
+  int64_t n_req;
+  /* user requests that miss */
+  int64_t n_demand_miss;
+  /* objects inserted by the prefetcher */
+  int64_t n_prefetch;
+  /* prefetched objects that are requested before eviction */
+  int64_t n_prefetch_hit;
+  /* prefetched objects that are evicted without being requested */
+  int64_t n_prefetch_unused;
+} prefetch_stat_t;
+
 typedef struct prefetcher {
   void *params;
   void *init_params;
@@ -26,17 +39,57 @@ typedef struct prefetcher {
   prefetcher_handle_evict_func_ptr handle_evict;
   prefetcher_free_func_ptr free;
   prefetcher_clone_func_ptr clone;
+  prefetch_stat_t stat;
 } prefetcher_t;
 
 prefetcher_t *create_Mithril_prefetcher(const char *init_paramsm,
                                         uint64_t cache_size);
 
+prefetcher_t *create_OBL_prefetcher(const char *init_params,
+                                    uint64_t cache_size);
+
+prefetcher_t *create_Sequential_prefetcher(const char *init_params,
+                                           uint64_t cache_size);
+
+prefetcher_t *create_AMP_prefetcher(const char *init_params,
+                                    uint64_t cache_size);
+
+/* the fraction of prefetched objects that are used */
+static inline double prefetch_accuracy(const prefetch_stat_t *stat) {
+  if (stat->n_prefetch == 0) return 0;
+  return (double)stat->n_prefetch_hit / (double)stat->n_prefetch;
+}
+
+/* the fraction of misses (without prefetching) that are removed by
+ * prefetching */
+static inline double prefetch_coverage(const prefetch_stat_t *stat) {
+  if (stat->n_prefetch_hit + stat->n_demand_miss == 0) return 0;
+  return (double)stat->n_prefetch_hit /
+         (double)(stat->n_prefetch_hit + stat->n_demand_miss);
+}
+
+static inline void print_prefetch_stat(const prefetcher_t *prefetcher) {
+  const prefetch_stat_t *stat = &prefetcher->stat;
+  printf(
+      "%ld req, %ld demand miss, %ld prefetch, %ld prefetch hit, "
+      "%ld unused, accuracy %.4lf, coverage %.4lf\n",
+      (long)stat->n_req, (long)stat->n_demand_miss, (long)stat->n_prefetch,
+      (long)stat->n_prefetch_hit, (long)stat->n_prefetch_unused,
+      prefetch_accuracy(stat), prefetch_coverage(stat));
+}
+
 static inline prefetcher_t *create_prefetcher(const char *prefetching_algo,
                                               const char *prefetching_params,
                                               uint64_t cache_size) {
   prefetcher_t *prefetcher = NULL;
   if (strcasecmp(prefetching_algo, "Mithril") == 0) {
     prefetcher = create_Mithril_prefetcher(prefetching_params, cache_size);
+  } else if (strcasecmp(prefetching_algo, "OBL") == 0) {
+    prefetcher = create_OBL_prefetcher(prefetching_params, cache_size);
+  } else if (strcasecmp(prefetching_algo, "Sequential") == 0) {
+    prefetcher = create_Sequential_prefetcher(prefetching_params, cache_size);
+  } else if (strcasecmp(prefetching_algo, "AMP") == 0) {
+    prefetcher = create_AMP_prefetcher(prefetching_params, cache_size);
   } else {
     ERROR("prefetching algo %s not supported\n", prefetching_algo);
   }
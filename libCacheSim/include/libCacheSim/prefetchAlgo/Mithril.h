@@ -16,6 +16,7 @@
 
 #include <glib.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
@@ -45,7 +46,7 @@
           params->cycle_time > 0 && params->cycle_time <= 100 &&            \
           params->block_size > 0 && params->sequential_type >= 0 &&         \
           params->sequential_type <= 2 && params->output_statistics >= 0 && \
-          params->output_statistics <= 1))
+          params->output_statistics <= 1 && params->mining_delay >= 0))
 
 /**
  retrieve the row_num row in the recording table
@@ -229,8 +230,56 @@ typedef struct {
   /** this is the control knob for whether printing out statistics **/
   gint output_statistics;
 
+  /** mine the associations on a helper thread,
+   *  the request path only takes a snapshot of the mining table
+   **/
+  gboolean async_mining;
+
+  /** with async_mining, the associations mined from a snapshot are added to
+   *  the prefetch table mining_delay requests after the snapshot is taken,
+   *  the simulation waits for the helper thread if it has not finished,
+   *  so the result does not depend on thread timing.
+   *  0: add the associations as soon as the helper thread finishes
+   **/
+  gint mining_delay;
+
 } Mithril_init_params_t;
 
+/** a snapshot of the mining table,
+ *  the timestamps of a row are unpacked into ts_stride contiguous int32,
+ *  rows are sorted by the first timestamp before mining, so that comparing
+ *  two rows is a short loop without unpacking or branches
+ **/
+typedef struct {
+  gint n_rows;
+  gint capacity;
+  gint ts_stride;
+  gint lookahead_range;
+  gint confidence;
+
+  /* rows in the order of the mining table */
+  gint64 *obj_ids;
+  gint32 *n_ts;
+  gint32 *ts;
+
+  /* (first timestamp << 32 | row) used for sorting */
+  gint64 *sort_keys;
+
+  /* rows sorted by the first timestamp */
+  gint64 *sorted_obj_ids;
+  gint32 *sorted_n_ts;
+  gint32 *sorted_ts;
+
+  /* the mined associations, pairs of (obj_id, associated obj_id) */
+  gint64 *assoc;
+  gint64 n_assoc;
+  gint64 assoc_capacity;
+
+  /* the Mithril ts when the snapshot is taken */
+  guint64 snapshot_ts;
+  gdouble mining_time;
+} mining_job_t;
+
 typedef struct {
   /** the hash table for storing block related info,
    *  currently key is the block number
@@ -346,6 +395,24 @@ typedef struct {
   guint64 num_of_check;
 
   GHashTable *cache_size_map;
+
+  /* mining, see Mithril_init_params_t */
+  gboolean async_mining;
+  gint mining_delay;
+  mining_job_t mining_job;
+  /* only accessed on the request path */
+  gboolean job_in_flight;
+  guint64 n_mining_blocked;
+
+  gboolean mining_thread_started;
+  pthread_t mining_thread;
+  pthread_mutex_t mining_mtx;
+  pthread_cond_t mining_cond;
+  /* protected by mining_mtx */
+  gboolean job_submitted;
+  gboolean mining_stop;
+  /* set by the mining thread, read without the lock */
+  gint job_done;
 } Mithril_params_t;
 
 #ifdef __cplusplus
@@ -26,6 +26,7 @@
 #include "const.h"
 #include "enum.h"
 #include "logging.h"
+#include "nextAccess.h"
 #include "request.h"
 #include "sampling.h"
 
@@ -64,6 +65,13 @@ typedef struct {
 
   // sample some requests in the trace
   sampler_t *sampler;
+
+  // compute next_access_vtime in memory when the reader is set up,
+  // used by algorithms that need the future on non-oracle traces
+  bool compute_next_access;
+  // the memory budget of the next access, beyond it the next access is
+  // spilled to a sidecar file, <= 0 uses the default
+  int64_t next_access_mem_limit;
 } reader_init_param_t;
 
 enum read_direction {
@@ -76,6 +84,9 @@ typedef struct reader {
   /************* common fields *************/
   uint64_t n_read_req;
   uint64_t n_total_req; /* number of requests in the trace */
+  /* number of objects in the trace from the trace header (LCS), 0 if the
+   * trace does not have it */
+  int64_t n_total_obj;
   char *trace_path;
   size_t file_size;
   reader_init_param_t init_params;
@@ -126,6 +137,12 @@ typedef struct reader {
   /* used for trace sampling */
   sampler_t *sampler;
   enum read_direction read_direction;
+
+  /* the next access computed when the reader is set up, shared by cloned
+   * readers, next_access_idx is the number of requests returned since the
+   * last reset, it is only used when reading forward */
+  next_access_oracle_t *next_access;
+  int64_t next_access_idx;
 } reader_t;
 
 static inline void set_default_reader_init_params(reader_init_param_t *params) {
@@ -152,6 +169,9 @@ static inline void set_default_reader_init_params(reader_init_param_t *params) {
   params->binary_fmt_str = NULL;
 
   params->sampler = NULL;
+
+  params->compute_next_access = false;
+  params->next_access_mem_limit = 0;
 }
 
 static inline reader_init_param_t default_reader_init_params(void) {
@@ -253,6 +273,8 @@ static inline int close_trace(reader_t *const reader) {
  */
 reader_t *clone_reader(const reader_t *reader);
 
+/* read the first (last) request of the trace without the sampler, the
+ * position of the reader and the next access do not change */
 void read_first_req(reader_t *reader, request_t *req);
 
 void read_last_req(reader_t *reader, request_t *req);
@@ -8,8 +8,12 @@ extern "C" {
 
 #include <assert.h>
 #include <math.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "../dataStructure/splay.h"
 #include "../include/libCacheSim/dist.h"
@@ -133,8 +137,11 @@ int32_t *get_stack_dist(reader_t *reader, const dist_type_e dist_type,
   while (req->valid) {
     stack_dist = get_stack_dist_add_req(req, &splay_tree, hash_table, curr_ts,
                                         &last_access_ts);
-    if (stack_dist > (int64_t)UINT32_MAX) {
-      ERROR("stack distance %ld is larger than UINT32_MAX\n", (long)stack_dist);
+    if (stack_dist > (int64_t)INT32_MAX) {
+      ERROR(
+          "stack distance %ld is larger than INT32_MAX, use stream_dist "
+          "instead\n",
+          (long)stack_dist);
       abort();
     }
     if (dist_type == STACK_DIST) {
@@ -174,8 +181,11 @@ int32_t *get_access_dist(reader_t *reader, const dist_type_e dist_type,
 
   while (req->valid) {
     dist = get_access_dist_add_req(req, hash_table, curr_ts, dist_type);
-    if (dist > (int64_t)UINT32_MAX) {
-      ERROR("access distance %ld is larger than UINT32_MAX\n", (long)dist);
+    if (dist > (int64_t)INT32_MAX) {
+      ERROR(
+          "access distance %ld is larger than INT32_MAX, use stream_dist "
+          "instead\n",
+          (long)dist);
       abort();
     }
 
@@ -280,6 +290,190 @@ void save_dist_as_cnt_txt(reader_t *const reader, const int32_t *dist_array,
   free(file_path);
 }
 
+/***********************************************************
+ * the output of stream_dist, the distances are written as they are computed
+ * binary: a buffered file, or a mmap'ed file when the distances are not
+ *         computed in the order of the requests (FUTURE_STACK_DIST)
+ * txt: a buffered file
+ * cnt: a hash table of dist -> cnt, written at the end
+ */
+typedef struct {
+  dist_output_e output_type;
+  char *file_path;
+  FILE *file;
+  int64_t *mapped_file;
+  size_t mapped_size;
+  GHashTable *cnt_table;
+} dist_stream_t;
+
+#define DIST_STREAM_BUF_SIZE (8 * MiB)
+
+static void _dist_stream_open(dist_stream_t *stream, reader_t *const reader,
+                              const char *const ofilepath,
+                              const dist_type_e dist_type,
+                              const dist_output_e output_type) {
+  memset(stream, 0, sizeof(dist_stream_t));
+  stream->output_type = output_type;
+  stream->file_path = (char *)malloc(strlen(ofilepath) + 128);
+
+  if (output_type == DIST_OUTPUT_CNT_TXT) {
+    sprintf(stream->file_path, "%s.%s.cnt", ofilepath,
+            g_dist_type_name[dist_type]);
+    stream->cnt_table =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
+    return;
+  }
+
+  if (output_type == DIST_OUTPUT_TXT) {
+    if (dist_type == FUTURE_STACK_DIST) {
+      ERROR(
+          "future stack distance is not computed in request order, "
+          "use the binary or cnt output\n");
+      abort();
+    }
+    sprintf(stream->file_path, "%s.%s.txt", ofilepath,
+            g_dist_type_name[dist_type]);
+  } else {
+    /* int64_t per request */
+    sprintf(stream->file_path, "%s.%s.int64", ofilepath,
+            g_dist_type_name[dist_type]);
+  }
+
+  if (output_type == DIST_OUTPUT_BINARY && dist_type == FUTURE_STACK_DIST) {
+    stream->mapped_size = sizeof(int64_t) * get_num_of_req(reader);
+    int fd = open(stream->file_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, (off_t)stream->mapped_size) != 0) {
+      ERROR("cannot create %s, %s\n", stream->file_path, strerror(errno));
+      abort();
+    }
+    if (stream->mapped_size > 0) {
+      stream->mapped_file = (int64_t *)mmap(NULL, stream->mapped_size,
+                                            PROT_READ | PROT_WRITE,
+                                            MAP_SHARED, fd, 0);
+      if (stream->mapped_file == MAP_FAILED) {
+        ERROR("cannot mmap %s, %s\n", stream->file_path, strerror(errno));
+        abort();
+      }
+    }
+    close(fd);
+    return;
+  }
+
+  stream->file = fopen(stream->file_path,
+                       output_type == DIST_OUTPUT_BINARY ? "wb" : "w");
+  if (stream->file == NULL) {
+    ERROR("cannot open %s, %s\n", stream->file_path, strerror(errno));
+    abort();
+  }
+  setvbuf(stream->file, NULL, _IOFBF, DIST_STREAM_BUF_SIZE);
+}
+
+/* write the dist of the request at idx, the requests are in order except in
+ * the mmap'ed output */
+static inline void _dist_stream_put(dist_stream_t *stream, const int64_t idx,
+                                    const int64_t dist) {
+  if (stream->mapped_file != NULL) {
+    if ((size_t)idx >= stream->mapped_size / sizeof(int64_t)) {
+      ERROR("the trace has more requests than get_num_of_req\n");
+      abort();
+    }
+    stream->mapped_file[idx] = dist;
+  } else if (stream->output_type == DIST_OUTPUT_BINARY) {
+    fwrite(&dist, sizeof(int64_t), 1, stream->file);
+  } else if (stream->output_type == DIST_OUTPUT_TXT) {
+    fprintf(stream->file, "%ld\n", (long)dist);
+  } else {
+    /* the same encoding as save_dist_as_cnt_txt */
+    gpointer gp_dist = GSIZE_TO_POINTER((gsize)(dist == -1 ? INT64_MAX : dist));
+    int64_t old_cnt = (int64_t)g_hash_table_lookup(stream->cnt_table, gp_dist);
+    g_hash_table_replace(stream->cnt_table, gp_dist,
+                         GSIZE_TO_POINTER(old_cnt + 1));
+  }
+}
+
+static void _dist_stream_close(dist_stream_t *stream) {
+  if (stream->cnt_table != NULL) {
+    FILE *file = fopen(stream->file_path, "w");
+    if (file == NULL) {
+      ERROR("cannot open %s, %s\n", stream->file_path, strerror(errno));
+      abort();
+    }
+    g_hash_table_foreach(stream->cnt_table, (GHFunc)_write_dist_cnt, file);
+    fclose(file);
+    g_hash_table_destroy(stream->cnt_table);
+  }
+
+  if (stream->mapped_file != NULL) {
+    munmap(stream->mapped_file, stream->mapped_size);
+  }
+
+  if (stream->file != NULL) {
+    if (fclose(stream->file) != 0) {
+      ERROR("fail to write %s, %s\n", stream->file_path, strerror(errno));
+      abort();
+    }
+  }
+
+  free(stream->file_path);
+}
+
+int64_t stream_dist(reader_t *const reader, const dist_type_e dist_type,
+                    const dist_output_e output_type,
+                    const char *const ofilepath) {
+  int64_t curr_ts = 0;
+  int64_t last_access_ts = 0;
+  int64_t dist = 0;
+  request_t *req = new_request();
+
+  dist_stream_t stream;
+  _dist_stream_open(&stream, reader, ofilepath, dist_type, output_type);
+
+  GHashTable *hash_table =
+      g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
+  sTree *splay_tree = NULL;
+
+  read_one_req(reader, req);
+  while (req->valid) {
+    if (dist_type == STACK_DIST) {
+      dist = get_stack_dist_add_req(req, &splay_tree, hash_table, curr_ts,
+                                    NULL);
+      _dist_stream_put(&stream, curr_ts, dist);
+    } else if (dist_type == FUTURE_STACK_DIST) {
+      dist = get_stack_dist_add_req(req, &splay_tree, hash_table, curr_ts,
+                                    &last_access_ts);
+      if (output_type == DIST_OUTPUT_CNT_TXT) {
+        /* each reuse has the same distance looking backward and forward, and
+         * the number of -1 is the number of objects in both, so the count of
+         * future stack distances is the count of stack distances */
+        _dist_stream_put(&stream, curr_ts, dist);
+      } else {
+        _dist_stream_put(&stream, curr_ts, -1);
+        if (last_access_ts != -1) {
+          _dist_stream_put(&stream, last_access_ts, dist);
+        }
+      }
+    } else if (dist_type == DIST_SINCE_LAST_ACCESS ||
+               dist_type == DIST_SINCE_FIRST_ACCESS) {
+      dist = get_access_dist_add_req(req, hash_table, curr_ts, dist_type);
+      _dist_stream_put(&stream, curr_ts, dist);
+    } else {
+      ERROR("dist_type %d is not supported\n", dist_type);
+    }
+
+    read_one_req(reader, req);
+    curr_ts++;
+  }
+
+  _dist_stream_close(&stream);
+
+  free_request(req);
+  g_hash_table_destroy(hash_table);
+  free_sTree(splay_tree);
+  reset_reader(reader);
+
+  return curr_ts;
+}
+
 #ifdef __cplusplus
 }
 #endif
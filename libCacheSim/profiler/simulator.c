@@ -17,6 +17,7 @@ extern "C" {
 #include "../cache/cacheUtils.h"
 #include "../include/libCacheSim/evictionAlgo.h"
 #include "../include/libCacheSim/plugin.h"
+#include "../include/libCacheSim/prefetchAlgo.h"
 #include "../utils/include/myprint.h"
 #include "../utils/include/mystr.h"
 
@@ -99,7 +100,7 @@ static void _simulate(gpointer data, gpointer user_data) {
 /* disabled due to ARC and LeCaR use ghost entries in the hash table */
 #if defined(SUPPORT_TTL) && defined(ENABLE_SCAN)
   /* get expiration information */
-  if (local_cache->hashtable->n_obj != 0) {
+  if (local_cache->hashtable != NULL && local_cache->hashtable->n_obj != 0) {
     cache_stat_t temp_stat;
     memset(&temp_stat, 0, sizeof(cache_stat_t));
     temp_stat.curr_rtime = req->clock_time;
@@ -117,6 +118,13 @@ static void _simulate(gpointer data, gpointer user_data) {
   }
 #endif
 
+  /* the prefetcher stat also counts the warmup requests */
+  if (local_cache->prefetcher != NULL) {
+    result[idx].n_prefetch = local_cache->prefetcher->stat.n_prefetch;
+    result[idx].n_prefetch_hit = local_cache->prefetcher->stat.n_prefetch_hit;
+    result[idx].n_demand_miss = local_cache->prefetcher->stat.n_demand_miss;
+  }
+
   result[idx].curr_rtime = req->clock_time;
   result[idx].n_obj = local_cache->n_obj;
   result[idx].occupied_byte = local_cache->occupied_byte;
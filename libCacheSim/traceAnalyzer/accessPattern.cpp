@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <numeric>
@@ -43,63 +44,148 @@ void AccessPattern::add_req(const request_t *req) {
     return;
   }
 
-  if (access_rtime_map_.find(req->obj_id) == access_rtime_map_.end()) {
-    access_rtime_map_[req->obj_id] = vector<uint32_t>();
-    access_vtime_map_[req->obj_id] = vector<uint32_t>();
+  uint32_t rtime = (uint32_t)(req->clock_time - start_rtime_);
+  uint32_t vtime = (uint32_t)n_seen_req_;
+
+  auto it = obj_idx_map_.find(req->obj_id);
+  if (it == obj_idx_map_.end()) {
+    uint32_t block = new_block();
+    obj_idx_map_[req->obj_id] = (uint32_t)obj_access_.size();
+    obj_access_.push_back({req->obj_id, block, block, 0, 0, 0,
+                           (uint32_t)sizeof(uint32_t)});
+    n_obj_ += 1;
+    it = obj_idx_map_.find(req->obj_id);
   }
-  access_rtime_map_[req->obj_id].push_back(req->clock_time - start_rtime_);
-  access_vtime_map_[req->obj_id].push_back(n_seen_req_);
+
+  struct obj_access &obj = obj_access_[it->second];
+  append_varint(obj, rtime - obj.last_rtime);
+  append_varint(obj, vtime - obj.last_vtime);
+  obj.last_rtime = rtime;
+  obj.last_vtime = vtime;
+  obj.n_access += 1;
+  n_access_ += 1;
 }
 
-void AccessPattern::dump(string &path_base) {
-  string ofile_path = path_base + ".accessRtime";
-  ofstream ofs(ofile_path, ios::out | ios::trunc);
-  ofs << "# " << path_base << "\n";
-  ofs << "# access pattern real time, each line stores all the real time of "
-         "requests to an object\n";
-
-  // sort the timestamp list by the first timestamp
-  vector<vector<uint32_t> *> sorted_rtime_vec;
-  for (auto &p : access_rtime_map_) {
-    sorted_rtime_vec.push_back(&p.second);
-  }
-  sort(sorted_rtime_vec.begin(), sorted_rtime_vec.end(),
-       [](vector<uint32_t> *p1, vector<uint32_t> *p2) {
-         return (*p1).at(0) < (*p2).at(0);
-       });
-
-  for (const auto *p : sorted_rtime_vec) {
-    for (const uint32_t rtime : *p) {
-      ofs << rtime << ",";
-    }
-    ofs << "\n";
+uint32_t AccessPattern::new_block() {
+  uint32_t block = (uint32_t)(arena_.size() / block_size_);
+  arena_.resize(arena_.size() + block_size_, 0);
+  memcpy(&arena_[(size_t)block * block_size_], &no_block_, sizeof(uint32_t));
+  return block;
+}
+
+void AccessPattern::append_byte(struct obj_access &obj, uint8_t byte) {
+  if (obj.last_block_used == block_size_) {
+    uint32_t block = new_block();
+    memcpy(&arena_[(size_t)obj.last_block * block_size_], &block,
+           sizeof(uint32_t));
+    obj.last_block = block;
+    obj.last_block_used = sizeof(uint32_t);
   }
-  ofs << "\n" << endl;
-  ofs.close();
+  arena_[(size_t)obj.last_block * block_size_ + obj.last_block_used] = byte;
+  obj.last_block_used += 1;
+}
 
-  ofs << "# " << path_base << "\n";
-  string ofile_path2 = path_base + ".accessVtime";
-  ofstream ofs2(ofile_path2, ios::out | ios::trunc);
-  ofs2 << "# access pattern virtual time, each line stores all the virtual "
-          "time of requests to an object\n";
-  vector<vector<uint32_t> *> sorted_vtime_vec;
-  for (auto &p : access_vtime_map_) {
-    sorted_vtime_vec.push_back(&(p.second));
+void AccessPattern::append_varint(struct obj_access &obj, uint32_t v) {
+  while (v >= 0x80) {
+    append_byte(obj, (uint8_t)(v | 0x80));
+    v >>= 7;
   }
+  append_byte(obj, (uint8_t)v);
+}
 
-  sort(sorted_vtime_vec.begin(), sorted_vtime_vec.end(),
-       [](vector<uint32_t> *p1, vector<uint32_t> *p2) -> bool {
-         return (*p1).at(0) < (*p2).at(0);
-       });
+template <typename F>
+void AccessPattern::for_each_access(const struct obj_access &obj,
+                                    F fn) const {
+  uint32_t block = obj.first_block;
+  uint32_t pos = sizeof(uint32_t);
+  auto next_byte = [&]() -> uint8_t {
+    if (pos == block_size_) {
+      memcpy(&block, &arena_[(size_t)block * block_size_], sizeof(uint32_t));
+      pos = sizeof(uint32_t);
+    }
+    return arena_[(size_t)block * block_size_ + pos++];
+  };
+  auto next_varint = [&]() -> uint32_t {
+    uint32_t v = 0;
+    for (int shift = 0;; shift += 7) {
+      uint8_t b = next_byte();
+      v |= (uint32_t)(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) return v;
+    }
+  };
 
-  for (const vector<uint32_t> *p : sorted_vtime_vec) {
-    for (const uint32_t vtime : *p) {
-      ofs2 << vtime << ",";
+  uint32_t rtime = 0, vtime = 0;
+  for (uint32_t i = 0; i < obj.n_access; i++) {
+    rtime += next_varint();
+    vtime += next_varint();
+    fn(rtime, vtime);
+  }
+}
+
+void AccessPattern::dump(string &path_base) {
+  string ofile_path = path_base + ".accessPattern";
+  ofstream ofs(ofile_path, ios::out | ios::trunc | ios::binary);
+
+  struct access_pattern_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, ACCESS_PATTERN_MAGIC, sizeof(ACCESS_PATTERN_MAGIC));
+  header.version = ACCESS_PATTERN_VERSION;
+  header.sample_ratio = sample_ratio_;
+  header.n_obj = obj_access_.size();
+  header.n_access = n_access_;
+  header.start_rtime = start_rtime_;
+  ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  /* the objects are stored in the order of first access */
+  vector<struct access_pattern_obj> objs;
+  objs.reserve(obj_access_.size());
+  uint64_t first_access = 0;
+  for (const auto &obj : obj_access_) {
+    objs.push_back({obj.obj_id, first_access, obj.n_access, 0});
+    first_access += obj.n_access;
+  }
+  ofs.write(reinterpret_cast<const char *>(objs.data()),
+            (streamsize)(sizeof(struct access_pattern_obj) * objs.size()));
+
+  /* the rtime and the vtime of all accesses are written in two passes */
+  vector<uint32_t> buf;
+  buf.reserve(1 << 16);
+  auto flush = [&]() {
+    ofs.write(reinterpret_cast<const char *>(buf.data()),
+              (streamsize)(sizeof(uint32_t) * buf.size()));
+    buf.clear();
+  };
+  for (int pass = 0; pass < 2; pass++) {
+    for (const auto &obj : obj_access_) {
+      for_each_access(obj, [&](uint32_t rtime, uint32_t vtime) {
+        buf.push_back(pass == 0 ? rtime : vtime);
+        if (buf.size() == buf.capacity()) flush();
+      });
     }
-    ofs2 << "\n";
+    flush();
   }
 
-  ofs2.close();
+  ofs.close();
+}
+
+void AccessPattern::save(CheckpointWriter &ckpt) {
+  ckpt.put(n_obj_);
+  ckpt.put(n_seen_req_);
+  ckpt.put(start_rtime_);
+  ckpt.put(n_access_);
+  ckpt.put(arena_);
+  ckpt.put(obj_access_);
+  ckpt.put(obj_idx_map_);
+}
+
+void AccessPattern::load(CheckpointReader &ckpt) {
+  ckpt.get(n_obj_);
+  ckpt.get(n_seen_req_);
+  ckpt.get(start_rtime_);
+  ckpt.get(n_access_);
+  ckpt.get(arena_);
+  ckpt.get(obj_access_);
+  ckpt.get(obj_idx_map_);
 }
 
 };  // namespace traceAnalyzer
@@ -10,16 +10,53 @@
  * a bias when we plot the access pattern
  * so we use a static sample ratio
  *
+ * the accesses of all sampled objects are appended to one arena of fixed-size
+ * blocks, each object has a chain of blocks that stores the delta of the real
+ * and virtual time of its accesses as varints, so the memory is a few bytes
+ * per access plus one small entry per object
+ *
+ * the result is dumped to a binary file (path_base.accessPattern) that can
+ * be mmapped by the plotting script, all fields are little-endian
+ *   header: struct access_pattern_header
+ *   objects: n_obj * struct access_pattern_obj, in the order of first access
+ *   rtime: n_access * uint32_t, the real time (since the first request) of
+ *          the accesses of object 0, object 1 ...
+ *   vtime: n_access * uint32_t, the virtual time of the same accesses
  */
 
 
+#include <cstdint>
+#include <vector>
+
 #include "../include/libCacheSim/logging.h"
 #include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
 #include "struct.h"
 
 using namespace std;
 
 namespace traceAnalyzer {
+
+#define ACCESS_PATTERN_MAGIC "LCSACCP"
+#define ACCESS_PATTERN_VERSION 1
+
+struct access_pattern_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t sample_ratio;
+  uint64_t n_obj;
+  uint64_t n_access;
+  int64_t start_rtime;
+};
+
+struct access_pattern_obj {
+  uint64_t obj_id;
+  /* the index of the first access of the object in rtime and vtime */
+  uint64_t first_access;
+  uint32_t n_access;
+  uint32_t pad;
+};
+
 class AccessPattern {
  public:
   /**
@@ -49,13 +86,47 @@ class AccessPattern {
 
   void dump(string &path_base);
 
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter &ckpt);
+
+  void load(CheckpointReader &ckpt);
+
  private:
   int64_t n_obj_ = 0;
   int64_t n_seen_req_ = 0;
   int sample_ratio_ = 1001;
 
   int64_t start_rtime_ = -1;
-  unordered_map<obj_id_t, vector<uint32_t>> access_rtime_map_;
-  unordered_map<obj_id_t, vector<uint32_t>> access_vtime_map_;
+  int64_t n_access_ = 0;
+
+  /* a block starts with the index of the next block in the chain */
+  static constexpr int block_size_ = 32;
+  static constexpr uint32_t no_block_ = UINT32_MAX;
+
+  struct obj_access {
+    obj_id_t obj_id;
+    uint32_t first_block;
+    uint32_t last_block;
+    uint32_t last_rtime;
+    uint32_t last_vtime;
+    uint32_t n_access;
+    /* the number of bytes used in the last block */
+    uint32_t last_block_used;
+  };
+
+  std::vector<uint8_t> arena_;
+  /* the sampled objects in the order of first access */
+  std::vector<struct obj_access> obj_access_;
+  robin_hood::unordered_flat_map<obj_id_t, uint32_t> obj_idx_map_;
+
+  uint32_t new_block();
+
+  void append_byte(struct obj_access &obj, uint8_t byte);
+
+  void append_varint(struct obj_access &obj, uint32_t v);
+
+  /* call fn(rtime, vtime) for each access of obj in order */
+  template <typename F>
+  void for_each_access(const struct obj_access &obj, F fn) const;
 };
 }  // namespace traceAnalyzer
@@ -3,13 +3,23 @@
 //
 
 #include <algorithm>  // std::make_heap, std::pop_heap, std::push_heap, std::sort_heap
+#include <mutex>
+#include <thread>
+#include <unistd.h>
 #include <vector>  // std::vector
 
 #include "analyzer.h"
 #include "utils/include/utils.h"
 
 void traceAnalyzer::TraceAnalyzer::initialize() {
-  obj_map_.reserve(DEFAULT_PREALLOC_N_OBJ);
+  if (sketch_) {
+    obj_map_.reserve((size_t)((double)prealloc_n_obj() * sketch_sample_ratio_));
+    sketch_stat_ = new SketchStat(time_window_,
+                                  MAX(SKETCH_TOP_K, track_n_popular_),
+                                  SKETCH_CMS_ENTRIES);
+  } else if (n_thread_ <= 1) {
+    obj_map_.reserve(prealloc_n_obj());
+  }
 
   op_stat_ = new OpStat();
 
@@ -26,16 +36,36 @@ void traceAnalyzer::TraceAnalyzer::initialize() {
   }
 
   if (option_.size) {
-    size_stat_ = new SizeDistribution(output_path_, time_window_);
+    size_stat_ =
+        new SizeDistribution(output_path_, time_window_, binary_output_);
   }
 
   if (option_.reuse) {
-    reuse_stat_ = new ReuseDistribution(output_path_, time_window_);
+    reuse_stat_ = new ReuseDistribution(output_path_, time_window_, 5, 1000,
+                                        binary_output_);
   }
 
   if (option_.popularity_decay) {
     popularity_decay_stat_ =
-        new PopularityDecay(output_path_, time_window_, warmup_time_);
+        new PopularityDecay(output_path_, time_window_, warmup_time_,
+                            binary_output_);
+  }
+
+  if (option_.footprint) {
+    footprint_stat_ =
+        new Footprint(time_window_, sketch_ ? 1.0 / sketch_sample_ratio_ : 1.0);
+  }
+
+  if (option_.stack_dist) {
+    stack_dist_stat_ =
+        new StackDist(output_path_, time_window_,
+                      sketch_ ? 1.0 / sketch_sample_ratio_ : 1.0,
+                      binary_output_);
+  }
+
+  if (option_.scan) {
+    scan_stat_ = new ScanStat(output_path_, time_window_, SCAN_N_STREAMS,
+                              scan_min_run_, scan_max_gap_, binary_output_);
   }
 
   if (option_.create_future_reuse_ccdf) {
@@ -53,8 +83,21 @@ void traceAnalyzer::TraceAnalyzer::initialize() {
   if (option_.size_change) {
     size_change_distribution_ = new SizeChangeDistribution();
   }
+}
+
+size_t traceAnalyzer::TraceAnalyzer::prealloc_n_obj() const {
+  /* the number of objects is at most the number of requests */
+  int64_t n_obj = (int64_t)DEFAULT_PREALLOC_N_OBJ;
+  if (reader_->n_total_obj > 0) {
+    n_obj = reader_->n_total_obj;
+  } else if (reader_->n_total_req > 0) {
+    n_obj = MIN(n_obj, (int64_t)reader_->n_total_req);
+  }
+  if (reader_->cap_at_n_req > 0) {
+    n_obj = MIN(n_obj, reader_->cap_at_n_req);
+  }
 
-  // scan_detector_ = new ScanDetector(reader_, output_path, 100);
+  return (size_t)n_obj;
 }
 
 void traceAnalyzer::TraceAnalyzer::cleanup() {
@@ -66,6 +109,9 @@ void traceAnalyzer::TraceAnalyzer::cleanup() {
   delete access_stat_;
   delete popularity_stat_;
   delete popularity_decay_stat_;
+  delete footprint_stat_;
+  delete stack_dist_stat_;
+  delete scan_stat_;
 
   delete prob_at_age_;
   delete lifetime_stat_;
@@ -75,7 +121,16 @@ void traceAnalyzer::TraceAnalyzer::cleanup() {
   // delete write_reuse_stat_;
   // delete write_future_reuse_stat_;
 
-  delete scan_detector_;
+  delete sketch_stat_;
+
+  for (auto *shard : shards_) {
+    delete shard->size_stat;
+    delete shard->reuse_stat;
+    delete shard->popularity_decay_stat;
+    delete shard->footprint_stat;
+    delete shard;
+  }
+  shards_.clear();
 
   if (n_hit_cnt_ != nullptr) {
     delete[] n_hit_cnt_;
@@ -88,15 +143,109 @@ void traceAnalyzer::TraceAnalyzer::cleanup() {
 void traceAnalyzer::TraceAnalyzer::run() {
   if (has_run_) return;
 
+  if (sketch_) {
+    run_sketch();
+  } else if (n_thread_ > 1) {
+    run_parallel();
+  } else {
+    run_serial();
+  }
+
+  /* processing */
+  post_processing();
+
+  {
+    /* the analyzers of a batch append to the same file */
+    static std::mutex stat_file_mtx;
+    std::lock_guard<std::mutex> lock(stat_file_mtx);
+    ofstream ofs("stat", ios::out | ios::app);
+    ofs << gen_stat_str() << endl;
+    ofs.close();
+  }
+
+  if (ttl_stat_ != nullptr) {
+    ttl_stat_->dump(output_path_);
+  }
+
+  if (req_rate_stat_ != nullptr) {
+    req_rate_stat_->dump(output_path_);
+  }
+
+  if (reuse_stat_ != nullptr) {
+    reuse_stat_->dump(output_path_);
+  }
+
+  if (size_stat_ != nullptr) {
+    size_stat_->dump(output_path_);
+  }
+
+  if (access_stat_ != nullptr) {
+    access_stat_->dump(output_path_);
+  }
+
+  if (popularity_stat_ != nullptr) {
+    popularity_stat_->dump(output_path_);
+  }
+
+  if (popularity_decay_stat_ != nullptr) {
+    popularity_decay_stat_->dump(output_path_);
+  }
+
+  if (footprint_stat_ != nullptr) {
+    footprint_stat_->dump(output_path_);
+  }
+
+  if (stack_dist_stat_ != nullptr) {
+    stack_dist_stat_->dump(output_path_);
+  }
+
+  if (scan_stat_ != nullptr) {
+    scan_stat_->dump(output_path_);
+  }
+
+  if (prob_at_age_ != nullptr) {
+    prob_at_age_->dump(output_path_);
+  }
+
+  if (lifetime_stat_ != nullptr) {
+    lifetime_stat_->dump(output_path_);
+  }
+
+  if (create_future_reuse_ != nullptr) {
+    create_future_reuse_->dump(output_path_);
+  }
+
+  // if (write_reuse_stat_ != nullptr) {
+  //   write_reuse_stat_->dump(output_path_);
+  // }
+
+  // if (write_future_reuse_stat_ != nullptr) {
+  //   write_future_reuse_stat_->dump(output_path_);
+  // }
+
+  has_run_ = true;
+}
+
+void traceAnalyzer::TraceAnalyzer::run_serial() {
   request_t *req = new_request();
-  read_one_req(reader_, req);
-  start_ts_ = req->clock_time;
   int32_t curr_time_window_idx = 0;
-  int next_time_window_ts = time_window_;
+  int64_t next_time_window_ts = time_window_;
+  /* the number of requests read from this trace */
+  int64_t n_req_in_trace = 0;
+
+  bool resume = resume_ && access(checkpoint_path_.c_str(), F_OK) == 0;
+  if (resume) {
+    n_req_in_trace =
+        load_checkpoint(&curr_time_window_idx, &next_time_window_ts);
+  } else if (resume_) {
+    INFO("no checkpoint %s, start a new analysis\n", checkpoint_path_.c_str());
+  }
+
+  read_one_req(reader_, req);
+  if (!resume) start_ts_ = req->clock_time;
 
-  int64_t n = 0;
   /* going through the trace */
-  do {
+  while (req->valid) {
     DEBUG_ASSERT(req->obj_size != 0);
 
     // change real time to relative time
@@ -119,66 +268,13 @@ void traceAnalyzer::TraceAnalyzer::run() {
 
     n_req_ += 1;
     sum_obj_size_req += req->obj_size;
+    req->n_req = n_req_;
 
-    auto it = obj_map_.find(req->obj_id);
-    if (it == obj_map_.end()) {
-      /* the first request to the object */
-      req->compulsory_miss =
-          true; /* whether the object is seen for the first time */
-      req->overwrite = false;
-      req->first_seen_in_window = true;
-      req->create_rtime = (int32_t)req->clock_time;
-      req->prev_size = -1;
-      //      req->last_seen_window_idx = curr_time_window_idx;
-
-      req->vtime_since_last_access = -1;
-      req->rtime_since_last_access = -1;
-
-      struct obj_info obj_info;
-      obj_info.create_rtime = (int32_t)req->clock_time;
-      obj_info.freq = 1;
-      obj_info.obj_size = (obj_size_t)req->obj_size;
-      obj_info.last_access_rtime = (int32_t)req->clock_time;
-      obj_info.last_access_vtime = n_req_;
-
-      obj_map_[req->obj_id] = obj_info;
+    if (update_obj_map(obj_map_, req, n_req_, curr_time_window_idx)) {
       sum_obj_size_obj += req->obj_size;
-
-    } else {
-      req->compulsory_miss = false;
-      req->first_seen_in_window =
-          (time_to_window_idx(it->second.last_access_rtime) !=
-           curr_time_window_idx);
-      req->create_rtime = it->second.create_rtime;
-      if (req->op == OP_SET || req->op == OP_REPLACE || req->op == OP_CAS) {
-        req->overwrite = true;
-      } else {
-        req->overwrite = false;
-      }
-      req->vtime_since_last_access =
-          (int64_t)n_req_ - it->second.last_access_vtime;
-      req->rtime_since_last_access =
-          (int64_t)(req->clock_time) - it->second.last_access_rtime;
-
-      assert(req->vtime_since_last_access > 0);
-      assert(req->rtime_since_last_access >= 0);
-
-      req->prev_size = it->second.obj_size;
-      it->second.obj_size = req->obj_size;
-      it->second.freq += 1;
-      it->second.last_access_vtime = n_req_;
-      it->second.last_access_rtime = (int32_t)(req->clock_time);
     }
 
-    op_stat_->add_req(req);
-
-    if (ttl_stat_ != nullptr) {
-      ttl_stat_->add_req(req);
-    }
-
-    if (req_rate_stat_ != nullptr) {
-      req_rate_stat_->add_req(req);
-    }
+    add_req_in_order(req);
 
     if (size_stat_ != nullptr) {
       size_stat_->add_req(req);
@@ -188,115 +284,148 @@ void traceAnalyzer::TraceAnalyzer::run() {
       reuse_stat_->add_req(req);
     }
 
-    if (access_stat_ != nullptr) {
-      access_stat_->add_req(req);
-    }
-
     if (popularity_decay_stat_ != nullptr) {
       popularity_decay_stat_->add_req(req);
     }
 
-    if (prob_at_age_ != nullptr) {
-      prob_at_age_->add_req(req);
-    }
-
-    if (lifetime_stat_ != nullptr) {
-      lifetime_stat_->add_req(req);
-    }
-
-    if (create_future_reuse_ != nullptr) {
-      create_future_reuse_->add_req(req);
+    if (footprint_stat_ != nullptr) {
+      footprint_stat_->add_req(req);
     }
 
-    if (size_change_distribution_ != nullptr) {
-      size_change_distribution_->add_req(req);
-    }
-    if (scan_detector_ != nullptr) {
-      scan_detector_->add_req(req);
+    end_ts_ = req->clock_time + start_ts_;
+    n_req_in_trace += 1;
+    if (!checkpoint_path_.empty() &&
+        n_req_in_trace % checkpoint_interval_ == 0) {
+      save_checkpoint(curr_time_window_idx, next_time_window_ts,
+                      n_req_in_trace, false);
     }
 
     read_one_req(reader_, req);
-  } while (req->valid);
-  end_ts_ = req->clock_time + start_ts_;
+  }
 
-  /* processing */
-  post_processing();
+  /* before the results are computed, so that the next segment of the trace
+   * can continue the analysis */
+  if (!checkpoint_path_.empty()) {
+    save_checkpoint(curr_time_window_idx, next_time_window_ts, n_req_in_trace,
+                    true);
+  }
 
   free_request(req);
+}
 
-  ofstream ofs("stat", ios::out | ios::app);
-  ofs << gen_stat_str() << endl;
-  ofs.close();
-
-  if (ttl_stat_ != nullptr) {
-    ttl_stat_->dump(output_path_);
+bool traceAnalyzer::TraceAnalyzer::update_obj_map(obj_info_map_type &obj_map,
+                                                  request_t *req, int64_t vtime,
+                                                  int32_t curr_time_window_idx) {
+  auto it = obj_map.find(req->obj_id);
+  if (it == obj_map.end()) {
+    /* the first request to the object */
+    req->compulsory_miss =
+        true; /* whether the object is seen for the first time */
+    req->overwrite = false;
+    req->first_seen_in_window = true;
+    req->create_rtime = (int32_t)req->clock_time;
+    req->prev_size = -1;
+    //      req->last_seen_window_idx = curr_time_window_idx;
+
+    req->vtime_since_last_access = -1;
+    req->rtime_since_last_access = -1;
+
+    struct obj_info obj_info;
+    obj_info.create_rtime = (int32_t)req->clock_time;
+    obj_info.freq = 1;
+    obj_info.obj_size = (obj_size_t)req->obj_size;
+    obj_info.last_access_rtime = (int32_t)req->clock_time;
+    obj_info.last_access_vtime = vtime;
+
+    obj_map[req->obj_id] = obj_info;
+
+    return true;
   }
 
-  if (req_rate_stat_ != nullptr) {
-    req_rate_stat_->dump(output_path_);
+  req->compulsory_miss = false;
+  req->first_seen_in_window =
+      (time_to_window_idx(it->second.last_access_rtime) !=
+       curr_time_window_idx);
+  req->create_rtime = it->second.create_rtime;
+  if (req->op == OP_SET || req->op == OP_REPLACE || req->op == OP_CAS) {
+    req->overwrite = true;
+  } else {
+    req->overwrite = false;
   }
+  req->vtime_since_last_access = vtime - it->second.last_access_vtime;
+  req->rtime_since_last_access =
+      (int64_t)(req->clock_time) - it->second.last_access_rtime;
 
-  if (reuse_stat_ != nullptr) {
-    reuse_stat_->dump(output_path_);
+  assert(req->vtime_since_last_access > 0);
+  assert(req->rtime_since_last_access >= 0);
+
+  req->prev_size = it->second.obj_size;
+  it->second.obj_size = req->obj_size;
+  it->second.freq += 1;
+  it->second.last_access_vtime = vtime;
+  it->second.last_access_rtime = (int32_t)(req->clock_time);
+
+  return false;
+}
+
+void traceAnalyzer::TraceAnalyzer::add_req_in_order(request_t *req) {
+  op_stat_->add_req(req);
+
+  if (ttl_stat_ != nullptr) {
+    ttl_stat_->add_req(req);
   }
 
-  if (size_stat_ != nullptr) {
-    size_stat_->dump(output_path_);
+  if (req_rate_stat_ != nullptr) {
+    req_rate_stat_->add_req(req);
   }
 
   if (access_stat_ != nullptr) {
-    access_stat_->dump(output_path_);
+    access_stat_->add_req(req);
   }
 
-  if (popularity_stat_ != nullptr) {
-    popularity_stat_->dump(output_path_);
+  /* the stack distance needs all objects in time order, so it runs here
+   * instead of in the object shards */
+  if (stack_dist_stat_ != nullptr) {
+    stack_dist_stat_->add_req(req);
   }
 
-  if (popularity_decay_stat_ != nullptr) {
-    popularity_decay_stat_->dump(output_path_);
+  /* the sequential runs interleave across objects, so the scan detector also
+   * needs the requests in time order */
+  if (scan_stat_ != nullptr) {
+    scan_stat_->add_req(req);
   }
 
   if (prob_at_age_ != nullptr) {
-    prob_at_age_->dump(output_path_);
+    prob_at_age_->add_req(req);
   }
 
   if (lifetime_stat_ != nullptr) {
-    lifetime_stat_->dump(output_path_);
+    lifetime_stat_->add_req(req);
   }
 
   if (create_future_reuse_ != nullptr) {
-    create_future_reuse_->dump(output_path_);
+    create_future_reuse_->add_req(req);
   }
 
-  // if (write_reuse_stat_ != nullptr) {
-  //   write_reuse_stat_->dump(output_path_);
-  // }
-
-  // if (write_future_reuse_stat_ != nullptr) {
-  //   write_future_reuse_stat_->dump(output_path_);
-  // }
-
-  if (scan_detector_ != nullptr) {
-    scan_detector_->dump(output_path_);
+  if (size_change_distribution_ != nullptr) {
+    size_change_distribution_->add_req(req);
   }
-
-  has_run_ = true;
 }
 
 string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
   stat_ss_.clear();
-  double cold_miss_ratio = (double)obj_map_.size() / (double)n_req_;
+  double cold_miss_ratio = (double)n_obj_ / (double)n_req_;
   double byte_cold_miss_ratio =
       (double)sum_obj_size_obj / (double)sum_obj_size_req;
   int mean_obj_size_req = (int)((double)sum_obj_size_req / (double)n_req_);
   int mean_obj_size_obj =
-      (int)((double)sum_obj_size_obj / (double)obj_map_.size());
-  double freq_mean = (double)n_req_ / (double)obj_map_.size();
+      (int)((double)sum_obj_size_obj / (double)n_obj_);
+  double freq_mean = (double)n_req_ / (double)n_obj_;
   int64_t time_span = end_ts_ - start_ts_;
 
   stat_ss_ << setprecision(4) << fixed << "dat: " << reader_->trace_path << "\n"
            << "number of requests: " << n_req_
-           << ", number of objects: " << obj_map_.size() << "\n"
+           << ", number of objects: " << n_obj_ << "\n"
            << "number of req GiB: " << (double)sum_obj_size_req / (double)GiB
            << ", number of obj GiB: " << (double)sum_obj_size_obj / (double)GiB
            << "\n"
@@ -313,12 +442,15 @@ string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
     stat_ss_ << *ttl_stat_;
   }
   if (req_rate_stat_ != nullptr) stat_ss_ << *req_rate_stat_;
+  if (footprint_stat_ != nullptr) stat_ss_ << *footprint_stat_;
+  if (stack_dist_stat_ != nullptr) stat_ss_ << *stack_dist_stat_;
+  if (scan_stat_ != nullptr) stat_ss_ << *scan_stat_;
   if (popularity_stat_ != nullptr) stat_ss_ << *popularity_stat_;
 
   stat_ss_ << "X-hit (number of obj accessed X times): ";
   for (int i = 0; i < track_n_hit_; i++) {
     stat_ss_ << n_hit_cnt_[i] << "("
-             << (double)n_hit_cnt_[i] / (double)obj_map_.size() << "), ";
+             << (double)n_hit_cnt_[i] / (double)n_obj_ << "), ";
   }
   stat_ss_ << "\n";
 
@@ -332,7 +464,7 @@ string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
   if (size_change_distribution_ != nullptr)
     stat_ss_ << *size_change_distribution_;
 
-  if (scan_detector_ != nullptr) stat_ss_ << *scan_detector_;
+  if (sketch_stat_ != nullptr) stat_ss_ << *sketch_stat_;
 
   return stat_ss_.str();
 }
@@ -341,22 +473,83 @@ void traceAnalyzer::TraceAnalyzer::post_processing() {
   assert(n_hit_cnt_ == nullptr);
   assert(popular_cnt_ == nullptr);
 
+  if (sketch_) {
+    post_processing_sketch();
+    return;
+  }
+
+  /* the per-object results of the shards */
+  std::vector<obj_info_map_type *> obj_maps;
+  if (shards_.empty()) {
+    obj_maps.push_back(&obj_map_);
+  } else {
+    merge_shard_window(size_window_row_, reuse_window_row_, INT64_MAX);
+    for (auto *shard : shards_) {
+      obj_maps.push_back(&shard->obj_map);
+      sum_obj_size_obj += shard->sum_obj_size_obj;
+      if (size_stat_ != nullptr) size_stat_->merge(*shard->size_stat);
+      if (reuse_stat_ != nullptr) reuse_stat_->merge(*shard->reuse_stat);
+    }
+  }
+
+  /* the footprint of each object map */
+  std::vector<Footprint *> footprints;
+  if (footprint_stat_ != nullptr) {
+    if (shards_.empty()) {
+      footprints.push_back(footprint_stat_);
+    } else {
+      for (auto *shard : shards_) footprints.push_back(shard->footprint_stat);
+    }
+  }
+
+  n_obj_ = 0;
+  for (auto *obj_map : obj_maps) {
+    n_obj_ += (int64_t)obj_map->size();
+  }
+
+  /* the frequency histogram of each object map, the shards are scanned in
+   * parallel */
+  std::vector<FreqHist> hists(obj_maps.size());
+  auto scan_obj_map = [&](size_t i) {
+    for (const auto &p : *obj_maps[i]) {
+      hists[i].add(p.second.freq);
+    }
+    if (!footprints.empty()) {
+      footprints[i]->add_obj_map(*obj_maps[i], n_req_, end_ts_ - start_ts_);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < obj_maps.size(); i++) {
+    threads.emplace_back(scan_obj_map, i);
+  }
+  scan_obj_map(0);
+  for (auto &t : threads) {
+    t.join();
+  }
+  for (size_t i = 1; i < hists.size(); i++) {
+    hists[0].merge(hists[i]);
+  }
+  FreqHist &hist = hists[0];
+
+  if (footprint_stat_ != nullptr) {
+    for (auto *shard : shards_) footprint_stat_->merge(*shard->footprint_stat);
+    footprint_stat_->compute(n_req_, end_ts_ - start_ts_);
+  }
+
   n_hit_cnt_ = new uint64_t[track_n_hit_];
   popular_cnt_ = new uint64_t[track_n_popular_];
   memset(n_hit_cnt_, 0, sizeof(uint64_t) * track_n_hit_);
   memset(popular_cnt_, 0, sizeof(uint64_t) * track_n_popular_);
 
-  for (auto it : obj_map_) {
-    if (it.second.freq <= track_n_hit_) {
-      n_hit_cnt_[it.second.freq - 1] += 1;
-    }
+  for (int i = 0; i < track_n_hit_; i++) {
+    n_hit_cnt_[i] = hist.n_obj_of_freq(i + 1);
   }
 
   if (option_.popularity) {
-    popularity_stat_ = new Popularity(obj_map_);
-    auto sorted_freq = popularity_stat_->get_sorted_freq();
-    for (int i = 0; i < track_n_popular_; i++) {
-      popular_cnt_[i] = sorted_freq[i];
+    popularity_stat_ = new Popularity(hist, n_thread_);
+    auto top_freq = popularity_stat_->get_top_freq(track_n_popular_);
+    for (size_t i = 0; i < top_freq.size(); i++) {
+      popular_cnt_[i] = top_freq[i];
     }
   }
 }
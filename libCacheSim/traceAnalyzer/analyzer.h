@@ -20,12 +20,17 @@
 
 #include "../include/libCacheSim/reader.h"
 #include "accessPattern.h"
+#include "checkpoint.h"
+#include "footprint.h"
 #include "op.h"
 #include "popularity.h"
 #include "popularityDecay.h"
 #include "reqRate.h"
 #include "reuse.h"
+#include "scan.h"
 #include "size.h"
+#include "sketch.h"
+#include "stackDist.h"
 #include "struct.h"
 #include "ttl.h"
 
@@ -33,7 +38,6 @@
 #include "experimental/createFutureReuseCCDF.h"
 #include "experimental/lifetime.h"
 #include "experimental/probAtAge.h"
-#include "experimental/scanDetector.h"
 #include "experimental/sizeChange.h"
 
 // /* deprecated module */
@@ -48,6 +52,9 @@ typedef struct analysis_option {
   bool reuse;
   bool popularity;
   bool ttl;
+  bool footprint;
+  bool stack_dist;
+  bool scan;
 
   bool popularity_decay;
   bool lifetime;
@@ -66,6 +73,28 @@ typedef struct analysis_param {
   int warmup_time;
   double access_pattern_sample_ratio;
   int access_pattern_sample_ratio_inv;
+  /* the number of threads that update the object map and the per-object
+   * analysis (reuse, size, popularityDecay), each owns a shard of the
+   * objects, 1 runs the analysis on the reader thread */
+  int n_thread;
+  /* bounded-memory mode, the trace-wide object stat come from sketches and
+   * the per-object analysis runs on a hash-sampled subset of the objects,
+   * see analyzerSketch.cpp */
+  bool sketch;
+  double sketch_sample_ratio;
+  /* write the per-window output (size, reuse and popularityDecay heatmaps)
+   * in the binary format, see windowStream.h */
+  bool binary_output;
+  /* a sequential run of at least scan_min_run requests whose obj_id
+   * increases by at most scan_max_gap is a scan */
+  int scan_min_run;
+  int scan_max_gap;
+  /* save the state to checkpoint_path every checkpoint_interval requests
+   * and at the end of the trace, NULL disables checkpoint, with resume, the
+   * analysis starts from the checkpoint, see analyzerCheckpoint.cpp */
+  const char *checkpoint_path;
+  int64_t checkpoint_interval;
+  bool resume;
 } analysis_param_t;
 
 static analysis_param_t default_param() {
@@ -76,6 +105,15 @@ static analysis_param_t default_param() {
   param.warmup_time = 86400;
   param.access_pattern_sample_ratio = 0.01;
   param.access_pattern_sample_ratio_inv = 101;
+  param.n_thread = 1;
+  param.sketch = false;
+  param.sketch_sample_ratio = 0.01;
+  param.binary_output = false;
+  param.scan_min_run = 32;
+  param.scan_max_gap = 1;
+  param.checkpoint_path = NULL;
+  param.checkpoint_interval = 100000000;
+  param.resume = false;
 
   return param;
 };
@@ -88,6 +126,9 @@ static struct analysis_option default_option() {
   option.size = false;
   option.reuse = false;
   option.popularity = false;
+  option.footprint = false;
+  option.stack_dist = false;
+  option.scan = false;
   option.popularity_decay = false;
   option.create_future_reuse_ccdf = false;
   option.prob_at_age = false;
@@ -98,6 +139,24 @@ static struct analysis_option default_option() {
 };
 
 #define DEFAULT_PREALLOC_N_OBJ 1e8
+/* the number of popular objects tracked in sketch mode */
+#define SKETCH_TOP_K 4096
+/* the number of counters per row of the count-min sketch, 256 MiB */
+#define SKETCH_CMS_ENTRIES (1ULL << 27)
+/* the number of sequential runs tracked by the scan detector */
+#define SCAN_N_STREAMS 32
+
+/* the objects of one shard and the per-object analysis of these objects when
+ * running with multiple threads, see analyzerParallel.cpp */
+struct analyzer_shard {
+  obj_info_map_type obj_map;
+  uint64_t sum_obj_size_obj = 0;
+
+  SizeDistribution *size_stat = nullptr;
+  ReuseDistribution *reuse_stat = nullptr;
+  PopularityDecay *popularity_decay_stat = nullptr;
+  Footprint *footprint_stat = nullptr;
+};
 
 class TraceAnalyzer {
  public:
@@ -112,7 +171,18 @@ class TraceAnalyzer {
         track_n_popular_(params.track_n_popular),
         track_n_hit_(params.track_n_hit),
         time_window_(params.time_window),
-        warmup_time_(params.warmup_time) {
+        warmup_time_(params.warmup_time),
+        n_thread_(params.n_thread),
+        sketch_(params.sketch),
+        sketch_sample_ratio_(params.sketch_sample_ratio),
+        binary_output_(params.binary_output),
+        scan_min_run_(params.scan_min_run),
+        scan_max_gap_(params.scan_max_gap),
+        checkpoint_path_(params.checkpoint_path == NULL
+                             ? ""
+                             : params.checkpoint_path),
+        checkpoint_interval_(params.checkpoint_interval),
+        resume_(params.resume) {
     if (warmup_time_ % time_window_ != 0) {
       /* the popularityDecay computation needs warmup time to be multiple of
        * time_window */
@@ -120,6 +190,24 @@ class TraceAnalyzer {
       exit(1);
     }
 
+    if (sketch_ &&
+        (sketch_sample_ratio_ <= 0 || sketch_sample_ratio_ > 1)) {
+      ERROR("sketch sample ratio needs to be in (0, 1]\n");
+      exit(1);
+    }
+
+    if (sketch_ && n_thread_ > 1) {
+      WARN("sketch mode runs on one thread, ignore n_thread %d\n", n_thread_);
+      n_thread_ = 1;
+    }
+
+    if (!checkpoint_path_.empty()) {
+      check_checkpoint_option();
+    } else if (resume_) {
+      ERROR("resume needs a checkpoint path\n");
+      exit(1);
+    }
+
     initialize();
   };
 
@@ -150,9 +238,27 @@ class TraceAnalyzer {
   int track_n_hit_;
   // the sampling ratio used in access pattern analysis
   int access_pattern_sample_ratio_inv_;
+  // the number of threads (object shards) updating the object map
+  int n_thread_;
+  // use sketches instead of keeping all objects in memory
+  bool sketch_;
+  // the fraction of objects (by hash) in the object map in sketch mode
+  double sketch_sample_ratio_;
+  // write the per-window output in the binary format
+  bool binary_output_;
+  // the minimal length and the maximal obj_id gap of a sequential run (scan)
+  int scan_min_run_;
+  int scan_max_gap_;
+  // the checkpoint file, empty if checkpoint is disabled
+  string checkpoint_path_;
+  // the number of requests between two checkpoints
+  int64_t checkpoint_interval_;
+  // start from the checkpoint if it exists
+  bool resume_;
 
   /* stat */
   int64_t n_req_ = 0;
+  int64_t n_obj_ = 0;
 
   /* number of one-hit, two-hit ... */
   uint64_t *n_hit_cnt_ = nullptr;
@@ -166,7 +272,10 @@ class TraceAnalyzer {
    * an object is requested, we ignore for now */
   //  uint64_t sum_req_size_req = 0, sum_req_size_obj = 0;
 
+  /* the object map when running on one thread, otherwise each shard has a
+   * part of the objects */
   obj_info_map_type obj_map_;
+  std::vector<struct analyzer_shard *> shards_;
 
  private:
   reader_t *reader_ = nullptr;
@@ -182,6 +291,8 @@ class TraceAnalyzer {
   AccessPattern *access_stat_ = nullptr;
   Popularity *popularity_stat_ = nullptr;
   PopularityDecay *popularity_decay_stat_ = nullptr;
+  Footprint *footprint_stat_ = nullptr;
+  StackDist *stack_dist_stat_ = nullptr;
 
   ProbAtAge *prob_at_age_ = nullptr;
   LifetimeDistribution *lifetime_stat_ = nullptr;
@@ -190,12 +301,56 @@ class TraceAnalyzer {
   CreateFutureReuseDistribution *create_future_reuse_ = nullptr;
   // WriteFutureReuseDistribution *write_future_reuse_stat_ = nullptr;
   SizeChangeDistribution *size_change_distribution_ = nullptr;
-  ScanDetector *scan_detector_ = nullptr;
+  ScanStat *scan_stat_ = nullptr;
+  SketchStat *sketch_stat_ = nullptr;
 
   string output_path_;
 
+  /* the window (row) of the per-window stream dump up to which the reuse and
+   * size requests have been counted, used when merging the shards */
+  int64_t reuse_window_row_ = 0;
+  int64_t size_window_row_ = 0;
+
+  /* the number of objects reserved in the object map, from the trace header
+   * when it has the number of objects */
+  size_t prealloc_n_obj() const;
+
+  void run_serial();
+
+  void run_parallel();
+
+  void run_sketch();
+
+  /* update the object map and fill in the analysis fields of the request,
+   * return true if this is the first request to the object */
+  bool update_obj_map(obj_info_map_type &obj_map, request_t *req,
+                      int64_t vtime, int32_t curr_time_window_idx);
+
+  /* feed the modules that see all requests in time order */
+  void add_req_in_order(request_t *req);
+
+  void merge_shard_window(int64_t size_until_row, int64_t reuse_until_row,
+                          int64_t popularity_decay_until_row);
+
+  /* checkpoint and resume, see analyzerCheckpoint.cpp */
+  void check_checkpoint_option();
+
+  /* n_req_in_trace is the number of requests read from the trace,
+   * trace_done is true at the end of the trace */
+  void save_checkpoint(int32_t curr_time_window_idx,
+                       int64_t next_time_window_ts, int64_t n_req_in_trace,
+                       bool trace_done);
+
+  /* load the checkpoint and move the reader to the first request not in the
+   * checkpoint, return the number of requests of the trace in the checkpoint,
+   * 0 if the trace is a new segment */
+  int64_t load_checkpoint(int32_t *curr_time_window_idx,
+                          int64_t *next_time_window_ts);
+
   void post_processing();
 
+  void post_processing_sketch();
+
   string gen_stat_str();
 
   inline int time_to_window_idx(uint32_t rtime) { return rtime / time_window_; }
@@ -0,0 +1,194 @@
+//
+// checkpoint and resume the trace analysis
+//
+// the checkpoint has the object map, the state of the modules and the
+// position in the trace, it is written every checkpoint_interval requests
+// and at the end of the trace (before the results are computed), so that
+//   1. an analysis killed in the middle of a trace resumes from the last
+//      checkpoint, the reader skips the requests in the checkpoint
+//   2. the next segment of a trace (e.g., the trace of the next day) is
+//      analyzed as the continuation of the segments in the checkpoint, the
+//      clock time continues from the first segment, so the segments need to
+//      be in time order
+// the per-window output files are truncated to the length at the checkpoint
+// and continued, the other output files are written at the end of each run
+//
+// the checkpoint only works on one thread without sketch, and the
+// experimental modules do not support it
+//
+
+#include <cstring>
+
+#include "analyzer.h"
+
+namespace traceAnalyzer {
+
+void TraceAnalyzer::check_checkpoint_option() {
+  if (sketch_) {
+    ERROR("checkpoint is not supported in sketch mode\n");
+    exit(1);
+  }
+
+  if (option_.prob_at_age || option_.lifetime ||
+      option_.create_future_reuse_ccdf || option_.size_change) {
+    ERROR("the experimental modules do not support checkpoint\n");
+    exit(1);
+  }
+
+  if (n_thread_ > 1) {
+    WARN("checkpoint runs on one thread, ignore n_thread %d\n", n_thread_);
+    n_thread_ = 1;
+  }
+
+  if (checkpoint_interval_ <= 0) {
+    ERROR("checkpoint interval needs to be positive, get %ld\n",
+          (long)checkpoint_interval_);
+    exit(1);
+  }
+}
+
+/* the params that change the state of the modules, a checkpoint can only be
+ * loaded with the same params */
+struct checkpoint_param {
+  struct analysis_option option;
+  int time_window;
+  int warmup_time;
+  int track_n_popular;
+  int track_n_hit;
+  int access_pattern_sample_ratio_inv;
+  int scan_min_run;
+  int scan_max_gap;
+  bool binary_output;
+};
+
+void TraceAnalyzer::save_checkpoint(int32_t curr_time_window_idx,
+                                    int64_t next_time_window_ts,
+                                    int64_t n_req_in_trace, bool trace_done) {
+  CheckpointWriter ckpt(checkpoint_path_);
+
+  struct checkpoint_param param;
+  memset(&param, 0, sizeof(param));
+  param.option = option_;
+  param.time_window = time_window_;
+  param.warmup_time = warmup_time_;
+  param.track_n_popular = track_n_popular_;
+  param.track_n_hit = track_n_hit_;
+  param.access_pattern_sample_ratio_inv = access_pattern_sample_ratio_inv_;
+  param.scan_min_run = scan_min_run_;
+  param.scan_max_gap = scan_max_gap_;
+  param.binary_output = binary_output_;
+  ckpt.put(param);
+
+  /* the position in the trace, the offset of an uncompressed binary trace
+   * is restored directly, other traces skip n_req_in_trace requests */
+  int64_t reader_offset = -1;
+  if (reader_->trace_format == BINARY_TRACE_FORMAT &&
+      !reader_->is_zstd_file && reader_->n_req_left == 0 &&
+      reader_->next_access == NULL) {
+    reader_offset = (int64_t)reader_->mmap_offset;
+  }
+  ckpt.put(std::string(reader_->trace_path));
+  ckpt.put(trace_done);
+  ckpt.put(n_req_in_trace);
+  ckpt.put(reader_offset);
+  ckpt.put(reader_->n_read_req);
+
+  ckpt.put(n_req_);
+  ckpt.put(sum_obj_size_req);
+  ckpt.put(sum_obj_size_obj);
+  ckpt.put(start_ts_);
+  ckpt.put(end_ts_);
+  ckpt.put(curr_time_window_idx);
+  ckpt.put(next_time_window_ts);
+  ckpt.put(obj_map_);
+
+  op_stat_->save(ckpt);
+  if (ttl_stat_ != nullptr) ttl_stat_->save(ckpt);
+  if (req_rate_stat_ != nullptr) req_rate_stat_->save(ckpt);
+  if (access_stat_ != nullptr) access_stat_->save(ckpt);
+  if (size_stat_ != nullptr) size_stat_->save(ckpt);
+  if (reuse_stat_ != nullptr) reuse_stat_->save(ckpt);
+  if (popularity_decay_stat_ != nullptr) popularity_decay_stat_->save(ckpt);
+  if (footprint_stat_ != nullptr) footprint_stat_->save(ckpt);
+  if (stack_dist_stat_ != nullptr) stack_dist_stat_->save(ckpt);
+  if (scan_stat_ != nullptr) scan_stat_->save(ckpt);
+
+  ckpt.commit();
+  INFO("checkpoint %s: %ld requests\n", checkpoint_path_.c_str(),
+       (long)n_req_);
+}
+
+int64_t TraceAnalyzer::load_checkpoint(int32_t *curr_time_window_idx,
+                                       int64_t *next_time_window_ts) {
+  CheckpointReader ckpt(checkpoint_path_);
+
+  struct checkpoint_param param;
+  ckpt.get(param);
+  if (memcmp(&param.option, &option_, sizeof(option_)) != 0 ||
+      param.time_window != time_window_ ||
+      param.warmup_time != warmup_time_ ||
+      param.track_n_popular != track_n_popular_ ||
+      param.track_n_hit != track_n_hit_ ||
+      param.access_pattern_sample_ratio_inv !=
+          access_pattern_sample_ratio_inv_ ||
+      param.scan_min_run != scan_min_run_ ||
+      param.scan_max_gap != scan_max_gap_ ||
+      param.binary_output != binary_output_) {
+    ERROR("checkpoint %s was taken with different analysis options\n",
+          checkpoint_path_.c_str());
+    exit(1);
+  }
+
+  std::string trace_path;
+  bool trace_done;
+  int64_t n_req_in_trace, reader_offset;
+  uint64_t n_read_req;
+  ckpt.get(trace_path);
+  ckpt.get(trace_done);
+  ckpt.get(n_req_in_trace);
+  ckpt.get(reader_offset);
+  ckpt.get(n_read_req);
+
+  ckpt.get(n_req_);
+  ckpt.get(sum_obj_size_req);
+  ckpt.get(sum_obj_size_obj);
+  ckpt.get(start_ts_);
+  ckpt.get(end_ts_);
+  ckpt.get(*curr_time_window_idx);
+  ckpt.get(*next_time_window_ts);
+  ckpt.get(obj_map_);
+
+  op_stat_->load(ckpt);
+  if (ttl_stat_ != nullptr) ttl_stat_->load(ckpt);
+  if (req_rate_stat_ != nullptr) req_rate_stat_->load(ckpt);
+  if (access_stat_ != nullptr) access_stat_->load(ckpt);
+  if (size_stat_ != nullptr) size_stat_->load(ckpt);
+  if (reuse_stat_ != nullptr) reuse_stat_->load(ckpt);
+  if (popularity_decay_stat_ != nullptr) popularity_decay_stat_->load(ckpt);
+  if (footprint_stat_ != nullptr) footprint_stat_->load(ckpt);
+  if (stack_dist_stat_ != nullptr) stack_dist_stat_->load(ckpt);
+  if (scan_stat_ != nullptr) scan_stat_->load(ckpt);
+
+  if (trace_done || trace_path != reader_->trace_path) {
+    INFO("continue the analysis of %ld requests in checkpoint %s with %s\n",
+         (long)n_req_, checkpoint_path_.c_str(), reader_->trace_path);
+    return 0;
+  }
+
+  INFO("resume %s from checkpoint %s at request %ld\n", reader_->trace_path,
+       checkpoint_path_.c_str(), (long)n_req_in_trace);
+  if (reader_offset >= 0) {
+    reader_->mmap_offset = (size_t)reader_offset;
+    reader_->n_read_req = n_read_req;
+  } else {
+    request_t *req = new_request();
+    for (int64_t i = 0; i < n_req_in_trace; i++) {
+      read_one_req(reader_, req);
+    }
+    free_request(req);
+  }
+
+  return n_req_in_trace;
+}
+
+}  // namespace traceAnalyzer
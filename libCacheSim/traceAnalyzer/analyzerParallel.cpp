@@ -0,0 +1,286 @@
+//
+// run the trace analysis with multiple threads
+//
+// the objects are partitioned into n_thread shards by the hash of obj_id,
+// each thread owns the object map of one shard and shard-local instances of
+// the per-object modules (size, reuse, popularityDecay, footprint).
+// The reader thread reads the trace in batches, and each batch goes through
+// three steps
+//   1. (shard threads) update the object map and fill in the analysis fields
+//      (compulsory_miss, rtime_since_last_access ...) of the requests
+//   2. (reader thread) feed the modules that need all requests in time order
+//      (op, ttl, reqRate, accessPattern ...) and find the window (row of the
+//      per-window stream dump) of each request for size and reuse
+//   3. (shard threads) feed the per-object modules
+// the steps of three consecutive batches run at the same time while the
+// reader thread reads the next batch, and the finished windows of the shards
+// are merged and dumped after each step.
+// The output is the same as running on one thread.
+//
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "analyzer.h"
+
+namespace traceAnalyzer {
+
+#define PARALLEL_BATCH_SIZE (1 << 16)
+/* a batch is read, annotated, fed to the ordered modules, and fed to the
+ * per-object modules in four consecutive steps */
+#define PARALLEL_N_BATCH_BUF 4
+
+struct req_batch {
+  std::vector<request_t> reqs;
+  /* the time window of the request, see run_serial */
+  std::vector<int32_t> window_idx;
+  /* the number of windows the size and reuse module has dumped before the
+   * request if running on one thread */
+  std::vector<int64_t> size_window_row;
+  std::vector<int64_t> reuse_window_row;
+  /* the position of the requests of each shard in reqs */
+  std::vector<std::vector<uint32_t>> shard_pos;
+  int64_t n_req = 0;
+};
+
+static inline int obj_id_to_shard(obj_id_t obj_id, int n_shard) {
+  /* the shard is decided by the high bits so that the low bits used by the
+   * object map of a shard are not correlated */
+  return (int)((((uint64_t)obj_id * 0x9E3779B97F4A7C15ULL) >> 32) % n_shard);
+}
+
+void TraceAnalyzer::run_parallel() {
+  const int n_shard = n_thread_;
+  for (int i = 0; i < n_shard; i++) {
+    auto *shard = new struct analyzer_shard;
+    shard->obj_map.reserve(prealloc_n_obj() / n_shard);
+    if (size_stat_ != nullptr) shard->size_stat = size_stat_->create_shard();
+    if (reuse_stat_ != nullptr) shard->reuse_stat = reuse_stat_->create_shard();
+    if (popularity_decay_stat_ != nullptr) {
+      shard->popularity_decay_stat = popularity_decay_stat_->create_shard();
+    }
+    if (footprint_stat_ != nullptr) {
+      shard->footprint_stat = footprint_stat_->create_shard();
+    }
+    shards_.push_back(shard);
+  }
+
+  request_t *req = new_request();
+  read_one_req(reader_, req);
+  start_ts_ = req->clock_time;
+  if (!req->valid) {
+    /* an empty trace or all requests are filtered */
+    end_ts_ = start_ts_;
+    free_request(req);
+    return;
+  }
+
+  struct req_batch batches[PARALLEL_N_BATCH_BUF];
+  for (auto &batch : batches) {
+    batch.reqs.resize(PARALLEL_BATCH_SIZE);
+    batch.window_idx.resize(PARALLEL_BATCH_SIZE);
+    batch.size_window_row.resize(PARALLEL_BATCH_SIZE);
+    batch.reuse_window_row.resize(PARALLEL_BATCH_SIZE);
+    batch.shard_pos.resize(n_shard);
+  }
+
+  int32_t curr_time_window_idx = 0;
+  int next_time_window_ts = time_window_;
+  bool reader_done = false;
+
+  auto read_batch = [&](struct req_batch &batch) {
+    batch.n_req = 0;
+    for (auto &pos : batch.shard_pos) pos.clear();
+    while (!reader_done && batch.n_req < PARALLEL_BATCH_SIZE) {
+      DEBUG_ASSERT(req->obj_size != 0);
+
+      req->clock_time -= start_ts_;
+      while (req->clock_time >= next_time_window_ts) {
+        curr_time_window_idx += 1;
+        next_time_window_ts += time_window_;
+      }
+
+      if (curr_time_window_idx != time_to_window_idx(req->clock_time)) {
+        ERROR(
+            "The data is not ordered by time, please sort the trace first!"
+            "Current time %ld requested object %lu, obj size %lu\n",
+            (long)(req->clock_time + start_ts_), (unsigned long)req->obj_id,
+            (long)req->obj_size);
+      }
+
+      n_req_ += 1;
+      sum_obj_size_req += req->obj_size;
+      /* the vtime of the request used in the object map */
+      req->n_req = n_req_;
+
+      int64_t pos = batch.n_req++;
+      copy_request(&batch.reqs[pos], req);
+      batch.window_idx[pos] = curr_time_window_idx;
+      batch.shard_pos[obj_id_to_shard(req->obj_id, n_shard)].push_back(pos);
+
+      read_one_req(reader_, req);
+      if (!req->valid) {
+        reader_done = true;
+        end_ts_ = req->clock_time + start_ts_;
+      }
+    }
+  };
+
+  /* the modules count the window of a request (a row in the stream dump)
+   * when a later request passes the window boundary, the reuse module only
+   * counts the requests that are not the first request of the object */
+  auto add_batch_in_order = [&](struct req_batch &batch) {
+    for (int64_t i = 0; i < batch.n_req; i++) {
+      request_t *r = &batch.reqs[i];
+      int64_t window_idx = time_to_window_idx(r->clock_time);
+      batch.size_window_row[i] = size_window_row_;
+      size_window_row_ = MAX(size_window_row_, window_idx);
+      batch.reuse_window_row[i] = reuse_window_row_;
+      if (!r->compulsory_miss) {
+        reuse_window_row_ = MAX(reuse_window_row_, window_idx);
+      }
+
+      add_req_in_order(r);
+    }
+  };
+
+  auto update_shard = [&](int shard_idx, struct req_batch &batch) {
+    struct analyzer_shard *shard = shards_[shard_idx];
+    for (uint32_t pos : batch.shard_pos[shard_idx]) {
+      request_t *r = &batch.reqs[pos];
+      if (update_obj_map(shard->obj_map, r, (int64_t)r->n_req,
+                         batch.window_idx[pos])) {
+        shard->sum_obj_size_obj += r->obj_size;
+      }
+    }
+  };
+
+  auto add_batch_to_shard = [&](int shard_idx, struct req_batch &batch) {
+    struct analyzer_shard *shard = shards_[shard_idx];
+    for (uint32_t pos : batch.shard_pos[shard_idx]) {
+      request_t *r = &batch.reqs[pos];
+      if (shard->size_stat != nullptr) {
+        shard->size_stat->add_shard_req(r, batch.size_window_row[pos]);
+      }
+      if (shard->reuse_stat != nullptr) {
+        shard->reuse_stat->add_shard_req(r, batch.reuse_window_row[pos]);
+      }
+      if (shard->popularity_decay_stat != nullptr) {
+        shard->popularity_decay_stat->add_shard_req(r);
+      }
+      if (shard->footprint_stat != nullptr) {
+        shard->footprint_stat->add_req(r);
+      }
+    }
+  };
+
+  /* the shard threads run one step at a time */
+  std::mutex mtx;
+  std::condition_variable step_cond, done_cond;
+  int64_t curr_step = -1;
+  int n_done = 0;
+  bool stop = false;
+
+  auto shard_thread_func = [&](int shard_idx) {
+    int64_t step = -1;
+    while (true) {
+      std::unique_lock<std::mutex> lock(mtx);
+      step_cond.wait(lock, [&] { return stop || curr_step > step; });
+      if (stop) return;
+      step = curr_step;
+      lock.unlock();
+
+      update_shard(shard_idx, batches[step % PARALLEL_N_BATCH_BUF]);
+      if (step >= 2) {
+        add_batch_to_shard(shard_idx,
+                           batches[(step - 2) % PARALLEL_N_BATCH_BUF]);
+      }
+
+      lock.lock();
+      if (++n_done == n_shard) done_cond.notify_one();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < n_shard; i++) {
+    threads.emplace_back(shard_thread_func, i);
+  }
+
+  /* batch t is read in step t - 1, updated in the object map in step t, fed
+   * to the ordered modules in step t + 1 and to the per-object modules in
+   * step t + 2, the batch buffer is reused after four steps */
+  read_batch(batches[0]);
+  int64_t n_batch = batches[0].n_req > 0 ? 1 : 0;
+  for (int64_t step = 0; step < n_batch + 2; step++) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      curr_step = step;
+      n_done = 0;
+    }
+    step_cond.notify_all();
+
+    struct req_batch &next_batch = batches[(step + 1) % PARALLEL_N_BATCH_BUF];
+    if (step >= 1) {
+      add_batch_in_order(batches[(step - 1) % PARALLEL_N_BATCH_BUF]);
+    }
+    /* the windows before the first request of the batch fed to the
+     * per-object modules in the next step are complete after this step */
+    int64_t size_until_row = size_window_row_;
+    int64_t reuse_until_row = reuse_window_row_;
+    if (step >= 1) {
+      struct req_batch &batch = batches[(step - 1) % PARALLEL_N_BATCH_BUF];
+      if (batch.n_req > 0) {
+        size_until_row = batch.size_window_row[0];
+        reuse_until_row = batch.reuse_window_row[0];
+      }
+    }
+    read_batch(next_batch);
+    if (next_batch.n_req > 0) n_batch += 1;
+
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      done_cond.wait(lock, [&] { return n_done == n_shard; });
+    }
+
+    merge_shard_window(size_until_row, reuse_until_row,
+                       size_until_row - MAX(warmup_time_ / time_window_, 1) +
+                           1);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stop = true;
+  }
+  step_cond.notify_all();
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  free_request(req);
+}
+
+void TraceAnalyzer::merge_shard_window(int64_t size_until_row,
+                                       int64_t reuse_until_row,
+                                       int64_t popularity_decay_until_row) {
+  if (size_stat_ != nullptr) {
+    std::vector<SizeDistribution *> stats;
+    for (auto *shard : shards_) stats.push_back(shard->size_stat);
+    size_stat_->merge_window(stats, size_until_row);
+  }
+
+  if (reuse_stat_ != nullptr) {
+    std::vector<ReuseDistribution *> stats;
+    for (auto *shard : shards_) stats.push_back(shard->reuse_stat);
+    reuse_stat_->merge_window(stats, reuse_until_row);
+  }
+
+  if (popularity_decay_stat_ != nullptr) {
+    std::vector<PopularityDecay *> stats;
+    for (auto *shard : shards_) stats.push_back(shard->popularity_decay_stat);
+    popularity_decay_stat_->merge_window(stats, popularity_decay_until_row);
+  }
+}
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,192 @@
+//
+// run the trace analysis with bounded memory
+//
+// the object map of the default mode grows with the number of objects in the
+// trace, in sketch mode
+//   1. the number of objects, the object and unique byte rate of each
+//      window, the X-hit wonders and the popular objects come from sketches
+//      (see sketch.h) that see all requests
+//   2. the per-object modules (size, reuse, footprint, stackDist,
+//      probAtAge ...) only see the requests to a sample of the objects
+//      selected by the hash of obj_id, the object map only keeps the sampled
+//      objects
+//   3. the modules that do not need per-object state (op, ttl, reqRate,
+//      accessPattern, scan) see all requests, whether a request is the first
+//      to its object comes from the count-min sketch for unsampled objects
+// the memory is the sketches plus sample_ratio of the default mode
+//
+
+#include "../dataStructure/hash/hash.h"
+#include "analyzer.h"
+
+namespace traceAnalyzer {
+
+void TraceAnalyzer::run_sketch() {
+  /* an object is sampled if the low 32 bits of its hash is below this */
+  const uint64_t sample_threshold =
+      (uint64_t)(sketch_sample_ratio_ * (double)(1ULL << 32));
+
+  request_t *req = new_request();
+  read_one_req(reader_, req);
+  start_ts_ = req->clock_time;
+  int32_t curr_time_window_idx = 0;
+  int next_time_window_ts = time_window_;
+
+  while (req->valid) {
+    DEBUG_ASSERT(req->obj_size != 0);
+
+    req->clock_time -= start_ts_;
+    while (req->clock_time >= next_time_window_ts) {
+      curr_time_window_idx += 1;
+      next_time_window_ts += time_window_;
+    }
+
+    if (curr_time_window_idx != time_to_window_idx(req->clock_time)) {
+      ERROR(
+          "The data is not ordered by time, please sort the trace first!"
+          "Current time %ld requested object %lu, obj size %lu\n",
+          (long)(req->clock_time + start_ts_), (unsigned long)req->obj_id,
+          (long)req->obj_size);
+    }
+
+    n_req_ += 1;
+    sum_obj_size_req += req->obj_size;
+    req->n_req = n_req_;
+
+    uint64_t hv = get_hash_value_int_64(&req->obj_id);
+    bool sampled = (hv & 0xFFFFFFFFULL) < sample_threshold;
+    if (sampled) {
+      update_obj_map(obj_map_, req, n_req_, curr_time_window_idx);
+    }
+
+    int prev_freq = sketch_stat_->add_req(req, hv, sampled);
+    if (prev_freq == 0) {
+      sum_obj_size_obj += req->obj_size;
+    }
+
+    if (!sampled) {
+      req->compulsory_miss = prev_freq == 0;
+      req->overwrite = !req->compulsory_miss &&
+                       (req->op == OP_SET || req->op == OP_REPLACE ||
+                        req->op == OP_CAS);
+      /* the object rate of reqRate is replaced by the sketch */
+      req->first_seen_in_window = req->compulsory_miss;
+      req->create_rtime = (int32_t)req->clock_time;
+      req->prev_size = -1;
+      req->vtime_since_last_access = -1;
+      req->rtime_since_last_access = -1;
+    }
+
+    op_stat_->add_req(req);
+
+    if (ttl_stat_ != nullptr) {
+      ttl_stat_->add_req(req);
+    }
+
+    if (req_rate_stat_ != nullptr) {
+      req_rate_stat_->add_req(req);
+    }
+
+    if (access_stat_ != nullptr) {
+      access_stat_->add_req(req);
+    }
+
+    if (scan_stat_ != nullptr) {
+      scan_stat_->add_req(req);
+    }
+
+    if (sampled) {
+      if (size_stat_ != nullptr) {
+        size_stat_->add_req(req);
+      }
+
+      if (reuse_stat_ != nullptr) {
+        reuse_stat_->add_req(req);
+      }
+
+      if (popularity_decay_stat_ != nullptr) {
+        popularity_decay_stat_->add_req(req);
+      }
+
+      if (footprint_stat_ != nullptr) {
+        footprint_stat_->add_req(req);
+      }
+
+      /* the stack distance of the sampled objects scaled up (SHARDS) */
+      if (stack_dist_stat_ != nullptr) {
+        stack_dist_stat_->add_req(req);
+      }
+
+      if (prob_at_age_ != nullptr) {
+        prob_at_age_->add_req(req);
+      }
+
+      if (lifetime_stat_ != nullptr) {
+        lifetime_stat_->add_req(req);
+      }
+
+      if (create_future_reuse_ != nullptr) {
+        create_future_reuse_->add_req(req);
+      }
+
+      if (size_change_distribution_ != nullptr) {
+        size_change_distribution_->add_req(req);
+      }
+    }
+
+    end_ts_ = req->clock_time + start_ts_;
+    read_one_req(reader_, req);
+  }
+
+  free_request(req);
+}
+
+void TraceAnalyzer::post_processing_sketch() {
+  assert(n_hit_cnt_ == nullptr);
+  assert(popular_cnt_ == nullptr);
+
+  n_obj_ = (int64_t)llround(sketch_stat_->n_obj());
+
+  n_hit_cnt_ = new uint64_t[track_n_hit_];
+  popular_cnt_ = new uint64_t[track_n_popular_];
+  memset(n_hit_cnt_, 0, sizeof(uint64_t) * track_n_hit_);
+  memset(popular_cnt_, 0, sizeof(uint64_t) * track_n_popular_);
+
+  /* the count-min sketch saturates, larger X are scaled from the sample */
+  for (int i = 0; i < track_n_hit_; i++) {
+    if (i + 1 <= SketchStat::max_freq()) {
+      n_hit_cnt_[i] = sketch_stat_->n_obj_of_freq(i + 1);
+    }
+  }
+  for (auto it : obj_map_) {
+    if (it.second.freq <= track_n_hit_ &&
+        it.second.freq > SketchStat::max_freq()) {
+      n_hit_cnt_[it.second.freq - 1] += 1;
+    }
+  }
+  for (int i = SketchStat::max_freq(); i < track_n_hit_; i++) {
+    n_hit_cnt_[i] = (uint64_t)llround(n_hit_cnt_[i] / sketch_sample_ratio_);
+  }
+
+  if (req_rate_stat_ != nullptr) {
+    req_rate_stat_->set_obj_rate(sketch_stat_->get_window_obj_cnt());
+    req_rate_stat_->set_obj_byte_rate(sketch_stat_->get_window_obj_byte());
+  }
+
+  /* the footprint of the sampled objects is scaled up */
+  if (footprint_stat_ != nullptr) {
+    footprint_stat_->add_obj_map(obj_map_, n_req_, end_ts_ - start_ts_);
+    footprint_stat_->compute(n_req_, end_ts_ - start_ts_);
+  }
+
+  /* the popularity is fitted on the top objects */
+  std::vector<uint32_t> top_freq = sketch_stat_->get_top_freq();
+  for (int i = 0; i < track_n_popular_ && i < (int)top_freq.size(); i++) {
+    popular_cnt_[i] = top_freq[i];
+  }
+  if (option_.popularity) {
+    popularity_stat_ = new Popularity(std::move(top_freq));
+  }
+}
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,206 @@
+#pragma once
+/**
+ * the binary snapshot of the analyzer state, so that an analysis can resume
+ * after the process is killed, or continue with the next segment of a trace
+ *
+ * the snapshot is a header (struct checkpoint_header) followed by the state
+ * of the analyzer and the modules in a fixed order, each module saves and
+ * loads its own fields with put and get, the values are written in the
+ * native byte order, a checkpoint is only loaded by the same build
+ *
+ * the snapshot is written to path.tmp and renamed to path when complete,
+ * so a crash while writing keeps the previous checkpoint
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../dataStructure/robin_hood.h"
+#include "../include/libCacheSim/logging.h"
+
+namespace traceAnalyzer {
+
+#define CHECKPOINT_MAGIC "LCSCKPT"
+#define CHECKPOINT_VERSION 1
+
+struct checkpoint_header {
+  char magic[8];
+  uint32_t version;
+  /* sizeof(struct checkpoint_header), a simple check of the build */
+  uint32_t header_size;
+};
+
+class CheckpointWriter {
+ public:
+  explicit CheckpointWriter(const std::string &path)
+      : path_(path), buf_(new char[buf_size_]) {
+    ofs_.rdbuf()->pubsetbuf(buf_.get(), buf_size_);
+    ofs_.open(path_ + ".tmp", std::ios::out | std::ios::trunc |
+                                  std::ios::binary);
+    if (!ofs_.is_open()) {
+      ERROR("cannot open checkpoint %s.tmp\n", path_.c_str());
+    }
+
+    struct checkpoint_header header {};
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version = CHECKPOINT_VERSION;
+    header.header_size = sizeof(struct checkpoint_header);
+    put(header);
+  }
+
+  CheckpointWriter(const CheckpointWriter &) = delete;
+  CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+  void put_bytes(const void *data, size_t len) {
+    ofs_.write(static_cast<const char *>(data), (std::streamsize)len);
+  }
+
+  template <typename T>
+  void put(const T &v) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable values can be saved directly");
+    put_bytes(&v, sizeof(T));
+  }
+
+  void put(const std::string &s) {
+    put((uint64_t)s.size());
+    put_bytes(s.data(), s.size());
+  }
+
+  template <typename T>
+  void put(const std::vector<T> &v) {
+    put((uint64_t)v.size());
+    put_bytes(v.data(), v.size() * sizeof(T));
+  }
+
+  template <typename K, typename V>
+  void put(const std::unordered_map<K, V> &m) {
+    put((uint64_t)m.size());
+    for (const auto &p : m) {
+      put(p.first);
+      put(p.second);
+    }
+  }
+
+  template <typename K, typename V>
+  void put(const robin_hood::unordered_flat_map<K, V> &m) {
+    put((uint64_t)m.size());
+    for (const auto &p : m) {
+      put(p.first);
+      put(p.second);
+    }
+  }
+
+  /* finish the checkpoint and replace the previous one */
+  void commit() {
+    ofs_.close();
+    if (ofs_.fail()) {
+      ERROR("fail to write checkpoint %s.tmp\n", path_.c_str());
+    }
+    if (rename((path_ + ".tmp").c_str(), path_.c_str()) != 0) {
+      ERROR("fail to rename checkpoint %s.tmp\n", path_.c_str());
+    }
+  }
+
+ private:
+  static constexpr size_t buf_size_ = 4 * 1024 * 1024;
+
+  std::string path_;
+  std::unique_ptr<char[]> buf_;
+  std::ofstream ofs_;
+};
+
+class CheckpointReader {
+ public:
+  explicit CheckpointReader(const std::string &path)
+      : path_(path), buf_(new char[buf_size_]) {
+    ifs_.rdbuf()->pubsetbuf(buf_.get(), buf_size_);
+    ifs_.open(path_, std::ios::in | std::ios::binary);
+    if (!ifs_.is_open()) {
+      ERROR("cannot open checkpoint %s\n", path_.c_str());
+    }
+
+    struct checkpoint_header header;
+    get(header);
+    if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) !=
+            0 ||
+        header.version != CHECKPOINT_VERSION ||
+        header.header_size != sizeof(struct checkpoint_header)) {
+      ERROR("%s is not a checkpoint of this version\n", path_.c_str());
+    }
+  }
+
+  CheckpointReader(const CheckpointReader &) = delete;
+  CheckpointReader &operator=(const CheckpointReader &) = delete;
+
+  void get_bytes(void *data, size_t len) {
+    ifs_.read(static_cast<char *>(data), (std::streamsize)len);
+    if (ifs_.gcount() != (std::streamsize)len) {
+      ERROR("checkpoint %s is truncated\n", path_.c_str());
+    }
+  }
+
+  template <typename T>
+  void get(T &v) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable values can be loaded directly");
+    get_bytes(&v, sizeof(T));
+  }
+
+  void get(std::string &s) {
+    s.resize(get_size());
+    get_bytes(&s[0], s.size());
+  }
+
+  template <typename T>
+  void get(std::vector<T> &v) {
+    v.resize(get_size());
+    get_bytes(v.data(), v.size() * sizeof(T));
+  }
+
+  template <typename K, typename V>
+  void get(std::unordered_map<K, V> &m) {
+    uint64_t n = get_size();
+    m.clear();
+    m.reserve(n);
+    for (uint64_t i = 0; i < n; i++) {
+      K k;
+      get(k);
+      get(m[k]);
+    }
+  }
+
+  template <typename K, typename V>
+  void get(robin_hood::unordered_flat_map<K, V> &m) {
+    uint64_t n = get_size();
+    m.clear();
+    m.reserve(n);
+    for (uint64_t i = 0; i < n; i++) {
+      K k;
+      get(k);
+      get(m[k]);
+    }
+  }
+
+ private:
+  static constexpr size_t buf_size_ = 4 * 1024 * 1024;
+
+  uint64_t get_size() {
+    uint64_t n;
+    get(n);
+    return n;
+  }
+
+  std::string path_;
+  std::unique_ptr<char[]> buf_;
+  std::ifstream ifs_;
+};
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,211 @@
+#include "footprint.h"
+
+#include <iomanip>
+
+#include "../include/libCacheSim/macro.h"
+
+namespace traceAnalyzer {
+using namespace std;
+
+void Footprint::add_gap(vector<struct gap_bucket> &hist, int64_t gap,
+                        double obj_size) {
+  /* a gap of 1 or less does not contain a window */
+  if (gap <= 1) return;
+
+  int bucket = gap_to_bucket((uint64_t)gap);
+  if (bucket >= (int)hist.size()) hist.resize(bucket + 1);
+  struct gap_bucket &b = hist[bucket];
+  b.n_obj += 1;
+  b.sum_obj += (double)gap;
+  b.n_byte += obj_size;
+  b.sum_byte += obj_size * (double)gap;
+}
+
+void Footprint::add_req(const request_t *req) {
+  double obj_size = (double)req->obj_size;
+  sum_req_byte_ += obj_size;
+
+  /* the time slots start from 1 */
+  if (req->compulsory_miss) {
+    add_gap(vtime_gap_, (int64_t)req->n_req, obj_size);
+    add_gap(rtime_gap_, (int64_t)req->clock_time + 1, obj_size);
+  } else {
+    add_gap(vtime_gap_, req->vtime_since_last_access, obj_size);
+    add_gap(rtime_gap_, req->rtime_since_last_access, obj_size);
+  }
+
+  if (req->first_seen_in_window) {
+    size_t window_idx = (size_t)(req->clock_time / time_window_);
+    if (window_idx >= window_obj_.size()) {
+      window_obj_.resize(window_idx + 1, 0);
+      window_byte_.resize(window_idx + 1, 0);
+    }
+    window_obj_[window_idx] += 1;
+    window_byte_[window_idx] += req->obj_size;
+  }
+}
+
+void Footprint::add_obj_map(const obj_info_map_type &obj_map, int64_t n_req,
+                            int64_t time_span) {
+  for (const auto &p : obj_map) {
+    double obj_size = (double)p.second.obj_size;
+    n_obj_ += 1;
+    n_byte_ += obj_size;
+    add_gap(vtime_gap_, n_req - p.second.last_access_vtime + 1, obj_size);
+    add_gap(rtime_gap_, time_span - p.second.last_access_rtime + 1, obj_size);
+  }
+}
+
+void Footprint::merge(const Footprint &shard) {
+  auto merge_hist = [](vector<struct gap_bucket> &dst,
+                       const vector<struct gap_bucket> &src) {
+    if (dst.size() < src.size()) dst.resize(src.size());
+    for (size_t i = 0; i < src.size(); i++) {
+      dst[i].n_obj += src[i].n_obj;
+      dst[i].sum_obj += src[i].sum_obj;
+      dst[i].n_byte += src[i].n_byte;
+      dst[i].sum_byte += src[i].sum_byte;
+    }
+  };
+
+  n_obj_ += shard.n_obj_;
+  n_byte_ += shard.n_byte_;
+  sum_req_byte_ += shard.sum_req_byte_;
+  merge_hist(vtime_gap_, shard.vtime_gap_);
+  merge_hist(rtime_gap_, shard.rtime_gap_);
+
+  if (window_obj_.size() < shard.window_obj_.size()) {
+    window_obj_.resize(shard.window_obj_.size(), 0);
+    window_byte_.resize(shard.window_byte_.size(), 0);
+  }
+  for (size_t i = 0; i < shard.window_obj_.size(); i++) {
+    window_obj_[i] += shard.window_obj_[i];
+    window_byte_[i] += shard.window_byte_[i];
+  }
+}
+
+vector<struct Footprint::fp_point> Footprint::compute_curve(
+    const vector<struct gap_bucket> &hist, int64_t n_slot) const {
+  /* the gaps longer than w are the buckets from gap_to_bucket(w + 1) */
+  vector<struct gap_bucket> suffix(hist.size() + 1);
+  for (int64_t i = (int64_t)hist.size() - 1; i >= 0; i--) {
+    suffix[i].n_obj = suffix[i + 1].n_obj + hist[i].n_obj;
+    suffix[i].sum_obj = suffix[i + 1].sum_obj + hist[i].sum_obj;
+    suffix[i].n_byte = suffix[i + 1].n_byte + hist[i].n_byte;
+    suffix[i].sum_byte = suffix[i + 1].sum_byte + hist[i].sum_byte;
+  }
+
+  vector<struct fp_point> curve;
+  for (size_t i = 2; i <= hist.size(); i++) {
+    int64_t w = (int64_t)bucket_lower((int)i) - 1;
+    if (w > n_slot) break;
+    double n_window = (double)(n_slot - w + 1);
+    double fp_obj =
+        n_obj_ - (suffix[i].sum_obj - (double)w * suffix[i].n_obj) / n_window;
+    double fp_byte = n_byte_ - (suffix[i].sum_byte -
+                                (double)w * suffix[i].n_byte) / n_window;
+    curve.push_back({w, fp_obj * scale_, fp_byte * scale_});
+  }
+  if (curve.empty() || curve.back().window < n_slot) {
+    curve.push_back({n_slot, n_obj_ * scale_, n_byte_ * scale_});
+  }
+
+  return curve;
+}
+
+void Footprint::compute(int64_t n_req, int64_t time_span) {
+  n_req_ = n_req;
+  vtime_fp_ = compute_curve(vtime_gap_, n_req);
+  rtime_fp_ = compute_curve(rtime_gap_, time_span + 1);
+}
+
+void Footprint::dump(string &path_base) {
+  ofstream ofs(path_base + ".footprint", ios::out | ios::trunc);
+  ofs << "# " << path_base << "\n";
+  ofs << fixed << setprecision(2);
+
+  ofs << "# footprint in virtual time: window (requests), obj, byte\n";
+  for (const auto &p : vtime_fp_) {
+    ofs << p.window << "," << p.n_obj << "," << p.n_byte << "\n";
+  }
+
+  ofs << "# footprint in real time: window (seconds), obj, byte\n";
+  for (const auto &p : rtime_fp_) {
+    ofs << p.window << "," << p.n_obj << "," << p.n_byte << "\n";
+  }
+
+  /* an LRU cache of size fp(w) misses fp(w + 1) - fp(w) per request */
+  double mean_req_byte = sum_req_byte_ * scale_ / (double)MAX(n_req_, 1);
+  ofs << "# miss ratio curve from the virtual time footprint: cache size "
+         "(obj), miss ratio, cache size (byte), byte miss ratio\n"
+      << setprecision(6);
+  for (size_t i = 0; i + 1 < vtime_fp_.size(); i++) {
+    const auto &p1 = vtime_fp_[i], &p2 = vtime_fp_[i + 1];
+    double dw = (double)(p2.window - p1.window);
+    ofs << (int64_t)p1.n_obj << "," << (p2.n_obj - p1.n_obj) / dw << ","
+        << (int64_t)p1.n_byte << ","
+        << (p2.n_byte - p1.n_byte) / dw / mean_req_byte << "\n";
+  }
+
+  ofs << "# the number of objects in each time window (" << time_window_
+      << " seconds)\n"
+      << setprecision(0);
+  for (auto n : window_obj_) {
+    ofs << (double)n * scale_ << ",";
+  }
+  ofs << "\n";
+  ofs << "# the number of bytes in each time window (" << time_window_
+      << " seconds)\n";
+  for (auto n : window_byte_) {
+    ofs << (double)n * scale_ << ",";
+  }
+  ofs << "\n";
+
+  ofs.close();
+}
+
+ostream &operator<<(ostream &os, const Footprint &fp) {
+  if (fp.rtime_fp_.empty()) return os;
+
+  os << fixed << setprecision(4) << "footprint (obj/GiB) of window ";
+  for (int64_t window :
+       {(int64_t)fp.time_window_, (int64_t)3600, (int64_t)86400}) {
+    if (window > fp.rtime_fp_.back().window) break;
+    /* interpolate between the two points around the window */
+    size_t i = 0;
+    while (fp.rtime_fp_[i].window < window) i++;
+    double n_obj = fp.rtime_fp_[i].n_obj, n_byte = fp.rtime_fp_[i].n_byte;
+    if (i > 0 && fp.rtime_fp_[i].window > window) {
+      const auto &p1 = fp.rtime_fp_[i - 1], &p2 = fp.rtime_fp_[i];
+      double r = (double)(window - p1.window) / (double)(p2.window - p1.window);
+      n_obj = p1.n_obj + r * (p2.n_obj - p1.n_obj);
+      n_byte = p1.n_byte + r * (p2.n_byte - p1.n_byte);
+    }
+    os << window << "s: " << (int64_t)n_obj << "/" << n_byte / GiB << ", ";
+  }
+  os << "\n";
+
+  return os;
+}
+
+void Footprint::save(CheckpointWriter &ckpt) {
+  ckpt.put(n_obj_);
+  ckpt.put(n_byte_);
+  ckpt.put(sum_req_byte_);
+  ckpt.put(vtime_gap_);
+  ckpt.put(rtime_gap_);
+  ckpt.put(window_obj_);
+  ckpt.put(window_byte_);
+}
+
+void Footprint::load(CheckpointReader &ckpt) {
+  ckpt.get(n_obj_);
+  ckpt.get(n_byte_);
+  ckpt.get(sum_req_byte_);
+  ckpt.get(vtime_gap_);
+  ckpt.get(rtime_gap_);
+  ckpt.get(window_obj_);
+  ckpt.get(window_byte_);
+}
+
+}  // namespace traceAnalyzer
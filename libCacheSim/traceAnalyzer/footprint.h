@@ -0,0 +1,129 @@
+#pragma once
+/**
+ * the footprint (working set size) of the trace as a function of the window
+ * length, the average number of objects and bytes in all windows of length w,
+ * for all w in one pass (Xiang et al., "All-window profiling and composable
+ * models of cache sharing", PPoPP'11)
+ *
+ * for a trace of N time slots, an object misses a window if the window falls
+ * in a gap between its accesses, the first access time and the time after
+ * the last access are also gaps, a gap of length g contains max(0, g - w + 1)
+ * windows of length w, so
+ *    fp(w) = m - sum_{gaps} max(0, g - w) / (N - w + 1)
+ * where m is the number of objects and g is measured between accesses
+ * (a gap of g has g - 1 slots without access).
+ * The gaps are kept in a histogram whose buckets are exact below 32 and have
+ * 16 sub-buckets per power of two above, fp is evaluated at the bucket
+ * boundaries where it is exact.
+ *
+ * The footprint is computed in virtual time (requests) and real time
+ * (seconds), the derivative of the virtual time footprint gives the miss
+ * ratio of an LRU cache of size fp(w) (higher order theory of locality).
+ *
+ * It also counts the number of objects and bytes in each time window.
+ * It only needs per-request fields filled by the analyzer, so the counts of
+ * object shards can be merged.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
+#include "struct.h"
+
+namespace traceAnalyzer {
+
+class Footprint {
+ public:
+  /**
+   * @param time_window the window of the per-window object and byte count
+   * @param scale the objects are a sample of the trace (sketch mode), the
+   * counts are multiplied by scale
+   */
+  explicit Footprint(int time_window, double scale = 1.0)
+      : time_window_(time_window), scale_(scale){};
+
+  /* req->n_req is the order (start from 1) of the request in the trace */
+  void add_req(const request_t *req);
+
+  /* add the last access of the objects, n_req and time_span (the clock time
+   * of the last request) are the length of the trace */
+  void add_obj_map(const obj_info_map_type &obj_map, int64_t n_req,
+                   int64_t time_span);
+
+  /* merge the counts of a shard of the objects */
+  void merge(const Footprint &shard);
+
+  /* compute the footprint after all requests and objects are added */
+  void compute(int64_t n_req, int64_t time_span);
+
+  void dump(std::string &path_base);
+
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter &ckpt);
+
+  void load(CheckpointReader &ckpt);
+
+  Footprint *create_shard() const {
+    return new Footprint(time_window_, scale_);
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const Footprint &fp);
+
+ private:
+  struct gap_bucket {
+    /* the number of gaps and the sum of gap length, weighted by object and
+     * by byte */
+    double n_obj = 0;
+    double sum_obj = 0;
+    double n_byte = 0;
+    double sum_byte = 0;
+  };
+
+  struct fp_point {
+    int64_t window;
+    double n_obj;
+    double n_byte;
+  };
+
+  static inline int gap_to_bucket(uint64_t gap) {
+    if (gap < 32) return (int)gap;
+    int e = 63 - __builtin_clzll(gap);
+    return 32 + (e - 5) * 16 + (int)((gap >> (e - 4)) & 15);
+  }
+
+  static inline uint64_t bucket_lower(int bucket) {
+    if (bucket < 32) return bucket;
+    int e = (bucket - 32) / 16 + 5;
+    return (uint64_t)(16 + (bucket - 32) % 16) << (e - 4);
+  }
+
+  static void add_gap(std::vector<struct gap_bucket> &hist, int64_t gap,
+                      double obj_size);
+
+  std::vector<struct fp_point> compute_curve(
+      const std::vector<struct gap_bucket> &hist, int64_t n_slot) const;
+
+  const int time_window_;
+  const double scale_;
+
+  double n_obj_ = 0;
+  double n_byte_ = 0;
+  double sum_req_byte_ = 0;
+  std::vector<struct gap_bucket> vtime_gap_;
+  std::vector<struct gap_bucket> rtime_gap_;
+
+  /* the number of objects and bytes of each time window */
+  std::vector<uint64_t> window_obj_;
+  std::vector<uint64_t> window_byte_;
+
+  int64_t n_req_ = 0;
+  std::vector<struct fp_point> vtime_fp_;
+  std::vector<struct fp_point> rtime_fp_;
+};
+
+}  // namespace traceAnalyzer
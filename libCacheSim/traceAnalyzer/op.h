@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
 
 using namespace std;
 
@@ -52,6 +53,17 @@ class OpStat {
     return os;
   }
 
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter& ckpt) {
+    ckpt.put(op_cnt_);
+    ckpt.put(overwrite_cnt_);
+  }
+
+  void load(CheckpointReader& ckpt) {
+    ckpt.get(op_cnt_);
+    ckpt.get(overwrite_cnt_);
+  }
+
  private:
   uint64_t op_cnt_[OP_INVALID + 1] = {0}; /* the number of requests of an op */
   uint64_t overwrite_cnt_ = 0;
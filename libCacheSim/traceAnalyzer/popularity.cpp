@@ -6,6 +6,7 @@
 #include <cmath>
 #include <fstream>
 #include <numeric>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -15,8 +16,32 @@
 namespace traceAnalyzer {
 using namespace std;
 
+void FreqHist::merge(const FreqHist &other) {
+  if (!other.dense_.empty()) {
+    if (dense_.empty()) dense_.resize(n_dense_, 0);
+    for (uint32_t i = 0; i < n_dense_; i++) dense_[i] += other.dense_[i];
+  }
+  for (const auto &p : other.sparse_) sparse_[p.first] += p.second;
+}
+
+uint64_t FreqHist::n_obj_of_freq(uint32_t freq) const {
+  if (freq < n_dense_) return dense_.empty() ? 0 : dense_[freq];
+  auto it = sparse_.find(freq);
+  return it == sparse_.end() ? 0 : it->second;
+}
+
+vector<pair<uint32_t, uint64_t>> FreqHist::get_sorted() const {
+  vector<pair<uint32_t, uint64_t>> freq_cnt(sparse_.begin(), sparse_.end());
+  sort(freq_cnt.begin(), freq_cnt.end(), greater<>());
+  for (int64_t i = (int64_t)dense_.size() - 1; i >= 0; i--) {
+    if (dense_[i] > 0) freq_cnt.emplace_back((uint32_t)i, dense_[i]);
+  }
+
+  return freq_cnt;
+}
+
 void Popularity::dump(string &path_base) {
-  if (freq_vec_.empty()) {
+  if (freq_cnt_.empty()) {
     assert(!has_run);
     ERROR("popularity has not been computed\n");
     return;
@@ -27,60 +52,101 @@ void Popularity::dump(string &path_base) {
   ofs << "# " << path_base << "\n";
   ofs << "# freq (sorted):cnt - for Zipf plot\n";
 
-  /* convert sorted freq list to freq:cnt list sorted by freq (to save some
-   * space) */
-  uint32_t last_freq = freq_vec_[0];
-  uint32_t freq_cnt = 0;
-  for (auto &cnt : freq_vec_) {
-    if (cnt == last_freq) {
-      freq_cnt += 1;
-    } else {
-      ofs << last_freq << ":" << freq_cnt << "\n";
-      freq_cnt = 1;
-      last_freq = cnt;
-    }
+  for (const auto &p : freq_cnt_) {
+    ofs << p.first << ":" << p.second << "\n";
   }
-  ofs << last_freq << ":" << freq_cnt << "\n";
   ofs.close();
 }
 
+vector<uint32_t> Popularity::get_top_freq(int n) const {
+  vector<uint32_t> top_freq;
+  for (const auto &p : freq_cnt_) {
+    for (uint64_t i = 0; i < p.second && (int)top_freq.size() < n; i++) {
+      top_freq.push_back(p.first);
+    }
+    if ((int)top_freq.size() >= n) break;
+  }
+
+  return top_freq;
+}
+
 void Popularity::run(obj_info_map_type &obj_map) {
-  /* freq_vec_ is a sorted vec of obj frequency */
-  freq_vec_.reserve(obj_map.size());
+  FreqHist hist;
   for (const auto &p : obj_map) {
-    freq_vec_.push_back(p.second.freq);
+    hist.add(p.second.freq);
   }
-  sort(freq_vec_.begin(), freq_vec_.end(), greater<>());
+  freq_cnt_ = hist.get_sorted();
+
+  fit();
+}
+
+void Popularity::fit() {
+  n_obj_ = 0;
+  for (const auto &p : freq_cnt_) n_obj_ += p.second;
 
-  if (obj_map.size() < 200) {
-    fit_fail_reason_ = "popularity: too few objects (" +
-                       to_string(obj_map.size()) +
+  if (n_obj_ < 200) {
+    fit_fail_reason_ = "popularity: too few objects (" + to_string(n_obj_) +
                        "), skip the popularity computation";
     WARN("%s\n", fit_fail_reason_.c_str());
     return;
   }
 
-  if (freq_vec_[0] < 200) {
+  if (freq_cnt_[0].first < 200) {
     fit_fail_reason_ = "popularity: the most popular object has " +
-                       to_string(freq_vec_[0]) + " requests ";
+                       to_string(freq_cnt_[0].first) + " requests ";
     WARN("%s\n", fit_fail_reason_.c_str());
   }
 
-  /* calculate Zipf alpha using linear regression */
-  vector<double> log_freq(obj_map.size());
-  vector<double> log_rank(obj_map.size());
-
-  int i = 0;
-  for_each(log_freq.begin(), log_freq.end(),
-           [&](double &item) { item = log(freq_vec_[i++]); });
-  i = 0;
-  for_each(log_rank.begin(), log_rank.end(), [&](double &item) {
-    ++i;
-    item = log(i);
-  });
-
-  /* TODO: a better linear regression with intercept and R2 */
-  slope_ = -PopularityUtils::slope(log_rank, log_freq);
+  /* calculate Zipf alpha using linear regression of log(freq) on log(rank),
+   * the objects of the same frequency have consecutive ranks, so each thread
+   * sums a range of ranks */
+  struct reg_sum {
+    double x = 0, y = 0, xx = 0, xy = 0;
+  };
+  int n_part = (int)MAX(1, MIN((uint64_t)n_thread_, n_obj_ >> 20));
+  vector<struct reg_sum> sums(n_part);
+
+  auto sum_part = [&](int part) {
+    /* the ranks in (start, end] */
+    uint64_t start = n_obj_ * part / n_part;
+    uint64_t end = n_obj_ * (part + 1) / n_part;
+    struct reg_sum &sum = sums[part];
+    uint64_t rank = 0;
+    for (const auto &p : freq_cnt_) {
+      uint64_t lo = MAX(rank, start), hi = MIN(rank + p.second, end);
+      if (lo < hi) {
+        double sum_x = 0, sum_xx = 0;
+        for (uint64_t r = lo + 1; r <= hi; r++) {
+          double x = log((double)r);
+          sum_x += x;
+          sum_xx += x * x;
+        }
+        double y = log((double)p.first);
+        sum.x += sum_x;
+        sum.xx += sum_xx;
+        sum.xy += y * sum_x;
+        sum.y += y * (double)(hi - lo);
+      }
+      rank += p.second;
+      if (rank >= end) break;
+    }
+  };
+
+  vector<thread> threads;
+  for (int i = 1; i < n_part; i++) threads.emplace_back(sum_part, i);
+  sum_part(0);
+  for (auto &t : threads) t.join();
+
+  struct reg_sum total;
+  for (const auto &sum : sums) {
+    total.x += sum.x;
+    total.y += sum.y;
+    total.xx += sum.xx;
+    total.xy += sum.xy;
+  }
+  double n = (double)n_obj_;
+  slope_ = -(n * total.xy - total.x * total.y) /
+           (n * total.xx - total.x * total.x);
 
   has_run = true;
 }
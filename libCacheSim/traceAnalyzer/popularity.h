@@ -6,9 +6,11 @@
 #include <iomanip>
 #include <numeric>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
 #include "struct.h"
 #include "utils/include/linReg.h"
 
@@ -29,6 +31,35 @@ class PopularityUtils {
   }
 };
 
+/* the number of objects of each frequency, the rank-frequency pairs of the
+ * Zipf fit only need this instead of the sorted frequency of all objects */
+class FreqHist {
+ public:
+  FreqHist() = default;
+
+  inline void add(uint32_t freq, uint64_t n_obj = 1) {
+    if (freq < n_dense_) {
+      if (dense_.empty()) dense_.resize(n_dense_, 0);
+      dense_[freq] += n_obj;
+    } else {
+      sparse_[freq] += n_obj;
+    }
+  }
+
+  void merge(const FreqHist &other);
+
+  uint64_t n_obj_of_freq(uint32_t freq) const;
+
+  /* (freq, number of objects) sorted by freq in descending order */
+  std::vector<std::pair<uint32_t, uint64_t>> get_sorted() const;
+
+ private:
+  /* most objects have a small frequency */
+  static constexpr uint32_t n_dense_ = 1 << 16;
+  std::vector<uint64_t> dense_;
+  std::unordered_map<uint32_t, uint64_t> sparse_;
+};
+
 class Popularity {
  public:
   Popularity() { has_run = false; };
@@ -36,9 +67,24 @@ class Popularity {
 
   explicit Popularity(obj_info_map_type &obj_map) { run(obj_map); };
 
+  /* freq_vec is the (unsorted) frequency of all objects */
+  explicit Popularity(const std::vector<uint32_t> &freq_vec) {
+    FreqHist hist;
+    for (auto freq : freq_vec) hist.add(freq);
+    freq_cnt_ = hist.get_sorted();
+    fit();
+  };
+
+  /* the fit uses up to n_thread threads */
+  explicit Popularity(const FreqHist &hist, int n_thread = 1)
+      : n_thread_(n_thread) {
+    freq_cnt_ = hist.get_sorted();
+    fit();
+  };
+
   friend std::ostream &operator<<(std::ostream &os,
                                   const Popularity &popularity) {
-    if (popularity.freq_vec_.empty()) {
+    if (popularity.freq_cnt_.empty()) {
       ERROR("popularity has not been computed\n");
       return os;
     }
@@ -54,7 +100,9 @@ class Popularity {
     return os;
   }
 
-  std::vector<uint32_t> &get_sorted_freq() { return freq_vec_; }
+  /* the frequency of the n most popular objects, fewer if there are fewer
+   * objects */
+  std::vector<uint32_t> get_top_freq(int n) const;
 
   void dump(std::string &path_base);
 
@@ -63,7 +111,12 @@ class Popularity {
  private:
   void run(obj_info_map_type &obj_map);
 
-  std::vector<uint32_t> freq_vec_{};
+  void fit();
+
+  /* (freq, number of objects) sorted by freq in descending order */
+  std::vector<std::pair<uint32_t, uint64_t>> freq_cnt_{};
+  uint64_t n_obj_ = 0;
+  int n_thread_ = 1;
   double slope_ = -1, intercept_ = -1, r2_ = -1;
   bool has_run = false;
 };
@@ -4,33 +4,35 @@
 #include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <sstream>
 
 namespace traceAnalyzer {
 using namespace std;
 
-void PopularityDecay::turn_on_stream_dump(string &path_base) {
+void PopularityDecay::turn_on_stream_dump(string &path_base,
+                                          bool binary_output) {
+  stringstream desc;
 #ifdef USE_REQ_METRIC
-  stream_dump_req_ofs.open(
+  desc << "req_cnt for new object in prev N windows (time window "
+       << time_window_ << ")";
+  stream_dump_req_ofs.open<int32_t>(
       path_base + ".popularityDecay_w" + to_string(time_window_) + "_req",
-      ios::out | ios::trunc);
-  stream_dump_req_ofs << "# " << path_base << "\n";
-  stream_dump_req_ofs
-      << "# req_cnt for new object in prev N windows (time window "
-      << time_window_ << ")\n";
+      path_base, desc.str(), time_window_, binary_output);
+  desc.str("");
 #endif
 
-  stream_dump_obj_ofs.open(
+  desc << "obj_cnt for new object in prev N windows (time window "
+       << time_window_ << ")";
+  stream_dump_obj_ofs.open<int32_t>(
       path_base + ".popularityDecay_w" + to_string(time_window_) + "_obj",
-      ios::out | ios::trunc);
-  stream_dump_obj_ofs << "# " << path_base << "\n";
-  stream_dump_obj_ofs
-      << "# obj_cnt for new object in prev N windows (time window "
-      << time_window_ << ")\n";
+      path_base, desc.str(), time_window_, binary_output);
 }
 
 void PopularityDecay::add_req(const request_t *req) {
   if (unlikely(next_window_ts_ == -1)) {
-    next_window_ts_ = (int64_t)req->clock_time + time_window_;
+    /* the clock time starts from 0, the module may not see the first request
+     * when it only sees sampled objects (sketch mode) */
+    next_window_ts_ = time_window_;
   }
 
   /* this assumes req real time starts from 0 */
@@ -69,4 +71,68 @@ void PopularityDecay::add_req(const request_t *req) {
   }
 }
 
+void PopularityDecay::add_shard_req(const request_t *req) {
+  if (req->clock_time < warmup_rtime_) {
+    return;
+  }
+
+  int create_time_window_idx = time_to_window_idx(req->create_rtime);
+  if (create_time_window_idx < idx_shift) {
+    return;
+  }
+
+  /* add_req dumps a window at each window boundary after warmup (and after
+   * the first window) that the requests have passed */
+  int64_t window_row =
+      time_to_window_idx(req->clock_time) - MAX(idx_shift, 1) + 1;
+  if (window_row > n_window_row_) {
+    n_window_row_ = window_row;
+  }
+
+#ifdef USE_REQ_METRIC
+  window_req_rows_.at(window_row).at(create_time_window_idx - idx_shift) += 1;
+#endif
+  if (req->first_seen_in_window) {
+    window_obj_rows_.at(window_row).at(create_time_window_idx - idx_shift) +=
+        1;
+  }
+}
+
+void PopularityDecay::merge_window(std::vector<PopularityDecay *> &shards,
+                                   int64_t until_row) {
+  for (auto *shard : shards) {
+    n_window_row_ = MAX(n_window_row_, shard->n_window_row_);
+  }
+  until_row = MIN(until_row, n_window_row_);
+
+  for (auto *shard : shards) {
+#ifdef USE_REQ_METRIC
+    window_req_rows_.merge(shard->window_req_rows_, until_row);
+#endif
+    window_obj_rows_.merge(shard->window_obj_rows_, until_row);
+  }
+#ifdef USE_REQ_METRIC
+  window_req_rows_.stream_dump(stream_dump_req_ofs, until_row);
+#endif
+  window_obj_rows_.stream_dump(stream_dump_obj_ofs, until_row);
+}
+
+void PopularityDecay::save(CheckpointWriter &ckpt) {
+  ckpt.put(n_window_row_);
+  ckpt.put(next_window_ts_);
+  ckpt.put(n_req_per_window);
+  ckpt.put(n_obj_per_window);
+  stream_dump_req_ofs.save(ckpt);
+  stream_dump_obj_ofs.save(ckpt);
+}
+
+void PopularityDecay::load(CheckpointReader &ckpt) {
+  ckpt.get(n_window_row_);
+  ckpt.get(next_window_ts_);
+  ckpt.get(n_req_per_window);
+  ckpt.get(n_obj_per_window);
+  stream_dump_req_ofs.load(ckpt);
+  stream_dump_obj_ofs.load(ckpt);
+}
+
 };  // namespace traceAnalyzer
@@ -38,6 +38,8 @@
 #include "../include/libCacheSim/macro.h"
 #include "../include/libCacheSim/request.h"
 #include "struct.h"
+#include "windowRows.h"
+#include "windowStream.h"
 
 // #define USE_REQ_METRIC 1
 
@@ -49,23 +51,17 @@ class PopularityDecay {
   int warmup_rtime_;
   int time_window_;
 
+  /* binary_output writes the rows in the binary format, see windowStream.h */
   PopularityDecay(std::string &path_base, int time_window = 300,
-                  int warmup_rtime = 7200)
+                  int warmup_rtime = 7200, bool binary_output = false)
       : time_window_(time_window), warmup_rtime_(warmup_rtime) {
     n_req_per_window.resize(1, 0);
     n_obj_per_window.resize(1, 0);
     idx_shift = (int)((double)warmup_rtime / time_window);
-    turn_on_stream_dump(path_base);
+    turn_on_stream_dump(path_base, binary_output);
   };
 
-  ~PopularityDecay() {
-#ifdef USE_REQ_METRIC
-    stream_dump_req_ofs.close();
-#endif
-    stream_dump_obj_ofs.close();
-  }
-
-  void turn_on_stream_dump(std::string &path_base);
+  void turn_on_stream_dump(std::string &path_base, bool binary_output);
 
   void add_req(const request_t *req);
 
@@ -73,7 +69,41 @@ class PopularityDecay {
 
   void dump(std::string &path_base) { ; }
 
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter &ckpt);
+
+  void load(CheckpointReader &ckpt);
+
+  /* parallel analysis, see analyzerParallel.cpp */
+  /* an instance that counts the requests of one shard of the objects,
+   * it does not write files */
+  PopularityDecay *create_shard() const {
+    return new PopularityDecay(time_window_, warmup_rtime_);
+  }
+
+  void add_shard_req(const request_t *req);
+
+  /* merge the windows before until_row of the shards and stream dump them,
+   * the windows after the last request of an object created after warmup
+   * are not dumped, as in add_req */
+  void merge_window(std::vector<PopularityDecay *> &shards, int64_t until_row);
+
  private:
+  PopularityDecay(int time_window, int warmup_rtime)
+      : warmup_rtime_(warmup_rtime), time_window_(time_window) {
+    idx_shift = (int)((double)warmup_rtime / time_window);
+  };
+
+  /* row i has the objects created in the first i windows after warmup */
+  static size_t window_row_init_len(int64_t row) { return row + 1; }
+
+#ifdef USE_REQ_METRIC
+  WindowRows<int32_t> window_req_rows_{window_row_init_len};
+#endif
+  WindowRows<int32_t> window_obj_rows_{window_row_init_len};
+  /* the number of windows that add_req would have dumped */
+  int64_t n_window_row_ = 0;
+
   int64_t next_window_ts_ = -1;
   /** how many of requests (objects) in current window are requesting objects
    * created in previous N windows for example, idx 0 stores the number of
@@ -82,22 +112,15 @@ class PopularityDecay {
   std::vector<int32_t> n_req_per_window;
   std::vector<int32_t> n_obj_per_window;
 
-  std::ofstream stream_dump_req_ofs;
-  std::ofstream stream_dump_obj_ofs;
+  WindowStream stream_dump_req_ofs;
+  WindowStream stream_dump_obj_ofs;
   int idx_shift = -1;
 
   void stream_dump() {
 #ifdef USE_REQ_METRIC
-    for (auto n_req : n_req_per_window) {
-      stream_dump_req_ofs << n_req << ",";
-    }
-    stream_dump_req_ofs << endl;
+    stream_dump_req_ofs.write_row(n_req_per_window);
 #endif
-
-    for (auto n_obj : n_obj_per_window) {
-      stream_dump_obj_ofs << n_obj << ",";
-    }
-    stream_dump_obj_ofs << std::endl;
+    stream_dump_obj_ofs.write_row(n_obj_per_window);
   }
 };
 }  // namespace traceAnalyzer
\ No newline at end of file
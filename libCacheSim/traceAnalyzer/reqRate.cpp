@@ -60,6 +60,14 @@ void ReqRate::dump(const string &path_base) {
   }
   ofs << "\n";
 
+  if (!obj_byte_rate_.empty()) {
+    ofs << "# obj byte rate - time window " << time_window_ << " second\n";
+    for (auto &n_byte : obj_byte_rate_) {
+      ofs << n_byte / time_window_ << ",";
+    }
+    ofs << "\n";
+  }
+
   ofs << "# first seen obj (cold miss) rate - time window " << time_window_
       << " second\n";
   for (auto &n_obj : first_seen_obj_rate_) {
@@ -70,4 +78,28 @@ void ReqRate::dump(const string &path_base) {
   ofs.close();
 }
 
+void ReqRate::save(CheckpointWriter &ckpt) {
+  ckpt.put(next_window_ts_);
+  ckpt.put(window_n_req_);
+  ckpt.put(window_n_byte_);
+  ckpt.put(window_n_obj_);
+  ckpt.put(window_compulsory_miss_obj_);
+  ckpt.put(req_rate_);
+  ckpt.put(byte_rate_);
+  ckpt.put(obj_rate_);
+  ckpt.put(first_seen_obj_rate_);
+}
+
+void ReqRate::load(CheckpointReader &ckpt) {
+  ckpt.get(next_window_ts_);
+  ckpt.get(window_n_req_);
+  ckpt.get(window_n_byte_);
+  ckpt.get(window_n_obj_);
+  ckpt.get(window_compulsory_miss_obj_);
+  ckpt.get(req_rate_);
+  ckpt.get(byte_rate_);
+  ckpt.get(obj_rate_);
+  ckpt.get(first_seen_obj_rate_);
+}
+
 };  // namespace traceAnalyzer
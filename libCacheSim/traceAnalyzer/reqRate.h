@@ -8,6 +8,7 @@
 
 #include "../include/libCacheSim/macro.h"
 #include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
 
 namespace traceAnalyzer {
 
@@ -21,6 +22,24 @@ class ReqRate {
 
   void dump(const std::string &path_base);
 
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter &ckpt);
+
+  void load(CheckpointReader &ckpt);
+
+  /* replace the number of objects of each window, used by the sketch mode
+   * which does not know whether a request is the first in its window */
+  void set_obj_rate(const std::vector<uint32_t> &obj_rate) {
+    obj_rate_ = obj_rate;
+    obj_rate_.resize(req_rate_.size(), 0);
+  }
+
+  /* the unique bytes of each window, only known in the sketch mode */
+  void set_obj_byte_rate(const std::vector<uint64_t> &obj_byte_rate) {
+    obj_byte_rate_ = obj_byte_rate;
+    obj_byte_rate_.resize(req_rate_.size(), 0);
+  }
+
   friend std::ostream &operator<<(std::ostream &os, const ReqRate &rr) {
     if (rr.req_rate_.size() < 10) {
       WARN("request rate not enough window (%zu window)\n",
@@ -64,6 +83,7 @@ class ReqRate {
   std::vector<uint32_t> req_rate_{};
   std::vector<uint64_t> byte_rate_{}; /* bytes/sec */
   std::vector<uint32_t> obj_rate_{};
+  std::vector<uint64_t> obj_byte_rate_{}; /* unique bytes/sec */
   /* used to calculate cold miss ratio over time */
   std::vector<uint32_t> first_seen_obj_rate_{};
 };
@@ -16,22 +16,16 @@ using namespace std;
 
 void ReuseDistribution::add_req(request_t *req) {
   if (unlikely(next_window_ts_ == -1)) {
-    next_window_ts_ = (int64_t)req->clock_time + time_window_;
+    /* the clock time starts from 0, the module may not see the first request
+     * when it only sees sampled objects (sketch mode) */
+    next_window_ts_ = time_window_;
   }
 
-  if (req->rtime_since_last_access < 0) {
-    reuse_rtime_req_cnt_[-1] += 1;
-    reuse_vtime_req_cnt_[-1] += 1;
-
+  int pos_rt, pos_vt;
+  if (!count_req(req, &pos_rt, &pos_vt)) {
     return;
   }
 
-  int pos_rt = (int)(req->rtime_since_last_access / rtime_granularity_);
-  int pos_vt = (int)(log(double(req->vtime_since_last_access)) / log_log_base_);
-
-  reuse_rtime_req_cnt_[pos_rt] += 1;
-  reuse_vtime_req_cnt_[pos_vt] += 1;
-
   //    switch (req->op) {
   //      case OP_GET:
   //      case OP_GETS:
@@ -63,6 +57,57 @@ void ReuseDistribution::add_req(request_t *req) {
   }
 }
 
+bool ReuseDistribution::count_req(const request_t *req, int *pos_rt,
+                                  int *pos_vt) {
+  if (req->rtime_since_last_access < 0) {
+    reuse_rtime_req_cnt_[-1] += 1;
+    reuse_vtime_req_cnt_[-1] += 1;
+
+    return false;
+  }
+
+  *pos_rt = (int)(req->rtime_since_last_access / rtime_granularity_);
+  *pos_vt = (int)(log(double(req->vtime_since_last_access)) / log_log_base_);
+
+  reuse_rtime_req_cnt_[*pos_rt] += 1;
+  reuse_vtime_req_cnt_[*pos_vt] += 1;
+
+  return true;
+}
+
+void ReuseDistribution::add_shard_req(request_t *req, int64_t window_row) {
+  int pos_rt, pos_vt;
+  if (!count_req(req, &pos_rt, &pos_vt)) {
+    return;
+  }
+
+  if (time_window_ <= 0) return;
+
+  window_rtime_rows_.incr(window_row, pos_rt, (int64_t)req->n_req, 1);
+  window_vtime_rows_.incr(window_row, pos_vt, (int64_t)req->n_req, 1);
+}
+
+void ReuseDistribution::merge_window(vector<ReuseDistribution *> &shards,
+                                     int64_t until_row) {
+  if (time_window_ <= 0) return;
+
+  for (auto *shard : shards) {
+    window_rtime_rows_.merge(shard->window_rtime_rows_, until_row);
+    window_vtime_rows_.merge(shard->window_vtime_rows_, until_row);
+  }
+  window_rtime_rows_.stream_dump(stream_dump_rt_ofs, until_row);
+  window_vtime_rows_.stream_dump(stream_dump_vt_ofs, until_row);
+}
+
+void ReuseDistribution::merge(const ReuseDistribution &shard) {
+  for (auto &p : shard.reuse_rtime_req_cnt_) {
+    reuse_rtime_req_cnt_[p.first] += p.second;
+  }
+  for (auto &p : shard.reuse_vtime_req_cnt_) {
+    reuse_vtime_req_cnt_[p.first] += p.second;
+  }
+}
+
 void ReuseDistribution::dump(string &path_base) {
   ofstream ofs(path_base + ".reuse", ios::out | ios::trunc);
   ofs << "# " << path_base << "\n";
@@ -88,34 +133,52 @@ void ReuseDistribution::dump(string &path_base) {
   //    rtime_granularity_ << ")\n";
 }
 
-void ReuseDistribution::turn_on_stream_dump(string &path_base) {
-  stream_dump_rt_ofs.open(
+void ReuseDistribution::turn_on_stream_dump(string &path_base,
+                                            bool binary_output) {
+  stringstream desc;
+  desc << "reuse real time distribution per window (time granularity "
+       << rtime_granularity_ << ", time window " << time_window_ << ")";
+  stream_dump_rt_ofs.open<uint32_t>(
       path_base + ".reuseWindow_w" + to_string(time_window_) + "_rt",
-      ios::out | ios::trunc);
-  stream_dump_rt_ofs << "# " << path_base << "\n";
-  stream_dump_rt_ofs
-      << "# reuse real time distribution per window (time granularity ";
-  stream_dump_rt_ofs << rtime_granularity_ << ", time window " << time_window_
-                     << ")\n";
-
-  stream_dump_vt_ofs.open(
+      path_base, desc.str(), time_window_, binary_output);
+
+  desc.str("");
+  desc << "reuse virtual time distribution per window (log base " << log_base_
+       << ", time window " << time_window_ << ")";
+  stream_dump_vt_ofs.open<uint32_t>(
       path_base + ".reuseWindow_w" + to_string(time_window_) + "_vt",
-      ios::out | ios::trunc);
-  stream_dump_vt_ofs << "# " << path_base << "\n";
-  stream_dump_vt_ofs
-      << "# reuse virtual time distribution per window (log base " << log_base_;
-  stream_dump_vt_ofs << ", time window " << time_window_ << ")\n";
+      path_base, desc.str(), time_window_, binary_output);
 }
 
 void ReuseDistribution::stream_dump_window_reuse_distribution() {
-  for (const auto &p : window_reuse_rtime_req_cnt_) {
-    stream_dump_rt_ofs << p << ",";
-  }
-  stream_dump_rt_ofs << "\n";
+  stream_dump_rt_ofs.write_row(window_reuse_rtime_req_cnt_);
+  stream_dump_vt_ofs.write_row(window_reuse_vtime_req_cnt_);
+}
 
-  for (const auto &p : window_reuse_vtime_req_cnt_) {
-    stream_dump_vt_ofs << p << ",";
-  }
-  stream_dump_vt_ofs << "\n";
+void ReuseDistribution::save(CheckpointWriter &ckpt) {
+  ckpt.put(reuse_rtime_req_cnt_);
+  ckpt.put(reuse_vtime_req_cnt_);
+  ckpt.put(reuse_rtime_req_cnt_read_);
+  ckpt.put(reuse_rtime_req_cnt_write_);
+  ckpt.put(reuse_rtime_req_cnt_delete_);
+  ckpt.put(next_window_ts_);
+  ckpt.put(window_reuse_rtime_req_cnt_);
+  ckpt.put(window_reuse_vtime_req_cnt_);
+  stream_dump_rt_ofs.save(ckpt);
+  stream_dump_vt_ofs.save(ckpt);
+}
+
+void ReuseDistribution::load(CheckpointReader &ckpt) {
+  ckpt.get(reuse_rtime_req_cnt_);
+  ckpt.get(reuse_vtime_req_cnt_);
+  ckpt.get(reuse_rtime_req_cnt_read_);
+  ckpt.get(reuse_rtime_req_cnt_write_);
+  ckpt.get(reuse_rtime_req_cnt_delete_);
+  ckpt.get(next_window_ts_);
+  ckpt.get(window_reuse_rtime_req_cnt_);
+  ckpt.get(window_reuse_vtime_req_cnt_);
+  stream_dump_rt_ofs.load(ckpt);
+  stream_dump_vt_ofs.load(ckpt);
 }
+
 };  // namespace traceAnalyzer
@@ -11,29 +11,59 @@
 #include "../include/libCacheSim/reader.h"
 #include "struct.h"
 #include "utils/include/utils.h"
+#include "windowRows.h"
+#include "windowStream.h"
 
 namespace traceAnalyzer {
 class ReuseDistribution {
  public:
+  /* binary_output writes the per-window distribution in the binary format,
+   * see windowStream.h */
   explicit ReuseDistribution(std::string output_path, int time_window = 300,
                              int rtime_granularity = 5,
-                             int vtime_granularity = 1000)
+                             int vtime_granularity = 1000,
+                             bool binary_output = false)
       : time_window_(time_window),
         rtime_granularity_(rtime_granularity),
         vtime_granularity_(vtime_granularity) {
-    turn_on_stream_dump(output_path);
+    turn_on_stream_dump(output_path, binary_output);
   };
 
-  ~ReuseDistribution() {
-    stream_dump_rt_ofs.close();
-    stream_dump_vt_ofs.close();
-  }
-
   void add_req(request_t *req);
 
   void dump(std::string &path_base);
 
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter &ckpt);
+
+  void load(CheckpointReader &ckpt);
+
+  /* parallel analysis, see analyzerParallel.cpp */
+  /* an instance that counts the requests of one shard of the objects,
+   * it does not write files */
+  ReuseDistribution *create_shard() const {
+    return new ReuseDistribution(time_window_, rtime_granularity_,
+                                 vtime_granularity_);
+  }
+
+  /* window_row is the number of windows dumped before the request,
+   * req->n_req is the order of the request in the trace */
+  void add_shard_req(request_t *req, int64_t window_row);
+
+  /* merge the windows before until_row of the shards and stream dump them */
+  void merge_window(std::vector<ReuseDistribution *> &shards,
+                    int64_t until_row);
+
+  /* merge the reuse distribution of the whole trace */
+  void merge(const ReuseDistribution &shard);
+
  private:
+  ReuseDistribution(int time_window, int rtime_granularity,
+                    int vtime_granularity)
+      : time_window_(time_window),
+        rtime_granularity_(rtime_granularity),
+        vtime_granularity_(vtime_granularity){};
+
   /* request count for reuse rtime/vtime */
   std::unordered_map<int32_t, uint32_t> reuse_rtime_req_cnt_;
   std::unordered_map<int32_t, uint32_t> reuse_vtime_req_cnt_;
@@ -53,12 +83,20 @@ class ReuseDistribution {
   std::vector<uint32_t> window_reuse_rtime_req_cnt_;
   std::vector<uint32_t> window_reuse_vtime_req_cnt_;
 
-  std::ofstream stream_dump_rt_ofs;
-  std::ofstream stream_dump_vt_ofs;
+  /* a window grows to pos + 2 in utils::vector_incr */
+  WindowRows<uint32_t> window_rtime_rows_{nullptr, 2};
+  WindowRows<uint32_t> window_vtime_rows_{nullptr, 2};
+
+  WindowStream stream_dump_rt_ofs;
+  WindowStream stream_dump_vt_ofs;
 
-  void turn_on_stream_dump(std::string &path_base);
+  void turn_on_stream_dump(std::string &path_base, bool binary_output);
 
   void stream_dump_window_reuse_distribution();
+
+  /* count the request in the reuse distribution of the whole trace,
+   * return false if it is the first request to the object */
+  bool count_req(const request_t *req, int *pos_rt, int *pos_vt);
 };
 
 }  // namespace traceAnalyzer
@@ -0,0 +1,153 @@
+#include "scan.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+
+namespace traceAnalyzer {
+using namespace std;
+
+ScanStat::ScanStat(string &output_path, int time_window, int n_streams,
+                   int min_run, int max_gap, bool binary_output)
+    : time_window_(time_window), window_cnt_(4, 0) {
+  if (scan_detector_init(&detector_, n_streams, min_run, max_gap) != 0) {
+    ERROR("scan detector init fails, n_streams %d, min_run %d, max_gap %d\n",
+          n_streams, min_run, max_gap);
+  }
+
+  if (time_window_ > 0) {
+    stringstream desc;
+    desc << "scan per window (min run " << min_run << ", max gap " << max_gap
+         << ", time window " << time_window_
+         << "): n_req, n_scan_req, n_byte, n_scan_byte";
+    stream_dump_ofs_.open<uint64_t>(
+        output_path + ".scanWindow_w" + to_string(time_window_), output_path,
+        desc.str(), time_window_, binary_output);
+  }
+}
+
+void ScanStat::add_req(const request_t *req) {
+  if (unlikely(next_window_ts_ == -1)) {
+    next_window_ts_ = time_window_;
+  }
+
+  if (time_window_ > 0) {
+    while (req->clock_time >= next_window_ts_) {
+      stream_dump_window();
+      next_window_ts_ += time_window_;
+    }
+  }
+
+  int64_t run_len = scan_detector_add(&detector_, req->obj_id);
+  if (detector_.ended_run_len > 0) {
+    add_run(detector_.ended_run_len);
+  }
+
+  bool is_scan = scan_detector_is_scan(&detector_, run_len);
+  n_req_byte_ += req->obj_size;
+  window_cnt_[0] += 1;
+  window_cnt_[2] += req->obj_size;
+  if (is_scan) {
+    n_scan_byte_ += req->obj_size;
+    window_cnt_[1] += 1;
+    window_cnt_[3] += req->obj_size;
+  }
+}
+
+void ScanStat::add_run(int64_t run_len) {
+  int bucket = 63 - __builtin_clzll((uint64_t)run_len);
+  if (bucket >= (int)run_len_hist_.size()) run_len_hist_.resize(bucket + 1);
+  run_len_hist_[bucket].n_run += 1;
+  run_len_hist_[bucket].n_req += run_len;
+}
+
+void ScanStat::stream_dump_window() {
+  stream_dump_ofs_.write_row(window_cnt_);
+  std::fill(window_cnt_.begin(), window_cnt_.end(), 0);
+}
+
+void ScanStat::dump(string &path_base) {
+  if (time_window_ > 0) {
+    /* the last window */
+    stream_dump_window();
+    stream_dump_ofs_.close();
+  }
+
+  /* the runs that have not ended */
+  for (int i = 0; i < detector_.n_streams; i++) {
+    if (detector_.streams[i].run_len > 0) {
+      add_run(detector_.streams[i].run_len);
+      detector_.streams[i].run_len = 0;
+    }
+  }
+
+  if (detector_.n_req == 0) return;
+
+  ofstream ofs(path_base + ".scan", ios::out | ios::trunc);
+  ofs << "# " << path_base << "\n";
+  ofs << "# min run " << detector_.min_run << ", max gap "
+      << detector_.max_gap << ", " << detector_.n_streams << " streams\n";
+  ofs << "# n_req, n_scan_req, n_req_in_scan, n_scan: " << detector_.n_req
+      << ", " << detector_.n_scan_req << ", " << detector_.n_req_in_scan
+      << ", " << detector_.n_scan << "\n";
+  ofs << "# run length histogram: run length (lower bound), run_cnt, req_cnt\n";
+  for (size_t i = 0; i < run_len_hist_.size(); i++) {
+    if (run_len_hist_[i].n_run == 0) continue;
+    ofs << (1ULL << i) << "," << run_len_hist_[i].n_run << ","
+        << run_len_hist_[i].n_req << "\n";
+  }
+
+  ofs.close();
+}
+
+ostream &operator<<(ostream &os, const ScanStat &stat) {
+  const struct scan_detector &sd = stat.detector_;
+  if (sd.n_req == 0) return os;
+
+  os << fixed << setprecision(4) << "scan (sequential run of at least "
+     << sd.min_run << " req): " << sd.n_scan
+     << " scans, scan req fraction (req/byte): "
+     << (double)sd.n_scan_req / (double)sd.n_req << "/"
+     << (double)stat.n_scan_byte_ / (double)stat.n_req_byte_
+     << ", req in scans: " << (double)sd.n_req_in_scan / (double)sd.n_req
+     << "\n";
+
+  return os;
+}
+
+void ScanStat::save(CheckpointWriter &ckpt) {
+  ckpt.put(next_window_ts_);
+  ckpt.put(detector_.n_req);
+  ckpt.put(detector_.n_scan_req);
+  ckpt.put(detector_.n_req_in_scan);
+  ckpt.put(detector_.n_scan);
+  ckpt.put(detector_.vtime);
+  ckpt.put_bytes(detector_.streams,
+                 sizeof(struct scan_stream) * detector_.n_streams);
+  ckpt.put(n_req_byte_);
+  ckpt.put(n_scan_byte_);
+  ckpt.put(run_len_hist_);
+  ckpt.put(window_cnt_);
+  stream_dump_ofs_.save(ckpt);
+}
+
+void ScanStat::load(CheckpointReader &ckpt) {
+  ckpt.get(next_window_ts_);
+  ckpt.get(detector_.n_req);
+  ckpt.get(detector_.n_scan_req);
+  ckpt.get(detector_.n_req_in_scan);
+  ckpt.get(detector_.n_scan);
+  ckpt.get(detector_.vtime);
+  ckpt.get_bytes(detector_.streams,
+                 sizeof(struct scan_stream) * detector_.n_streams);
+  ckpt.get(n_req_byte_);
+  ckpt.get(n_scan_byte_);
+  ckpt.get(run_len_hist_);
+  ckpt.get(window_cnt_);
+  stream_dump_ofs_.load(ckpt);
+}
+
+}  // namespace traceAnalyzer
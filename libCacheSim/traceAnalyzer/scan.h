@@ -0,0 +1,78 @@
+#pragma once
+/**
+ * the sequential runs (scans) of the trace detected online, a request is a
+ * scan request if it extends a sequential run (the next obj_id within
+ * max_gap of the last request of the run) to at least min_run requests,
+ * see dataStructure/scanDetector.h, the same detector is used by the scan
+ * admission (cache/admission/scan.c)
+ *
+ * the detector tracks a fixed number of runs, so the memory does not grow
+ * with the trace, the fraction of scan requests and bytes of each time
+ * window is streamed to dataname.scanWindow_w300, and the histogram of the
+ * run lengths is written to dataname.scan
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../dataStructure/scanDetector.h"
+#include "../include/libCacheSim/request.h"
+#include "windowStream.h"
+
+namespace traceAnalyzer {
+
+class ScanStat {
+ public:
+  /**
+   * @param time_window the window of the per-window scan requests
+   * @param n_streams the number of runs tracked at the same time
+   * @param min_run the length of a run when it becomes a scan
+   * @param max_gap the largest obj_id distance between two requests of a run
+   * @param binary_output write the per-window output in the binary format,
+   * see windowStream.h
+   */
+  ScanStat(std::string &output_path, int time_window, int n_streams,
+           int min_run, int max_gap, bool binary_output = false);
+
+  ~ScanStat() { scan_detector_free(&detector_); }
+
+  void add_req(const request_t *req);
+
+  void dump(std::string &path_base);
+
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter &ckpt);
+
+  void load(CheckpointReader &ckpt);
+
+  friend std::ostream &operator<<(std::ostream &os, const ScanStat &stat);
+
+ private:
+  struct run_bucket {
+    /* the number of runs and the requests in them */
+    uint64_t n_run = 0;
+    uint64_t n_req = 0;
+  };
+
+  /* runs of length [2^i, 2^(i+1)) are in bucket i */
+  void add_run(int64_t run_len);
+
+  void stream_dump_window();
+
+  const int time_window_;
+  int64_t next_window_ts_ = -1;
+
+  struct scan_detector detector_;
+
+  uint64_t n_req_byte_ = 0;
+  uint64_t n_scan_byte_ = 0;
+  std::vector<struct run_bucket> run_len_hist_;
+
+  /* n_req, n_scan_req, n_byte, n_scan_byte of the current window */
+  std::vector<uint64_t> window_cnt_;
+  WindowStream stream_dump_ofs_;
+};
+
+}  // namespace traceAnalyzer
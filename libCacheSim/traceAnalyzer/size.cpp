@@ -3,7 +3,9 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
+#include <sstream>
 #include <string>
 
 namespace traceAnalyzer {
@@ -11,7 +13,9 @@ using namespace std;
 
 void SizeDistribution::add_req(request_t *req) {
   if (unlikely(next_window_ts_ == -1)) {
-    next_window_ts_ = (int64_t)req->clock_time + time_window_;
+    /* the clock time starts from 0, the module may not see the first request
+     * when it only sees sampled objects (sketch mode) */
+    next_window_ts_ = time_window_;
   }
 
   /* request count */
@@ -49,12 +53,47 @@ void SizeDistribution::add_req(request_t *req) {
 
   while (req->clock_time >= next_window_ts_) {
     stream_dump();
-    window_obj_size_req_cnt_ = vector<uint32_t>(20, 0);
-    window_obj_size_obj_cnt_ = vector<uint32_t>(20, 0);
+    window_obj_size_req_cnt_ = vector<uint32_t>(window_init_len_, 0);
+    window_obj_size_obj_cnt_ = vector<uint32_t>(window_init_len_, 0);
     next_window_ts_ += time_window_;
   }
 }
 
+void SizeDistribution::add_shard_req(request_t *req, int64_t window_row) {
+  obj_size_req_cnt_[req->obj_size] += 1;
+  if (req->compulsory_miss) {
+    obj_size_obj_cnt_[req->obj_size] += 1;
+  }
+
+  if (time_window_ <= 0) return;
+
+  int pos = (int)MAX(log((double)req->obj_size) / log_log_base, 0);
+  window_req_rows_.incr(window_row, pos, (int64_t)req->n_req, 1);
+  window_obj_rows_.incr(window_row, pos, (int64_t)req->n_req,
+                        req->first_seen_in_window ? 1 : 0);
+}
+
+void SizeDistribution::merge_window(vector<SizeDistribution *> &shards,
+                                    int64_t until_row) {
+  if (time_window_ <= 0) return;
+
+  for (auto *shard : shards) {
+    window_req_rows_.merge(shard->window_req_rows_, until_row);
+    window_obj_rows_.merge(shard->window_obj_rows_, until_row);
+  }
+  window_req_rows_.stream_dump(ofs_stream_req, until_row);
+  window_obj_rows_.stream_dump(ofs_stream_obj, until_row);
+}
+
+void SizeDistribution::merge(const SizeDistribution &shard) {
+  for (auto &p : shard.obj_size_req_cnt_) {
+    obj_size_req_cnt_[p.first] += p.second;
+  }
+  for (auto &p : shard.obj_size_obj_cnt_) {
+    obj_size_obj_cnt_[p.first] += p.second;
+  }
+}
+
 void SizeDistribution::dump(string &path_base) {
   ofstream ofs(path_base + ".size", ios::out | ios::trunc);
   ofs << "# " << path_base << "\n";
@@ -70,31 +109,43 @@ void SizeDistribution::dump(string &path_base) {
   ofs.close();
 }
 
-void SizeDistribution::turn_on_stream_dump(string &path_base) {
-  ofs_stream_req.open(
-      path_base + ".sizeWindow_w" + to_string(time_window_) + "_req",
-      ios::out | ios::trunc);
-  ofs_stream_req << "# " << path_base << "\n";
-  ofs_stream_req << "# object_size: req_cnt (time window " << time_window_
-                 << ", log_base " << LOG_BASE << ", size_base " << 1 << ")\n";
-
-  ofs_stream_obj.open(
-      path_base + ".sizeWindow_w" + to_string(time_window_) + "_obj",
-      ios::out | ios::trunc);
-  ofs_stream_obj << "# " << path_base << "\n";
-  ofs_stream_obj << "# object_size: obj_cnt (time window " << time_window_
-                 << ", log_base " << LOG_BASE << ", size_base " << 1 << ")\n";
+void SizeDistribution::turn_on_stream_dump(string &path_base,
+                                           bool binary_output) {
+  for (const char *cnt : {"req", "obj"}) {
+    stringstream desc;
+    desc << "object_size: " << cnt << "_cnt (time window " << time_window_
+         << ", log_base " << LOG_BASE << ", size_base " << 1 << ")";
+    WindowStream &ofs =
+        strcmp(cnt, "req") == 0 ? ofs_stream_req : ofs_stream_obj;
+    ofs.open<uint32_t>(
+        path_base + ".sizeWindow_w" + to_string(time_window_) + "_" + cnt,
+        path_base, desc.str(), time_window_, binary_output);
+  }
 }
 
 void SizeDistribution::stream_dump() {
-  for (const auto &p : window_obj_size_req_cnt_) {
-    ofs_stream_req << p << ",";
-  }
-  ofs_stream_req << "\n";
+  ofs_stream_req.write_row(window_obj_size_req_cnt_);
+  ofs_stream_obj.write_row(window_obj_size_obj_cnt_);
+}
 
-  for (const auto &p : window_obj_size_obj_cnt_) {
-    ofs_stream_obj << p << ",";
-  }
-  ofs_stream_obj << "\n";
+void SizeDistribution::save(CheckpointWriter &ckpt) {
+  ckpt.put(obj_size_req_cnt_);
+  ckpt.put(obj_size_obj_cnt_);
+  ckpt.put(next_window_ts_);
+  ckpt.put(window_obj_size_req_cnt_);
+  ckpt.put(window_obj_size_obj_cnt_);
+  ofs_stream_req.save(ckpt);
+  ofs_stream_obj.save(ckpt);
 }
+
+void SizeDistribution::load(CheckpointReader &ckpt) {
+  ckpt.get(obj_size_req_cnt_);
+  ckpt.get(obj_size_obj_cnt_);
+  ckpt.get(next_window_ts_);
+  ckpt.get(window_obj_size_req_cnt_);
+  ckpt.get(window_obj_size_obj_cnt_);
+  ofs_stream_req.load(ckpt);
+  ofs_stream_obj.load(ckpt);
+}
+
 };  // namespace traceAnalyzer
@@ -11,6 +11,8 @@
 #include "../include/libCacheSim/macro.h"
 #include "../include/libCacheSim/reader.h"
 #include "struct.h"
+#include "windowRows.h"
+#include "windowStream.h"
 
 namespace traceAnalyzer {
 class SizeDistribution {
@@ -23,24 +25,54 @@ class SizeDistribution {
    */
  public:
   SizeDistribution() = default;
-  explicit SizeDistribution(std::string &output_path, int time_window)
+  /* binary_output writes the per-window distribution in the binary format,
+   * see windowStream.h */
+  explicit SizeDistribution(std::string &output_path, int time_window,
+                            bool binary_output = false)
       : time_window_(time_window) {
     obj_size_req_cnt_.reserve(1e6);
     obj_size_obj_cnt_.reserve(1e6);
 
-    turn_on_stream_dump(output_path);
+    turn_on_stream_dump(output_path, binary_output);
   };
 
-  ~SizeDistribution() {
-    ofs_stream_req.close();
-    ofs_stream_obj.close();
-  }
-
   void add_req(request_t *req);
 
   void dump(std::string &path_base);
 
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter &ckpt);
+
+  void load(CheckpointReader &ckpt);
+
+  /* parallel analysis, see analyzerParallel.cpp */
+  /* an instance that counts the requests of one shard of the objects,
+   * it does not write files */
+  SizeDistribution *create_shard() const {
+    return new SizeDistribution(time_window_);
+  }
+
+  /* window_row is the number of windows dumped before the request,
+   * req->n_req is the order of the request in the trace */
+  void add_shard_req(request_t *req, int64_t window_row);
+
+  /* merge the windows before until_row of the shards and stream dump them */
+  void merge_window(std::vector<SizeDistribution *> &shards,
+                    int64_t until_row);
+
+  /* merge the size distribution of the whole trace */
+  void merge(const SizeDistribution &shard);
+
  private:
+  explicit SizeDistribution(int time_window) : time_window_(time_window){};
+
+  /* the first window starts empty, and the later ones start with
+   * window_init_len_ sizes */
+  static constexpr int window_init_len_ = 20;
+  static size_t window_row_init_len(int64_t row) {
+    return row == 0 ? 0 : window_init_len_;
+  }
+
   /* request/object count of certain size, size->count */
   std::unordered_map<obj_size_t, uint32_t> obj_size_req_cnt_;
   std::unordered_map<obj_size_t, uint32_t> obj_size_obj_cnt_;
@@ -54,10 +86,14 @@ class SizeDistribution {
   std::vector<uint32_t> window_obj_size_req_cnt_;
   std::vector<uint32_t> window_obj_size_obj_cnt_;
 
-  std::ofstream ofs_stream_req;
-  std::ofstream ofs_stream_obj;
+  /* a window grows to pos + 8 in add_req */
+  WindowRows<uint32_t> window_req_rows_{window_row_init_len, 8};
+  WindowRows<uint32_t> window_obj_rows_{window_row_init_len, 8};
+
+  WindowStream ofs_stream_req;
+  WindowStream ofs_stream_obj;
 
-  void turn_on_stream_dump(std::string &path_base);
+  void turn_on_stream_dump(std::string &path_base, bool binary_output);
 
   void stream_dump();
 };
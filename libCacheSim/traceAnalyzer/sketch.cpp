@@ -0,0 +1,127 @@
+#include "sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace traceAnalyzer {
+using namespace std;
+
+double HyperLogLog::estimate() const {
+  double m = (double)registers_.size();
+  double sum = 0;
+  int n_zero = 0;
+  for (auto r : registers_) {
+    sum += ldexp(1.0, -r);
+    if (r == 0) n_zero += 1;
+  }
+
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  double est = alpha * m * m / sum;
+  if (est <= 2.5 * m && n_zero > 0) {
+    /* small range correction (linear counting) */
+    est = m * log(m / n_zero);
+  }
+
+  return est;
+}
+
+void SpaceSaving::add(obj_id_t obj_id) {
+  auto it = pos_.find(obj_id);
+  if (it != pos_.end()) {
+    uint32_t i = it->second;
+    counters_[i].cnt += 1;
+    sift_down(i);
+    return;
+  }
+
+  if ((int)counters_.size() < k_) {
+    counters_.push_back({obj_id, 1});
+    pos_[obj_id] = counters_.size() - 1;
+    sift_up(counters_.size() - 1);
+    return;
+  }
+
+  /* replace the object with the smallest count, the new object inherits the
+   * count as its error */
+  pos_.erase(counters_[0].obj_id);
+  counters_[0].obj_id = obj_id;
+  counters_[0].cnt += 1;
+  pos_[obj_id] = 0;
+  sift_down(0);
+}
+
+void SpaceSaving::sift_up(uint32_t i) {
+  while (i > 0) {
+    uint32_t parent = (i - 1) / 2;
+    if (counters_[parent].cnt <= counters_[i].cnt) break;
+    swap_counter(i, parent);
+    i = parent;
+  }
+}
+
+void SpaceSaving::sift_down(uint32_t i) {
+  uint32_t n = counters_.size();
+  while (true) {
+    uint32_t smallest = i, l = 2 * i + 1, r = 2 * i + 2;
+    if (l < n && counters_[l].cnt < counters_[smallest].cnt) smallest = l;
+    if (r < n && counters_[r].cnt < counters_[smallest].cnt) smallest = r;
+    if (smallest == i) break;
+    swap_counter(i, smallest);
+    i = smallest;
+  }
+}
+
+vector<uint32_t> SpaceSaving::get_sorted_freq() const {
+  vector<uint32_t> freq_vec;
+  freq_vec.reserve(counters_.size());
+  for (const auto &c : counters_) {
+    freq_vec.push_back((uint32_t)MIN(c.cnt, UINT32_MAX));
+  }
+  sort(freq_vec.begin(), freq_vec.end(), greater<>());
+
+  return freq_vec;
+}
+
+int SketchStat::add_req(const request_t *req, uint64_t hash, bool sampled) {
+  if (unlikely(next_window_ts_ == -1)) {
+    next_window_ts_ = (int64_t)req->clock_time + time_window_;
+  }
+
+  hll_.add(hash);
+  window_hll_.add(hash);
+  top_k_.add(req->obj_id);
+  if (sampled && req->first_seen_in_window) {
+    window_sampled_n_obj_ += 1;
+    window_sampled_n_byte_ += req->obj_size;
+  }
+
+  int freq = blocked_cms_estimate(&cms_, hash);
+  if (freq < BLOCKED_CMS_MAX_COUNT) {
+    blocked_cms_increment(&cms_, hash);
+    freq_hist_[freq] -= 1;
+    freq_hist_[freq + 1] += 1;
+  }
+
+  /* the same windows as ReqRate */
+  while (req->clock_time >= next_window_ts_) {
+    double n_obj = window_hll_.estimate();
+    window_obj_cnt_.push_back((uint32_t)llround(n_obj));
+    /* the sampled objects are a uniform sample of the objects of the window,
+     * so their mean size is the mean size of the objects */
+    window_obj_byte_.push_back(
+        window_sampled_n_obj_ == 0
+            ? 0
+            : (uint64_t)llround(n_obj * (double)window_sampled_n_byte_ /
+                                (double)window_sampled_n_obj_));
+    window_hll_.reset();
+    window_sampled_n_obj_ = 0;
+    window_sampled_n_byte_ = 0;
+    next_window_ts_ += time_window_;
+  }
+
+  return freq;
+}
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,180 @@
+#pragma once
+/**
+ * the sketches used by the trace analyzer in sketch mode, which does not keep
+ * all objects in memory, see analyzerSketch.cpp
+ *
+ * 1. HyperLogLog estimates the number of objects in the trace and in each
+ *    time window, the unique bytes of a window is the HyperLogLog estimate
+ *    times the mean size of the sampled objects of the window
+ * 2. SpaceSaving keeps the top-k popular objects, the frequency of a top
+ *    object is over-estimated by at most the smallest counter
+ * 3. a count-min sketch with 4-bit counters estimates the frequency of each
+ *    object, the number of objects requested X times (X < 15) is updated when
+ *    the estimate of an object moves from X - 1 to X, an object with an
+ *    estimate of 0 has not been seen (the sketch never under-estimates)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../dataStructure/blockedCountMinSketch.h"
+#include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/request.h"
+#include "struct.h"
+
+namespace traceAnalyzer {
+
+class HyperLogLog {
+ public:
+  explicit HyperLogLog(int precision = 14)
+      : precision_(precision), registers_(1ULL << precision, 0){};
+
+  inline void add(uint64_t hash) {
+    uint64_t idx = hash >> (64 - precision_);
+    /* the bits after the index, with a guard bit so that rank is bounded */
+    uint64_t w = (hash << precision_) | (1ULL << (precision_ - 1));
+    uint8_t rank = (uint8_t)(__builtin_clzll(w) + 1);
+    if (rank > registers_[idx]) registers_[idx] = rank;
+  }
+
+  double estimate() const;
+
+  void reset() { std::fill(registers_.begin(), registers_.end(), 0); }
+
+  double std_error() const { return 1.04 / sqrt((double)registers_.size()); }
+
+ private:
+  int precision_;
+  std::vector<uint8_t> registers_;
+};
+
+class SpaceSaving {
+ public:
+  explicit SpaceSaving(int k) : k_(k) {
+    counters_.reserve(k);
+    pos_.reserve(k);
+  };
+
+  void add(obj_id_t obj_id);
+
+  /* the estimated frequency of the top objects, sorted in descending order */
+  std::vector<uint32_t> get_sorted_freq() const;
+
+  /* an object not in the top-k has at most this frequency, and the
+   * frequency of a top object is over-estimated by at most this much */
+  uint64_t max_error() const {
+    return (int)counters_.size() < k_ ? 0 : counters_[0].cnt;
+  }
+
+  int k() const { return k_; }
+
+ private:
+  struct counter {
+    obj_id_t obj_id;
+    uint64_t cnt;
+  };
+
+  int k_;
+  /* a min-heap on cnt */
+  std::vector<struct counter> counters_;
+  /* obj_id -> position in counters_ */
+  robin_hood::unordered_flat_map<obj_id_t, uint32_t> pos_;
+
+  inline void swap_counter(uint32_t i, uint32_t j) {
+    std::swap(counters_[i], counters_[j]);
+    pos_[counters_[i].obj_id] = i;
+    pos_[counters_[j].obj_id] = j;
+  }
+
+  void sift_up(uint32_t i);
+
+  void sift_down(uint32_t i);
+};
+
+class SketchStat {
+ public:
+  /**
+   * @param time_window the window of the per-window object count, it uses
+   * the same windows as ReqRate
+   * @param top_k the number of popular objects tracked by SpaceSaving
+   * @param cms_entries the number of counters per row of the count-min sketch
+   */
+  SketchStat(int time_window, int top_k, uint64_t cms_entries)
+      : time_window_(time_window), top_k_(top_k), cms_entries_(cms_entries) {
+    if (blocked_cms_init(&cms_, cms_entries) != 0) {
+      ERROR("cannot allocate count-min sketch of %lu entries\n",
+            (unsigned long)cms_entries);
+      abort();
+    }
+    freq_hist_.resize(BLOCKED_CMS_MAX_COUNT + 1, 0);
+  };
+
+  ~SketchStat() { blocked_cms_free(&cms_); }
+
+  /* hash is the hash of obj_id, sampled means the object is tracked in the
+   * object map and req->first_seen_in_window is set, return the estimated
+   * frequency of the object before this request, 0 means the object has not
+   * been seen */
+  int add_req(const request_t *req, uint64_t hash, bool sampled);
+
+  double n_obj() const { return hll_.estimate(); }
+
+  /* the largest X that n_obj_of_freq(X) can estimate */
+  static constexpr int max_freq() { return BLOCKED_CMS_MAX_COUNT - 1; }
+
+  /* the number of objects requested freq times */
+  int64_t n_obj_of_freq(int freq) const {
+    return freq > max_freq() ? 0 : MAX(freq_hist_[freq], 0);
+  }
+
+  std::vector<uint32_t> get_top_freq() const {
+    return top_k_.get_sorted_freq();
+  }
+
+  /* the number of objects of each window, the same windows as ReqRate */
+  const std::vector<uint32_t> &get_window_obj_cnt() const {
+    return window_obj_cnt_;
+  }
+
+  /* the unique bytes of each window */
+  const std::vector<uint64_t> &get_window_obj_byte() const {
+    return window_obj_byte_;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const SketchStat &stat) {
+    os << std::fixed << std::setprecision(4)
+       << "sketch: number of objects, obj rate and unique byte rate by "
+          "HyperLogLog (std error "
+       << stat.hll_.std_error() << "), X-hit by count-min sketch ("
+       << stat.cms_entries_ << " entries), popular obj by SpaceSaving (top "
+       << stat.top_k_.k() << ", max error " << stat.top_k_.max_error()
+       << ")\n";
+    return os;
+  }
+
+ private:
+  const int time_window_;
+  int64_t next_window_ts_ = -1;
+
+  HyperLogLog hll_;
+  HyperLogLog window_hll_;
+  std::vector<uint32_t> window_obj_cnt_;
+  /* the sampled objects of the current window and their bytes */
+  uint64_t window_sampled_n_obj_ = 0;
+  uint64_t window_sampled_n_byte_ = 0;
+  std::vector<uint64_t> window_obj_byte_;
+
+  SpaceSaving top_k_;
+
+  uint64_t cms_entries_;
+  struct blocked_cms cms_;
+  /* freq_hist_[X] is the number of objects whose estimated frequency is X,
+   * the last one is the objects of saturated counters */
+  std::vector<int64_t> freq_hist_;
+};
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,267 @@
+#include "stackDist.h"
+
+#include <array>
+#include <iomanip>
+#include <sstream>
+
+#include "../include/libCacheSim/macro.h"
+
+namespace traceAnalyzer {
+using namespace std;
+
+/* the initial number of slots in the Fenwick tree */
+static constexpr uint32_t init_n_slot = 1u << 16;
+
+StackDist::StackDist(string &output_path, int time_window, double scale,
+                     bool binary_output)
+    : time_window_(time_window), scale_(scale) {
+  tree_.resize(init_n_slot, {0, 0});
+
+  if (time_window_ > 0) {
+    stringstream desc;
+    desc << "stack distance (obj) distribution per window (log base "
+         << log_base_ << ", time window " << time_window_ << ")";
+    stream_dump_ofs_.open<uint32_t>(
+        output_path + ".stackDistWindow_w" + to_string(time_window_),
+        output_path, desc.str(), time_window_, binary_output);
+  }
+}
+
+void StackDist::add_req(const request_t *req) {
+  if (unlikely(next_window_ts_ == -1)) {
+    /* the clock time starts from 0, the module may not see the first request
+     * when it only sees sampled objects (sketch mode) */
+    next_window_ts_ = time_window_;
+  }
+
+  if (time_window_ > 0) {
+    while (req->clock_time >= next_window_ts_) {
+      stream_dump_window();
+      window_pos_cnt_.clear();
+      next_window_ts_ += time_window_;
+    }
+  }
+
+  obj_size_t obj_size = (obj_size_t)req->obj_size;
+  n_req_ += 1;
+  n_req_byte_ += obj_size;
+
+  if (n_used_slot_ == tree_.size()) {
+    compact();
+  }
+
+  auto it = slot_map_.find(req->obj_id);
+  if (it == slot_map_.end()) {
+    n_cold_req_ += 1;
+    n_cold_byte_ += obj_size;
+    n_obj_ += 1;
+    n_byte_ += obj_size;
+    slot_map_.emplace(req->obj_id, slot_info{n_used_slot_, obj_size});
+  } else {
+    /* the objects and bytes after the slot of the object */
+    int64_t n_obj_before, n_byte_before;
+    tree_prefix(it->second.slot + 1, &n_obj_before, &n_byte_before);
+    uint64_t obj_pos = (uint64_t)(n_obj_ - n_obj_before) + 1;
+    uint64_t byte_pos = (uint64_t)(n_byte_ - n_byte_before) + obj_size;
+    if (scale_ != 1.0) {
+      obj_pos = (uint64_t)llround((double)obj_pos * scale_);
+      byte_pos = (uint64_t)llround((double)byte_pos * scale_);
+    }
+
+    tree_add(it->second.slot, -1, -(int64_t)it->second.obj_size);
+    n_byte_ += (int64_t)obj_size - (int64_t)it->second.obj_size;
+    it->second = slot_info{n_used_slot_, obj_size};
+
+    add_pos(obj_pos_hist_, obj_pos, obj_size);
+    add_pos(byte_pos_hist_, byte_pos, obj_size);
+
+    if (time_window_ > 0) {
+      int pos = (int)(log((double)obj_pos) / log_log_base_);
+      if (pos >= (int)window_pos_cnt_.size()) {
+        window_pos_cnt_.resize(pos + 1, 0);
+      }
+      window_pos_cnt_[pos] += 1;
+    }
+  }
+
+  tree_add(n_used_slot_, 1, obj_size);
+  n_used_slot_ += 1;
+}
+
+void StackDist::compact() {
+  size_t n_slot = tree_.size();
+
+  /* the slot values from the Fenwick tree, the reverse of the build */
+  for (int64_t i = (int64_t)n_slot - 1; i >= 0; i--) {
+    size_t j = (size_t)i | ((size_t)i + 1);
+    if (j < n_slot) {
+      tree_[j].n_obj -= tree_[i].n_obj;
+      tree_[j].n_byte -= tree_[i].n_byte;
+    }
+  }
+
+  std::vector<uint32_t> new_slot(n_slot);
+  uint32_t n_live = 0;
+  for (size_t i = 0; i < n_slot; i++) {
+    if (tree_[i].n_obj > 0) {
+      new_slot[i] = n_live;
+      tree_[n_live++] = tree_[i];
+    }
+  }
+  for (auto &p : slot_map_) {
+    p.second.slot = new_slot[p.second.slot];
+  }
+
+  while (n_live > n_slot / 2) {
+    n_slot *= 2;
+  }
+  tree_.resize(n_slot);
+  std::fill(tree_.begin() + n_live, tree_.end(), tree_node{0, 0});
+  n_used_slot_ = n_live;
+
+  /* build the Fenwick tree in linear time */
+  for (size_t i = 0; i < n_slot; i++) {
+    size_t j = i | (i + 1);
+    if (j < n_slot) {
+      tree_[j].n_obj += tree_[i].n_obj;
+      tree_[j].n_byte += tree_[i].n_byte;
+    }
+  }
+}
+
+void StackDist::add_pos(vector<struct pos_bucket> &hist, uint64_t pos,
+                        int64_t obj_size) {
+  int bucket = pos_to_bucket(pos);
+  if (bucket >= (int)hist.size()) hist.resize(bucket + 1);
+  hist[bucket].n_req += 1;
+  hist[bucket].n_byte += obj_size;
+}
+
+void StackDist::stream_dump_window() {
+  stream_dump_ofs_.write_row(window_pos_cnt_);
+}
+
+vector<array<double, 3>> StackDist::compute_mrc(
+    const vector<struct pos_bucket> &hist) const {
+  /* the requests and bytes in and after each bucket */
+  vector<struct pos_bucket> suffix(hist.size() + 1);
+  for (int64_t i = (int64_t)hist.size() - 1; i >= 0; i--) {
+    suffix[i].n_req = suffix[i + 1].n_req + hist[i].n_req;
+    suffix[i].n_byte = suffix[i + 1].n_byte + hist[i].n_byte;
+  }
+
+  vector<array<double, 3>> mrc;
+  for (size_t i = 1; i < suffix.size(); i++) {
+    double cache_size = (double)(bucket_lower((int)i) - 1);
+    mrc.push_back(
+        {cache_size,
+         (double)(n_cold_req_ + suffix[i].n_req) / (double)n_req_,
+         (double)(n_cold_byte_ + suffix[i].n_byte) / (double)n_req_byte_});
+  }
+  return mrc;
+}
+
+void StackDist::dump(string &path_base) {
+  if (time_window_ > 0) {
+    /* the last window */
+    stream_dump_window();
+    window_pos_cnt_.clear();
+    stream_dump_ofs_.close();
+  }
+
+  if (n_req_ == 0) return;
+
+  ofstream ofs(path_base + ".stackDist", ios::out | ios::trunc);
+  ofs << "# " << path_base << "\n";
+  ofs << "# cold miss (req/byte): " << n_cold_req_ << "/" << n_cold_byte_
+      << "\n";
+
+  for (int is_byte = 0; is_byte < 2; is_byte++) {
+    const auto &hist = is_byte ? byte_pos_hist_ : obj_pos_hist_;
+    const char *unit = is_byte ? "byte" : "obj";
+
+    ofs << "# stack distance (" << unit
+        << ") histogram: position (lower bound), req_cnt, byte_cnt\n";
+    for (size_t i = 0; i < hist.size(); i++) {
+      if (hist[i].n_req == 0) continue;
+      ofs << bucket_lower((int)i) << "," << hist[i].n_req << ","
+          << hist[i].n_byte << "\n";
+    }
+
+    ofs << "# LRU miss ratio curve: cache size (" << unit
+        << "), miss ratio, byte miss ratio\n"
+        << fixed << setprecision(6);
+    for (const auto &p : compute_mrc(hist)) {
+      ofs << (uint64_t)p[0] << "," << p[1] << "," << p[2] << "\n";
+    }
+    ofs << defaultfloat;
+  }
+
+  ofs.close();
+}
+
+ostream &operator<<(ostream &os, const StackDist &stat) {
+  if (stat.n_req_ == 0) return os;
+
+  auto miss_ratio_at = [&stat](const vector<struct StackDist::pos_bucket> &hist,
+                               double cache_size, bool byte) {
+    /* a request misses if its position is larger than the cache size, the
+     * positions in a bucket are counted as the lower bound */
+    uint64_t n_miss = byte ? stat.n_cold_byte_ : stat.n_cold_req_;
+    for (size_t i = 0; i < hist.size(); i++) {
+      if ((double)StackDist::bucket_lower((int)i) > cache_size) {
+        n_miss += byte ? hist[i].n_byte : hist[i].n_req;
+      }
+    }
+    return (double)n_miss / (double)(byte ? stat.n_req_byte_ : stat.n_req_);
+  };
+
+  double n_obj = (double)stat.n_obj_ * stat.scale_;
+  double n_byte = (double)stat.n_byte_ * stat.scale_;
+  os << fixed << setprecision(4)
+     << "LRU miss ratio (cache size in obj/byte) at 0.1%, 1%, 10% of the "
+        "working set: ";
+  for (double r : {0.001, 0.01, 0.1}) {
+    os << miss_ratio_at(stat.obj_pos_hist_, n_obj * r, false) << "/"
+       << miss_ratio_at(stat.byte_pos_hist_, n_byte * r, true) << ", ";
+  }
+  os << "\n";
+
+  return os;
+}
+
+void StackDist::save(CheckpointWriter &ckpt) {
+  ckpt.put(next_window_ts_);
+  ckpt.put(slot_map_);
+  ckpt.put(tree_);
+  ckpt.put(n_used_slot_);
+  ckpt.put(n_obj_);
+  ckpt.put(n_byte_);
+  ckpt.put(n_req_);
+  ckpt.put(n_req_byte_);
+  ckpt.put(n_cold_req_);
+  ckpt.put(n_cold_byte_);
+  ckpt.put(obj_pos_hist_);
+  ckpt.put(byte_pos_hist_);
+  ckpt.put(window_pos_cnt_);
+  stream_dump_ofs_.save(ckpt);
+}
+
+void StackDist::load(CheckpointReader &ckpt) {
+  ckpt.get(next_window_ts_);
+  ckpt.get(slot_map_);
+  ckpt.get(tree_);
+  ckpt.get(n_used_slot_);
+  ckpt.get(n_obj_);
+  ckpt.get(n_byte_);
+  ckpt.get(n_req_);
+  ckpt.get(n_req_byte_);
+  ckpt.get(n_cold_req_);
+  ckpt.get(n_cold_byte_);
+  ckpt.get(obj_pos_hist_);
+  ckpt.get(byte_pos_hist_);
+  ckpt.get(window_pos_cnt_);
+  stream_dump_ofs_.load(ckpt);
+}
+
+}  // namespace traceAnalyzer
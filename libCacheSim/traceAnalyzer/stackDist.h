@@ -0,0 +1,143 @@
+#pragma once
+/**
+ * the stack distance (LRU stack position) of each request in one pass, and
+ * the LRU miss ratio curve in objects and bytes derived from it
+ *
+ * the position of a request is one plus the number of distinct objects
+ * (bytes) requested since the last request to the object, an LRU cache of
+ * C objects (bytes) hits the request if C >= position.
+ * Each object is a slot ordered by the last access, a Fenwick tree over the
+ * slots counts the objects and bytes after a slot in O(log N). The slot of
+ * an object moves to the end at each access, when the slots are used up, the
+ * live slots are compacted to the front, the tree has at most twice as many
+ * slots as the objects
+ *
+ * the positions are kept in histograms with 16 buckets per power of two,
+ * the miss ratio curve is exact at the bucket boundaries, and the position
+ * of the requests in each time window is streamed with log base 1.5 buckets
+ */
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/libCacheSim/request.h"
+#include "struct.h"
+#include "windowStream.h"
+
+namespace traceAnalyzer {
+
+class StackDist {
+ public:
+  /**
+   * @param time_window the window of the per-window distribution
+   * @param scale the objects are a sample of the trace (sketch mode), the
+   * positions are multiplied by scale
+   * @param binary_output write the per-window distribution in the binary
+   * format, see windowStream.h
+   */
+  StackDist(std::string &output_path, int time_window, double scale = 1.0,
+            bool binary_output = false);
+
+  void add_req(const request_t *req);
+
+  void dump(std::string &path_base);
+
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter &ckpt);
+
+  void load(CheckpointReader &ckpt);
+
+  friend std::ostream &operator<<(std::ostream &os, const StackDist &stat);
+
+ private:
+  struct pos_bucket {
+    /* the number and the bytes of the requests */
+    uint64_t n_req = 0;
+    uint64_t n_byte = 0;
+  };
+
+  struct tree_node {
+    int64_t n_byte;
+    int32_t n_obj;
+  };
+
+  struct slot_info {
+    uint32_t slot;
+    obj_size_t obj_size;
+  };
+
+  static inline int pos_to_bucket(uint64_t pos) {
+    if (pos < 32) return (int)pos;
+    int e = 63 - __builtin_clzll(pos);
+    return 32 + (e - 5) * 16 + (int)((pos >> (e - 4)) & 15);
+  }
+
+  static inline uint64_t bucket_lower(int bucket) {
+    if (bucket < 32) return bucket;
+    int e = (bucket - 32) / 16 + 5;
+    return (uint64_t)(16 + (bucket - 32) % 16) << (e - 4);
+  }
+
+  /* add to the slot in the Fenwick tree */
+  inline void tree_add(uint32_t slot, int32_t n_obj, int64_t n_byte) {
+    for (uint32_t i = slot + 1; i <= tree_.size(); i += i & (-i)) {
+      tree_[i - 1].n_obj += n_obj;
+      tree_[i - 1].n_byte += n_byte;
+    }
+  }
+
+  /* the number of objects and bytes in the slots before slot */
+  inline void tree_prefix(uint32_t slot, int64_t *n_obj,
+                          int64_t *n_byte) const {
+    *n_obj = 0, *n_byte = 0;
+    for (uint32_t i = slot; i > 0; i -= i & (-i)) {
+      *n_obj += tree_[i - 1].n_obj;
+      *n_byte += tree_[i - 1].n_byte;
+    }
+  }
+
+  /* move the live slots to the front, and grow the tree if more than half of
+   * the slots are live */
+  void compact();
+
+  /* the miss ratio and byte miss ratio at the bucket boundaries */
+  std::vector<std::array<double, 3>> compute_mrc(
+      const std::vector<struct pos_bucket> &hist) const;
+
+  static void add_pos(std::vector<struct pos_bucket> &hist, uint64_t pos,
+                      int64_t obj_size);
+
+  void stream_dump_window();
+
+  const int time_window_;
+  const double scale_;
+  const double log_base_ = 1.5;
+  const double log_log_base_ = log(log_base_);
+  int64_t next_window_ts_ = -1;
+
+  robin_hood::unordered_flat_map<obj_id_t, struct slot_info> slot_map_;
+  std::vector<struct tree_node> tree_;
+  uint32_t n_used_slot_ = 0;
+  int64_t n_obj_ = 0;
+  int64_t n_byte_ = 0;
+
+  /* the requests and bytes of the whole trace, the first request to an
+   * object (cold miss) is not in the histograms */
+  uint64_t n_req_ = 0;
+  uint64_t n_req_byte_ = 0;
+  uint64_t n_cold_req_ = 0;
+  uint64_t n_cold_byte_ = 0;
+  /* indexed by the position in objects and in bytes */
+  std::vector<struct pos_bucket> obj_pos_hist_;
+  std::vector<struct pos_bucket> byte_pos_hist_;
+
+  std::vector<uint32_t> window_pos_cnt_;
+  WindowStream stream_dump_ofs_;
+};
+
+}  // namespace traceAnalyzer
@@ -44,4 +44,14 @@ void TtlStat::dump(const string &path_base) {
   }
   ofs.close();
 }
+
+void TtlStat::save(CheckpointWriter &ckpt) {
+  ckpt.put(ttl_cnt_);
+  ckpt.put(too_many_ttl_);
+}
+
+void TtlStat::load(CheckpointReader &ckpt) {
+  ckpt.get(ttl_cnt_);
+  ckpt.get(too_many_ttl_);
+}
 };  // namespace traceAnalyzer
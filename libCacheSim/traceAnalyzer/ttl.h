@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
 
 namespace traceAnalyzer {
 
@@ -48,6 +49,11 @@ class TtlStat {
 
   void dump(const std::string& filename);
 
+  /* save and load the state in a checkpoint, see checkpoint.h */
+  void save(CheckpointWriter& ckpt);
+
+  void load(CheckpointReader& ckpt);
+
  private:
   /* the number of requests have ttl value */
   std::unordered_map<int32_t, uint32_t> ttl_cnt_{};
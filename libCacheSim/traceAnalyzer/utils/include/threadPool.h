@@ -26,6 +26,9 @@ class ThreadPool {
   void wait_for_finish();
 
   int n_set_thread_;
+  /* when the number of threads is not set, one thread per core is started
+   * and a job waits while the load is higher than the cores */
+  const bool throttle_on_load_;
 
  private:
   std::queue<std::function<void()>> job_queue;
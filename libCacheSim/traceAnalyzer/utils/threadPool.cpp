@@ -2,7 +2,8 @@
 #include "include/threadPool.h"
 #include "include/utilsSys.h"
 
-utilsSys::ThreadPool::ThreadPool(int n_thread) : n_set_thread_(n_thread) {
+utilsSys::ThreadPool::ThreadPool(int n_thread)
+    : n_set_thread_(n_thread), throttle_on_load_(n_thread == -1) {
   if (n_set_thread_ == -1) {
     n_set_thread_ = get_n_cores();
   }
@@ -33,20 +34,24 @@ void utilsSys::ThreadPool::shutdown() {
 
 void utilsSys::ThreadPool::wait_job() {
   while (true) {
-    std::unique_lock<std::mutex> lock(mtx_);
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
 
-    cond_.wait(lock, [this](){
-      return !job_queue.empty() || stopped_;
-    });
+      cond_.wait(lock, [this](){
+        return !job_queue.empty() || stopped_;
+      });
 
-    if (stopped_)
-      return;
+      if (stopped_)
+        return;
 
-    auto job = job_queue.front();
-    n_running_jobs.fetch_add(1);
-    job_queue.pop();
+      job = job_queue.front();
+      n_running_jobs.fetch_add(1);
+      job_queue.pop();
+    }
+    /* the job runs without the lock so that the threads run in parallel */
 
-    while (n_set_thread_ == -1 && get_n_available_cores() <= 1) {
+    while (throttle_on_load_ && get_n_available_cores() <= 1) {
       /* only run when the load is not more than cores */
       printf("throttle due to high load\n");
       std::this_thread::sleep_for(std::chrono::seconds (8));
@@ -1,6 +1,9 @@
 
-#include "utilsSys.h"
-#include "logging.h"
+#include "include/utilsSys.h"
+
+#include <unistd.h>
+
+#include "../../include/libCacheSim/logging.h"
 #include <thread>
 #include <iostream>
 #include <fstream>
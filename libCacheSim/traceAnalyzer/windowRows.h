@@ -0,0 +1,107 @@
+#pragma once
+/**
+ * the per-window vectors (one row per time window) of a module that counts
+ * one shard of the objects in the parallel analysis,
+ * the rows of all shards are summed and streamed in order once no shard can
+ * add to them, see analyzerParallel.cpp
+ *
+ * a module running on one thread grows a row to pos + grow_len when a request
+ * counts at pos beyond the row, so the length of a row depends on the order
+ * of the requests. A row only grows at a request whose pos is larger than
+ * all requests before it, and such a request is also larger than the requests
+ * before it in its shard, so each shard keeps the (vtime, pos) of these
+ * requests, and the merged row replays them in vtime order
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "windowStream.h"
+
+namespace traceAnalyzer {
+
+template <typename T>
+class WindowRows {
+ public:
+  /**
+   * @param init_len the length of a new row, nullptr means an empty row
+   * @param grow_len the row grows to pos + grow_len, see incr
+   */
+  explicit WindowRows(size_t (*init_len)(int64_t row) = nullptr,
+                      int grow_len = 1)
+      : init_len_(init_len), grow_len_(grow_len){};
+
+  /* a row that has been merged or dumped can only be requested by an
+   * out-of-order request, it is counted in the first row kept */
+  std::vector<T> &at(int64_t row) { return get_row(row).cnt; }
+
+  /* add v at pos of the row, vtime is the order of the request in the trace,
+   * a v of 0 still grows the row */
+  void incr(int64_t row, int pos, int64_t vtime, T v) {
+    struct window_row &r = get_row(row);
+    if (r.grow.empty() || pos > r.grow.back().second) {
+      r.grow.emplace_back(vtime, pos);
+    }
+    if (pos >= (int)r.cnt.size()) r.cnt.resize(pos + 1, 0);
+    r.cnt[pos] += v;
+  }
+
+  /* add the rows of shard before until_row to this, and drop them in shard */
+  void merge(WindowRows &shard, int64_t until_row) {
+    while (shard.first_row_ < until_row && !shard.rows_.empty()) {
+      struct window_row &src = shard.rows_.front();
+      struct window_row &dst = get_row(shard.first_row_);
+      if (dst.cnt.size() < src.cnt.size()) dst.cnt.resize(src.cnt.size(), 0);
+      for (size_t i = 0; i < src.cnt.size(); i++) dst.cnt[i] += src.cnt[i];
+      dst.grow.insert(dst.grow.end(), src.grow.begin(), src.grow.end());
+      shard.rows_.pop_front();
+      shard.first_row_ += 1;
+    }
+    if (shard.first_row_ < until_row) shard.first_row_ = until_row;
+  }
+
+  /* write the rows before until_row in the same format as the stream dump of
+   * the modules, and drop them */
+  void stream_dump(WindowStream &ofs, int64_t until_row) {
+    while (first_row_ < until_row) {
+      struct window_row &r = get_row(first_row_);
+      size_t len = init_len_ == nullptr ? 0 : init_len_(first_row_);
+      std::sort(r.grow.begin(), r.grow.end());
+      for (const auto &g : r.grow) {
+        if (g.second >= (int)len) len = g.second + grow_len_;
+      }
+      r.cnt.resize(std::max(len, r.cnt.size()), 0);
+
+      ofs.write_row(r.cnt);
+      rows_.pop_front();
+      first_row_ += 1;
+    }
+  }
+
+ private:
+  struct window_row {
+    std::vector<T> cnt;
+    /* (vtime, pos) of the requests that may grow the row */
+    std::vector<std::pair<int64_t, int>> grow;
+  };
+
+  struct window_row &get_row(int64_t row) {
+    if (row < first_row_) row = first_row_;
+    while (first_row_ + (int64_t)rows_.size() <= row) {
+      int64_t r = first_row_ + (int64_t)rows_.size();
+      rows_.emplace_back();
+      rows_.back().cnt.resize(init_len_ == nullptr ? 0 : init_len_(r), 0);
+    }
+    return rows_[row - first_row_];
+  }
+
+  size_t (*init_len_)(int64_t row);
+  int grow_len_;
+  int64_t first_row_ = 0;
+  std::deque<struct window_row> rows_;
+};
+
+}  // namespace traceAnalyzer
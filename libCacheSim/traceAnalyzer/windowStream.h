@@ -0,0 +1,250 @@
+#pragma once
+/**
+ * the output of the per-window rows (one row per time window) of the size,
+ * reuse and popularityDecay heatmaps, the rows are written through a large
+ * buffer instead of formatting each value with operator<<
+ *
+ * the text format is two comment lines (the trace and the description of the
+ * rows) followed by one line of comma-separated values per window,
+ * the binary format (path + ".bin") can be loaded with numpy
+ * (scripts/utils/data_utils.py), it has
+ *    1. a header (struct window_stream_header, 256 bytes)
+ *    2. the values of all rows, n_value of dtype
+ *    3. the length of each row, n_row uint32_t
+ * the rows are the same as the text format, n_row and n_value are written
+ * when the stream is closed
+ *
+ * the file is created at the first flush, so a stream loaded from a
+ * checkpoint continues the file written before the checkpoint
+ */
+
+#include <cassert>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+namespace traceAnalyzer {
+
+#define WINDOW_STREAM_MAGIC "LCSWIND"
+#define WINDOW_STREAM_VERSION 1
+
+struct window_stream_header {
+  char magic[8];
+  uint32_t version;
+  /* the numpy dtype of the values, e.g., "<u4" */
+  char dtype[4];
+  uint64_t n_row;
+  uint64_t n_value;
+  int64_t time_window;
+  /* the same as the description line of the text format */
+  char desc[216];
+};
+static_assert(sizeof(struct window_stream_header) == 256,
+              "window_stream_header size changed");
+
+class WindowStream {
+ public:
+  WindowStream() = default;
+
+  ~WindowStream() { close(); }
+
+  WindowStream(const WindowStream &) = delete;
+  WindowStream &operator=(const WindowStream &) = delete;
+
+  /**
+   * @param path the text output, the binary output is path + ".bin"
+   * @param path_base the output path of the analyzer, written in the header
+   * @param desc the description of the rows
+   * @param time_window the time window of a row
+   * @param binary write the binary format
+   */
+  template <typename T>
+  void open(const std::string &path, const std::string &path_base,
+            const std::string &desc, int time_window, bool binary);
+
+  template <typename T>
+  void write_row(const std::vector<T> &row);
+
+  void close();
+
+  /* flush the rows written so far and save the position in the file */
+  void save(CheckpointWriter &ckpt);
+
+  /* continue the file from the position saved in the checkpoint, the rows
+   * written after the checkpoint are dropped */
+  void load(CheckpointReader &ckpt);
+
+ private:
+  static constexpr size_t buf_size_ = 4 * 1024 * 1024;
+
+  void open_file();
+
+  void flush() {
+    if (!ofs_.is_open()) open_file();
+    ofs_.write(buf_.get(), (std::streamsize)buf_len_);
+    buf_len_ = 0;
+  }
+
+  inline void append(const char *data, size_t len) {
+    if (buf_len_ + len > buf_size_) {
+      flush();
+      if (len > buf_size_) {
+        ofs_.write(data, (std::streamsize)len);
+        return;
+      }
+    }
+    memcpy(buf_.get() + buf_len_, data, len);
+    buf_len_ += len;
+  }
+
+  std::ofstream ofs_;
+  /* the stream is open, the file is created at the first flush */
+  bool active_ = false;
+  std::string file_path_;
+  /* the file length when loaded from a checkpoint, -1 creates a new file */
+  int64_t resume_offset_ = -1;
+  bool binary_ = false;
+  size_t value_size_ = 0;
+
+  std::unique_ptr<char[]> buf_;
+  size_t buf_len_ = 0;
+
+  struct window_stream_header header_ {};
+  std::vector<uint32_t> row_len_;
+};
+
+template <typename T>
+void WindowStream::open(const std::string &path, const std::string &path_base,
+                        const std::string &desc, int time_window,
+                        bool binary) {
+  static_assert(std::is_integral<T>::value && sizeof(T) <= 8,
+                "window rows are integers");
+  assert(!active_);
+
+  active_ = true;
+  resume_offset_ = -1;
+  binary_ = binary;
+  value_size_ = sizeof(T);
+  buf_.reset(new char[buf_size_]);
+  buf_len_ = 0;
+
+  if (!binary_) {
+    file_path_ = path;
+    std::string header = "# " + path_base + "\n# " + desc + "\n";
+    append(header.data(), header.size());
+    return;
+  }
+
+  file_path_ = path + ".bin";
+  memset(&header_, 0, sizeof(header_));
+  memcpy(header_.magic, WINDOW_STREAM_MAGIC, sizeof(WINDOW_STREAM_MAGIC));
+  header_.version = WINDOW_STREAM_VERSION;
+  header_.dtype[0] = '<';
+  header_.dtype[1] = std::is_signed<T>::value ? 'i' : 'u';
+  header_.dtype[2] = (char)('0' + sizeof(T));
+  header_.time_window = time_window;
+  strncpy(header_.desc, desc.c_str(), sizeof(header_.desc) - 1);
+  /* the header is rewritten with n_row and n_value at close */
+  append(reinterpret_cast<const char *>(&header_), sizeof(header_));
+}
+
+template <typename T>
+void WindowStream::write_row(const std::vector<T> &row) {
+  assert(sizeof(T) == value_size_);
+  if (!active_) return;
+
+  if (binary_) {
+    append(reinterpret_cast<const char *>(row.data()), row.size() * sizeof(T));
+    row_len_.push_back((uint32_t)row.size());
+    header_.n_row += 1;
+    header_.n_value += row.size();
+    return;
+  }
+
+  /* a value and the comma */
+  constexpr size_t max_len = 21;
+  for (const auto &v : row) {
+    if (buf_len_ + max_len > buf_size_) flush();
+    char *p = buf_.get() + buf_len_;
+    p = std::to_chars(p, p + max_len, v).ptr;
+    *p++ = ',';
+    buf_len_ = p - buf_.get();
+  }
+  append("\n", 1);
+}
+
+inline void WindowStream::open_file() {
+  if (resume_offset_ < 0) {
+    ofs_.open(file_path_, binary_ ? std::ios::out | std::ios::trunc |
+                                        std::ios::binary
+                                  : std::ios::out | std::ios::trunc);
+  } else {
+    if (truncate(file_path_.c_str(), (off_t)resume_offset_) != 0) {
+      ERROR("cannot truncate %s to the checkpoint\n", file_path_.c_str());
+    }
+    ofs_.open(file_path_, std::ios::in | std::ios::out | std::ios::binary);
+    ofs_.seekp(resume_offset_);
+  }
+}
+
+inline void WindowStream::close() {
+  if (!active_) return;
+
+  if (binary_) {
+    append(reinterpret_cast<const char *>(row_len_.data()),
+           row_len_.size() * sizeof(uint32_t));
+  }
+  flush();
+
+  if (binary_) {
+    ofs_.seekp(0);
+    ofs_.write(reinterpret_cast<const char *>(&header_), sizeof(header_));
+  }
+  ofs_.close();
+  active_ = false;
+  buf_.reset();
+  row_len_.clear();
+}
+
+inline void WindowStream::save(CheckpointWriter &ckpt) {
+  int64_t offset = -1;
+  if (active_) {
+    flush();
+    ofs_.flush();
+    offset = (int64_t)ofs_.tellp();
+  }
+
+  ckpt.put(active_);
+  ckpt.put(file_path_);
+  ckpt.put(offset);
+  ckpt.put(binary_);
+  ckpt.put(value_size_);
+  ckpt.put(header_);
+  ckpt.put(row_len_);
+}
+
+inline void WindowStream::load(CheckpointReader &ckpt) {
+  if (ofs_.is_open()) ofs_.close();
+  buf_len_ = 0;
+
+  ckpt.get(active_);
+  ckpt.get(file_path_);
+  ckpt.get(resume_offset_);
+  ckpt.get(binary_);
+  ckpt.get(value_size_);
+  ckpt.get(header_);
+  ckpt.get(row_len_);
+
+  if (active_ && !buf_) buf_.reset(new char[buf_size_]);
+}
+
+}  // namespace traceAnalyzer
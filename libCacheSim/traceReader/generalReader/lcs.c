@@ -81,6 +81,7 @@ int LCSReader_setup(reader_t *reader) {
   reader->init_params.binary_fmt_str = strdup(header->format);
   reader->init_params.trace_start_offset = sizeof(lcs_trace_header_t);
   reader->trace_start_offset = sizeof(lcs_trace_header_t);
+  reader->n_total_obj = header->n_obj;
 
   binaryReader_setup(reader);
 
@@ -0,0 +1,256 @@
+//
+//  compute the next access vtime of each request in memory,
+//  it replaces converting the trace to oracleGeneral format before running
+//  algorithms that need the future
+//
+//  1. a forward pass maps each obj_id to a dense id and stores the dense id
+//     of each request (4 bytes per request)
+//  2. a backward pass over the dense ids keeps the last seen position of
+//     each dense id in an array, and replaces the dense id of each request
+//     with the distance to its next access in place
+//
+//  when the dense ids do not fit in the memory budget, they are written to a
+//  sidecar file, and the backward pass reads, transforms and writes back one
+//  chunk at a time, starting from the end of the file, the sidecar is then
+//  mmapped for reading forward. The sidecar is created next to the trace, or
+//  in $TMPDIR (/tmp if not set) when the trace directory is not writable
+//
+//  the memory budget covers the dense ids and the per-object memory, which is
+//  the obj_map entry in the forward pass and the last seen position in the
+//  backward pass, estimated as NEXT_ACCESS_OBJ_MEM_SIZE bytes per object
+//
+//  nextAccess.c
+//  libCacheSim
+//
+
+#include "../include/libCacheSim/nextAccess.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NEXT_ACCESS_MIN_BUF_SIZE (1L << 12)
+/* an obj_map entry (hash, key, value and the free slots of the table), the
+ * last seen position uses less and is allocated after obj_map is freed */
+#define NEXT_ACCESS_OBJ_MEM_SIZE 48
+
+static void _pwrite_all(int fd, const void *buf, size_t size, off_t offset) {
+  const char *p = buf;
+  while (size > 0) {
+    ssize_t n = pwrite(fd, p, size, offset);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ERROR("cannot write next access sidecar: %s\n", strerror(errno));
+      abort();
+    }
+    p += n;
+    size -= n;
+    offset += n;
+  }
+}
+
+static void _pread_all(int fd, void *buf, size_t size, off_t offset) {
+  char *p = buf;
+  while (size > 0) {
+    ssize_t n = pread(fd, p, size, offset);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) continue;
+      ERROR("cannot read next access sidecar: %s\n",
+            n == 0 ? "unexpected end of file" : strerror(errno));
+      abort();
+    }
+    p += n;
+    size -= n;
+    offset += n;
+  }
+}
+
+static int _open_sidecar(const reader_t *reader) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s.nextAccess.%d", reader->trace_path,
+           (int)getpid());
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    /* the trace directory may be read-only, use the tmp directory */
+    const char *tmp_dir = getenv("TMPDIR");
+    if (tmp_dir == NULL || tmp_dir[0] == '\0') tmp_dir = "/tmp";
+    const char *trace_name = strrchr(reader->trace_path, '/');
+    trace_name = trace_name == NULL ? reader->trace_path : trace_name + 1;
+    WARN("cannot create next access sidecar %s: %s, use %s\n", path,
+         strerror(errno), tmp_dir);
+    snprintf(path, sizeof(path), "%s/%s.nextAccess.%d", tmp_dir, trace_name,
+             (int)getpid());
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  }
+  if (fd < 0) {
+    ERROR("cannot create next access sidecar %s: %s\n", path,
+          strerror(errno));
+    abort();
+  }
+  /* the file stays accessible through fd and the mapping */
+  unlink(path);
+  INFO("%s: next access does not fit in memory, spill to %s\n",
+       reader->trace_path, path);
+
+  return fd;
+}
+
+/* the last seen position is replaced, and the dense id becomes the distance */
+static inline void _dense_id_to_dist(uint32_t *buf, int64_t start, int64_t end,
+                                     int64_t *last_seen) {
+  for (int64_t i = end - 1; i >= start; i--) {
+    uint32_t *p = &buf[i - start];
+    int64_t next = last_seen[*p];
+    last_seen[*p] = i;
+    if (next == -1) {
+      *p = NEXT_ACCESS_NONE;
+    } else if (next - i >= NEXT_ACCESS_NONE) {
+      *p = NEXT_ACCESS_NONE - 1;
+    } else {
+      *p = (uint32_t)(next - i);
+    }
+  }
+}
+
+next_access_oracle_t *create_next_access_oracle(reader_t *reader,
+                                                int64_t mem_limit_byte) {
+  if (mem_limit_byte <= 0) mem_limit_byte = NEXT_ACCESS_DEFAULT_MEM_LIMIT;
+  int64_t max_buf_size = mem_limit_byte / (int64_t)sizeof(uint32_t);
+  if (max_buf_size < NEXT_ACCESS_MIN_BUF_SIZE) {
+    max_buf_size = NEXT_ACCESS_MIN_BUF_SIZE;
+  }
+
+  int64_t buf_size = NEXT_ACCESS_MIN_BUF_SIZE;
+  if (reader->n_total_req > 0) {
+    buf_size = MIN((int64_t)reader->n_total_req, max_buf_size);
+  }
+  uint32_t *buf = malloc(sizeof(uint32_t) * buf_size);
+
+  /* forward pass: obj_id -> dense id + 1 */
+  GHashTable *obj_map = g_hash_table_new(g_direct_hash, g_direct_equal);
+  int64_t n_req = 0, n_obj = 0;
+  /* the position of the first request in buf, it is not 0 after spilling */
+  int64_t buf_start = 0;
+  int fd = -1;
+
+  reset_reader(reader);
+  request_t *req = new_request();
+  while (read_one_req(reader, req) == 0) {
+    gpointer v = g_hash_table_lookup(obj_map, GSIZE_TO_POINTER(req->obj_id));
+    uint32_t id;
+    if (v == NULL) {
+      if (n_obj >= NEXT_ACCESS_NONE) {
+        ERROR("%s: too many objects for next access computation\n",
+              reader->trace_path);
+        abort();
+      }
+      id = (uint32_t)n_obj++;
+      g_hash_table_insert(obj_map, GSIZE_TO_POINTER(req->obj_id),
+                          GSIZE_TO_POINTER((gsize)id + 1));
+    } else {
+      id = (uint32_t)(GPOINTER_TO_SIZE(v) - 1);
+    }
+
+    if (n_req - buf_start == buf_size) {
+      /* the objects seen so far take part of the budget */
+      int64_t obj_mem = n_obj * NEXT_ACCESS_OBJ_MEM_SIZE;
+      int64_t avail_buf_size = MAX(
+          (mem_limit_byte - obj_mem) / (int64_t)sizeof(uint32_t),
+          NEXT_ACCESS_MIN_BUF_SIZE);
+      if (fd == -1 && buf_size < MIN(max_buf_size, avail_buf_size)) {
+        buf_size = MIN(buf_size * 2, MIN(max_buf_size, avail_buf_size));
+        buf = realloc(buf, sizeof(uint32_t) * buf_size);
+      } else {
+        if (fd == -1) fd = _open_sidecar(reader);
+        _pwrite_all(fd, buf, sizeof(uint32_t) * (n_req - buf_start),
+                    (off_t)sizeof(uint32_t) * buf_start);
+        buf_start = n_req;
+      }
+    }
+    buf[n_req - buf_start] = id;
+    n_req += 1;
+  }
+  free_request(req);
+  g_hash_table_destroy(obj_map);
+
+  /* backward pass */
+  int64_t *last_seen = malloc(sizeof(int64_t) * MAX(n_obj, 1));
+  memset(last_seen, 0xff, sizeof(int64_t) * MAX(n_obj, 1));
+
+  next_access_oracle_t *oracle = malloc(sizeof(next_access_oracle_t));
+  oracle->n_req = n_req;
+  oracle->n_obj = n_obj;
+  oracle->mapped_size = 0;
+
+  if (fd == -1) {
+    _dense_id_to_dist(buf, 0, n_req, last_seen);
+    oracle->dist = buf;
+  } else {
+    _pwrite_all(fd, buf, sizeof(uint32_t) * (n_req - buf_start),
+                (off_t)sizeof(uint32_t) * buf_start);
+    for (int64_t end = n_req; end > 0;) {
+      int64_t start = MAX(end - buf_size, 0);
+      size_t size = sizeof(uint32_t) * (end - start);
+      off_t offset = (off_t)sizeof(uint32_t) * start;
+      _pread_all(fd, buf, size, offset);
+      _dense_id_to_dist(buf, start, end, last_seen);
+      _pwrite_all(fd, buf, size, offset);
+      end = start;
+    }
+    free(buf);
+
+    oracle->mapped_size = MAX(sizeof(uint32_t) * n_req, 1);
+    if (n_req == 0) _pwrite_all(fd, "", 1, 0);
+    oracle->dist =
+        mmap(NULL, oracle->mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (oracle->dist == MAP_FAILED) {
+      ERROR("cannot mmap next access sidecar: %s\n", strerror(errno));
+      abort();
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(oracle->dist, oracle->mapped_size, MADV_SEQUENTIAL);
+#endif
+    close(fd);
+  }
+  free(last_seen);
+
+  reset_reader(reader);
+  reader->n_read_req = 0;
+  reader->n_req_left = 0;
+  reader->last_req_clock_time = -1;
+  /* the pass advanced the state of the sampler (e.g., the counter of the
+   * temporal sampler), the replay needs to sample the same requests */
+  if (reader->sampler != NULL) {
+    sampler_t *sampler = reader->sampler->clone(reader->sampler);
+    reader->sampler->free(reader->sampler);
+    reader->sampler = sampler;
+  }
+
+  INFO("%s: computed next access of %ld requests %ld objects%s\n",
+       reader->trace_path, (long)n_req, (long)n_obj,
+       oracle->mapped_size > 0 ? " (sidecar)" : "");
+
+  return oracle;
+}
+
+void free_next_access_oracle(next_access_oracle_t *oracle) {
+  if (oracle->mapped_size > 0) {
+    munmap(oracle->dist, oracle->mapped_size);
+  } else {
+    free(oracle->dist);
+  }
+  free(oracle);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -67,6 +67,7 @@ reader_t *setup_reader(const char *const trace_path,
   reader->trace_format = INVALID_TRACE_FORMAT;
   reader->trace_type = trace_type;
   reader->n_total_req = 0;
+  reader->n_total_obj = 0;
   reader->n_read_req = 0;
   reader->ignore_size_zero_req = true;
   reader->ignore_obj_size = false;
@@ -80,6 +81,8 @@ reader_t *setup_reader(const char *const trace_path,
   reader->read_direction = READ_FORWARD;
   reader->n_req_left = 0;
   reader->last_req_clock_time = -1;
+  reader->next_access = NULL;
+  reader->next_access_idx = 0;
 
   if (init_params != NULL) {
     memcpy(&reader->init_params, init_params, sizeof(reader_init_param_t));
@@ -261,6 +264,12 @@ reader_t *setup_reader(const char *const trace_path,
   }
 
   close(fd);
+
+  if (reader->init_params.compute_next_access) {
+    reader->next_access = create_next_access_oracle(
+        reader, reader->init_params.next_access_mem_limit);
+  }
+
   return reader;
 }
 
@@ -390,7 +399,10 @@ int read_one_req(reader_t *const reader, request_t *const req) {
     /* we use this complex solution rather than simply recursive calls
        because recursive calls can lead to stack overflow */
     sampler_t *sampler = reader->sampler;
+    next_access_oracle_t *next_access = reader->next_access;
     reader->sampler = NULL;
+    /* the skipped requests do not count */
+    reader->next_access = NULL;
     while (!sampler->sample(sampler, req)) {
       VVERBOSE("skip one req: time %lu, obj_id %lu, size %lu at offset %zu\n",
                req->clock_time, req->obj_id, req->obj_size, offset_before_read);
@@ -401,16 +413,25 @@ int read_one_req(reader_t *const reader, request_t *const req) {
       }
       if (status != 0) {
         reader->sampler = sampler;
+        reader->next_access = next_access;
         return status;
       }
     }
     reader->sampler = sampler;
+    reader->next_access = next_access;
   }
 
   if (reader->ignore_obj_size) {
     req->obj_size = 1;
   }
 
+  if (reader->next_access != NULL && status == 0 &&
+      reader->read_direction == READ_FORWARD) {
+    req->next_access_vtime =
+        next_access_oracle_get(reader->next_access, reader->next_access_idx);
+    reader->next_access_idx += 1;
+  }
+
   VVERBOSE("read one req: time %lu, obj_id %lu, size %lu at offset %zu\n",
            req->clock_time, req->obj_id, req->obj_size, offset_before_read);
 
@@ -570,6 +591,7 @@ void reset_reader(reader_t *const reader) {
     reader->mmap_offset = reader->trace_start_offset;
     curr_offset = reader->mmap_offset;
   }
+  reader->next_access_idx = 0;
 
 #ifdef SUPPORT_ZSTD_TRACE
   if (reader->is_zstd_file) {
@@ -601,9 +623,15 @@ uint64_t get_num_of_req(reader_t *const reader) {
 }
 
 reader_t *clone_reader(const reader_t *const reader_in) {
-  reader_t *reader = setup_reader(reader_in->trace_path, reader_in->trace_type,
-                                  &reader_in->init_params);
+  /* the next access is shared, not computed again */
+  reader_init_param_t init_params = reader_in->init_params;
+  init_params.compute_next_access = false;
+  reader_t *reader =
+      setup_reader(reader_in->trace_path, reader_in->trace_type, &init_params);
   reader->n_total_req = reader_in->n_total_req;
+  reader->next_access = reader_in->next_access;
+  reader->init_params.compute_next_access =
+      reader_in->init_params.compute_next_access;
 
   if (reader->trace_format != TXT_TRACE_FORMAT) {
     munmap(reader->mapped_file, reader->file_size);
@@ -653,6 +681,9 @@ int close_reader(reader_t *const reader) {
     if (reader->init_params.sampler != NULL) {
       reader->init_params.sampler->free(reader->init_params.sampler);
     }
+    if (reader->next_access != NULL) {
+      free_next_access_oracle(reader->next_access);
+    }
   }
 
   if (reader->reader_params != NULL) {
@@ -702,19 +733,35 @@ void reader_set_read_pos(reader_t *const reader, double pos) {
 
 void read_first_req(reader_t *reader, request_t *req) {
   uint64_t offset = reader->mmap_offset;
+  /* reset_reader and read_one_req move the index of the next access and the
+   * state of the sampler, which are restored after the read */
+  int64_t next_access_idx = reader->next_access_idx;
+  uint64_t n_read_req = reader->n_read_req;
+  sampler_t *sampler = reader->sampler;
+  reader->sampler = NULL;
   reset_reader(reader);
   read_one_req(reader, req);
   reader->mmap_offset = offset;
+  reader->next_access_idx = next_access_idx;
+  reader->n_read_req = n_read_req;
+  reader->sampler = sampler;
 }
 
 void read_last_req(reader_t *reader, request_t *req) {
   uint64_t offset = reader->mmap_offset;
+  int64_t next_access_idx = reader->next_access_idx;
+  uint64_t n_read_req = reader->n_read_req;
+  sampler_t *sampler = reader->sampler;
+  reader->sampler = NULL;
   reset_reader(reader);
   reader_set_read_pos(reader, 1.0);
   go_back_one_req(reader);
   read_one_req(reader, req);
 
   reader->mmap_offset = offset;
+  reader->next_access_idx = next_access_idx;
+  reader->n_read_req = n_read_req;
+  reader->sampler = sampler;
 }
 
 bool is_str_num(const char *str) {
@@ -4,10 +4,12 @@ this can be used to visualize how objects get accessed
 
 usage: 
 1. run traceAnalyzer: `./traceAnalyzer /path/trace trace_format --common`, 
-this will generate some output, including accessPattern result files, trace.accessRtime and trace.accessVtime
-each records the clock/logical time of sampled objects
+this will generate some output, including the accessPattern result file trace.accessPattern,
+which records the clock and logical time of the accesses to sampled objects
 2. plot access pattern using this script: 
-`python3 access_pattern.py trace.accessRtime`
+`python3 access_pattern.py trace.accessPattern` (clock time)
+`python3 access_pattern.py trace.accessPattern --vtime` (logical time)
+the text files (trace.accessRtime and trace.accessVtime) of older versions are also supported
 
 
 """
@@ -15,6 +17,7 @@ each records the clock/logical time of sampled objects
 import os, sys
 from typing import List, Dict, Tuple
 import logging
+import numpy as np
 import matplotlib.pyplot as plt
 
 sys.path.append(os.path.dirname(os.path.abspath(__file__)) + "/../")
@@ -23,6 +26,22 @@ from utils.plot_utils import FIG_DIR, FIG_TYPE
 
 logger = logging.getLogger("access_pattern")
 
+# the binary format written by libCacheSim/traceAnalyzer/accessPattern.cpp
+ACCESS_PATTERN_MAGIC = b"LCSACCP\x00"
+ACCESS_PATTERN_HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "S8"),
+        ("version", "<u4"),
+        ("sample_ratio", "<u4"),
+        ("n_obj", "<u8"),
+        ("n_access", "<u8"),
+        ("start_rtime", "<i8"),
+    ]
+)
+ACCESS_PATTERN_OBJ_DTYPE = np.dtype(
+    [("obj_id", "<u8"), ("first_access", "<u8"), ("n_access", "<u4"), ("pad", "<u4")]
+)
+
 
 def _get_num_of_lines(datapath):
     """get number of lines in a file"""
@@ -84,14 +103,57 @@ def _load_access_pattern_data(datapath: str, n_obj_to_plot: int) -> List[List[fl
     return access_time_list
 
 
+def _load_access_pattern_bin(
+    datapath: str, n_obj_to_plot: int, is_real_time: bool
+) -> List[np.ndarray]:
+    """load access pattern plot data from the binary file, the access times
+    are mmapped and only the plotted objects are read
+    Args:
+        datapath: the path to the .accessPattern file
+        n_obj_to_plot: the number of objects to plot
+        is_real_time: load the clock time or the logical time
+    Returns:
+        a list of access time arrays sorted by the first access time
+    """
+
+    header = np.memmap(datapath, dtype=ACCESS_PATTERN_HEADER_DTYPE, mode="r", shape=(1,))[0]
+    assert header["magic"] == ACCESS_PATTERN_MAGIC.rstrip(b"\x00"), (
+        "the input file might not be accessPattern data file " + datapath
+    )
+    n_obj, n_access = int(header["n_obj"]), int(header["n_access"])
+    if n_obj == 0:
+        return []
+
+    offset = ACCESS_PATTERN_HEADER_DTYPE.itemsize
+    objs = np.memmap(datapath, dtype=ACCESS_PATTERN_OBJ_DTYPE, mode="r", offset=offset, shape=(n_obj,))
+    offset += ACCESS_PATTERN_OBJ_DTYPE.itemsize * n_obj
+    if not is_real_time:
+        offset += 4 * n_access
+    access_time = np.memmap(datapath, dtype="<u4", mode="r", offset=offset, shape=(n_access,))
+
+    sample_ratio = max(1, n_obj // n_obj_to_plot)
+    logger.debug(
+        "access pattern: sample ratio {}//{} = {}".format(n_obj, n_obj_to_plot, sample_ratio)
+    )
+
+    # the objects are stored in the order of first access
+    access_time_list = []
+    for obj in objs[sample_ratio - 1 :: sample_ratio]:
+        first, n = int(obj["first_access"]), int(obj["n_access"])
+        access_time_list.append(np.asarray(access_time[first : first + n], dtype=np.float64))
+
+    return access_time_list
+
+
 def plot_access_pattern(
-    datapath: str, n_obj_to_plot: int = 2000, figname_prefix: str = ""
+    datapath: str, n_obj_to_plot: int = 2000, figname_prefix: str = "", vtime: bool = False
 ) -> None:
     """plot access patterns
 
     Args:
         datapath: the path to the access pattern data file
         n_obj_to_plot: the number of objects to plot
+        vtime: plot the logical time, only used with the binary data file
 
     Returns:
         None
@@ -100,9 +162,13 @@ def plot_access_pattern(
     if len(figname_prefix) == 0:
         figname_prefix = extract_dataname(datapath)
 
-    access_time_list = _load_access_pattern_data(datapath, n_obj_to_plot)
+    if datapath.endswith(".accessPattern"):
+        is_real_time = not vtime
+        access_time_list = _load_access_pattern_bin(datapath, n_obj_to_plot, is_real_time)
+    else:
+        is_real_time = "Rtime" in datapath
+        access_time_list = _load_access_pattern_data(datapath, n_obj_to_plot)
 
-    is_real_time = "Rtime" in datapath
     if is_real_time:
         xlabel = "Time (hour)"
         figname = "fig/{}_access_rt.{}".format(figname_prefix, FIG_TYPE)
@@ -113,9 +179,6 @@ def plot_access_pattern(
             )
 
     else:
-        assert (
-            "Vtime" in datapath
-        ), "the input file might not be accessPattern data file"
         xlabel = "Time (# million requests)"
         figname = "fig/{}_access_vt.{}".format(figname_prefix, FIG_TYPE)
         for idx, ts_list in enumerate(access_time_list):
@@ -142,6 +205,9 @@ if __name__ == "__main__":
     ap.add_argument(
         "--figname-prefix", type=str, default="", help="the prefix of figname"
     )
+    ap.add_argument(
+        "--vtime", action="store_true", help="plot the logical time (binary data file only)"
+    )
     p = ap.parse_args()
 
-    plot_access_pattern(p.datapath, p.n_obj_to_plot, p.figname_prefix)
+    plot_access_pattern(p.datapath, p.n_obj_to_plot, p.figname_prefix, p.vtime)
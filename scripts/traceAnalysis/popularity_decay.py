@@ -23,6 +23,7 @@ import matplotlib.colors as colors
 
 sys.path.append(os.path.dirname(os.path.abspath(__file__)))
 from utils.trace_utils import extract_dataname
+from utils.data_utils import load_window_rows
 from utils.plot_utils import FIG_DIR, FIG_TYPE
 
 logger = logging.getLogger("popularity_decay")
@@ -41,19 +42,17 @@ def load_popularity_decay_data(datapath: str) -> Tuple[np.ndarray, int]:
 
     import numpy.ma as ma
 
-    ifile = open(datapath)
-    _data_line = ifile.readline()
-    desc_line = ifile.readline()
+    desc_line, rows = load_window_rows(datapath)
     assert "cnt for new" in desc_line, (
         "the input file might not be popularityDecay data file: " + datapath
     )
     time_window = int(desc_line.split()[11].strip("()"))
     window_cnt_list_list = []
 
-    line = ifile.readline()
-    assert line == "0,\n", f"the first line should be 0, it is {line}" + datapath
-    for line in ifile:
-        l = [int(i) for i in line.strip("\n,").split(",")]
+    assert len(rows) > 0 and list(rows[0]) == [0], (
+        f"the first line should be 0, it is {rows[0] if rows else None}" + datapath
+    )
+    for l in rows[1:]:
         assert l[-1] == 0, "the last element should be 0, " + datapath
         assert len(l) - 2 == len(
             window_cnt_list_list
@@ -69,8 +68,6 @@ def load_popularity_decay_data(datapath: str) -> Tuple[np.ndarray, int]:
         )
     )
 
-    ifile.close()
-
     dim = len(window_cnt_list_list)
     data = np.full((dim, dim), -1, dtype=np.double)
     # data = np.zeros((dim, dim), dtype=np.double)
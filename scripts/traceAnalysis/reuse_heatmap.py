@@ -5,6 +5,7 @@ plot reuse time heatmap
 usage: 
 1. run traceAnalyzer: `./traceAnalyzer /path/trace trace_format --common`, 
 this will generate some output, including reuse distribution result per-window, trace.reuseWindow_w300_rt
+(trace.reuseWindow_w300_rt.bin with --binary-output)
 2. plot reuse heatmap using this script: 
 `python3 reuse_heatmap.py trace.reuseWindow_w300_rt`
 
@@ -23,6 +24,7 @@ import logging
 
 sys.path.append(os.path.dirname(os.path.abspath(__file__)))
 from utils.trace_utils import extract_dataname
+from utils.data_utils import find_window_rows, load_window_rows, window_rows_to_matrix
 from utils.plot_utils import FIG_DIR, FIG_TYPE
 
 logger = logging.getLogger("reuse_heatmap")
@@ -39,9 +41,9 @@ def _load_reuse_heatmap_data(datapath: str) -> Tuple[np.ndarray, int, int, float
 
     """
 
-    ifile = open(datapath)
-    data_line = ifile.readline()
-    desc_line = ifile.readline()
+    desc_line, reuse_time_distribution_list = load_window_rows(
+        find_window_rows(datapath)
+    )
 
     time_granularity, log_base = 0, 0
     if "real time" in desc_line:
@@ -78,22 +80,10 @@ def _load_reuse_heatmap_data(datapath: str) -> Tuple[np.ndarray, int, int, float
             + datapath
         )
 
-    reuse_time_distribution_list = []
-
-    for line in ifile:
-        if len(line.strip()) == 0:
-            continue
-        else:
-            reuse_time_distribution_list.append(
-                [int(i) for i in line.strip(",\n").split(",")]
-            )
-
-    ifile.close()
-
-    dim = max([len(l) for l in reuse_time_distribution_list])
-    plot_data = np.ones((len(reuse_time_distribution_list), dim))
-    for idx, l in enumerate(reuse_time_distribution_list):
-        plot_data[idx][: len(l)] = np.cumsum(np.array(l) / sum(l))
+    # skip the windows without reuse, the cumsum stays at the sum after the end of a row
+    reuse_time_distribution_list = [l for l in reuse_time_distribution_list if len(l) > 0]
+    plot_data = np.cumsum(window_rows_to_matrix(reuse_time_distribution_list), axis=1)
+    plot_data = plot_data / plot_data[:, -1:]
     # plot_data = ma.array(plot_data, mask=plot_data<1e-12).T
     # print(np.sum(plot_data, axis=1))
     plot_data = plot_data.T
@@ -194,6 +184,8 @@ if __name__ == "__main__":
     )
     p = ap.parse_args()
 
+    if p.datapath.endswith(".bin"):
+        p.datapath = p.datapath[:-4]
     if p.datapath.endswith("_rt") or p.datapath.endswith("_vt"):
         p.datapath = p.datapath[:-3]
     plot_reuse_heatmap(p.datapath, p.figname_prefix)
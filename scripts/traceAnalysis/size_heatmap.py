@@ -22,6 +22,7 @@ import logging
 
 sys.path.append(os.path.dirname(os.path.abspath(__file__)))
 from utils.trace_utils import extract_dataname
+from utils.data_utils import find_window_rows, load_window_rows, window_rows_to_matrix
 from utils.plot_utils import FIG_DIR, FIG_TYPE
 
 logger = logging.getLogger("size_heatmap")
@@ -38,9 +39,9 @@ def _load_size_heatmap_data(datapath) -> Tuple[np.ndarray, int, float, int]:
 
     """
 
-    ifile = open(datapath)
-    data_line = ifile.readline()
-    desc_line = ifile.readline()
+    desc_line, size_distribution_over_time = load_window_rows(
+        find_window_rows(datapath)
+    )
     m = re.search(
         r"# (object_size): \w\w\w_cnt \(time window (?P<tw>\d+), log_base (?P<logb>\d+\.?\d*), size_base (?P<sizeb>\d+)\)",
         desc_line,
@@ -55,26 +56,9 @@ def _load_size_heatmap_data(datapath) -> Tuple[np.ndarray, int, float, int]:
     time_window = int(m.group("tw"))
     log_base = float(m.group("logb"))
     size_base = int(m.group("sizeb"))
-    size_distribution_over_time = []
-
-    for line in ifile:
-        # if "obj_cnt" in line:
-        #     curr_data = size_distribution_by_obj_over_time
-        # elif len(line.strip()) == 0:
-        #     continue
-        # else:
-        count_list = line.strip("\n,").split(",")
-        size_distribution_over_time.append(count_list)
-
-    ifile.close()
 
-    dim = max([len(l) for l in size_distribution_over_time])
-    plot_data = np.zeros((len(size_distribution_over_time), dim))
-
-    for idx, l in enumerate(size_distribution_over_time):
-        l = np.array(l, dtype=np.float64)
-        l = l / np.sum(l)
-        plot_data[idx][: len(l)] = l
+    plot_data = window_rows_to_matrix(size_distribution_over_time)
+    plot_data = plot_data / np.sum(plot_data, axis=1, keepdims=True)
 
     return plot_data.T, time_window, log_base, size_base
 
@@ -152,6 +136,8 @@ if __name__ == "__main__":
     )
     p = ap.parse_args()
 
+    if p.datapath.endswith(".bin"):
+        p.datapath = p.datapath[:-4]
     if p.datapath.endswith("_req") or p.datapath.endswith("_obj"):
         p.datapath = p.datapath[:-4]
 
@@ -22,3 +22,87 @@ def conv_to_cdf(
     y = np.cumsum(y)
     y = y / y[-1]
     return x, y
+
+
+# the binary per-window output written by traceAnalyzer --binary-output,
+# see libCacheSim/traceAnalyzer/windowStream.h
+WINDOW_STREAM_MAGIC = b"LCSWIND"
+WINDOW_STREAM_HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "S8"),
+        ("version", "<u4"),
+        ("dtype", "S4"),
+        ("n_row", "<u8"),
+        ("n_value", "<u8"),
+        ("time_window", "<i8"),
+        ("desc", "S216"),
+    ]
+)
+
+
+def find_window_rows(datapath: str) -> str:
+    """return the binary per-window output of datapath if there is no text output
+
+    Args:
+        datapath (str): the path of the text output, e.g., trace.reuseWindow_w300_rt
+
+    Returns:
+        str: datapath or datapath.bin
+    """
+    import os
+
+    if not os.path.exists(datapath) and os.path.exists(datapath + ".bin"):
+        return datapath + ".bin"
+    return datapath
+
+
+def load_window_rows(datapath: str) -> Tuple[str, List[np.ndarray]]:
+    """load the per-window rows of the size, reuse and popularityDecay heatmaps,
+    the text and the binary output are both supported
+
+    Args:
+        datapath (str): the path of the per-window output
+
+    Returns:
+        Tuple[str, List[np.ndarray]]: the description line, the rows (one per time window)
+    """
+
+    if not datapath.endswith(".bin"):
+        with open(datapath) as ifile:
+            _data_line = ifile.readline()
+            desc_line = ifile.readline()
+            rows = [
+                np.array(line.strip("\n,").split(","), dtype=np.int64)
+                if len(line.strip("\n,")) > 0
+                else np.zeros(0, dtype=np.int64)
+                for line in ifile
+            ]
+        return desc_line, rows
+
+    header = np.fromfile(datapath, dtype=WINDOW_STREAM_HEADER_DTYPE, count=1)[0]
+    assert header["magic"] == WINDOW_STREAM_MAGIC, (
+        "the input file is not a binary per-window output " + datapath
+    )
+    n_row, n_value = int(header["n_row"]), int(header["n_value"])
+    value_dtype = np.dtype(header["dtype"].decode())
+    offset = WINDOW_STREAM_HEADER_DTYPE.itemsize
+    values = np.fromfile(datapath, dtype=value_dtype, count=n_value, offset=offset)
+    row_len = np.fromfile(
+        datapath,
+        dtype="<u4",
+        count=n_row,
+        offset=offset + n_value * value_dtype.itemsize,
+    )
+    rows = np.split(values, np.cumsum(row_len)[:-1]) if n_row > 0 else []
+
+    return "# " + header["desc"].decode() + "\n", rows
+
+
+def window_rows_to_matrix(rows: List[np.ndarray], fill: float = 0) -> np.ndarray:
+    """pad the per-window rows to a matrix, one row per time window"""
+
+    dim = max([len(l) for l in rows], default=0)
+    row_len = np.array([len(l) for l in rows])
+    data = np.full((len(rows), dim), fill, dtype=np.float64)
+    data[np.arange(dim) < row_len[:, None]] = np.concatenate(rows) if rows else []
+    return data
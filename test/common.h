@@ -229,8 +229,14 @@ static cache_t *create_test_cache(const char *alg_name,
       init_params =
           "type=learned, "
           "train-source-y=online, rank-intvl=0.05, retrain-intvl=172800";
+    } else {
+      init_params = params;
     }
     cache = GLCache_init(cc_params, init_params);
+#endif
+#if defined(ENABLE_LRB) && ENABLE_LRB == 1
+  } else if (strcasecmp(alg_name, "LRB") == 0) {
+    cache = LRB_init(cc_params, params);
 #endif
   } else if (strcasecmp(alg_name, "LHD") == 0) {
     cache = LHD_init(cc_params, NULL);
@@ -254,10 +260,31 @@ static cache_t *create_test_cache(const char *alg_name,
     cache = S3FIFO_init(cc_params, "move-to-main-threshold=2");
   } else if (strcasecmp(alg_name, "Sieve") == 0) {
     cache = Sieve_init(cc_params, NULL);
+  } else if (strcasecmp(alg_name, "ConcurrentFIFO") == 0) {
+    cache = ConcurrentFIFO_init(cc_params, NULL);
+  } else if (strcasecmp(alg_name, "ConcurrentClock") == 0) {
+    cache = ConcurrentClock_init(cc_params, NULL);
+  } else if (strcasecmp(alg_name, "ConcurrentSieve") == 0) {
+    cache = ConcurrentSieve_init(cc_params, NULL);
+  } else if (strcasecmp(alg_name, "ConcurrentS3FIFO") == 0) {
+    cache = ConcurrentS3FIFO_init(cc_params, "move-to-main-threshold=2");
+  } else if (strcasecmp(alg_name, "ShardedLRU") == 0) {
+    cache = ShardedLRU_init(cc_params, "n-shard=1");
   } else if (strcasecmp(alg_name, "Mithril") == 0) {
     cache = LRU_init(cc_params, NULL);
     cache->prefetcher =
         create_prefetcher("Mithril", NULL, cc_params.cache_size);
+  } else if (strcasecmp(alg_name, "MithrilAsync") == 0) {
+    cache = LRU_init(cc_params, NULL);
+    cache->prefetcher =
+        create_prefetcher("Mithril", "async-mining=true, mining-delay=1000",
+                          cc_params.cache_size);
+  } else if (strcasecmp(alg_name, "OBL") == 0 ||
+             strcasecmp(alg_name, "Sequential") == 0 ||
+             strcasecmp(alg_name, "AMP") == 0) {
+    cache = LRU_init(cc_params, NULL);
+    cache->prefetcher =
+        create_prefetcher(alg_name, NULL, cc_params.cache_size);
   } else {
     printf("cannot recognize algorithm %s\n", alg_name);
     exit(1);
@@ -0,0 +1,240 @@
+//
+// the blocked count-min sketch and the TinyLFU admission that uses it,
+// the scan detector and the scan admission that uses it
+//
+
+#include "../libCacheSim/dataStructure/blockedCountMinSketch.h"
+#include "../libCacheSim/dataStructure/hash/hash.h"
+#include "../libCacheSim/dataStructure/scanDetector.h"
+#include "common.h"
+
+#define N_CMS_ITEM 4096
+
+/* the true count of item i, some items are beyond the max count */
+static int _true_count(uint64_t i) { return (int)(i % 20); }
+
+static uint64_t _item_hash(uint64_t i) {
+  return (uint64_t)get_hash_value_int_64(&i);
+}
+
+static void _fill_sketch(struct blocked_cms *cms, bool use_avx2) {
+  g_assert_cmpint(blocked_cms_init(cms, N_CMS_ITEM), ==, 0);
+  blocked_cms_use_avx2(cms, use_avx2);
+  for (uint64_t i = 0; i < N_CMS_ITEM; i++) {
+    for (int j = 0; j < _true_count(i); j++) {
+      blocked_cms_increment(cms, _item_hash(i));
+    }
+  }
+}
+
+/* a count-min sketch never underestimates, the counters saturate at the max
+ * count, and the conservative update keeps the overestimation small */
+static void test_blocked_cms_estimate(gconstpointer user_data) {
+  bool use_avx2 = GPOINTER_TO_INT(user_data);
+  struct blocked_cms cms;
+
+  /* a single item is counted exactly until it saturates */
+  g_assert_cmpint(blocked_cms_init(&cms, N_CMS_ITEM), ==, 0);
+  blocked_cms_use_avx2(&cms, use_avx2);
+  for (int i = 1; i <= BLOCKED_CMS_MAX_COUNT + 5; i++) {
+    int cnt = blocked_cms_increment(&cms, _item_hash(0));
+    g_assert_cmpint(cnt, ==, MIN(i, BLOCKED_CMS_MAX_COUNT));
+    g_assert_cmpint(blocked_cms_estimate(&cms, _item_hash(0)), ==, cnt);
+  }
+  g_assert_cmpint(blocked_cms_estimate(&cms, _item_hash(1)), ==, 0);
+  blocked_cms_free(&cms);
+
+  _fill_sketch(&cms, use_avx2);
+  int64_t n_overestimate = 0, overestimate_sum = 0;
+  for (uint64_t i = 0; i < N_CMS_ITEM; i++) {
+    int cnt_true = MIN(_true_count(i), BLOCKED_CMS_MAX_COUNT);
+    int est = blocked_cms_estimate(&cms, _item_hash(i));
+    g_assert_cmpint(est, >=, cnt_true);
+    g_assert_cmpint(est, <=, BLOCKED_CMS_MAX_COUNT);
+    if (est > cnt_true) n_overestimate++;
+    overestimate_sum += est - cnt_true;
+  }
+  printf("%ld/%d items overestimated, mean overestimation %.4lf\n",
+         (long)n_overestimate, N_CMS_ITEM,
+         (double)overestimate_sum / N_CMS_ITEM);
+  g_assert_cmpint(n_overestimate, <=, N_CMS_ITEM / 8);
+  g_assert_cmpint(overestimate_sum, <=, N_CMS_ITEM / 2);
+  blocked_cms_free(&cms);
+}
+
+/* halving is the aging of TinyLFU, it halves the estimate of every item */
+static void test_blocked_cms_aging(gconstpointer user_data) {
+  bool use_avx2 = GPOINTER_TO_INT(user_data);
+  struct blocked_cms cms;
+  _fill_sketch(&cms, use_avx2);
+
+  int est[N_CMS_ITEM];
+  for (uint64_t i = 0; i < N_CMS_ITEM; i++) {
+    est[i] = blocked_cms_estimate(&cms, _item_hash(i));
+  }
+
+  blocked_cms_halve(&cms);
+  for (uint64_t i = 0; i < N_CMS_ITEM; i++) {
+    g_assert_cmpint(blocked_cms_estimate(&cms, _item_hash(i)), ==,
+                    est[i] / 2);
+  }
+
+  /* the counters keep counting after halving */
+  blocked_cms_increment(&cms, _item_hash(0));
+  g_assert_cmpint(blocked_cms_estimate(&cms, _item_hash(0)), >=, 1);
+
+  blocked_cms_reset(&cms);
+  for (uint64_t i = 0; i < N_CMS_ITEM; i++) {
+    g_assert_cmpint(blocked_cms_estimate(&cms, _item_hash(i)), ==, 0);
+  }
+  blocked_cms_free(&cms);
+}
+
+/* the AVX2 and the scalar implementation give the same counters, the AVX2
+ * path only runs on CPUs that support it */
+static void test_blocked_cms_avx2(gconstpointer user_data) {
+  struct blocked_cms cms_scalar, cms_avx2;
+  g_assert_cmpint(blocked_cms_init(&cms_scalar, N_CMS_ITEM), ==, 0);
+  g_assert_cmpint(blocked_cms_init(&cms_avx2, N_CMS_ITEM), ==, 0);
+  g_assert_cmpint(blocked_cms_use_avx2(&cms_scalar, false), ==, 0);
+  if (!blocked_cms_use_avx2(&cms_avx2, true)) {
+    printf("AVX2 is not supported, only the scalar path is tested\n");
+  }
+
+  for (uint64_t i = 0; i < N_CMS_ITEM; i++) {
+    for (int j = 0; j < _true_count(i); j++) {
+      g_assert_cmpint(blocked_cms_increment(&cms_avx2, _item_hash(i)), ==,
+                      blocked_cms_increment(&cms_scalar, _item_hash(i)));
+    }
+    if (i == N_CMS_ITEM / 2) {
+      blocked_cms_halve(&cms_scalar);
+      blocked_cms_halve(&cms_avx2);
+    }
+  }
+
+  for (uint64_t i = 0; i < N_CMS_ITEM * 2; i++) {
+    g_assert_cmpint(blocked_cms_estimate(&cms_avx2, _item_hash(i)), ==,
+                    blocked_cms_estimate(&cms_scalar, _item_hash(i)));
+  }
+  g_assert_cmpint(memcmp(cms_scalar.table, cms_avx2.table,
+                         cms_scalar.n_block * 8 * sizeof(uint64_t)),
+                  ==, 0);
+
+  blocked_cms_free(&cms_scalar);
+  blocked_cms_free(&cms_avx2);
+}
+
+/* the first access only sets the doorkeeper, the second one admits, after
+ * n-obj * sample-ratio accesses the counters are halved and the doorkeeper is
+ * cleared, so the object needs two more accesses to be admitted again */
+static void test_tinylfu_aging(gconstpointer user_data) {
+  admissioner_t *admissioner =
+      create_tinylfu_admissioner("n-obj=1000, sample-ratio=1, min-freq=2");
+  request_t *req = new_request();
+
+  req->obj_id = 0;
+  g_assert_false(admissioner->admit(admissioner, req));
+  g_assert_true(admissioner->admit(admissioner, req));
+
+  /* one-hit objects fill the sample until the reset */
+  for (int64_t i = 1; i <= 1000; i++) {
+    req->obj_id = i;
+    admissioner->admit(admissioner, req);
+  }
+
+  req->obj_id = 0;
+  g_assert_false(admissioner->admit(admissioner, req));
+  g_assert_true(admissioner->admit(admissioner, req));
+
+  free_request(req);
+  admissioner->free(admissioner);
+}
+
+/* a run becomes a scan at its min_run-th request, a re-reference of the last
+ * block does not break the run, and a new run replaces the least recently
+ * used stream */
+static void test_scan_detector(gconstpointer user_data) {
+  struct scan_detector sd;
+  g_assert_cmpint(scan_detector_init(&sd, 2, 4, 1), ==, 0);
+
+  for (uint64_t i = 0; i < 10; i++) {
+    int64_t run_len = scan_detector_add(&sd, i);
+    g_assert_cmpint(run_len, ==, i + 1);
+    g_assert_cmpint(scan_detector_is_scan(&sd, run_len), ==, i + 1 >= 4);
+  }
+  g_assert_cmpint(scan_detector_add(&sd, 9), ==, 10);
+  g_assert_cmpint(sd.n_scan, ==, 1);
+  g_assert_cmpint(sd.n_scan_req, ==, 8);
+  g_assert_cmpint(sd.n_req_in_scan, ==, 11);
+
+  /* two interleaved runs, the first one replaces the empty stream, the
+   * second one replaces the run of 0-9 */
+  for (uint64_t i = 0; i < 3; i++) {
+    g_assert_cmpint(scan_detector_add(&sd, 1000 + i), ==, i + 1);
+    g_assert_cmpint(sd.ended_run_len, ==, 0);
+    g_assert_cmpint(scan_detector_add(&sd, 2000 + i), ==, i + 1);
+    g_assert_cmpint(sd.ended_run_len, ==, i == 0 ? 10 : 0);
+  }
+  g_assert_cmpint(sd.n_scan, ==, 1);
+
+  /* a gap larger than max_gap starts a new run */
+  g_assert_cmpint(scan_detector_add(&sd, 1004), ==, 1);
+  g_assert_cmpint(sd.ended_run_len, ==, 3);
+  g_assert_cmpint(sd.n_req, ==, 18);
+  scan_detector_free(&sd);
+
+  g_assert_cmpint(scan_detector_init(&sd, 2, 4, 2), ==, 0);
+  for (uint64_t i = 0; i < 8; i++) {
+    g_assert_cmpint(scan_detector_add(&sd, i * 2), ==, i + 1);
+  }
+  g_assert_cmpint(sd.n_scan_req, ==, 5);
+  scan_detector_free(&sd);
+}
+
+/* the first min-run - 1 blocks of a run are admitted, the hits recorded by
+ * update extend the run, and a random block is admitted */
+static void test_scan_admission(gconstpointer user_data) {
+  admissioner_t *admissioner =
+      create_scan_admissioner("n-streams=1, min-run=4, max-gap=1");
+  request_t *req = new_request();
+
+  for (int64_t i = 0; i < 10; i++) {
+    req->obj_id = i;
+    g_assert_cmpint(admissioner->admit(admissioner, req), ==, i < 3);
+  }
+
+  /* a hit in the middle of the scan */
+  req->obj_id = 10;
+  admissioner->update(admissioner, req);
+  req->obj_id = 11;
+  g_assert_false(admissioner->admit(admissioner, req));
+
+  req->obj_id = 5000;
+  g_assert_true(admissioner->admit(admissioner, req));
+  req->obj_id = 12;
+  g_assert_true(admissioner->admit(admissioner, req));
+
+  free_request(req);
+  admissioner->free(admissioner);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_data_func("/libCacheSim/blocked_cms_estimate_scalar",
+                       GINT_TO_POINTER(false), test_blocked_cms_estimate);
+  g_test_add_data_func("/libCacheSim/blocked_cms_estimate_avx2",
+                       GINT_TO_POINTER(true), test_blocked_cms_estimate);
+  g_test_add_data_func("/libCacheSim/blocked_cms_aging_scalar",
+                       GINT_TO_POINTER(false), test_blocked_cms_aging);
+  g_test_add_data_func("/libCacheSim/blocked_cms_aging_avx2",
+                       GINT_TO_POINTER(true), test_blocked_cms_aging);
+  g_test_add_data_func("/libCacheSim/blocked_cms_avx2", NULL,
+                       test_blocked_cms_avx2);
+  g_test_add_data_func("/libCacheSim/tinylfu_aging", NULL, test_tinylfu_aging);
+  g_test_add_data_func("/libCacheSim/scan_detector", NULL, test_scan_detector);
+  g_test_add_data_func("/libCacheSim/scan_admission", NULL,
+                       test_scan_admission);
+
+  return g_test_run();
+}
@@ -61,6 +61,114 @@ void test_distUtils_more1(gconstpointer user_data) {
   g_free(rd);
 }
 
+static int64_t* load_stream_dist(const char* path, int64_t n_req) {
+  int64_t* dist = g_new(int64_t, n_req);
+  FILE* file = fopen(path, "rb");
+  g_assert_nonnull(file);
+  g_assert_cmpint(fread(dist, sizeof(int64_t), n_req, file), ==, n_req);
+  fclose(file);
+  return dist;
+}
+
+static int _cmp_str(const void* a, const void* b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/* the "dist:cnt, " entries of a cnt output, sorted because the order of the
+ * entries follows the hash table */
+static char** load_sorted_cnt(const char* path, int64_t* n_entry) {
+  FILE* file = fopen(path, "r");
+  g_assert_nonnull(file);
+  int64_t cap = 1024;
+  char** entries = g_new(char*, cap);
+  char entry[64];
+  *n_entry = 0;
+  while (fscanf(file, "%63[^,], ", entry) == 1) {
+    if (*n_entry == cap) {
+      cap *= 2;
+      entries = g_renew(char*, entries, cap);
+    }
+    entries[(*n_entry)++] = g_strdup(entry);
+  }
+  fclose(file);
+  qsort(entries, *n_entry, sizeof(char*), _cmp_str);
+  return entries;
+}
+
+static void assert_same_cnt(const char* path1, const char* path2) {
+  int64_t n_entry1, n_entry2;
+  char** entries1 = load_sorted_cnt(path1, &n_entry1);
+  char** entries2 = load_sorted_cnt(path2, &n_entry2);
+  g_assert_cmpint(n_entry1, >, 0);
+  g_assert_cmpint(n_entry1, ==, n_entry2);
+  for (int64_t i = 0; i < n_entry1; i++) {
+    g_assert_cmpstr(entries1[i], ==, entries2[i]);
+    g_free(entries1[i]);
+    g_free(entries2[i]);
+  }
+  g_free(entries1);
+  g_free(entries2);
+}
+
+void test_distUtils_stream(gconstpointer user_data) {
+  int32_t rd_true[N_TEST] = {-1, -1, -1, 7, -1, 86};
+  int32_t last_dist_true[N_TEST] = {-1, -1, -1, 8, -1, 138};
+  int32_t frd_true[N_TEST] = {11, 37, 49, -1, 8, -1};
+  reader_t* reader = (reader_t*)user_data;
+  int64_t n_req = (int64_t)get_num_of_req(reader);
+  int64_t* dist;
+  long i, j;
+
+  g_assert_cmpint(
+      stream_dist(reader, STACK_DIST, DIST_OUTPUT_BINARY, "dist.stream"), ==,
+      n_req);
+  dist = load_stream_dist("dist.stream.STACK_DIST.int64", n_req);
+  for (i = n_req - 1, j = 0; j < N_TEST; i--, j++) {
+    g_assert_cmpint(dist[i], ==, rd_true[j]);
+  }
+  g_free(dist);
+
+  stream_dist(reader, FUTURE_STACK_DIST, DIST_OUTPUT_BINARY, "dist.stream");
+  dist = load_stream_dist("dist.stream.FUTURE_STACK_DIST.int64", n_req);
+  for (i = 6, j = 0; j < N_TEST; i++, j++) {
+    g_assert_cmpint(dist[i], ==, frd_true[j]);
+  }
+  g_free(dist);
+
+  stream_dist(reader, DIST_SINCE_LAST_ACCESS, DIST_OUTPUT_BINARY,
+              "dist.stream");
+  dist = load_stream_dist("dist.stream.DIST_SINCE_LAST_ACCESS.int64", n_req);
+  for (i = n_req - 1, j = 0; j < N_TEST; i--, j++) {
+    g_assert_cmpint(dist[i], ==, last_dist_true[j]);
+  }
+  g_free(dist);
+
+  /* the cnt output of the future stack distance is counted without the
+   * distances of each request, it must match the count of the full array */
+  int64_t array_size;
+  int32_t* frd = get_stack_dist(reader, FUTURE_STACK_DIST, &array_size);
+  save_dist_as_cnt_txt(reader, frd, array_size, "dist.save",
+                       FUTURE_STACK_DIST);
+  g_free(frd);
+  g_assert_cmpint(stream_dist(reader, FUTURE_STACK_DIST, DIST_OUTPUT_CNT_TXT,
+                              "dist.stream"),
+                  ==, n_req);
+  assert_same_cnt("dist.stream.FUTURE_STACK_DIST.cnt",
+                  "dist.save.FUTURE_STACK_DIST.cnt");
+}
+
+/* the future stack distance is not computed in request order, the txt output
+ * rejects it */
+void test_distUtils_stream_txt_future(gconstpointer user_data) {
+  if (g_test_subprocess()) {
+    stream_dist((reader_t*)user_data, FUTURE_STACK_DIST, DIST_OUTPUT_TXT,
+                "dist.stream");
+    return;
+  }
+  g_test_trap_subprocess(NULL, 0, 0);
+  g_test_trap_assert_failed();
+}
+
 int main(int argc, char* argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t* reader;
@@ -92,6 +200,10 @@ int main(int argc, char* argv[]) {
   reader = setup_binary_reader();
   g_test_add_data_func("/libCacheSim/test_distUtils_basic_binary", reader,
                        test_distUtils_basic);
+  g_test_add_data_func("/libCacheSim/test_distUtils_stream_binary", reader,
+                       test_distUtils_stream);
+  g_test_add_data_func("/libCacheSim/test_distUtils_stream_txt_future_binary",
+                       reader, test_distUtils_stream_txt_future);
   g_test_add_data_func_full("/libCacheSim/test_distUtils_more1_binary", reader,
                             test_distUtils_more1, test_teardown);
 
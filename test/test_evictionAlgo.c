@@ -158,10 +158,10 @@ static void test_BeladySize(gconstpointer user_data) {
 }
 
 static void test_Random(gconstpointer user_data) {
-  uint64_t miss_cnt_true[] = {92444, 88637, 84247, 79875,
-                              75206, 71042, 67096, 63182};
-  uint64_t miss_byte_true[] = {4165255168, 3976227840, 3744436736, 3506359808,
-                               3300872704, 3055019008, 2837280256, 2642700288};
+  uint64_t miss_cnt_true[] = {92621, 88702, 84640, 80552,
+                              76604, 72710, 68769, 64541};
+  uint64_t miss_byte_true[] = {4178442752, 3985596928, 3776769536, 3554308096,
+                               3340689920, 3137526272, 2937103872, 2733008896};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {
@@ -263,10 +263,10 @@ static void test_LHD(gconstpointer user_data) {
 }
 
 static void test_Hyperbolic(gconstpointer user_data) {
-  uint64_t miss_cnt_true[] = {92836, 89281, 84407, 80420,
-                              76299, 71843, 68884, 65654};
-  uint64_t miss_byte_true[] = {4210119680, 4050535424, 3806349824, 3578494976,
-                               3352331264, 3092705792, 2910994944, 2769552384};
+  uint64_t miss_cnt_true[] = {92913, 89466, 83352, 81258,
+                              74576, 71143, 69313, 65257};
+  uint64_t miss_byte_true[] = {4212874240, 4064745984, 3763238912, 3646384128,
+                               3247233024, 3029979136, 2938654720, 2748873728};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {
@@ -514,6 +514,219 @@ static void test_Sieve(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+static void test_ConcurrentFIFO(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {93403, 89386, 84387, 84025,
+                              72498, 72228, 72182, 72140};
+  uint64_t miss_byte_true[] = {4213112832, 4052646400, 3829170176, 3807412736,
+                               3093146112, 3079525888, 3079210496, 3077547520};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("ConcurrentFIFO", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
+}
+
+static void test_ConcurrentClock(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {93313, 89775, 83411, 81328,
+                              74815, 72283, 71927, 64456};
+  uint64_t miss_byte_true[] = {4213887488, 4064512000, 3762650624, 3644467200,
+                               3256760832, 3091688448, 3074241024, 2697378816};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("ConcurrentClock", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
+}
+
+static void test_ConcurrentSieve(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {91699, 86720, 78578, 76707,
+                              69945, 66221, 64445, 64376};
+  uint64_t miss_byte_true[] = {4158632960, 3917211648, 3536227840, 3455379968,
+                               3035580416, 2801699328, 2699456000, 2696345600};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("ConcurrentSieve", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
+}
+
+static void test_ConcurrentS3FIFO(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {88670, 82584, 79229, 77839,
+                              71292, 71174, 70585, 70367};
+  uint64_t miss_byte_true[] = {3986914816, 3676685312, 3489491968, 3350976512,
+                               3038423552, 3034930688, 2991954944, 2980435968};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("ConcurrentS3FIFO", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
+}
+
+/* single-threaded, the deferred promotions are applied before each eviction,
+ * so one shard gives the same result as LRU */
+static void test_ShardedLRU(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {93374, 89783, 83572, 81722,
+                              72494, 72104, 71972, 71704};
+  uint64_t miss_byte_true[] = {4214303232, 4061242368, 3778040320, 3660569600,
+                               3100927488, 3078128640, 3075403776, 3061662720};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("ShardedLRU", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
+}
+
+#define N_CONCURRENT_TEST_THREAD 4
+
+typedef struct {
+  cache_t *cache;
+  const request_t *reqs;
+  int64_t n_req;
+  int64_t start_idx;
+  int64_t n_hit;
+  int64_t n_miss;
+} concurrent_test_worker_t;
+
+static gpointer _concurrent_test_worker(gpointer user_data) {
+  concurrent_test_worker_t *worker = (concurrent_test_worker_t *)user_data;
+  for (int64_t i = 0; i < worker->n_req; i++) {
+    const request_t *req =
+        &worker->reqs[(worker->start_idx + i) % worker->n_req];
+    if (worker->cache->get(worker->cache, req)) {
+      worker->n_hit++;
+    } else {
+      worker->n_miss++;
+    }
+    if (i % 64 == 0) {
+      worker->cache->remove(worker->cache, req->obj_id);
+    }
+  }
+  return NULL;
+}
+
+/* run the concurrent caches with several threads, the miss ratio is not
+ * deterministic, so check the hit and miss accounting, that the first request
+ * of every object misses, that the objects found in the cache add up to
+ * n_obj and occupied_byte, and that the cache stays within its size */
+static void test_concurrent_multi_thread(gconstpointer user_data) {
+  const char *algos[] = {"ConcurrentFIFO", "ConcurrentClock",
+                         "ConcurrentSieve", "ConcurrentS3FIFO", "ShardedLRU"};
+  reader_t *reader = (reader_t *)user_data;
+  int64_t n_req = get_num_of_req(reader);
+  request_t *reqs = my_malloc_n(request_t, n_req);
+  int64_t max_obj_size = 0;
+  GHashTable *obj_set = g_hash_table_new(g_int64_hash, g_int64_equal);
+  reset_reader(reader);
+  for (int64_t i = 0; i < n_req; i++) {
+    read_one_req(reader, &reqs[i]);
+    max_obj_size = MAX(max_obj_size, reqs[i].obj_size);
+    g_hash_table_add(obj_set, &reqs[i].obj_id);
+  }
+  reset_reader(reader);
+  int64_t n_uniq_obj = g_hash_table_size(obj_set);
+
+  for (int i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+    common_cache_params_t cc_params = {
+        .cache_size = CACHE_SIZE / 4, .hashpower = 20,
+        .default_ttl = DEFAULT_TTL};
+    cache_t *cache = create_test_cache(algos[i], cc_params, reader, NULL);
+    concurrent_test_worker_t workers[N_CONCURRENT_TEST_THREAD];
+    GThread *threads[N_CONCURRENT_TEST_THREAD];
+    for (int j = 0; j < N_CONCURRENT_TEST_THREAD; j++) {
+      workers[j] = (concurrent_test_worker_t){
+          .cache = cache,
+          .reqs = reqs,
+          .n_req = n_req,
+          .start_idx = n_req * j / N_CONCURRENT_TEST_THREAD,
+          .n_hit = 0,
+          .n_miss = 0};
+      threads[j] = g_thread_new(NULL, _concurrent_test_worker, &workers[j]);
+    }
+    int64_t n_hit = 0, n_miss = 0;
+    for (int j = 0; j < N_CONCURRENT_TEST_THREAD; j++) {
+      g_thread_join(threads[j]);
+      g_assert_cmpint(workers[j].n_hit + workers[j].n_miss, ==, n_req);
+      n_hit += workers[j].n_hit;
+      n_miss += workers[j].n_miss;
+    }
+
+    printf("%s %d threads, hit ratio %.4lf\n", cache->cache_name,
+           N_CONCURRENT_TEST_THREAD,
+           (double)n_hit / (double)(n_req * N_CONCURRENT_TEST_THREAD));
+    g_assert_cmpint(n_hit, >, 0);
+    g_assert_cmpint(n_miss, >=, n_uniq_obj);
+
+    /* the threads have finished, find is safe to use */
+    int64_t n_obj_found = 0, n_byte_found = 0;
+    GHashTableIter iter;
+    gpointer key;
+    g_hash_table_iter_init(&iter, obj_set);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+      request_t req = {.obj_id = *(obj_id_t *)key};
+      cache_obj_t *obj = cache->find(cache, &req, false);
+      if (obj != NULL) {
+        n_obj_found++;
+        n_byte_found += obj->obj_size + cache->obj_md_size;
+      }
+    }
+    g_assert_cmpint(cache->get_n_obj(cache), >, 0);
+    g_assert_cmpint(cache->get_n_obj(cache), ==, n_obj_found);
+    g_assert_cmpint(cache->get_occupied_byte(cache), ==, n_byte_found);
+    g_assert_cmpint(cache->get_occupied_byte(cache), <=,
+                    cache->cache_size +
+                        max_obj_size * N_CONCURRENT_TEST_THREAD);
+    cache->cache_free(cache);
+  }
+
+  g_hash_table_destroy(obj_set);
+  my_free(sizeof(request_t) * n_req, reqs);
+}
+
 static void test_WTinyLFU(gconstpointer user_data) {
   // TODO: to be implemented
 }
@@ -539,6 +752,94 @@ static void test_LIRS(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+#if defined(ENABLE_GLCACHE) && ENABLE_GLCACHE == 1
+static cache_stat_t *_simulate_GLCache(reader_t *reader, const char *params) {
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("GLCache", cc_params, reader, params);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+  print_results(cache, res);
+  cache->cache_free(cache);
+  return res;
+}
+
+/* the trace spans two hours, so the model is retrained every ten minutes.
+ * With max-staleness=0 the async training installs the model at the next
+ * request, before any eviction uses it, so it gives the same misses as the
+ * training in the request path */
+static void test_GLCache(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  uint64_t n_size = CACHE_SIZE / STEP_SIZE;
+
+  cache_stat_t *res_sync =
+      _simulate_GLCache(reader, "retrain-intvl=600, async-train=false");
+  cache_stat_t *res_async = _simulate_GLCache(
+      reader, "retrain-intvl=600, async-train=true, max-staleness=0");
+  for (uint64_t i = 0; i < n_size; i++) {
+    g_assert_cmpuint(res_sync[i].n_req, ==, g_req_cnt_true);
+    g_assert_cmpuint(res_sync[i].n_req_byte, ==, g_req_byte_true);
+    g_assert_cmpuint(res_async[i].n_miss, ==, res_sync[i].n_miss);
+    g_assert_cmpuint(res_async[i].n_miss_byte, ==, res_sync[i].n_miss_byte);
+  }
+
+  my_free(sizeof(cache_stat_t), res_sync);
+  my_free(sizeof(cache_stat_t), res_async);
+}
+#endif
+
+#if defined(ENABLE_LRB) && ENABLE_LRB == 1
+static cache_stat_t *_simulate_LRB(reader_t *reader, const char *params) {
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("LRB", cc_params, reader, params);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+  print_results(cache, res);
+  cache->cache_free(cache);
+  return res;
+}
+
+/* the default trains in the request path and ranks for every eviction. The
+ * batched eviction and the async training with a fixed training-delay are
+ * opt-in, they do not depend on the thread timing, so two runs give exactly
+ * the same misses. The async training without a delay is not checked because
+ * its results depend on how fast the trainer is */
+static void test_LRB(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  uint64_t n_size = CACHE_SIZE / STEP_SIZE;
+
+  cache_stat_t *res = _simulate_LRB(reader, NULL);
+  cache_stat_t *res_sync =
+      _simulate_LRB(reader, "async-training=false,eviction-batch=1");
+  for (uint64_t i = 0; i < n_size; i++) {
+    g_assert_cmpuint(res_sync[i].n_miss, ==, res[i].n_miss);
+    g_assert_cmpuint(res_sync[i].n_miss_byte, ==, res[i].n_miss_byte);
+  }
+
+  const char *opt_in_params[] = {
+      "eviction-batch=8", "async-training=true,training-delay=10000",
+      "async-training=true,training-delay=10000,eviction-batch=8"};
+  for (int i = 0; i < 3; i++) {
+    cache_stat_t *res_opt1 = _simulate_LRB(reader, opt_in_params[i]);
+    cache_stat_t *res_opt2 = _simulate_LRB(reader, opt_in_params[i]);
+    for (uint64_t j = 0; j < n_size; j++) {
+      g_assert_cmpuint(res_opt1[j].n_req, ==, g_req_cnt_true);
+      g_assert_cmpuint(res_opt1[j].n_req_byte, ==, g_req_byte_true);
+      g_assert_cmpuint(res_opt2[j].n_miss, ==, res_opt1[j].n_miss);
+      g_assert_cmpuint(res_opt2[j].n_miss_byte, ==, res_opt1[j].n_miss_byte);
+    }
+    my_free(sizeof(cache_stat_t), res_opt1);
+    my_free(sizeof(cache_stat_t), res_opt2);
+  }
+
+  my_free(sizeof(cache_stat_t), res);
+  my_free(sizeof(cache_stat_t), res_sync);
+}
+#endif
+
 static void empty_test(gconstpointer user_data) { ; }
 
 int main(int argc, char *argv[]) {
@@ -578,9 +879,28 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/cacheAlgo_LFU", reader, test_LFU);
   g_test_add_data_func("/libCacheSim/cacheAlgo_LFUDA", reader, test_LFUDA);
 
+  g_test_add_data_func("/libCacheSim/cacheAlgo_ConcurrentFIFO", reader,
+                       test_ConcurrentFIFO);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_ConcurrentClock", reader,
+                       test_ConcurrentClock);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_ConcurrentSieve", reader,
+                       test_ConcurrentSieve);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_ConcurrentS3FIFO", reader,
+                       test_ConcurrentS3FIFO);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_ShardedLRU", reader,
+                       test_ShardedLRU);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_concurrent_multi_thread",
+                       reader, test_concurrent_multi_thread);
+
   g_test_add_data_func("/libCacheSim/cacheAlgo_LFUCpp", reader, test_LFUCpp);
   g_test_add_data_func("/libCacheSim/cacheAlgo_GDSF", reader, test_GDSF);
   g_test_add_data_func("/libCacheSim/cacheAlgo_LHD", reader, test_LHD);
+#if defined(ENABLE_GLCACHE) && ENABLE_GLCACHE == 1
+  g_test_add_data_func("/libCacheSim/cacheAlgo_GLCache", reader, test_GLCache);
+#endif
+#if defined(ENABLE_LRB) && ENABLE_LRB == 1
+  g_test_add_data_func("/libCacheSim/cacheAlgo_LRB", reader, test_LRB);
+#endif
 
   /* Belady requires reader that has next access information and can only use
    * oracleGeneral trace */
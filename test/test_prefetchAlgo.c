@@ -65,6 +65,136 @@ static void test_Mithril(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+/* mining on a helper thread with a fixed mining delay applies the
+ * associations exactly mining-delay requests after the snapshot, so the
+ * result is deterministic and close to the synchronous Mithril */
+static void test_Mithril_async(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {79803, 78501, 76126, 75256,
+                              72337, 72063, 71936, 71667};
+  uint64_t miss_byte_true[] = {3471318528, 3400258560, 3285093888, 3245231616,
+                               3092763136, 3077805568, 3075234816, 3061489664};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("MithrilAsync", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+  cache_t *sync_cache = create_test_cache("Mithril", cc_params, reader, NULL);
+  g_assert_true(sync_cache != NULL);
+  cache_stat_t *sync_res = simulate_at_multi_sizes_with_step_size(
+      reader, sync_cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  for (uint64_t i = 0; i < CACHE_SIZE / STEP_SIZE; i++) {
+    g_assert_cmpfloat((double)res[i].n_miss, <=, 1.001 * sync_res[i].n_miss);
+    g_assert_cmpfloat((double)res[i].n_miss, >=, 0.999 * sync_res[i].n_miss);
+  }
+  cache->cache_free(cache);
+  sync_cache->cache_free(sync_cache);
+  my_free(sizeof(cache_stat_t), res);
+  my_free(sizeof(cache_stat_t), sync_res);
+}
+
+/* the lightweight prefetchers are checked on the prefetch stat of one cache
+ * size, the trace has short sequential runs, the synthetic workload has
+ * N_SEQ_STREAM interleaved sequential streams of SEQ_STREAM_LEN blocks */
+#define N_SEQ_STREAM 4
+#define SEQ_STREAM_LEN 2500
+
+typedef struct {
+  int64_t n_prefetch;
+  int64_t n_prefetch_hit;
+  int64_t n_prefetch_unused;
+} prefetch_stat_true_t;
+
+static void _verify_prefetch_stat(const cache_t *cache, int64_t n_req,
+                                  int64_t n_miss,
+                                  const prefetch_stat_true_t *stat_true) {
+  const prefetch_stat_t *stat = &cache->prefetcher->stat;
+  print_prefetch_stat(cache->prefetcher);
+
+  g_assert_cmpint(stat->n_req, ==, n_req);
+  g_assert_cmpint(stat->n_demand_miss, ==, n_miss);
+  g_assert_cmpint(stat->n_prefetch_hit + stat->n_prefetch_unused, <=,
+                  stat->n_prefetch);
+  g_assert_true(prefetch_accuracy(stat) >= 0 && prefetch_accuracy(stat) <= 1);
+  g_assert_true(prefetch_coverage(stat) >= 0 && prefetch_coverage(stat) <= 1);
+  g_assert_cmpint(stat->n_prefetch, ==, stat_true->n_prefetch);
+  g_assert_cmpint(stat->n_prefetch_hit, ==, stat_true->n_prefetch_hit);
+  g_assert_cmpint(stat->n_prefetch_unused, ==, stat_true->n_prefetch_unused);
+}
+
+static void _test_block_prefetcher(reader_t *reader, const char *alg_name,
+                                   const prefetch_stat_true_t *trace_true,
+                                   const prefetch_stat_true_t *seq_true) {
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache(alg_name, cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+
+  request_t *req = new_request();
+  int64_t n_miss = 0;
+  reset_reader(reader);
+  read_one_req(reader, req);
+  while (req->valid) {
+    if (!cache->get(cache, req)) n_miss++;
+    read_one_req(reader, req);
+  }
+  reset_reader(reader);
+
+  printf("%s trace: ", alg_name);
+  _verify_prefetch_stat(cache, g_req_cnt_true, n_miss, trace_true);
+  cache->cache_free(cache);
+
+  /* only the first requests of each stream miss */
+  cache = create_test_cache(alg_name, cc_params, reader, NULL);
+  n_miss = 0;
+  for (int64_t i = 0; i < SEQ_STREAM_LEN; i++) {
+    for (int64_t s = 0; s < N_SEQ_STREAM; s++) {
+      req->obj_id = (s + 1) * 1000000 + i;
+      req->obj_size = 4096;
+      req->clock_time = i;
+      req->valid = true;
+      if (!cache->get(cache, req)) n_miss++;
+    }
+  }
+
+  printf("%s sequential: ", alg_name);
+  _verify_prefetch_stat(cache, N_SEQ_STREAM * SEQ_STREAM_LEN, n_miss,
+                        seq_true);
+  g_assert_cmpint(n_miss + seq_true->n_prefetch_hit, ==,
+                  N_SEQ_STREAM * SEQ_STREAM_LEN);
+
+  free_request(req);
+  cache->cache_free(cache);
+}
+
+static void test_OBL(gconstpointer user_data) {
+  prefetch_stat_true_t trace_true = {81547, 3808, 68493};
+  /* the first block of a stream misses */
+  prefetch_stat_true_t seq_true = {10000, 9996, 0};
+  _test_block_prefetcher((reader_t *)user_data, "OBL", &trace_true, &seq_true);
+}
+
+static void test_Sequential(gconstpointer user_data) {
+  prefetch_stat_true_t trace_true = {4000, 3712, 198};
+  /* the first min-run=2 blocks of a stream miss */
+  prefetch_stat_true_t seq_true = {10008, 9992, 0};
+  _test_block_prefetcher((reader_t *)user_data, "Sequential", &trace_true,
+                         &seq_true);
+}
+
+static void test_AMP(gconstpointer user_data) {
+  prefetch_stat_true_t trace_true = {9557, 7133, 1657};
+  /* the first block starts a stream, min-confirm=2 blocks confirm it */
+  prefetch_stat_true_t seq_true = {10000, 9988, 0};
+  _test_block_prefetcher((reader_t *)user_data, "AMP", &trace_true, &seq_true);
+}
+
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   srand(0);  // for reproducibility
@@ -80,6 +210,12 @@ int main(int argc, char *argv[]) {
   reader = setup_oracleGeneralBin_reader();
   // reader = setup_vscsi_reader_with_ignored_obj_size();
   g_test_add_data_func("/libCacheSim/cacheAlgo_Mithril", reader, test_Mithril);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_MithrilAsync", reader,
+                       test_Mithril_async);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_OBL", reader, test_OBL);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_Sequential", reader,
+                       test_Sequential);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_AMP", reader, test_AMP);
 
   return g_test_run();
 }
\ No newline at end of file
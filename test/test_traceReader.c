@@ -134,6 +134,104 @@ void test_reader_more2(gconstpointer user_data) {
   close_reader(cloned_reader);
 }
 
+/* the next access computed by the reader must be the same as the one in the
+ * oracleGeneral trace, a small memory limit spills it to the sidecar */
+void test_next_access(gconstpointer user_data) {
+  char data_path[1024];
+  _detect_data_path(data_path, "cloudPhysicsIO.oracleGeneral.bin");
+  reader_t *reader = setup_reader(data_path, ORACLE_GENERAL_TRACE, NULL);
+
+  reader_init_param_t init_params = default_reader_init_params();
+  init_params.compute_next_access = true;
+  init_params.next_access_mem_limit = GPOINTER_TO_INT(user_data);
+  reader_t *reader_computed =
+      setup_reader(data_path, ORACLE_GENERAL_TRACE, &init_params);
+  reader_t *reader_cloned = clone_reader(reader_computed);
+
+  request_t *req = new_request();
+  request_t *req_computed = new_request();
+  request_t *req_cloned = new_request();
+  size_t n_req = 0;
+  while (read_one_req(reader, req) == 0) {
+    g_assert_true(read_one_req(reader_computed, req_computed) == 0);
+    g_assert_true(read_one_req(reader_cloned, req_cloned) == 0);
+    g_assert_true(req->obj_id == req_computed->obj_id);
+    g_assert_cmpint(req->next_access_vtime, ==,
+                    req_computed->next_access_vtime);
+    g_assert_cmpint(req->next_access_vtime, ==, req_cloned->next_access_vtime);
+    n_req++;
+  }
+  g_assert_true(read_one_req(reader_computed, req_computed) != 0);
+  g_assert_true(n_req == trace_length);
+
+  /* reset starts from the first request again */
+  reset_reader(reader);
+  reset_reader(reader_computed);
+  read_one_req(reader, req);
+  read_one_req(reader_computed, req_computed);
+  g_assert_cmpint(req->next_access_vtime, ==, req_computed->next_access_vtime);
+
+  free_request(req);
+  free_request(req_computed);
+  free_request(req_cloned);
+  close_reader(reader_cloned);
+  close_reader(reader_computed);
+  close_reader(reader);
+}
+
+/* with a sampler, the next access is the index of the next request to the
+ * object in the sampled trace, read_first_req and read_last_req in the middle
+ * of the trace do not move it */
+void test_next_access_sampled(gconstpointer user_data) {
+  char data_path[1024];
+  _detect_data_path(data_path, "cloudPhysicsIO.oracleGeneral.bin");
+  /* the reader owns the sampler in init_params */
+  reader_init_param_t init_params = default_reader_init_params();
+  init_params.sampler = create_temporal_sampler(0.1);
+  reader_t *reader =
+      setup_reader(data_path, ORACLE_GENERAL_TRACE, &init_params);
+  init_params.sampler = create_temporal_sampler(0.1);
+  init_params.compute_next_access = true;
+  reader_t *reader_computed =
+      setup_reader(data_path, ORACLE_GENERAL_TRACE, &init_params);
+
+  /* the next access of the sampled trace from a backward pass */
+  request_t *req = new_request();
+  GArray *obj_ids = g_array_new(FALSE, FALSE, sizeof(obj_id_t));
+  while (read_one_req(reader, req) == 0) {
+    g_array_append_val(obj_ids, req->obj_id);
+  }
+  int64_t n_req = obj_ids->len;
+  int64_t *next_access = g_new(int64_t, n_req);
+  GHashTable *next_idx = g_hash_table_new(g_direct_hash, g_direct_equal);
+  for (int64_t i = n_req - 1; i >= 0; i--) {
+    gpointer key = GSIZE_TO_POINTER(g_array_index(obj_ids, obj_id_t, i));
+    gpointer v = g_hash_table_lookup(next_idx, key);
+    next_access[i] = v == NULL ? INT64_MAX : (int64_t)GPOINTER_TO_SIZE(v);
+    g_hash_table_insert(next_idx, key, GSIZE_TO_POINTER(i + 1));
+  }
+
+  request_t *req_other = new_request();
+  for (int64_t i = 0; i < n_req; i++) {
+    g_assert_true(read_one_req(reader_computed, req) == 0);
+    g_assert_true(req->obj_id == g_array_index(obj_ids, obj_id_t, i));
+    g_assert_cmpint(req->next_access_vtime, ==, next_access[i]);
+    if (i == 100) {
+      read_first_req(reader_computed, req_other);
+      read_last_req(reader_computed, req_other);
+    }
+  }
+  g_assert_true(read_one_req(reader_computed, req) != 0);
+
+  g_hash_table_destroy(next_idx);
+  g_free(next_access);
+  g_array_free(obj_ids, TRUE);
+  free_request(req);
+  free_request(req_other);
+  close_reader(reader_computed);
+  close_reader(reader);
+}
+
 void test_twr(gconstpointer user_data) {
   reader_t *reader = setup_reader("/Users/junchengy/twr.sbin", TWR_TRACE, NULL);
   gint64 n_req = get_num_of_req(reader);
@@ -210,6 +308,13 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func_full("/libCacheSim/reader_more2_oracleGeneral", reader,
                             test_reader_more2, test_teardown);
 
+  g_test_add_data_func("/libCacheSim/reader_next_access",
+                       GINT_TO_POINTER(0), test_next_access);
+  g_test_add_data_func("/libCacheSim/reader_next_access_sidecar",
+                       GINT_TO_POINTER(1), test_next_access);
+  g_test_add_data_func("/libCacheSim/reader_next_access_sampled", NULL,
+                       test_next_access_sampled);
+
   // g_test_add_data_func("/libCacheSim/test_twr", NULL, test_twr);
   return g_test_run();
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+//
+// the trace slice used by tracePrint and traceSlice, and the spatial sample
+// used by traceSample
+//
+
+#include <unistd.h>
+
+#include <unordered_set>
+#include <vector>
+
+#include "../libCacheSim/bin/traceUtils/sample.hpp"
+#include "../libCacheSim/bin/traceUtils/slice.hpp"
+#include "../libCacheSim/traceReader/generalReader/lcs.h"
+#include "common.h"
+
+/* the request at idx of a new reader of the same trace */
+static void read_req_at(reader_t *reader, int64_t idx, request_t *req) {
+  reader_t *ref = clone_reader(reader);
+  for (int64_t i = 0; i <= idx; i++) {
+    g_assert_cmpint(read_one_req(ref, req), ==, 0);
+  }
+  close_reader(ref);
+}
+
+static void test_slice_start_req(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  request_t *req = new_request(), *ref_req = new_request();
+
+  struct traceUtils::slice_param param;
+  traceUtils::init_slice_param(&param);
+  param.start_req = 1000;
+  g_assert_cmpint(traceUtils::slice_seek(reader, &param), ==, 1000);
+
+  read_one_req(reader, req);
+  read_req_at(reader, 1000, ref_req);
+  g_assert_cmpuint(req->obj_id, ==, ref_req->obj_id);
+  g_assert_cmpint(req->clock_time, ==, ref_req->clock_time);
+  g_assert_cmpint(req->obj_size, ==, ref_req->obj_size);
+
+  free_request(req);
+  free_request(ref_req);
+}
+
+static void test_slice_start_time(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  request_t *req = new_request(), *ref_req = new_request();
+
+  /* the trace has many requests of the same time, the slice starts at the
+   * first of them */
+  read_req_at(reader, 50000, ref_req);
+  int64_t start_time = ref_req->clock_time;
+
+  struct traceUtils::slice_param param;
+  traceUtils::init_slice_param(&param);
+  param.start_time = start_time;
+  int64_t idx = traceUtils::slice_seek(reader, &param);
+  g_assert_cmpint(idx, <=, 50000);
+
+  read_one_req(reader, req);
+  g_assert_cmpint(req->clock_time, ==, start_time);
+  read_req_at(reader, idx - 1, ref_req);
+  g_assert_cmpint(ref_req->clock_time, <, start_time);
+
+  free_request(req);
+  free_request(ref_req);
+}
+
+/* -n counts the requests from the start of the slice */
+static void test_slice_num_req(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  request_t *req = new_request();
+
+  struct traceUtils::slice_param param;
+  traceUtils::init_slice_param(&param);
+  param.start_req = 1000;
+  reader->cap_at_n_req = 20;
+  g_assert_cmpint(traceUtils::slice_seek(reader, &param), ==, 1000);
+
+  int64_t n_req = 0;
+  while (read_one_req(reader, req) == 0) n_req++;
+  g_assert_cmpint(n_req, ==, 20);
+
+  free_request(req);
+}
+
+/* the records of an lcs trace written by TraceWriter, the header stat must
+ * match the records */
+static std::vector<traceUtils::oracleGeneral_req_t> read_lcs_sample(
+    const char *path) {
+  FILE *f = fopen(path, "rb");
+  g_assert_nonnull(f);
+  lcs_trace_header_t header;
+  g_assert_cmpint(fread(&header, sizeof(header), 1, f), ==, 1);
+  g_assert_cmpuint(header.start_magic, ==, LCS_TRACE_START_MAGIC);
+
+  std::vector<traceUtils::oracleGeneral_req_t> reqs;
+  traceUtils::oracleGeneral_req_t og_req;
+  std::unordered_set<uint64_t> objs;
+  int64_t n_req_byte = 0;
+  while (fread(&og_req, sizeof(og_req), 1, f) == 1) {
+    reqs.push_back(og_req);
+    objs.insert(og_req.obj_id);
+    n_req_byte += og_req.obj_size;
+  }
+  fclose(f);
+
+  g_assert_cmpint(header.n_req, ==, (int64_t)reqs.size());
+  g_assert_cmpint(header.n_obj, ==, (int64_t)objs.size());
+  g_assert_cmpint(header.n_req_byte, ==, n_req_byte);
+
+  return reqs;
+}
+
+/* the samples of smaller ratios are subsets of the samples of larger ratios,
+ * a sample has all requests of its objects in the trace order */
+static void test_sample_nested(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  const double ratios[] = {0.5, 0.1, 0.01};
+  const int n_ratio = sizeof(ratios) / sizeof(ratios[0]);
+  char paths[n_ratio][64];
+
+  std::vector<struct TraceSample::sample> samples;
+  for (int i = 0; i < n_ratio; i++) {
+    snprintf(paths[i], sizeof(paths[i]), "test_sample_%g.lcs", ratios[i]);
+    samples.push_back({ratios[i], TraceSample::cal_max_hv(ratios[i]),
+                       new traceUtils::TraceWriter(paths[i], true)});
+  }
+  TraceSample::sample(reader, samples);
+  for (auto &s : samples) delete s.writer;
+
+  std::vector<traceUtils::oracleGeneral_req_t> larger =
+      read_lcs_sample(paths[0]);
+  g_assert_cmpint(larger.size(), >, 0);
+  for (int i = 1; i < n_ratio; i++) {
+    std::vector<traceUtils::oracleGeneral_req_t> smaller =
+        read_lcs_sample(paths[i]);
+    g_assert_cmpint(smaller.size(), >, 0);
+    g_assert_cmpint(smaller.size(), <, larger.size());
+
+    std::unordered_set<uint64_t> smaller_objs;
+    for (auto &r : smaller) smaller_objs.insert(r.obj_id);
+    size_t pos = 0;
+    for (auto &r : larger) {
+      if (smaller_objs.count(r.obj_id) == 0) continue;
+      g_assert_cmpuint(pos, <, smaller.size());
+      g_assert_cmpuint(smaller[pos].obj_id, ==, r.obj_id);
+      g_assert_cmpuint(smaller[pos].clock_time, ==, r.clock_time);
+      g_assert_cmpuint(smaller[pos].obj_size, ==, r.obj_size);
+      pos++;
+    }
+    g_assert_cmpuint(pos, ==, smaller.size());
+    larger = smaller;
+  }
+
+  for (int i = 0; i < n_ratio; i++) unlink(paths[i]);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+  reader_t *reader;
+
+  /* an uncompressed binary trace seeks to the start */
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func_full("/libCacheSim/slice_start_req_oracleGeneral",
+                            reader, test_slice_start_req, test_teardown);
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func_full("/libCacheSim/slice_start_time_oracleGeneral",
+                            reader, test_slice_start_time, test_teardown);
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func_full("/libCacheSim/slice_num_req_oracleGeneral",
+                            reader, test_slice_num_req, test_teardown);
+
+  /* other traces read to the start */
+  reader = setup_csv_reader_obj_num();
+  g_test_add_data_func_full("/libCacheSim/slice_start_req_csv", reader,
+                            test_slice_start_req, test_teardown);
+  reader = setup_csv_reader_obj_num();
+  g_test_add_data_func_full("/libCacheSim/slice_num_req_csv", reader,
+                            test_slice_num_req, test_teardown);
+
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func_full("/libCacheSim/sample_nested_oracleGeneral", reader,
+                            test_sample_nested, test_teardown);
+
+  return g_test_run();
+}